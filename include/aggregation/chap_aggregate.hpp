@@ -0,0 +1,101 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef CHAP_AGGREGATE_HPP
+#define CHAP_AGGREGATE_HPP
+
+#include <string>
+#include <vector>
+
+#include <gromacs/commandline/cmdlineoptionsmodule.h>
+#include <gromacs/options/ioptionscontainer.h>
+#include <gromacs/utility/real.h>
+
+#include "aggregation/frame_stream_aggregator.hpp"
+#include "io/molecular_path_obj_exporter.hpp"
+
+
+/*!
+ * \brief Command line module implementing the chap-aggregate tool.
+ *
+ * This tool regenerates the JSON, PDB, and OBJ/PLY output of a CHAP run from
+ * the frame stream files retained with -out-detailed, so that output 
+ * parameters such as the number of support points, the extrapolation 
+ * distance, or the energy anchor points can be changed without repeating the
+ * path finding. Several stream files of the same pathway (e.g. one per
+ * replicate trajectory) are aggregated in parallel and pooled.
+ *
+ * Neither topology nor trajectory are required. Residue names, chain IDs, 
+ * and hydrophobicities are instead taken from the results file of the 
+ * original run and the pore-lining annotation is written to a PDB file only
+ * if a reference structure is given.
+ *
+ * Alternatively, the aggregation states written by several runs over 
+ * different time windows of the same trajectory can be merged, which yields
+ * the same results as a single run over all frames.
+ */
+class ChapAggregate : public gmx::ICommandLineOptionsModule
+{
+    public:
+
+        // constructor:
+        ChapAggregate();
+
+        // methods from libgromacs base class:
+        virtual void init(gmx::CommandLineModuleSettings *settings);
+        virtual void initOptions(
+                gmx::IOptionsContainer *options,
+                gmx::ICommandLineOptionsModuleSettings *settings);
+        virtual void optionsFinished();
+        virtual int run();
+
+
+    private:
+
+        // input parameters:
+        std::vector<std::string> streamFileNames_;
+        std::vector<std::string> stateFileNames_;
+        std::string refJsonFileName_;
+        bool refJsonIsSet_;
+        std::string refPdbFileName_;
+        bool refPdbIsSet_;
+
+        // output parameters:
+        std::string outputBaseFileName_;
+        int outputNumPoints_;
+        real outputExtrapDist_;
+        std::vector<real> outputSupportRange_;
+        bool outputSupportRangeIsSet_;
+        eEnergyAnchor outputEnergyAnchor_;
+        real outputGridSampleDist_;
+        real outputCorrectionThreshold_;
+        eMeshFormat outputMeshFormat_;
+        real outputMeshTolerance_;
+        int outputMeshMaxVertices_;
+        int outputAnimStride_;
+        real outputAnimQuantStep_;
+        bool outputState_;
+};
+
+#endif
+
@@ -0,0 +1,189 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef FRAME_STREAM_AGGREGATOR_HPP
+#define FRAME_STREAM_AGGREGATOR_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+#include "external/rapidjson/document.h"
+
+#include "aggregation/pathway_aggregator.hpp"
+#include "analysis-setup/residue_information_provider.hpp"
+#include "io/colour.hpp"
+#include "io/mesh_sequence_io.hpp"
+#include "io/molecular_path_obj_exporter.hpp"
+#include "io/pdb_io.hpp"
+#include "path-finding/molecular_path.hpp"
+
+
+/*!
+ * Enum for the choice of anchor points at which the energy profile is set to 
+ * zero. The anchors are either the outermost pathway endpoints over all 
+ * frames, the mean pathway endpoints, or the ends of the (extrapolated) 
+ * range of support points.
+ */
+typedef enum {eEnergyAnchorEndpoints, 
+              eEnergyAnchorMeanEndpoints, 
+              eEnergyAnchorSupportRange} eEnergyAnchor;
+
+
+/*!
+ * \brief Aggregates a set of frame stream files into the final pathway 
+ * output.
+ *
+ * This class forms the aggregation half of a CHAP run. It reads one 
+ * newline-delimited JSON frame stream file per replicate trajectory, forms 
+ * time averages using one PathwayAggregator per replicate, and pools the 
+ * results. As the stream files contain all per-frame information needed for 
+ * this, aggregation can be repeated with different output parameters without
+ * rerunning the path finding, which is what the chap-aggregate tool does.
+ *
+ * Output parameters must be set before aggregate() is called, which performs
+ * the two passes over each stream file. Replicates are processed in parallel
+ * if OpenMP is available. If an animation file name is given, every n-th 
+ * frame of the first stream file is also written to a mesh sequence file 
+ * during the second pass. Afterwards the results can be written with 
+ * writeJson(), writePdb(), and writeSurface().
+ *
+ * Alternatively, the aggregation state can be saved with writeState() and 
+ * the states of several runs over disjoint time windows of the same 
+ * trajectories can be combined with mergeStates(), which yields the same 
+ * output as a single run over all frames up to floating point rounding. This
+ * requires all runs to use the same support points and energy anchor points,
+ * which is ensured by fixing the support range with setSupportRange() and 
+ * using the eEnergyAnchorSupportRange anchor type. With the default anchor 
+ * type, the anchor points depend on the pathway endpoints seen in each run, 
+ * so that mergeStates() will throw.
+ */
+class FrameStreamAggregator
+{
+    public:
+
+        // constructor:
+        FrameStreamAggregator(
+                const std::vector<std::string> &streamFileNames);
+
+        // setters for output parameters:
+        void setNumPoints(size_t numPoints);
+        void setExtrapDist(real extrapDist);
+        void setSupportRange(
+                real supportRangeLo, 
+                real supportRangeHi);
+        void setEnergyAnchor(eEnergyAnchor energyAnchor);
+        void setGridSampleDist(real gridSampleDist);
+        void setCorrectionThreshold(real correctionThreshold);
+        void setAdaptiveResolution(
+                real tolerance, 
+                size_t maxNumVertices);
+        void setMeshFormat(eMeshFormat meshFormat);
+        void setAnimation(
+                const std::string &fileName,
+                size_t stride,
+                real quantStep);
+        void setVerbose(bool verbose);
+
+        // aggregation of frame data:
+        void aggregate();
+
+        // saving and merging of aggregation states:
+        void writeState(
+                const std::string &fileName,
+                const ResidueInformationProvider &resInfo) const;
+        void mergeStates(
+                const std::vector<std::string> &fileNames,
+                ResidueInformationProvider &resInfo);
+
+        // getter functions:
+        size_t numReplicates() const;
+        const PathwayAggregator& replicate(size_t idx) const;
+        const PathwayAggregator& pooled() const;
+
+        // output functions:
+        void writeJson(
+                const std::string &fileName,
+                const ResidueInformationProvider &resInfo) const;
+        void writePdb(
+                const std::string &fileName,
+                PdbStructure structure) const;
+        void writeSurface(
+                const std::string &baseFileName,
+                const std::map<std::string, ColourPalette> &palettes) const;
+
+
+    private:
+
+        // input stream files:
+        std::vector<std::string> streamFileNames_;
+
+        // output parameters:
+        size_t numPoints_;
+        real extrapDist_;
+        bool supportRangeIsSet_;
+        real supportRangeLo_;
+        real supportRangeHi_;
+        eEnergyAnchor energyAnchor_;
+        real gridSampleDist_;
+        real correctionThreshold_;
+        real meshTolerance_;
+        size_t meshMaxNumVertices_;
+        eMeshFormat meshFormat_;
+        std::string animFileName_;
+        size_t animStride_;
+        real animQuantStep_;
+        bool verbose_;
+
+        // aggregation state:
+        std::vector<PathwayAggregator> replicates_;
+        PathwayAggregator pooled_;
+        rapidjson::Document firstFrameDoc_;
+        std::unique_ptr<MolecularPath> firstFramePath_;
+
+        // passes over individual stream files:
+        void scalarPass(size_t replicateIdx);
+        void profilePass(
+                size_t replicateIdx,
+                MolecularPathObjExporter &mpexp,
+                MeshSequenceExporter &animExp,
+                size_t &linesProcessedTotal,
+                size_t numFramesTotal);
+
+        // auxiliary functions:
+        std::vector<real> makeSupportPoints(
+                const PathwayAggregator &scalars) const;
+        void setFirstFrame(
+                const rapidjson::Value &frameDoc);
+        void anchorPoints(
+                const PathwayAggregator &scalars,
+                real &anchorPointLo,
+                real &anchorPointHi) const;
+        void configureSurfaceExporter(MolecularPathObjExporter &mpexp) const;
+};
+
+#endif
+
@@ -0,0 +1,95 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef OCCUPANCY_MAP_HPP
+#define OCCUPANCY_MAP_HPP
+
+#include <map>
+#include <utility>
+
+#include "gromacs/utility/real.h"
+
+
+/*!
+ * \brief Sparse two-dimensional histogram of particle positions.
+ *
+ * This class counts how often particles are found in the bins of a regular 
+ * two-dimensional grid, e.g. spanned by the arc length coordinate \f$ s \f$ 
+ * and the radial distance \f$ \rho \f$ or angle \f$ \phi \f$ of solvent 
+ * particles mapped onto a pathway. Bin \f$ (i, j) \f$ covers the interval
+ * \f$ [i \Delta x, (i + 1) \Delta x) \times [j \Delta y, (j + 1) \Delta y) \f$,
+ * so that the grid need not be known in advance and only bins that have been
+ * visited at least once are stored.
+ *
+ * Maps with the same bin widths can be combined with merge(), which simply
+ * adds up counts and frame numbers. This makes it possible to bin particles 
+ * on the fly in each frame and to pool the per-frame maps (as well as maps
+ * from different threads, replicates, or runs) afterwards. Dividing the 
+ * count in a bin by numFrames() gives the average occupancy of this bin.
+ */
+class OccupancyMap
+{
+    public:
+
+        // constructors:
+        OccupancyMap();
+        OccupancyMap(
+                real binWidthX, 
+                real binWidthY);
+
+        // adding data:
+        void add(
+                real x, 
+                real y);
+        void addCount(
+                int binX, 
+                int binY, 
+                unsigned long count);
+        void addFrames(
+                unsigned long numFrames);
+        void merge(
+                const OccupancyMap &other);
+
+        // getter functions:
+        real binWidthX() const;
+        real binWidthY() const;
+        unsigned long numFrames() const;
+        unsigned long count(
+                int binX, 
+                int binY) const;
+        const std::map<std::pair<int, int>, unsigned long>& counts() const;
+        bool empty() const;
+
+    private:
+
+        // bin widths:
+        real binWidthX_;
+        real binWidthY_;
+
+        // number of frames and counts per visited bin:
+        unsigned long numFrames_;
+        std::map<std::pair<int, int>, unsigned long> counts_;
+};
+
+#endif
+
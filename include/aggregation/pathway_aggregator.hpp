@@ -0,0 +1,162 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef PATHWAY_AGGREGATOR_HPP
+#define PATHWAY_AGGREGATOR_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+#include "external/rapidjson/document.h"
+
+#include "aggregation/occupancy_map.hpp"
+#include "analysis-setup/residue_information_provider.hpp"
+#include "io/results_json_exporter.hpp"
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * \brief Aggregates per-frame pathway data into time-averaged summaries.
+ *
+ * This class holds the aggregation state built from the per-frame data
+ * written to the frame stream file, i.e. the summary statistics of scalar
+ * pathway properties, the time series of these properties, the summary
+ * statistics of pathway profiles evaluated at a common set of support
+ * points, and the summary statistics of per-residue properties.
+ *
+ * Aggregation proceeds in two passes over the frame stream. In the first
+ * pass, each frame is handed to addScalarFrame(), which collects all scalar
+ * quantities. Since the range covered by the support points depends on the
+ * pathway endpoints in all frames, the support points can only be set after
+ * the first pass has been completed, usually via supportPointsFromScalars().
+ * In the second pass, each frame is handed to addProfileFrame(), which
+ * samples the pathway profiles and residue properties. If the frame stream
+ * contains binned solvent positions, these are accumulated into occupancy
+ * maps over arc length and radial distance (sRho) or angle (sPhi).
+ *
+ * Aggregators built from disjoint sets of frames (e.g. replicate
+ * trajectories) can be combined using merge(), provided they share the same
+ * support points and energy anchor points. The energy profile is stored 
+ * without the shift that sets the energy at the anchor points to zero, so 
+ * that this shift is correctly recomputed from the pooled anchor energies 
+ * upon merging. Note that means and variances are combined from the partial
+ * moments of each aggregator, so that merged statistics agree with those of
+ * a single pass over all frames only up to floating point rounding, but are
+ * not bit-identical to them.
+ *
+ * The complete aggregation state can be converted to JSON with stateToJson()
+ * and restored with stateFromJson(). This allows aggregators built in 
+ * separate runs (e.g. over different time windows of the same trajectory) to
+ * be merged later. As anchor points derived from the pathway endpoints differ
+ * between such runs, merge() will throw unless the anchor points are fixed
+ * independently of the data (e.g. at the ends of a fixed support range).
+ */
+class PathwayAggregator
+{
+    public:
+
+        // first pass over frame stream:
+        void addScalarFrame(
+                rapidjson::Document &frameDoc);
+
+        // set up support points for profile evaluation:
+        void supportPointsFromScalars(
+                size_t numPoints,
+                real extrapDist);
+        void setSupportPoints(
+                const std::vector<real> &supportPoints,
+                real anchorPointLo,
+                real anchorPointHi);
+
+        // second pass over frame stream:
+        void addProfileFrame(
+                rapidjson::Document &frameDoc);
+
+        // combine with aggregation state from other frames:
+        void merge(
+                const PathwayAggregator &other);
+
+        // getter functions:
+        size_t numScalarFrames() const;
+        size_t numProfileFrames() const;
+        const std::vector<real>& supportPoints() const;
+        const std::vector<int>& poreResIds() const;
+        const SummaryStatistics& scalarSummary(
+                const std::string &name) const;
+        const std::vector<SummaryStatistics>& residueSummary(
+                const std::string &name) const;
+        std::vector<SummaryStatistics> profileSummary(
+                const std::string &name) const;
+        std::vector<real> meanProfile(
+                const std::string &name) const;
+        const OccupancyMap& occupancyMap(
+                const std::string &name) const;
+
+        // export to results document:
+        void addToResults(
+                ResultsJsonExporter &results,
+                const ResidueInformationProvider &resInfo) const;
+
+        // lossless serialisation of aggregation state:
+        rapidjson::Value stateToJson(
+                rapidjson::Document::AllocatorType &alloc) const;
+        void stateFromJson(
+                const rapidjson::Value &state);
+
+
+    private:
+
+        // number of frames added in each pass:
+        size_t numScalarFrames_ = 0;
+        size_t numProfileFrames_ = 0;
+
+        // scalar summaries and time series:
+        std::vector<real> timeStamps_;
+        std::map<std::string, SummaryStatistics> scalarSummaries_;
+        std::map<std::string, std::vector<real>> scalarTimeSeries_;
+
+        // support and anchor points for profile evaluation:
+        std::vector<real> supportPoints_;
+        real anchorPointLo_ = 0.0;
+        real anchorPointHi_ = 0.0;
+        SummaryStatistics anchorEnergyLo_;
+        SummaryStatistics anchorEnergyHi_;
+
+        // profile summaries and time series:
+        std::map<std::string, std::vector<SummaryStatistics>> profileSummaries_;
+        std::map<std::string, std::vector<std::vector<real>>> profileTimeSeries_;
+
+        // residue summaries:
+        std::vector<int> poreResIds_;
+        std::map<std::string, std::vector<SummaryStatistics>> residueSummaries_;
+
+        // solvent occupancy maps:
+        std::map<std::string, OccupancyMap> occupancyMaps_;
+};
+
+#endif
+
@@ -67,6 +67,7 @@ class ResidueInformationProvider
         void nameFromTopology(const gmx::TopologyInformation &top);
         void chainFromTopology(const gmx::TopologyInformation &top);
         void hydrophobicityFromJson(const rapidjson::Document &doc);
+        void fromResidueSummary(const rapidjson::Value &residueSummary);
         void setDefaultHydrophobicity(const real hydrophobicity);
         
         // getter methods:
@@ -25,6 +25,7 @@
 #ifndef ABSTRACT_SPLINE_CURVE_HPP
 #define ABSTRACT_SPLINE_CURVE_HPP
 
+#include <array>
 #include <vector>
 
 #include <gromacs/math/vec.h>
@@ -82,6 +83,16 @@ class AbstractSplineCurve
 
         // internal utility functions:
         int findInterval(const real &evalPoint);
+
+        // piecewise polynomial representation (up to cubic splines):
+        static const int maxPolynomialDegree_ = 3;
+        typedef std::array<real, maxPolynomialDegree_ + 1> SpanPolynomial;
+        bool hasPolynomialSpans() const;
+        bool powerBasisCoefs(
+                int span,
+                SpanPolynomial ctrl,
+                SpanPolynomial &coefs) const;
+        static void differentiatePolynomial(SpanPolynomial &coefs);
 };
 
 
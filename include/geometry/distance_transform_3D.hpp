@@ -0,0 +1,89 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef DISTANCE_TRANSFORM_3D_HPP
+#define DISTANCE_TRANSFORM_3D_HPP
+
+#include <vector>
+
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Exact Euclidean distance transform on a regular three-dimensional 
+ * grid.
+ *
+ * Given a set of feature voxels, the transform computes for every voxel the
+ * squared Euclidean distance (in units of the grid spacing) to the nearest 
+ * feature voxel. The implementation follows Felzenszwalb and Huttenlocher, 
+ * who showed that the squared distance transform is separable and can be 
+ * obtained by a one-dimensional lower envelope of parabolas
+ *
+ * \f[
+ *      d(p) = \min_q \left( (p - q)^2 + f(q) \right)
+ * \f]
+ *
+ * applied successively along each grid axis. Each pass is linear in the 
+ * number of voxels and the grid lines within a pass are independent, so that
+ * they are distributed over threads if OpenMP is available.
+ *
+ * Voxels are indexed with the x-index running fastest, i.e. voxel 
+ * \f$ (i, j, k) \f$ has linear index \f$ i + n_x (j + n_y k) \f$. As squared
+ * distances between voxels are integers, the result is exact as long as it 
+ * can be represented in the floating point type. Voxels in a grid without
+ * any feature voxel are assigned infinite distance.
+ */
+class DistanceTransform3D
+{
+    public:
+
+        // constructor:
+        DistanceTransform3D(int numX, int numY, int numZ);
+
+        // grid size:
+        int numVoxels() const;
+
+        // transform:
+        std::vector<real> squaredDistances(
+                const std::vector<char> &isFeature) const;
+
+    private:
+
+        // grid dimensions:
+        int numX_;
+        int numY_;
+        int numZ_;
+
+        // utilities for separable transform:
+        void transformAxis(
+                std::vector<real> &dist, 
+                int axis) const;
+        static void transformLine(
+                const std::vector<real> &f,
+                std::vector<real> &d,
+                std::vector<int> &v,
+                std::vector<double> &z);
+};
+
+#endif
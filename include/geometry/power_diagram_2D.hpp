@@ -0,0 +1,123 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef POWER_DIAGRAM_2D_HPP
+#define POWER_DIAGRAM_2D_HPP
+
+#include <array>
+#include <vector>
+
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Power diagram of weighted sites in the plane, restricted to an
+ * axis-aligned rectangle.
+ *
+ * The power of a point \f$ \mathbf{x} \f$ with respect to a site 
+ * \f$ \mathbf{p}_i \f$ with weight \f$ w_i \f$ is 
+ *
+ * \f[
+ *      \pi_i(\mathbf{x}) = |\mathbf{x} - \mathbf{p}_i|^2 - w_i
+ * \f]
+ *
+ * and the power cell of a site is the region of the rectangle in which its
+ * power is smaller than that of all other sites. Power cells are convex 
+ * polygons (possibly empty) and are constructed here by clipping the 
+ * rectangle with the bisecting half planes of neighbouring sites. Sites are 
+ * binned on a uniform grid and neighbours are visited ring by ring, so that
+ * clipping stops as soon as no further site can intersect the cell.
+ *
+ * Each cell vertex records the generators of the two cell edges meeting in
+ * it. Generators are either site indices or one of the negative labels
+ * eBoxLoX, eBoxHiX, eBoxLoY, and eBoxHiY for the sides of the rectangle. 
+ * The edge leaving vertex k towards vertex k + 1 is generated by 
+ * nextGenerator of vertex k.
+ */
+class PowerDiagram2D
+{
+    public:
+
+        // types for points and cell vertices:
+        typedef std::array<real, 2> Point;
+        struct CellVertex
+        {
+            Point pos;
+            int prevGenerator;
+            int nextGenerator;
+        };
+
+        // generator labels for sides of bounding rectangle:
+        static const int eBoxLoX = -1;
+        static const int eBoxHiX = -2;
+        static const int eBoxLoY = -3;
+        static const int eBoxHiY = -4;
+
+        // constructor:
+        PowerDiagram2D(
+                const std::vector<Point> &sites,
+                const std::vector<real> &weights,
+                const Point &lo,
+                const Point &hi);
+
+        // access to diagram:
+        size_t numSites() const;
+        const std::vector<CellVertex>& cell(size_t i) const;
+        real power(size_t i, const Point &x) const;
+        size_t locate(const Point &x) const;
+
+    private:
+
+        // sites and bounding rectangle:
+        std::vector<Point> sites_;
+        std::vector<real> weights_;
+        Point lo_;
+        Point hi_;
+        real maxWeight_;
+
+        // cell polygons:
+        std::vector<std::vector<CellVertex>> cells_;
+
+        // uniform grid of sites in compressed row format:
+        Point gridLo_;
+        real gridSpacing_;
+        int gridNumX_;
+        int gridNumY_;
+        std::vector<size_t> gridOffsets_;
+        std::vector<size_t> gridSites_;
+
+        // construction utilities:
+        void buildGrid();
+        void constructCell(
+                size_t i,
+                std::vector<CellVertex> &buffer);
+        bool clipCell(
+                size_t i,
+                size_t j,
+                std::vector<CellVertex> &poly,
+                std::vector<CellVertex> &buffer) const;
+        int gridIndex(real x, real lo, int num) const;
+};
+
+#endif
@@ -25,6 +25,7 @@
 #ifndef SPLINE_CURVE_1D_HPP
 #define SPLINE_CURVE_1D_HPP
 
+#include <array>
 #include <utility>
 #include <vector>
 
@@ -62,19 +63,43 @@ class SplineCurve1D : public AbstractSplineCurve
         std::vector<real> evaluateMultiple(
                 const std::vector<real> &eval, 
                 unsigned int deriv);
+        void evaluateSorted(
+                const std::vector<real> &eval,
+                unsigned int maxDeriv,
+                std::vector<std::vector<real>> &values) const;
 
         // getter function for control points:
         std::vector<real> ctrlPoints() const;
 
         // compute spline properties:
         real length() const;
-        std::pair<real, real> minimum(const std::pair<real, real> &lim);
+        std::pair<real, real> minimum(const std::pair<real, real> &lim) const;
+        std::pair<real, real> maximum(const std::pair<real, real> &lim) const;
+        real integrateSquared(const std::pair<real, real> &lim) const;
+        std::vector<real> roots(
+                const std::pair<real, real> &lim,
+                real level = 0.0) const;
 
     private:
 
         // internal variables:
         std::vector<real> ctrlPoints_;
 
+        // piecewise polynomial utilities:
+        bool spanPolynomial(int span, SpanPolynomial &coefs) const;
+        real boundaryValue(bool upper) const;
+        std::pair<real, real> extremum(
+                const std::pair<real, real> &lim,
+                bool findMaximum) const;
+        int criticalPoints(
+                const SpanPolynomial &coefs,
+                real uLo,
+                real uHi,
+                std::array<real, 2> &crit) const;
+        inline real evaluatePolynomial(
+                const SpanPolynomial &coefs,
+                real u) const;
+
         // auxiliary functions for evaluation:
         inline real evaluateInternal(const real &eval, unsigned int deriv);
         inline real evaluateExternal(const real &eval, unsigned int deriv);
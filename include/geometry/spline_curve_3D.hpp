@@ -65,12 +65,21 @@ class SplineCurve3D : public AbstractSplineCurve
 
         // public interface for curve evaluation:
         gmx::RVec evaluate(const real &eval, unsigned int deriv);
+        std::vector<gmx::RVec> evaluateMultiple(
+                const std::vector<real> &eval,
+                unsigned int deriv);
+        void evaluateSorted(
+                const std::vector<real> &eval,
+                unsigned int maxDeriv,
+                std::vector<std::vector<gmx::RVec>> &values) const;
 
         // re-parameterisation methods:
         void arcLengthParam();
         // map points onto curve:
         double pointSqDist(gmx::RVec point, double eval);
-        gmx::RVec cartesianToCurvilinear(const gmx::RVec &cartPoint);
+        gmx::RVec cartesianToCurvilinear(
+                const gmx::RVec &cartPoint,
+                bool angular = false);
 
         // calculate differential properties of curve:
         real length(const real &lo, const real &hi);
@@ -101,6 +110,9 @@ class SplineCurve3D : public AbstractSplineCurve
         inline gmx::RVec evaluateInternal(const real &eval, unsigned int deriv);
         inline gmx::RVec evaluateExternal(const real &eval, unsigned int deriv);
         inline gmx::RVec computeLinearCombination(const SparseBasis &basis);
+        bool spanPolynomials(
+                int span, 
+                std::array<SpanPolynomial, DIM> &coefs) const;
 
         // curve length utilities:
         inline real arcLengthBoole(const real &lo, const real &hi);
@@ -120,6 +132,9 @@ class SplineCurve3D : public AbstractSplineCurve
         gmx::RVec projectionInExtrapRange(
                 const gmx::RVec &point,
                 const real &ds);
+        real angularCoordinate(
+                const gmx::RVec &cartPoint,
+                real arcLength);
 };
 
 #endif
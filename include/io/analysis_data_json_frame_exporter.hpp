@@ -25,6 +25,7 @@
 #ifndef ANALYSIS_DATA_JSON_FRAME_EXPORTER
 #define ANALYSIS_DATA_JSON_FRAME_EXPORTER
 
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <string>
@@ -65,6 +66,23 @@
  *
  * The repeated opening and closing of files may not be very efficient, but 
  * will likely not be the bottleneck of the analysis tool.
+ *
+ * If several exporters are attached to the same data, each of them can be
+ * restricted to a contiguous block of data sets by means of 
+ * setDataSetOffset(). Points in data sets outside this block are ignored and
+ * frames in which no points were added to this block are not written.
+ *
+ * Data sets that are not needed can be excluded with setDataSetMask(). These
+ * are left out of the JSON object entirely rather than being written as 
+ * empty arrays, and any points added to them are ignored.
+ *
+ * When an interrupted analysis is resumed, setResumeLineCount() can be used
+ * to keep the frames already written to an existing file. Any lines beyond
+ * this count (e.g. frames written after the last checkpoint) are discarded
+ * by truncating the file and new frames are appended to the remaining ones.
+ * If the size of the retained part is known from fileSize() at the time of
+ * the checkpoint, it can be given with setResumeByteOffset(), so that the
+ * file does not need to be scanned for line breaks.
  */
 class AnalysisDataJsonFrameExporter : public gmx::AnalysisDataModuleSerial
 {
@@ -93,6 +111,17 @@ class AnalysisDataJsonFrameExporter : public gmx::AnalysisDataModuleSerial
                 const std::vector<std::string> &dataSetNames);
         void setColumnNames(
                 const std::vector<std::vector<std::string>> &columnNames);
+        void setDataSetOffset(
+                size_t offset);
+        void setDataSetMask(
+                const std::vector<bool> &dataSetMask);
+        void setResumeLineCount(
+                size_t numLines);
+        void setResumeByteOffset(
+                uint64_t numBytes);
+
+        // getter function for number of bytes in output file:
+        uint64_t fileSize() const;
     
 
     private:
@@ -100,6 +129,16 @@ class AnalysisDataJsonFrameExporter : public gmx::AnalysisDataModuleSerial
         // names of data sets and columns:
         std::vector<std::string> dataSetNames_;
         std::vector<std::vector<std::string>> columnNames_;
+        size_t dataSetOffset_ = 0;
+        std::vector<bool> dataSetMask_;
+        bool frameHasPoints_ = false;
+        size_t resumeLineCount_ = 0;
+        uint64_t resumeByteOffset_ = 0;
+        bool resumeByteOffsetIsSet_ = false;
+        uint64_t fileSize_ = 0;
+
+        // internal utilities:
+        bool dataSetIsEnabled(size_t dataSetIdx) const;
 
         // internal variables:
         rapidjson::Document json_;
@@ -0,0 +1,64 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef BINARY_IO_HPP
+#define BINARY_IO_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <utility>
+
+
+/*!
+ * Writes the binary representation of a value to the given stream in little 
+ * endian byte order, irrespective of the byte order of the host. Used by the
+ * binary mesh exporters.
+ */
+template<typename T>
+inline void
+writeLittleEndian(
+        std::ostream &stream,
+        T value)
+{
+    // obtain byte representation:
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+
+    // reverse byte order on big endian hosts:
+    const uint16_t probe = 1;
+    if( *reinterpret_cast<const uint8_t*>(&probe) == 0 )
+    {
+        for(size_t i = 0; i < sizeof(T)/2; i++)
+        {
+            std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+        }
+    }
+
+    stream.write(bytes, sizeof(T));
+}
+
+#endif
+
@@ -0,0 +1,100 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef BUFFERED_TEXT_WRITER_HPP
+#define BUFFERED_TEXT_WRITER_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+/*!
+ * \brief Buffered writer for plain text files with locale independent number
+ * formatting.
+ *
+ * Text is collected in an internal buffer, which is only written to the file
+ * once it exceeds a given size or the file is closed. Floating point numbers
+ * are formatted with a fixed number of significant digits, matching the 
+ * default behaviour of std::ostream, but without consulting the global locale
+ * and without the overhead of formatted stream output. A decimal point is 
+ * therefore always used as separator, irrespective of the user's locale 
+ * settings.
+ *
+ * Used by WavefrontObjExporter and WavefrontMtlExporter, whose output files 
+ * can contain several hundred thousand lines.
+ */
+class BufferedTextWriter
+{
+    public:
+
+        // constructor and destructor:
+        BufferedTextWriter(
+                size_t bufferSize = 1 << 16,
+                int precision = 6);
+        ~BufferedTextWriter();
+
+        // file handling:
+        void open(const std::string &fileName);
+        void close();
+
+        // output operators:
+        BufferedTextWriter& operator<<(char c);
+        BufferedTextWriter& operator<<(const char *str);
+        BufferedTextWriter& operator<<(const std::string &str);
+        BufferedTextWriter& operator<<(int value);
+        BufferedTextWriter& operator<<(long value);
+        BufferedTextWriter& operator<<(unsigned int value);
+        BufferedTextWriter& operator<<(unsigned long value);
+        BufferedTextWriter& operator<<(float value);
+        BufferedTextWriter& operator<<(double value);
+
+        // formatting utility:
+        static void formatFloat(
+                double value, 
+                int precision, 
+                std::string &out);
+
+    private:
+
+        // file handle and name:
+        std::ofstream file_;
+        std::string fileName_;
+
+        // output buffer:
+        std::string buffer_;
+        size_t bufferSize_;
+        int precision_;
+
+        // utilities:
+        static bool roundSignificant(
+                double value, 
+                int power,
+                long long &mantissa);
+        void flush();
+        void writeUnsigned(unsigned long value);
+};
+
+#endif
+
@@ -21,17 +21,23 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-
 #ifndef JSON_DOC_IMPORTER_HPP
 #define JSON_DOC_IMPORTER_HPP
 
 #include <string>
+#include <vector>
 
 #include "external/rapidjson/document.h"
 
 
 /*!
  * \brief Imports JSON files and returns them as rapidjson objects.
+ *
+ * The function call operator reads the file into a single buffer and parses
+ * it into a self-contained document. For large files, InsituJsonDocument 
+ * avoids copying strings altogether, and member() extracts a single member
+ * by streaming through the file without building a document of the entire 
+ * file.
  */
 class JsonDocImporter
 {
@@ -43,6 +49,58 @@ class JsonDocImporter
 
         // define operator for file reading:
         rapidjson::Document operator()(std::string fileName);
+
+        // lazy access to individual members:
+        rapidjson::Document member(
+                const std::string &fileName,
+                const std::string &path);
+};
+
+
+/*!
+ * \brief JSON document parsed in-situ from a memory mapped file.
+ *
+ * The file is mapped into memory privately (i.e. copy-on-write, the file 
+ * itself is never modified) and parsed in-situ, so that all strings in the
+ * document point directly into the mapped file rather than being copied. All
+ * other values are allocated from a memory pool sized according to the 
+ * file. If the file can not be mapped, it is read into a buffer instead. 
+ *
+ * As the document refers to the file buffer, it is only valid for the 
+ * lifetime of this object, which therefore can not be copied.
+ */
+class InsituJsonDocument
+{
+    public:
+
+        // constructor and destructor:
+        explicit InsituJsonDocument(const std::string &fileName);
+        ~InsituJsonDocument();
+
+        // access to document:
+        rapidjson::Document& doc();
+
+    private:
+
+        // file buffer:
+        char *buffer_;
+        size_t size_;
+        bool isMapped_;
+        std::vector<char> fallbackBuffer_;
+
+        // pooled allocator and document using it:
+        rapidjson::MemoryPoolAllocator<> allocator_;
+        rapidjson::Document doc_;
+
+        // utilities:
+        static size_t fileSize(const std::string &fileName);
+        bool mapFile(const std::string &fileName);
+        void unmapFile();
+        void readFile(const std::string &fileName);
+
+        // prohibit copying:
+        InsituJsonDocument(const InsituJsonDocument&);
+        InsituJsonDocument& operator=(const InsituJsonDocument&);
 };
 
 #endif
@@ -0,0 +1,124 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef MESH_SEQUENCE_IO_HPP
+#define MESH_SEQUENCE_IO_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gromacs/utility/real.h>   
+
+#include "io/ply_io.hpp"
+
+
+/*!
+ * Enum for the encoding of vertex coordinates in a mesh sequence frame.
+ */
+typedef enum {eMeshFrameFloat = 0, 
+              eMeshFrameKey = 1, 
+              eMeshFrameDelta = 2} eMeshFrameType;
+
+
+/*!
+ * \brief Streaming serialiser for a time series of triangle meshes which all
+ * share the same topology, such as the pathway surface grid generated by 
+ * MolecularPathObjExporter::surfaceMesh().
+ *
+ * The faces and property names are taken from the first frame and written 
+ * only once, after which each frame only adds its time stamp, vertex 
+ * positions and property values. Properties are assumed to be constant on 
+ * each block of ringSize consecutive vertices (i.e. on each vertex ring of 
+ * the surface grid) and are therefore stored only once per ring.
+ *
+ * If a positive quantisation step is given, vertex coordinates are rounded 
+ * to integer multiples of this step. The first frame is then stored as an 
+ * absolute key frame of 32 bit integers and all subsequent frames as 16 bit 
+ * differences to the previous frame. A new key frame is written whenever a 
+ * difference does not fit into 16 bits. As differences are taken between 
+ * quantised coordinates, rounding errors do not accumulate over time. 
+ *
+ * All data is written in little endian byte order. The file layout is:
+ *
+ *  - header: the magic string "CHAPMSEQ", uint32 format version, uint32 
+ *    number of frames, uint32 number of vertices, uint32 ring size, float32 
+ *    quantisation step, uint32 number of properties followed by each 
+ *    property name as uint32 length and characters, uint32 number of faces 
+ *    followed by three int32 zero-based vertex indices per face
+ *  - per frame: uint8 frame type (0 = float32 coordinates, 1 = int32 key 
+ *    frame, 2 = int16 delta frame), float32 time stamp, three coordinates 
+ *    per vertex, and for each property one float32 value per ring
+ *
+ * Loaders for PyMOL and VMD are provided in scripts/visualisation.
+ */
+class MeshSequenceExporter
+{
+    public:
+
+        // constructor:
+        MeshSequenceExporter(
+                size_t ringSize, 
+                real quantStep);
+
+        // interface for export:
+        void open(const std::string &fileName);
+        void addFrame(
+                real time,
+                const PlyMesh &mesh);
+        void close();
+
+        // getter functions:
+        size_t numFrames() const;
+
+    private:
+
+        // format parameters:
+        const uint32_t version_ = 1;
+        size_t ringSize_;
+        real quantStep_;
+
+        // file handle and name:
+        std::fstream seq_;
+        std::string fileName_;
+
+        // topology of first frame:
+        size_t numVertices_;
+        std::vector<std::string> propertyNames_;
+
+        // state of stream:
+        uint32_t numFrames_;
+        std::streampos numFramesPos_;
+        std::vector<int32_t> prevQuant_;
+
+        // utilities for writing binary data:
+        void writeHeader(const PlyMesh &mesh);
+        void writeVertices(
+                const PlyMesh &mesh,
+                real time);
+        void checkTopology(const PlyMesh &mesh);
+};
+
+#endif
+
@@ -27,13 +27,13 @@
 
 #include <map>
 #include <string>
-#include <tuple>
-#include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "path-finding/molecular_path.hpp"
 #include "io/colour.hpp"
+#include "io/ply_io.hpp"
 #include "io/wavefront_mtl_io.hpp"
 #include "io/wavefront_obj_io.hpp"
 
@@ -47,6 +47,14 @@
  * which can be exploited to generate triangular faces. These faces can be used
  * to subsequently generate vertex normals. 
  *
+ * Each scalar property mapped onto the surface has its own layer of vertices.
+ * Vertices, weights, and normals are stored in dense arrays indexed by 
+ * \f$ (k, i, j) \f$, where \f$ k \f$ is the property index in order of
+ * addition and \f$ i \f$ and \f$ j \f$ index the \f$ s \f$ and 
+ * \f$ \phi \f$ coordinates, so that neighbouring vertices are found by 
+ * index arithmetic. The vertices of each property are contiguous in the same
+ * order as the linear indices used in faces().
+ *
  * This is all used by MolcularPathObjExporter.
  */
 class RegularVertexGrid
@@ -61,54 +69,58 @@ class RegularVertexGrid
                 std::vector<real> phi);
 
         // interface for adding vertices to the grid:
+        size_t addProperty(
+                const std::string &p);
         void addVertex(
                 size_t i, 
                 size_t j,
-                std::string p,
-                gmx::RVec vertex, 
+                size_t k,
+                const gmx::RVec &vertex, 
                 real weight);
-
-
-        void addColourScale(
-                std::string p,
-                std::vector<real> prop,
-                std::vector<gmx::RVec> palette);
-
-
-
-        void interpolateMissing();
         
         // method for determining vertex normals:
         void normalsFromFaces();
     
         // getter methods:
         std::vector<gmx::RVec> vertices(
-                std::string p);
+                const std::string &p);
         std::vector<std::pair<gmx::RVec, real>> weightedVertices(
-                std::string p);
+                const std::string &p);
         std::vector<gmx::RVec> normals(
-                std::string p);
+                const std::string &p);
         std::vector<WavefrontObjFace> faces(
-                std::string p);
+                const std::string &p);
         ColourScale colourScale(
-                std::string p);
+                const std::string &p);
 
     private:
 
-        int numX;
-        int numY;
-
-        const std::vector<real> phi_;
         const std::vector<real> s_;
-        std::unordered_set<std::string> p_;
+        const std::vector<real> phi_;
 
-        std::map<std::string, ColourScale> colourScales_;
+        // properties in order of addition:
+        std::vector<std::string> p_;
 
-        std::map<std::tuple<size_t, size_t, std::string>, gmx::RVec> vertices_;
-        std::map<std::tuple<size_t, size_t, std::string>, real> weights_;
-        std::map<std::tuple<size_t, size_t, std::string>, gmx::RVec> normals_;
+        std::map<std::string, ColourScale> colourScales_;
 
+        // dense per-vertex data:
+        std::vector<gmx::RVec> vertices_;
+        std::vector<real> weights_;
+        std::vector<bool> isSet_;
+        std::vector<gmx::RVec> normals_;
 
+        // index arithmetic:
+        size_t propertyIndex(
+                const std::string &p) const;
+        inline size_t linearIndex(
+                size_t i, 
+                size_t j, 
+                size_t k) const
+        {
+            return (k*s_.size() + i)*phi_.size() + j;
+        };
+        void checkComplete(
+                size_t k) const;
 
         void addTriangleNorm(
                 const gmx::RVec &sideA, 
@@ -117,6 +129,12 @@ class RegularVertexGrid
 };
 
 
+/*!
+ * Enum for file formats in which the pathway surface can be written.
+ */
+typedef enum {eMeshFormatObj, eMeshFormatPly} eMeshFormat;
+
+
 /*!
  * \brief Writes the surface of a MolecularPathway to an OBJ and MTL file.
  *
@@ -124,6 +142,19 @@ class RegularVertexGrid
  * a different scalar property mapped to the pathway surface. The colour 
  * associated with this property is written to an MTL file, which is referenced
  * at the beginning of the OBJ file.
+ *
+ * Alternatively, writePly() writes the surface to a binary PLY file, in which
+ * the geometry is stored only once and each scalar property is stored as a
+ * per-vertex attribute. Colouring is then left to the viewer. The underlying
+ * mesh is available through surfaceMesh(), which uses the same grid 
+ * resolution() and hence the same topology for any pathway unless adaptive
+ * resolution is enabled.
+ *
+ * By default, vertex rings are spaced evenly along the pathway. If 
+ * setAdaptiveResolution() is used, rings are instead placed by successively
+ * bisecting the intervals with the largest deviation from linear 
+ * interpolation in centre line, radius, and scalar properties until all 
+ * deviations are within tolerance or the vertex budget is exhausted.
  */
 class MolecularPathObjExporter
 {
@@ -134,6 +165,9 @@ class MolecularPathObjExporter
     FRIEND_TEST(
             MolecularPathObjExporterTest, 
             MolecularPathObjExporterAxisRotationTest);
+    FRIEND_TEST(
+            MolecularPathObjExporterTest, 
+            MolecularPathObjExporterAdaptiveRingTest);
 
 
     public:
@@ -146,6 +180,12 @@ class MolecularPathObjExporter
         void setGridSampleDist(real gridSampleDist);
         void setCorrectionThreshold(real correctionThreshold);
         void setPermitClashes(bool permitClashes);
+        void setAdaptiveResolution(
+                real tolerance, 
+                size_t maxNumVertices);
+
+        // getter functions:
+        std::pair<size_t, size_t> resolution() const;
 
         // interface for exporting:
         void operator()(
@@ -153,24 +193,56 @@ class MolecularPathObjExporter
                 std::string objectName,
                 MolecularPath &molPath,
                 std::map<std::string, ColourPalette> palettes);
+        void writePly(
+                std::string fileName,
+                MolecularPath &molPath);
+        PlyMesh surfaceMesh(
+                MolecularPath &molPath);
 
 
     private:
 
+        // grid resolution along and around the pathway:
+        const size_t numLen_ = 257;
+        const size_t numPhi_ = 50;
+
         // parameters:
         real extrapDist_;
         real gridSampleDist_;
         real correctionThreshold_;
 
+        // adaptive ring placement:
+        real adaptiveTolerance_;
+        size_t maxNumVertices_;
+        const real colourTolerance_ = 0.01;
+
         // functions for generating the pathway surface grid:
         std::vector<gmx::RVec> generateNormals(
                 const std::vector<gmx::RVec> &tangents);
+        std::vector<real> ringPositions(
+                SplineCurve3D &centreLine,
+                SplineCurve1D &radius,
+                std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
+                size_t numLen,
+                std::pair<real, real> range);
         RegularVertexGrid generateGrid(
                 SplineCurve3D &centreLine,
                 SplineCurve1D &radius,
                 std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
-                std::pair<size_t, size_t> resolution,
+                const std::vector<real> &s,
+                size_t numPhi);
+        std::vector<real> adaptiveRingPositions(
+                SplineCurve3D &centreLine,
+                SplineCurve1D &radius,
+                std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
                 std::pair<real, real> range);
+        real ringIntervalError(
+                SplineCurve3D &centreLine,
+                SplineCurve1D &radius,
+                std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
+                const std::vector<real> &propertyRanges,
+                real sLo,
+                real sHi);
         void generatePropertyGrid(
                 SplineCurve3D &centreLine,
                 SplineCurve1D &radius,
@@ -0,0 +1,58 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef OCCUPANCY_MAP_JSON_CONVERTER_HPP
+#define OCCUPANCY_MAP_JSON_CONVERTER_HPP
+
+#include "external/rapidjson/allocators.h"
+#include "external/rapidjson/document.h"
+
+#include "aggregation/occupancy_map.hpp"
+
+
+/*!
+ * \brief Converts OccupancyMap to JSON object and back.
+ *
+ * The sparse map is written as a dense grid covering all visited bins, which
+ * is the most compact representation for maps of particles in a pore. The
+ * JSON object contains the number of frames, the bin widths, the indices of 
+ * the lowest bin in either dimension (so that the lower edge of the grid is
+ * at binLo times binWidth), the number of bins in either dimension (shape), 
+ * and the counts in row-major order, i.e. with the second dimension varying
+ * fastest. This conversion is lossless, so that the same format is used both
+ * in the results file and for saving aggregation states.
+ */
+class OccupancyMapJsonConverter
+{
+    public:
+
+        // conversion functionality:
+        static rapidjson::Value convert(
+                const OccupancyMap &map,
+                rapidjson::Document::AllocatorType &alloc);
+        static OccupancyMap fromJson(
+                const rapidjson::Value &obj);
+};
+
+#endif
+
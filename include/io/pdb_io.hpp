@@ -47,6 +47,7 @@ class PdbStructure
 
         // create PDB file from topology:
         void fromTopology(const gmx::TopologyInformation &top);
+        void fromFile(const std::string &fileName);
 
         // 
         void setPoreFacing(
@@ -0,0 +1,102 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef PLY_IO_HPP
+#define PLY_IO_HPP
+
+#include <array>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/utility/real.h>   
+
+
+/*!
+ * \brief Data container representing a triangle mesh with an arbitrary number
+ * of named scalar properties per vertex, as written to PLY files.
+ *
+ * In contrast to WavefrontObjObject, where each property requires its own 
+ * copy of the geometry, all properties share one set of vertices, vertex 
+ * normals, and faces. Face indices are zero-based as in the PLY format.
+ */
+class PlyMesh
+{
+    public:
+
+        // functions to add data:
+        void addVertices(
+                const std::vector<gmx::RVec> &vertices);
+        void addVertexNormals(
+                const std::vector<gmx::RVec> &normals);
+        void addVertexProperty(
+                const std::string &name,
+                const std::vector<real> &values);
+        void addFace(
+                const std::array<int, 3> &face);
+
+        // returns flag indicating whether mesh is valid:
+        bool valid() const;
+
+        // functions to manipulate data:
+        void scale(real fac);
+
+        // data:
+        std::vector<gmx::RVec> vertices_;
+        std::vector<gmx::RVec> normals_;
+        std::vector<std::pair<std::string, std::vector<real>>> properties_;
+        std::vector<std::array<int, 3>> faces_;
+};
+
+
+/*!
+ * \brief Serialiser for writing a PlyMesh to a binary PLY file.
+ *
+ * Files are written in the binary little endian variant of the PLY format, 
+ * where all vertex coordinates, normals and properties are stored as single
+ * precision floats and faces as lists of integer indices. Byte order is 
+ * converted if necessary, so that the output is the same on all platforms.
+ */
+class PlyExporter
+{
+    public:
+
+        // interface for export:
+        void write(
+                const std::string &fileName,
+                const PlyMesh &mesh);
+
+    private:
+
+        // file handle:
+        std::fstream ply_;
+
+        // utility for writing header:
+        void writeHeader(const PlyMesh &mesh);
+};
+
+#endif
+
@@ -29,6 +29,7 @@
 
 #include "external/rapidjson/document.h"
 
+#include "aggregation/occupancy_map.hpp"
 #include "analysis-setup/residue_information_provider.hpp"
 #include "statistics/summary_statistics.hpp"
 
@@ -69,6 +70,11 @@ class ResultsJsonExporter
         void addResidueSummary(
                 std::string name,
                 const std::vector<SummaryStatistics> &resSummary);
+        void addOccupancyMap(
+                std::string name,
+                const OccupancyMap &map);
+        void addReplicate(
+                const ResultsJsonExporter &replicate);
 
         // interface for writing to file:
         void write(std::string filename);
@@ -33,6 +33,11 @@
 
 /*!
  * \brief Converts SummaryStatistics to JSON object.
+ *
+ * Besides the summary statistics themselves, which are written to the results
+ * file, the internal state of a SummaryStatistics object can be converted to
+ * and from JSON without loss, which is used to save and merge aggregation 
+ * states.
  */
 class SummaryStatisticsJsonConverter
 {
@@ -43,6 +48,13 @@ class SummaryStatisticsJsonConverter
                 const SummaryStatistics &sumStats,
                 rapidjson::Document::AllocatorType &alloc);
 
+        // lossless conversion of internal state:
+        static rapidjson::Value convertState(
+                const SummaryStatistics &sumStats,
+                rapidjson::Document::AllocatorType &alloc);
+        static SummaryStatistics fromState(
+                const rapidjson::Value &state);
+
     private:
 
 
@@ -44,6 +44,13 @@ class SummaryStatisticsVectorJsonConverter
         static rapidjson::Value convert(
                 const std::vector<SummaryStatistics> &sumStats,
                 rapidjson::Document::AllocatorType &alloc);
+
+        // lossless conversion of internal state:
+        static rapidjson::Value convertState(
+                const std::vector<SummaryStatistics> &sumStats,
+                rapidjson::Document::AllocatorType &alloc);
+        static std::vector<SummaryStatistics> fromState(
+                const rapidjson::Value &state);
 };
 
 #endif
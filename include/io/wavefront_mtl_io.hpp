@@ -25,13 +25,14 @@
 #ifndef WAVEFRONT_MTL_IO_HPP
 #define WAVEFRONT_MTL_IO_HPP
 
-#include <fstream>
 #include <string>
 #include <vector>
 
 #include <gromacs/math/vec.h>
 #include <gromacs/utility/real.h>
 
+#include "io/buffered_text_writer.hpp"
+
 
 /*!
  * \brief Representation of material in MTL format.
@@ -104,7 +105,7 @@ class WavefrontMtlExporter
     private:
 
         // file handle:
-        std::fstream file_;
+        BufferedTextWriter file_;
     
         // utilities for writing individual lines:
         void writeMaterialName(std::string name);
@@ -25,7 +25,6 @@
 #ifndef WAVEFRONT_OBJ_IO_HPP
 #define WAVEFRONT_OBJ_IO_HPP
 
-#include <fstream>
 #include <iostream>
 #include <map>
 #include <string>
@@ -35,6 +34,8 @@
 #include <gromacs/math/vec.h>
 #include <gromacs/utility/real.h>   
 
+#include "io/buffered_text_writer.hpp"
+
 
 /*!
  * \brief Abstract data type for faces in Wavefront OBJ objects.
@@ -162,7 +163,7 @@ class WavefrontObjExporter
         std::string crntMtlName_ = "";
 
         // file handle:
-        std::fstream obj_;
+        BufferedTextWriter obj_;
 
         // utilities for writing individual lines:
         inline void writeComment(std::string comment);
@@ -0,0 +1,100 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef FIXED_NELDER_MEAD_MODULE_HPP
+#define FIXED_NELDER_MEAD_MODULE_HPP
+
+#include <array>
+#include <map>
+#include <string>
+
+#include <gromacs/utility/real.h>
+
+#include "optim/fixed_optimisation.hpp"
+
+
+/*!
+ * \brief Nelder-Mead downhill simplex optimisation in a space of fixed 
+ * dimension \f$ D \f$.
+ *
+ * This class implements the same algorithm, parameters, and convergence 
+ * criteria as NelderMeadModule (which is documented in detail there), but 
+ * the dimension of the optimisation space is a template parameter. The 
+ * simplex, its centroid, and all trial points are stored in std::arrays, so
+ * that the optimisation loop does not perform any heap allocation. As with
+ * NelderMeadModule, the objective function is maximised.
+ *
+ * The class is explicitly instantiated for \f$ D = 2 \f$, which is the 
+ * dimension of the in-plane optimisation problems in probe-based path 
+ * finding.
+ */
+template<int D>
+class FixedNelderMeadModule
+{
+    public:
+
+        // constructor:
+        FixedNelderMeadModule();
+
+        // setting parameters and initial point:
+        void setParams(std::map<std::string, real> params);
+        void setObjFun(FixedObjectiveFunction<D> objFun);
+        void setInitGuess(const std::array<real, D> &guess);
+
+        // optimisation and result retrieval:
+        void optimise();
+        FixedOptimSpacePoint<D> getOptimPoint() const;
+        int numIterations() const;
+        
+    private:
+
+        // control parameters:
+        int maxIter_;
+        real initShiftFac_;
+        real simplexTol_;
+        real valueTol_;
+
+        // internal parameters:
+        real contractionPar_;
+        real expansionPar_;
+        real reflectionPar_;
+        real shrinkagePar_;
+
+        // objective function:
+        FixedObjectiveFunction<D> objFun_;
+
+        // internal optimisation state:
+        std::array<FixedOptimSpacePoint<D>, D + 1> simplex_;
+        FixedOptimSpacePoint<D> centroid_;
+        int numIter_;
+
+        // internal functions:
+        void sortSimplex();
+        void calcCentroid();
+        bool isConverged() const;
+};
+
+#endif
+
@@ -0,0 +1,115 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef FIXED_OPTIMISATION_HPP
+#define FIXED_OPTIMISATION_HPP
+
+#include <array>
+#include <functional>
+#include <utility>
+
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Representation of a point in an optimisation space of fixed 
+ * dimension \f$ D \f$ and its corresponding objective function value.
+ *
+ * This is the compile-time sized counterpart of OptimSpacePoint. As the 
+ * coordinates are stored in an std::array, copying and manipulating points 
+ * does not require any heap allocation, which makes this class suitable for
+ * the many small optimisation problems solved in probe-based path finding.
+ */
+template<int D>
+class FixedOptimSpacePoint : public std::pair<std::array<real, D>, real>
+{
+    public:
+
+        void add(const FixedOptimSpacePoint &other)
+        {
+            for(int i = 0; i < D; i++)
+            {
+                this -> first[i] += other.first[i];
+            }
+        };
+
+        void addScaled(const FixedOptimSpacePoint &other, real fac)
+        {
+            for(int i = 0; i < D; i++)
+            {
+                this -> first[i] += fac*other.first[i];
+            }
+        };
+
+        void scale(real fac)
+        {
+            for(int i = 0; i < D; i++)
+            {
+                this -> first[i] *= fac;
+            }
+        };
+
+        real dist2(const FixedOptimSpacePoint &other) const
+        {
+            real d = 0.0;
+            for(int i = 0; i < D; i++)
+            {
+                d += (this -> first[i] - other.first[i])
+                   * (this -> first[i] - other.first[i]);
+            }
+            return d;
+        };
+};
+
+
+/*!
+ * \brief Functor for comparing two points in a fixed-dimension optimisation
+ * space by their respective function value.
+ *
+ * Returns true if the value of the objective function is lower at the first 
+ * point than at the second point.
+ */
+template<int D>
+struct CompFixedOptimSpacePoints
+{
+    bool operator()(
+            const FixedOptimSpacePoint<D> &pointA, 
+            const FixedOptimSpacePoint<D> &pointB) const
+    {
+        return pointA.second < pointB.second;
+    }
+};
+
+
+/*!
+ * \typedef Shorthand notation for an objective function on a fixed-dimension
+ * optimisation space. Arguments are passed by reference so that evaluating 
+ * the function does not copy the point.
+ */
+template<int D>
+using FixedObjectiveFunction = std::function<real(const std::array<real, D>&)>;
+
+#endif
+
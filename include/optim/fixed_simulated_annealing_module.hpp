@@ -0,0 +1,130 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef FIXED_SIMULATED_ANNEALING_MODULE_HPP
+#define FIXED_SIMULATED_ANNEALING_MODULE_HPP
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gromacs/utility/real.h>
+#include <gromacs/random/threefry.h>
+#include <gromacs/random/uniformrealdistribution.h>
+
+#include "optim/fixed_optimisation.hpp"
+
+
+/*!
+ * \brief Simulated annealing in an optimisation space of fixed dimension
+ * \f$ D \f$.
+ *
+ * This class implements the same isotropic annealing procedure, parameters,
+ * and convergence criteria as SimulatedAnnealingModule, but the dimension of
+ * the optimisation space is a template parameter. Current, candidate, and 
+ * best state are stored in std::arrays and the buffers used by the 
+ * convergence criteria are allocated in setParams(), so that the annealing
+ * loop does not perform any heap allocation.
+ *
+ * Random numbers are drawn from the stream of the threefry engine selected 
+ * with setRandomStream() under the key given by setRandomSeed() (or by the
+ * saRandomSeed parameter, which is limited to the precision of real). 
+ * Annealing runs on different streams are statistically independent and 
+ * reproducible regardless of the order in which they are carried out, which
+ * allows several runs to proceed concurrently on different threads. Setting
+ * up a stream only requires resetting the counter of the engine, so that a 
+ * new stream can cheaply be used for every run. See annealingStream() for 
+ * how streams are assigned in path finding.
+ *
+ * The class is explicitly instantiated for \f$ D = 2 \f$, which is the 
+ * dimension of the in-plane optimisation problems in probe-based path 
+ * finding.
+ */
+template<int D>
+class FixedSimulatedAnnealingModule
+{
+    public:
+
+        // constructor:
+        FixedSimulatedAnnealingModule();
+
+        // public interface:
+        void setParams(std::map<std::string, real> params);
+        void setObjFun(FixedObjectiveFunction<D> objFun);
+        void setInitGuess(const std::array<real, D> &guess);
+        void setRandomSeed(uint64_t seed);
+        void setRandomStream(uint64_t stream);
+        void optimise();
+        FixedOptimSpacePoint<D> getOptimPoint() const;
+        int getNumCoolingIter() const;
+
+    private:
+
+        // parameters:
+        uint64_t seed_;
+        uint64_t stream_;
+        int maxCoolingIter_;
+        int convIter_;
+        real convTol_;
+        real minAccRate_;
+        real initTemp_;
+        real temp_;
+        real coolingFactor_;
+        real stepLengthFactor_;
+
+        // internal state:
+        std::array<real, D> crntState_;
+        std::array<real, D> candState_;
+        std::array<real, D> bestState_;
+        real crntCost_;
+        real candCost_;
+        real bestCost_;
+        int numCoolingIter_;
+
+        // ring buffers for convergence criteria:
+        std::vector<real> windowBestCost_;
+        std::vector<char> windowAccepted_;
+
+        // random number generation:
+        gmx::DefaultRandomEngine rng_;
+        gmx::UniformRealDistribution<real> candGenDistr_;
+        gmx::UniformRealDistribution<real> candAccDistr_;
+
+        // objective function:
+        FixedObjectiveFunction<D> objFun_;
+
+        // member functions:
+        void annealIsotropic();
+        bool acceptCandidateState();
+};
+
+
+// random number stream of annealing run in path finding:
+uint64_t annealingStream(uint64_t frame, uint64_t chain, uint64_t plane);
+
+#endif
+
@@ -107,7 +107,12 @@
  * \f]
  *
  * where the parameter \f$ \delta \f$ is typically set to 0.5. The algorithm is
- * terminated after a maximum number of iterations.
+ * terminated after a maximum number of iterations or as soon as the simplex
+ * has converged, i.e. once the largest distance of any vertex from the best 
+ * vertex and the spread of objective function values across the simplex both
+ * drop to or below their respective tolerances. As both tolerances default to
+ * zero, a simplex that has collapsed onto a single point is always considered
+ * converged.
  */
 class NelderMeadModule : public OptimisationModule
 {
@@ -128,12 +133,18 @@ class NelderMeadModule : public OptimisationModule
         // optimisation and result retrieval:
         void optimise();
         OptimSpacePoint getOptimPoint();
+        int numIterations() const;
         
     private:
 
         // control parameters:
         int maxIter_;
         real initShiftFac_;
+        real simplexTol_;
+        real valueTol_;
+
+        // number of iterations performed:
+        int numIter_;
 
         // internal parameters:
         real contractionPar_;
@@ -153,6 +164,7 @@ class NelderMeadModule : public OptimisationModule
 
         // internal functions:
         void calcCentroid();
+        bool isConverged();
 };
 
 #endif
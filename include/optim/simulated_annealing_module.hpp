@@ -25,6 +25,7 @@
 #ifndef SIMULATED_ANNEALING_MODULE_HPP
 #define SIMULATED_ANNEALING_MODULE_HPP
 
+#include <cstdint>
 #include <map>
 #include <string>
 
@@ -43,6 +44,16 @@
  * This class implements a simple version of the classic simulated annealing
  * algorithm for multidimensional optimisation. 
  *
+ * Annealing stops after a maximum number of cooling iterations. If a 
+ * convergence window is set, it stops earlier if the best cost has not 
+ * improved by more than a given tolerance over the last window of cooling
+ * iterations (stagnation), or if the fraction of candidate states accepted 
+ * within this window has dropped below a given minimum acceptance rate 
+ * (freezing).
+ *
+ * Random numbers are drawn from a threefry stream in the same way as in 
+ * FixedSimulatedAnnealingModule.
+ *
  * \todo Document parameters properly. 
  */
 class SimulatedAnnealingModule : public OptimisationModule
@@ -61,11 +72,14 @@ class SimulatedAnnealingModule : public OptimisationModule
         virtual void setInitGuess(std::vector<real> objFun);
         virtual void optimise();
         OptimSpacePoint getOptimPoint();
+        void setRandomSeed(uint64_t seed);
+        void setRandomStream(uint64_t stream);
 
         // getter functions (used in unit tests):
         int getStateDim(){return stateDim_;};
         int getMaxCoolingIter(){return maxCoolingIter_;};
-        int getSeed(){return seed_;};
+        int getNumCoolingIter(){return numCoolingIter_;};
+        uint64_t getSeed(){return seed_;};
 
         real getTemp(){return temp_;};
         real getCoolingFactor(){return coolingFactor_;};
@@ -89,9 +103,16 @@ class SimulatedAnnealingModule : public OptimisationModule
         void anneal();
 
         // parameters:
-        int seed_;					// seed for random number generator
+        uint64_t seed_;				// key of random number engine
+        uint64_t stream_;			// random number stream
         int stateDim_;				// dimension of state space
         int maxCoolingIter_;		// maximum number of cooling steps
+        int convIter_;              // window for convergence criteria
+        real convTol_;              // minimal improvement within window
+        real minAccRate_;           // minimal acceptance rate within window
+
+        // number of cooling steps performed:
+        int numCoolingIter_;
 
         // internal state variables:
         real temp_;				    // temperature
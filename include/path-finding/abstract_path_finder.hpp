@@ -25,6 +25,7 @@
 #ifndef ABSTRACT_PATH_FINDER_HPP
 #define ABSTRACT_PATH_FINDER_HPP
 
+#include <cstdint>
 #include <vector>
 
 #include <gromacs/trajectoryanalysis.h>
@@ -36,7 +37,10 @@
  * \brief Enaum for available path-finding methods.
  */
 typedef enum {ePathFindingMethodNaiveCylindrical,
-              ePathFindingMethodInplaneOptimised} ePathFindingMethod;
+              ePathFindingMethodInplaneOptimised,
+              ePathFindingMethodOptimisedDirection,
+              ePathFindingMethodPowerDiagram,
+              ePathFindingMethodDistanceTransform} ePathFindingMethod;
 
 
 /*!
@@ -59,6 +63,8 @@ class PathFindingParameters
         void setProbeStepLength(real probeStepLength);
         void setMaxProbeRadius(real maxProbeRadius);
         void setMaxProbeSteps(int maxProbeSteps);
+        void setRandomSeed(uint64_t randomSeed);
+        void setFrameIndex(uint64_t frameIndex);
 
         // getter methods:
         real nbhCutoff() const;
@@ -73,6 +79,12 @@ class PathFindingParameters
         int maxProbeSteps() const;
         bool maxProbeStepsIsSet() const;
 
+        uint64_t randomSeed() const;
+        bool randomSeedIsSet() const;
+
+        uint64_t frameIndex() const;
+        bool frameIndexIsSet() const;
+
     private:
 
         real nbhCutoff_;
@@ -86,6 +98,12 @@ class PathFindingParameters
 
         int maxProbeSteps_;
         bool maxProbeStepsIsSet_;
+
+        uint64_t randomSeed_;
+        bool randomSeedIsSet_;
+
+        uint64_t frameIndex_;
+        bool frameIndexIsSet_;
 };
 
 
@@ -115,6 +133,10 @@ class AbstractPathFinder
         std::vector<gmx::RVec> pathPoints(){return path_;};
         std::vector<real> pathRadii(){return radii_;};
 
+        // optimiser iterations spent on each path point:
+        std::vector<int> pathSaIterations() const;
+        std::vector<int> pathNmIterations() const;
+
 
     protected:
 
@@ -127,6 +149,11 @@ class AbstractPathFinder
         // data containers for path points and corresponding radii:
         std::vector<gmx::RVec> path_;
         std::vector<real> radii_;
+
+        // number of optimiser iterations for each path point (may be left 
+        // empty by path finders that do not use optimisation):
+        std::vector<int> saIter_;
+        std::vector<int> nmIter_;
 };
 
 #endif
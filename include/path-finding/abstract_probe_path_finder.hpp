@@ -25,6 +25,8 @@
 #ifndef ABSTRACT_PROBE_PATH_FINDER
 #define ABSTRACT_PROBE_PATH_FINDER
 
+#include <array>
+#include <cstdint>
 #include <vector>
 
 #include <gromacs/trajectoryanalysis.h>
@@ -34,6 +36,30 @@
 #include "path-finding/molecular_path.hpp"
 
 
+/*!
+ * \brief Verlet-style list of pore particles around a reference point.
+ *
+ * Holds the distance vectors from the reference point to all pore particles
+ * within the neighbourhood search cutoff plus a skin, as well as their van 
+ * der Waals radii. As the particles do not move during path finding, the list
+ * is complete for any probe position within one skin distance of the 
+ * reference point.
+ */
+struct ProbeNeighbourList
+{
+    // constructor:
+    ProbeNeighbourList() : isValid(false), refPos(), numBuilds(0) {};
+
+    bool isValid;
+    gmx::RVec refPos;
+    std::vector<gmx::RVec> dx;
+    std::vector<real> vdwRadii;
+
+    // number of times the list was rebuilt:
+    int numBuilds;
+};
+
+
 /*!
  * \brief Abstract class that implements infrastructure used by all probe-based
  * path finding algorithms (such as the probe position).
@@ -45,7 +71,7 @@ class AbstractProbePathFinder : public AbstractPathFinder
         // constructor:
         AbstractProbePathFinder(std::map<std::string, real> params,
                                 gmx::RVec initProbePos,
-                                std::vector<real> vdwRadii);
+                                const std::vector<real> &vdwRadii);
 
 
     protected:
@@ -54,7 +80,11 @@ class AbstractProbePathFinder : public AbstractPathFinder
         void prepareNeighborhoodSearch(
                 t_pbc *pbc,
                 gmx::AnalysisNeighborhoodPositions porePos,
-                real cutoff);
+                real cutoff,
+                bool useSkin = false);
+
+        // sets key and frame index of random number streams:
+        void setRandomStreamParameters(const PathFindingParameters &params);
 
 
         int maxProbeSteps_;
@@ -63,20 +93,38 @@ class AbstractProbePathFinder : public AbstractPathFinder
         real maxProbeRadius_;
         real nbhCutoff_;
 
-        std::vector<real> vdwRadii_;
+        const std::vector<real> &vdwRadii_;  // must outlive path finder
         real maxVdwRadius_;
 
         gmx::RVec initProbePos_;
         gmx::RVec crntProbePos_;
 
+        // random number streams of simulated annealing:
+        uint64_t randomSeed_;
+        uint64_t frameIndex_;
+
         t_pbc pbc_;
         gmx::AnalysisNeighborhood nbh_;
         gmx::AnalysisNeighborhoodSearch nbSearch_;
+
+        // cached neighbour list parameters:
+        real nbhSkin_;
+        real freeDistCutoff_;
+        bool useNbhList_;
+        ProbeNeighbourList nbhList_;
         
-        real findMinimalFreeDistance(std::vector<real> optimSpacePos);
+        real findMinimalFreeDistance(const std::array<real, 2> &optimSpacePos);
+        real findMinimalFreeDistance(const gmx::RVec &probePos);
+        real findMinimalFreeDistance(
+                const gmx::RVec &probePos,
+                ProbeNeighbourList &nbhList);
+        void buildNeighbourList(
+                const gmx::RVec &refPos,
+                ProbeNeighbourList &nbhList);
 
         // conversion between optimisation space and configuration space:
-        virtual gmx::RVec optimToConfig(std::vector<real> optimSpacePos) = 0;
+        virtual gmx::RVec optimToConfig(
+                const std::array<real, 2> &optimSpacePos) = 0;
 };
 
 
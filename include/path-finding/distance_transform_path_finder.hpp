@@ -0,0 +1,138 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef DISTANCE_TRANSFORM_PATH_FINDER_HPP
+#define DISTANCE_TRANSFORM_PATH_FINDER_HPP
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gromacs/trajectoryanalysis.h>
+
+#include "path-finding/abstract_probe_path_finder.hpp"
+
+
+/*!
+ * \brief Path finder that traces the pore centre line through a grid-based
+ * Euclidean distance transform of the space not occupied by the pore-forming
+ * atoms.
+ *
+ * Rather than moving a probe from plane to plane, this class discretises the
+ * bounding box of the pore-forming atoms plus a margin of bulk solvent on a 
+ * regular grid. Voxels whose centre lies within the van der Waals radius of 
+ * an atom are marked as occupied and the free distance of each voxel is 
+ * estimated by the exact distance transform of the occupied voxels (see 
+ * DistanceTransform3D). Free distances are capped at the maximum probe 
+ * radius, so that all of the bulk is considered equally open. The bulk 
+ * consists of the voxels at this cap that are connected to the boundary of 
+ * the grid.
+ *
+ * The centre line is the path between the two openings of the pore that 
+ * maximises the smallest free distance along the way (a maximin or widest 
+ * path). To keep it from passing around the outside of the protein, the 
+ * grid slice through the initial probe position may only be crossed inside
+ * the cross section of the pore, which is the enclosed region of unoccupied 
+ * voxels around the initial probe position. The bulk on either side of this
+ * slice forms the two openings. The path is extracted from the maximum 
+ * spanning tree of the voxel graph, which is grown by adding voxels in order
+ * of decreasing free distance and joining them to their already added 
+ * neighbours until both openings are connected. As the tree 
+ * path is a widest path between any two of its voxels, the centre line 
+ * follows the ridge of the distance transform on either side of the 
+ * bottleneck, rather than only respecting the narrowest constriction. The 
+ * path is then truncated where it enters the bulk on either side, i.e. where 
+ * the free distance first reaches the maximum probe radius, just as the 
+ * probe-based path finders terminate at this point.
+ *
+ * Finally, the voxel path is resampled with the probe step length and each 
+ * point is refined onto the continuous free distance function by 
+ * Nelder-Mead optimisation in the plane perpendicular to the local path 
+ * tangent. Because the path is found globally and does not rely on a fixed
+ * plane orientation, curved pores are followed naturally. The channel 
+ * direction vector only determines the orientation of the grid and of the 
+ * slice through the initial probe position, which the pore must cross and
+ * in which its cross section must be enclosed by pore-forming atoms on the 
+ * grid. The initial probe position needs only lie somewhere in this cross 
+ * section.
+ */
+class DistanceTransformPathFinder : public AbstractProbePathFinder
+{
+    public:
+
+        // constructor
+        DistanceTransformPathFinder(
+                std::map<std::string, real> params,
+                gmx::RVec initProbePos,
+                gmx::RVec chanDirVec,
+                t_pbc *pbc,
+                gmx::AnalysisNeighborhoodPositions porePos,
+                const std::vector<real> &vdwRadii);
+
+        // interface for setting parameters:
+        void setParameters(const PathFindingParameters &params);
+
+        // public interface for path finding:
+        void findPath();
+
+    private:
+
+        gmx::AnalysisNeighborhoodPositions porePos_;
+        t_pbc *pbc_;
+
+        gmx::RVec chanDirVec_;
+        gmx::RVec orthVecU_;
+        gmx::RVec orthVecW_;
+
+        // grid parameters:
+        real gridSpacing_;
+        std::vector<int> gridDim_;
+        gmx::RVec gridOrigin_;
+        std::array<int, 3> probeVoxel_;
+
+        // orientation of the plane used in refining current point:
+        gmx::RVec crntOrthVecU_;
+        gmx::RVec crntOrthVecW_;
+
+        // steps of the algorithm:
+        void buildGrid(
+                std::vector<gmx::RVec> &atomPos,
+                std::vector<real> &atomVdwRadii);
+        std::vector<real> freeDistances(
+                const std::vector<gmx::RVec> &atomPos,
+                const std::vector<real> &atomVdwRadii) const;
+        std::vector<char> bulkVoxels(const std::vector<real> &freeDist) const;
+        std::vector<char> poreCrossSection(
+                const std::vector<real> &freeDist) const;
+        std::vector<int> widestPath(const std::vector<real> &freeDist) const;
+        void refinePath(const std::vector<gmx::RVec> &points);
+
+        // grid utilities:
+        gmx::RVec voxelPosition(int idx) const;
+
+        gmx::RVec optimToConfig(const std::array<real, 2> &optimSpacePos);
+};
+
+#endif
@@ -25,17 +25,33 @@
 #ifndef INPLANE_OPTIMISED_PROBE_PATH_FINDER_HPP
 #define INPLANE_OPTIMISED_PROBE_PATH_FINDER_HPP
 
+#include <array>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
 
 #include <gromacs/trajectoryanalysis.h>
 
+#include "optim/fixed_optimisation.hpp"
 #include "path-finding/abstract_probe_path_finder.hpp"
 
 
 /*!
  * \brief Probe-based path-finder based on the HOLE algorithm.
+ *
+ * After the probe position in the plane through the initial probe position 
+ * has been optimised, the probe is advanced plane by plane in and against 
+ * the channel direction. As these two sweeps are independent of each other,
+ * they are carried out concurrently if OpenMP is available, each with its 
+ * own probe position and result containers. The optimisation of the initial
+ * position may be repeated from several random number streams 
+ * (saNumStarts parameter), which are likewise distributed over threads, and
+ * the best result is used. Each simulated annealing run draws from the 
+ * stream given by annealingStream() for the current frame, where the 
+ * forward and backward sweep form chains zero and one and the starts for the
+ * initial position use plane zero of chains zero to saNumStarts - 1, so that
+ * results do not depend on the number of threads.
  */
 class InplaneOptimisedProbePathFinder : public AbstractProbePathFinder
 {
@@ -47,7 +63,7 @@ class InplaneOptimisedProbePathFinder : public AbstractProbePathFinder
                                         gmx::RVec chanDirVec,
                                         t_pbc *pbc,
                                         gmx::AnalysisNeighborhoodPositions porePos,
-                                        std::vector<real> vdwRadii);
+                                        const std::vector<real> &vdwRadii);
 
         // interface for setting parameters:
         void setParameters(const PathFindingParameters &params);
@@ -64,10 +80,31 @@ class InplaneOptimisedProbePathFinder : public AbstractProbePathFinder
         gmx::RVec orthVecU_;
         gmx::RVec orthVecW_;
 
-        void optimiseInitialPos();
-        void advanceAndOptimise(bool forward);
+        // number of independent optimisations of initial position:
+        int numInitStarts_;
+
+        // path points found in one sweep along the channel:
+        struct ProbeSweep
+        {
+            std::vector<gmx::RVec> path;
+            std::vector<real> radii;
+            std::vector<int> saIter;
+            std::vector<int> nmIter;
+        };
 
-        gmx::RVec optimToConfig(std::vector<real> optimSpacePos);
+        void optimiseInitialPos();
+        void advanceAndOptimise(bool forward, ProbeSweep &sweep);
+        FixedOptimSpacePoint<2> optimiseInPlane(
+                const gmx::RVec &planeOrigin,
+                uint64_t stream,
+                ProbeNeighbourList &nbhList,
+                int &saIter,
+                int &nmIter);
+
+        gmx::RVec inplaneToConfig(
+                const gmx::RVec &planeOrigin,
+                const std::array<real, 2> &optimSpacePos) const;
+        gmx::RVec optimToConfig(const std::array<real, 2> &optimSpacePos);
 };
 
 #endif
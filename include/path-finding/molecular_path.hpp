@@ -101,9 +101,11 @@ class MolecularPath
 
         // interface for mapping particles onto pathway:
         std::vector<gmx::RVec> mapPositions(
-                const std::vector<gmx::RVec> &positions);
+                const std::vector<gmx::RVec> &positions,
+                bool angular = false);
         std::map<int, gmx::RVec> mapSelection(
-                const gmx::Selection &mapSel); 
+                const gmx::Selection &mapSel,
+                bool angular = false); 
         
         // check if points lie inside pore:
         std::map<int, bool> checkIfInside(
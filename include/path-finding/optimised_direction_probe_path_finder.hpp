@@ -22,56 +22,78 @@
 // THE SOFTWARE.
 
 
-#ifdef NOTDEFINED
-
 #ifndef OPTIMISED_DIRECTION_PROBE_PATH_FINDER_HPP
-#define OPTIMESED_DIRECTION_PROBE_PATH_FINDER_HPP
+#define OPTIMISED_DIRECTION_PROBE_PATH_FINDER_HPP
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gromacs/trajectoryanalysis.h>
 
 #include "path-finding/abstract_probe_path_finder.hpp"
 
+
 /*!
- * \brief Not yet implemented.
+ * \brief Probe-based path-finder that adapts the probe direction to the local
+ * pore axis.
+ *
+ * Like InplaneOptimisedProbePathFinder, this class moves a probe sphere 
+ * through the pore in steps of fixed length and optimises its position in a
+ * plane orthogonal to the direction of motion so as to maximise the free 
+ * distance. However, rather than keeping the direction of motion fixed to 
+ * the channel direction vector, the direction is updated after every step to 
+ * point from the previous to the current optimal probe position. The planes 
+ * in which the probe position is optimised are thus always approximately 
+ * orthogonal to the local pore axis, so that curved pathways can be traced 
+ * without cutting the pore obliquely. The channel direction vector only 
+ * determines the initial direction of motion.
+ *
+ * To prevent the probe from turning back on itself in wide cavities, the 
+ * change in direction per probe step is limited to maxDirChangeAngle_.
  */
 class OptimisedDirectionProbePathFinder : public AbstractProbePathFinder
 {
     public:
-        
-        OptimisedDirectionProbePathFinder(real probeStepLength,
-                                          real probeRadius,
-                                          real maxFreeDist,
-                                          int maxProbeSteps,
-                                          gmx::RVec initProbePos,
-                                          std::vector<real> vdwRadii,
-                                          gmx::AnalysisNeighborhoodSearch *nbSearch,
-                                          int saRandomSeed,
-                                          int saMaxCoolingIter,
-                                          int saNumCostSamples,
-                                          real saXi,
-                                          real saConvRelTol,
-                                          real saInitTemp,
-                                          real saCoolinGFactor,
-                                          real saStepLengthFactor,
-                                          bool saUseAdaptiveCandGen);
 
+        // constructor
+        OptimisedDirectionProbePathFinder(
+                std::map<std::string, real> params,
+                gmx::RVec initProbePos,
+                gmx::RVec chanDirVec,
+                t_pbc *pbc,
+                gmx::AnalysisNeighborhoodPositions porePos,
+                const std::vector<real> &vdwRadii);
+
+        // interface for setting parameters:
+        void setParameters(const PathFindingParameters &params);
+
+        // public interface for path finding:
         void findPath();
 
+        // maximum change in direction per probe step:
+        real maxDirChangeAngle() const;
+
     private:
 
-        real probeStepLength_;
+        // maximum change in direction per probe step (in radians):
+        const real maxDirChangeAngle_ = 0.5;
 
-        gmx::RVec initProbePos_;
-        gmx::RVec prevProbePos_;
-        gmx::RVec crntProbePos_;
+        gmx::AnalysisNeighborhoodPositions porePos_;
+        t_pbc *pbc_;
 
-        matrix inverseRotationMatrix_;
+        gmx::RVec chanDirVec_;
+        gmx::RVec dirVec_;
+        gmx::RVec orthVecU_;
+        gmx::RVec orthVecW_;
 
         void optimiseInitialPos();
-        void advanceAndOptimise(gmx::RVec initDirection);
-        void updateInverseRotationMatrix(gmx::RVec direction);
+        void advanceAndOptimise(bool forward);
+        void updateDirection(const gmx::RVec &direction);
 
-        gmx::RVec optimToConfig(std::vector<real> optimSpacePos);
+        gmx::RVec optimToConfig(const std::array<real, 2> &optimSpacePos);
 };
 
 #endif
 
-#endif
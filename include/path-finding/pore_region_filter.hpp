@@ -0,0 +1,104 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef PORE_REGION_FILTER_HPP
+#define PORE_REGION_FILTER_HPP
+
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/pbcutil/pbc.h>
+
+
+/*!
+ * \brief Selects the pore-forming particles inside a tube around a centre 
+ * line.
+ *
+ * The pathway selection usually comprises the entire protein, whereas only 
+ * particles close to the pore can restrict the probe. This class defines a 
+ * tube of given radius around either a polygonal centre line (typically the
+ * path found in the previous frame) or an infinite axis (typically the 
+ * channel direction vector through the initial probe position) and returns
+ * the indices of all particles inside of it, so that neighbourhood searches
+ * only need to be set up for these.
+ *
+ * A probe-based path finder whose searches reach no further than some 
+ * distance from the probe finds the same path in the reduced set of 
+ * particles as long as all path points satisfy contains(), i.e. lie at least
+ * this distance inside the tube. Otherwise the tube needs to be widened.
+ *
+ * Centre lines are simplified before use by dropping points that deviate by
+ * no more than the given tolerance from the chord between their neighbours,
+ * which keeps the cost of filtering low for finely sampled paths. All 
+ * distances refer to the simplified centre line. Distances are computed 
+ * with respect to the periodic image of a particle closest to the first 
+ * point of the centre line, which assumes that the centre line is shorter 
+ * than half the box.
+ */
+class PoreRegionFilter
+{
+    public:
+
+        // constructors:
+        PoreRegionFilter(
+                const std::vector<gmx::RVec> &centreLine,
+                real tubeRadius,
+                real simplifyTol,
+                const t_pbc *pbc);
+        PoreRegionFilter(
+                const gmx::RVec &axisPoint,
+                const gmx::RVec &axisDir,
+                real tubeRadius,
+                const t_pbc *pbc);
+
+        // filtering and checking of positions:
+        std::vector<int> filter(const std::vector<gmx::RVec> &positions) const;
+        bool contains(const std::vector<gmx::RVec> &points, real reach) const;
+        real distance(const gmx::RVec &pos) const;
+
+        // getter methods:
+        real tubeRadius() const;
+        size_t numCentreLinePoints() const;
+
+    private:
+
+        // centre line relative to origin:
+        std::vector<gmx::RVec> centreLine_;
+        bool isAxis_;
+        gmx::RVec origin_;
+        gmx::RVec axisDir_;
+        real tubeRadius_;
+        const t_pbc *pbc_;
+
+        // bounding box of tube:
+        gmx::RVec boxLo_;
+        gmx::RVec boxHi_;
+
+        gmx::RVec relativePosition(const gmx::RVec &pos) const;
+        real minDistanceSq(const gmx::RVec &relPos, real stopSq) const;
+};
+
+#endif
+
@@ -0,0 +1,128 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef POWER_DIAGRAM_PROBE_PATH_FINDER_HPP
+#define POWER_DIAGRAM_PROBE_PATH_FINDER_HPP
+
+#include <array>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gromacs/trajectoryanalysis.h>
+
+#include "geometry/power_diagram_2D.hpp"
+#include "path-finding/abstract_probe_path_finder.hpp"
+
+
+/*!
+ * \brief Deterministic probe-based path finder that locates the maximal free
+ * disc in each plane from a local power diagram.
+ *
+ * Like InplaneOptimisedProbePathFinder, this class marches a probe along the
+ * channel direction vector in steps of fixed length and in each plane finds
+ * the position that maximises the free distance to the van der Waals 
+ * surface. Rather than using simulated annealing and Nelder-Mead 
+ * optimisation, the pore-forming atoms near the plane are projected onto it
+ * and the power diagram of the projected atoms is constructed, where an atom 
+ * at projected position \f$ \mathbf{p}_i \f$ and out-of-plane distance 
+ * \f$ h_i \f$ has weight \f$ r_i^2 - h_i^2 \f$. The power of a point in the
+ * plane with respect to an atom then equals 
+ * \f$ (f_i + r_i)^2 - r_i^2 \f$, where \f$ f_i \f$ is the free distance
+ * between point and atom surface. For equal van der Waals radii the power
+ * diagram therefore coincides with the diagram of nearest atom surfaces and 
+ * the maximum of the free distance is attained at one of its vertices.
+ *
+ * Starting from the previous probe position, the algorithm follows the path 
+ * of steepest ascent of the free distance along the edges of the diagram 
+ * until it reaches a local maximum at one of its vertices. This mirrors the 
+ * local nature of the stochastic optimisation, but is deterministic and 
+ * requires a single neighbourhood search per plane. For unequal radii the 
+ * power diagram differs from the diagram of nearest atom surfaces (an 
+ * additively weighted Voronoi diagram), so that its vertex is only used as 
+ * starting point of a local ascent of the free distance to all atoms, which
+ * ends at the point equidistant to the surfaces of three atoms.
+ *
+ * The search in each plane is restricted to a square of half width equal to 
+ * the maximum probe radius around the previous probe position.
+ */
+class PowerDiagramProbePathFinder : public AbstractProbePathFinder
+{
+    public:
+
+        // constructor
+        PowerDiagramProbePathFinder(
+                std::map<std::string, real> params,
+                gmx::RVec initProbePos,
+                gmx::RVec chanDirVec,
+                t_pbc *pbc,
+                gmx::AnalysisNeighborhoodPositions porePos,
+                const std::vector<real> &vdwRadii);
+
+        // interface for setting parameters:
+        void setParameters(const PathFindingParameters &params);
+
+        // public interface for path finding:
+        void findPath();
+
+    private:
+
+        gmx::AnalysisNeighborhoodPositions porePos_;
+        t_pbc *pbc_;
+
+        gmx::RVec chanDirVec_;
+        gmx::RVec orthVecU_;
+        gmx::RVec orthVecW_;
+
+        // atoms projected onto current plane:
+        std::vector<PowerDiagram2D::Point> planePos_;
+        std::vector<real> planeSqDist_;
+        std::vector<real> planeVdwRadii_;
+
+        void optimiseInitialPos();
+        void advanceAndOptimise(bool forward);
+        std::pair<std::array<real, 2>, real> maximiseFreeDisc();
+
+        // utilities for free distance in plane:
+        void projectAtoms();
+        real freeDistance(size_t i, const PowerDiagram2D::Point &x) const;
+        real freeDistance(const PowerDiagram2D::Point &x) const;
+        real vertexFreeDistance(
+                size_t i, 
+                const PowerDiagram2D::CellVertex &v) const;
+        std::pair<std::array<real, 2>, real> ascendFreeDistance(
+                PowerDiagram2D::Point x) const;
+        PowerDiagram2D::Point steepestAscentDirection(
+                const std::vector<size_t> &atoms,
+                const PowerDiagram2D::Point &x) const;
+        bool refineVertex(
+                const std::array<size_t, 3> &atoms,
+                const PowerDiagram2D::Point &start,
+                PowerDiagram2D::Point &x) const;
+
+        gmx::RVec optimToConfig(const std::array<real, 2> &optimSpacePos);
+};
+
+#endif
@@ -42,6 +42,10 @@
  * For the minimum and maximum this is accomplished by a trivial comparison to
  * the currently stored minimum and maximum. For mean, variance, and standard
  * deviation a numerically stable algorithm due to Welford (1962) is used. 
+ * Two SummaryStatistics objects collected over disjoint datasets can be 
+ * combined using merge(), which implements the pairwise update formula due 
+ * to Chan et al. (1979). The result is identical (up to rounding) to what 
+ * would have been obtained by updating a single object with both datasets.
  *
  * Note that while standard deviation and variance are strictly speaking 
  * undefined for less then two data points, this class will return a value of
@@ -60,6 +64,12 @@ class SummaryStatistics
 
         // constructor and destructor:
         SummaryStatistics();        
+        SummaryStatistics(
+                real min,
+                real max,
+                real mean,
+                real sumSquaredMeanDiff,
+                int num);
 
         // getter methods:
         real min() const;
@@ -68,6 +78,7 @@ class SummaryStatistics
         real var() const;
         real sd() const;
         int num() const;
+        real sumSquaredMeanDiff() const;
 
         // updating method:
         void update(
@@ -76,6 +87,13 @@ class SummaryStatistics
                 std::vector<SummaryStatistics> &stat,
                 const std::vector<real> &newValues);
 
+        // merging method:
+        void merge(
+                const SummaryStatistics &other);
+        static void mergeMultiple(
+                std::vector<SummaryStatistics> &stat,
+                const std::vector<SummaryStatistics> &other);
+
         // manipulation methods:
         void shift(
                 const real shift);
@@ -26,14 +26,21 @@
 #define TRAJECTORYANALYSIS_HPP
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <gromacs/fileio/oenv.h>
+#include <gromacs/fileio/trxio.h>
 #include <gromacs/trajectoryanalysis.h>
 
+#include "aggregation/frame_stream_aggregator.hpp"
+
 #include "analysis-setup/residue_information_provider.hpp"
 
+#include "io/analysis_data_json_frame_exporter.hpp"
+#include "io/molecular_path_obj_exporter.hpp"
 #include "io/pdb_io.hpp"
 
 #include "path-finding/abstract_path_finder.hpp"
@@ -45,6 +52,15 @@
 using namespace gmx;
 
 
+/*!
+ * Enum for the amount of per-frame data written to the frame stream. Each 
+ * level includes the data of the levels below it.
+ */
+typedef enum {eStreamLevelProfiles, 
+              eStreamLevelResidues, 
+              eStreamLevelParticles} eStreamLevel;
+
+
 /*!
  * \brief Trajectory analysis module implementing the CHAP workflow.
  */
@@ -76,6 +92,34 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
 
     private:
 
+        // number of data sets in frame stream per pathway:
+        static const int numFrameStreamDataSets_ = 11;
+
+        // per-pathway parts of frame analysis and aggregation:
+        void analyzePathway(
+                size_t replicateIdx,
+                size_t pathwayIdx,
+                int frnr,
+                const t_trxframe &fr,
+                t_pbc *pbc,
+                TrajectoryAnalysisModuleData *pdata,
+                AnalysisDataHandle &dhFrameStream);
+        void analyzeReplicateFrames();
+        void analyzeReplicateFrame(
+                size_t replicateIdx);
+        void finishPathway(
+                size_t pathwayIdx,
+                int numFrames);
+        std::string frameStreamFileName(
+                size_t pathwayIdx,
+                size_t replicateIdx) const;
+
+        // checkpointing of analysis progress:
+        void writeCheckpoint(
+                int numFrames,
+                real lastTime);
+        void readCheckpoint();
+
         // find file path for index files:
         virtual void obtainNdxFilePathInfo();   
         std::string customNdxFileName_;
@@ -87,26 +131,67 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         
         // names of output files:
         std::string outputBaseFileName_;
-        std::string outputJsonFileName_;
-        std::string outputPdbFileName_;
+        std::vector<std::string> outputPathwayBaseFileNames_;
+        std::vector<std::string> outputJsonFileNames_;
+        std::vector<std::string> outputPdbFileNames_;
 
         
         // user specified selections:
         SelectionList solventSel_;
-        Selection pathwaySel_;
-        Selection ippSel_;
+        SelectionList pathwaySel_;
+        SelectionList ippSel_;
         bool ippSelIsSet_;
 
         
+        // replicate trajectories analysed alongside main trajectory:
+        std::vector<std::string> ensTrajFileNames_;
+        size_t numReplicates_;
+        gmx_output_env_t *ensOenv_;
+        std::vector<t_trxstatus*> ensTrxStatus_;
+        std::vector<t_trxframe> ensFrames_;
+        std::vector<char> ensFrameAvailable_;  // not bool, written concurrently
+
+        // each replicate evaluates its own copy of all selections, so that 
+        // replicates can be analysed concurrently:
+        struct ReplicateSelections
+        {
+            SelectionCollection selCol;
+            SelectionList pathwaySel;
+            SelectionList ippSel;
+            SelectionCollection poreMappingSelCol;
+            SelectionList poreMappingSelCal;
+            SelectionList poreMappingSelCog;
+            SelectionCollection solvMappingSelCol;
+            Selection solvMappingSelCog;
+        };
+        std::vector<std::unique_ptr<ReplicateSelections>> ensSel_;
+        std::vector<int> ensNumFrames_;
+        bool ensHasPbc_;
+        int ensEPBC_;
+        std::vector<std::unique_ptr<AnalysisData>> ensFrameStreamData_;
+        std::vector<AnalysisDataHandle> ensFrameStreamHandles_;
+
+
+        // checkpointing and resuming interrupted runs:
+        int checkpointInterval_;
+        bool resume_;
+        std::string checkpointFileName_;
+        int resumeNumFrames_;
+        real resumeLastTime_;
+        std::vector<size_t> streamNumLines_;   // one per pathway and replicate
+        std::vector<uint64_t> streamNumBytes_; // empty unless resumed
+        std::vector<AnalysisDataJsonFrameExporterPointer> frameStreamExporters_;
+
+        
         // internal selections for pore mapping:
         std::string pfSelString_;
         SelectionCollection poreMappingSelCol_;
         SelectionCollection solvMappingSelCol_;
-        Selection poreMappingSelCal_;
-        Selection poreMappingSelCog_;
+        SelectionList poreMappingSelCal_;
+        SelectionList poreMappingSelCog_;
         Selection solvMappingSelCog_;
         real poreMappingMargin_;
-        bool findPfResidues_;
+        std::vector<bool> findPfResidues_;
 
 
         // data containers:
@@ -126,9 +211,24 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         // output parameters:
         int outputNumPoints_;        
         real outputExtrapDist_;
+        std::vector<real> outputSupportRange_;
+        bool outputSupportRangeIsSet_;
+        eEnergyAnchor outputEnergyAnchor_;
         real outputGridSampleDist_;
         real outputCorrectionThreshold_;
         bool outputDetailed_;
+        eStreamLevel outputStreamLevel_;
+        bool outputStreamSampleOnly_;
+        bool outputOccupancy_;
+        real outputOccupancyBinWidthS_;
+        real outputOccupancyBinWidthRho_;
+        int outputOccupancyNumBinsPhi_;
+        bool outputState_;
+        eMeshFormat outputMeshFormat_;
+        real outputMeshTolerance_;
+        int outputMeshMaxVertices_;
+        int outputAnimStride_;
+        real outputAnimQuantStep_;
         PdbStructure outputStructure_;
 
 
@@ -145,14 +245,17 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         real pfProbeRadius_;
         real pfMaxProbeRadius_;
         int pfMaxProbeSteps_;
-        std::vector<real> pfInitProbePos_;
+        real pfCullMargin_;
+        std::vector<real> pfInitProbePos_;  // three components per pathway
         bool pfInitProbePosIsSet_;
-        std::vector<real> pfChanDirVec_;
+        std::vector<real> pfChanDirVec_;    // three components per pathway
         bool pfChanDirVecIsSet_;
         ePathAlignmentMethod pfPathAlignmentMethod_;
         PathFindingParameters pfParams_;
         std::map<std::string, real> pfPar_;
         std::unordered_map<int, real> vdwRadii_;
+        std::vector<std::vector<real>> pathwayVdwRadii_;    // one per pathway
+        std::vector<std::vector<gmx::RVec>> prevPathPoints_;   // one per pathway and replicate
         real maxVdwRadius_;
 
 
@@ -160,6 +263,8 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         int64_t saRandomSeed_;
         bool saRandomSeedIsSet_;
         int saMaxCoolingIter_;
+        int saConvIter_;
+        int saNumStarts_;
         int saNumCostSamples_;
         real saXi_;
         real saInitTemp_;
@@ -185,10 +290,6 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         real hpEvalRangeCutoff_;
         real hpResolution_;
         DensityEstimationParameters hydrophobKernelParams_;
-        
-        
-        // molecular pathway for first frame:
-        std::unique_ptr<MolecularPath> molPathAvg_;
 };
 
 #endif
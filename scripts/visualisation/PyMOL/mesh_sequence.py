@@ -0,0 +1,211 @@
+# CHAP - The Channel Annotation Package
+# 
+# Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+# Stephen J. Tucker
+# 
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+from pymol import cmd
+from pymol.cgo import *
+import struct
+
+
+class MeshSequenceImporter:
+    """ Reads time series of pathway surfaces from CHAP mesh sequence files.
+
+    Mesh sequence files are written by CHAP if the -out-anim-stride flag is 
+    set. The surface topology (i.e. the list of triangles) is stored once in
+    the file header, while each frame contains a time stamp, the vertex 
+    positions and the values of all scalar properties on each ring of 
+    vertices. Vertex positions may be quantised and delta encoded with respect
+    to the previous frame.
+    """
+
+    def read(self, filename):
+
+        # read entire file into memory:
+        with open(filename, "rb") as f:
+            self.__data = f.read()
+        self.__offset = 0
+
+        # check format identifier:
+        if self.__data[0:8] != b"CHAPMSEQ":
+            raise IOError(filename + " is not a CHAP mesh sequence file.")
+        self.__offset = 8
+
+        # read header:
+        seq = dict()
+        seq["version"] = self.__unpack("<I")[0]
+        num_frames = self.__unpack("<I")[0]
+        num_vertices = self.__unpack("<I")[0]
+        seq["ring_size"] = self.__unpack("<I")[0]
+        seq["quant_step"] = self.__unpack("<f")[0]
+
+        # property names:
+        num_properties = self.__unpack("<I")[0]
+        seq["property_names"] = []
+        for i in range(0, num_properties):
+            length = self.__unpack("<I")[0]
+            name = self.__data[self.__offset:self.__offset + length]
+            seq["property_names"].append(name.decode("ascii"))
+            self.__offset += length
+
+        # faces:
+        num_faces = self.__unpack("<I")[0]
+        indices = self.__unpack("<" + str(3*num_faces) + "i")
+        seq["faces"] = [indices[3*i:3*i + 3] for i in range(0, num_faces)]
+
+        # read frames:
+        seq["frames"] = []
+        num_rings = num_vertices // seq["ring_size"]
+        coords = []
+        for i in range(0, num_frames):
+            
+            # frame type and time stamp:
+            frame_type = self.__unpack("<B")[0]
+            frame = dict()
+            frame["time"] = self.__unpack("<f")[0]
+
+            # decode vertex coordinates:
+            n = str(3*num_vertices)
+            if frame_type == 0:
+                coords = list(self.__unpack("<" + n + "f"))
+            elif frame_type == 1:
+                coords = list(self.__unpack("<" + n + "i"))
+            elif frame_type == 2:
+                deltas = self.__unpack("<" + n + "h")
+                coords = [c + d for c, d in zip(coords, deltas)]
+            else:
+                raise IOError("Unknown frame type in " + filename + ".")
+
+            # convert quantised coordinates to positions:
+            if frame_type == 0:
+                flat = coords
+            else:
+                flat = [c*seq["quant_step"] for c in coords]
+            frame["vertices"] = [flat[3*j:3*j + 3] 
+                                 for j in range(0, num_vertices)]
+
+            # property values per ring:
+            frame["properties"] = dict()
+            for name in seq["property_names"]:
+                frame["properties"][name] = self.__unpack(
+                    "<" + str(num_rings) + "f")
+
+            seq["frames"].append(frame)
+
+        # return sequence dictionary:
+        return seq
+
+
+    def __unpack(self, fmt):
+        """ Unpacks binary data at the current offset and advances it. """
+
+        values = struct.unpack_from(fmt, self.__data, self.__offset)
+        self.__offset += struct.calcsize(fmt)
+        return values
+
+
+def import_mesh_sequence(filename):
+    """ Imports a CHAP mesh sequence file.
+
+    Args:
+        filename: name of the file to read
+
+    Returns:
+        dictionary containing faces, property names and a list of frames
+    """
+
+    importer = MeshSequenceImporter()
+    return importer.read(filename)
+
+
+def _vertex_normals(vertices, faces):
+    """ Calculates vertex normals as sum of normals of adjacent faces. """
+
+    normals = [[0.0, 0.0, 0.0] for v in vertices]
+    for face in faces:
+        a = vertices[face[0]]
+        b = vertices[face[1]]
+        c = vertices[face[2]]
+        u = [b[k] - a[k] for k in range(0, 3)]
+        w = [c[k] - a[k] for k in range(0, 3)]
+        n = [u[1]*w[2] - u[2]*w[1], u[2]*w[0] - u[0]*w[2], u[0]*w[1] - u[1]*w[0]]
+        for idx in face:
+            for k in range(0, 3):
+                normals[idx][k] += n[k]
+    for n in normals:
+        length = (n[0]**2 + n[1]**2 + n[2]**2)**0.5
+        if length > 0.0:
+            n[0] /= length
+            n[1] /= length
+            n[2] /= length
+    return normals
+
+
+def _colour(value, lo, hi):
+    """ Maps a scalar to a blue-white-red colour scale. """
+
+    if hi <= lo:
+        return [1.0, 1.0, 1.0]
+    x = 2.0*(value - lo)/(hi - lo) - 1.0
+    x = min(max(x, -1.0), 1.0)
+    if x < 0.0:
+        return [1.0 + x, 1.0 + x, 1.0]
+    return [1.0, 1.0 - x, 1.0 - x]
+
+
+def draw_mesh_sequence(seq, prop = None, name = "surface_animation"):
+    """ Draws each frame of a mesh sequence as one state of a CGO object.
+
+    Args:
+        seq: dictionary created by import_mesh_sequence
+        prop: name of property used for colouring (uses first if None or
+              not present in the sequence)
+        name: name of the CGO object in PyMOL
+    """
+
+    # select property and find its range over all frames:
+    if prop not in seq["property_names"]:
+        prop = seq["property_names"][0]
+    values = [v for f in seq["frames"] for v in f["properties"][prop]]
+    lo = min(values)
+    hi = max(values)
+
+    # one state per frame:
+    for state, frame in enumerate(seq["frames"]):
+
+        vertices = frame["vertices"]
+        normals = _vertex_normals(vertices, seq["faces"])
+        ring_values = frame["properties"][prop]
+
+        # create a CGO object:
+        cgo_object = [ BEGIN, TRIANGLES ]
+        for face in seq["faces"]:
+            for idx in face:
+                col = _colour(ring_values[idx // seq["ring_size"]], lo, hi)
+                cgo_object.extend([
+                    COLOR, col[0], col[1], col[2],
+                    NORMAL, normals[idx][0], normals[idx][1], normals[idx][2],
+                    VERTEX, vertices[idx][0], vertices[idx][1], vertices[idx][2]])
+        cgo_object.extend([END])
+
+        # load into PyMOL as separate state:
+        cmd.load_cgo(cgo_object, name, state + 1)
@@ -34,6 +34,7 @@ import sys                                  # ability to append to import path
 sys.path.append(path.dirname(__script__))   # find wobj.py in script directory
 import argparse                             # command line argument parsing
 import wobj as wobj                         # import and draw OBJ meshes
+import mesh_sequence as msq                 # import and draw mesh sequences
 
 # parse command line arguments: 
 parser = argparse.ArgumentParser()
@@ -52,6 +53,11 @@ parser.add_argument(
     nargs = "?",
     const = None,
     default = None)
+parser.add_argument(
+    "-animation",
+    nargs = "?",
+    const = "output_animation.msq",
+    default = None)
 args = parser.parse_args()
 
 
@@ -91,3 +97,12 @@ obj = wobj.import_wobj(args.surface)
 # draw all groups in the OBJ file:
 wobj.draw_wobj(obj, args.property)
 
+
+###############################################################################
+# ADD PORE SURFACE ANIMATION
+###############################################################################
+
+# read and draw mesh sequence (one state per frame):
+if args.animation is not None:
+    seq = msq.import_mesh_sequence(args.animation)
+    msq.draw_mesh_sequence(seq, args.property)
@@ -0,0 +1,238 @@
+# CHAP - The Channel Annotation Package
+# 
+# Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+# Stephen J. Tucker
+# 
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+namespace eval MSEQ {
+
+# global variables in this namespace:
+set SEQUENCE ""
+set PROPERTY ""
+set STRIDE 1
+
+# Parses a CHAP mesh sequence file as written with the -out-anim-stride flag.
+# The returned dictionary contains the ring size, the property names, a flat 
+# list of zero-based face indices, and a list of frames, each of which holds a
+# time stamp, a flat list of vertex coordinates and a dictionary mapping each
+# property name to its values on each vertex ring.
+#
+# INPUT:
+# filename - name of mesh sequence file to import
+proc import_mesh_sequence {filename} {
+
+    # read entire file:
+    set seqfile [open $filename r]
+    fconfigure $seqfile -translation binary
+    set data [read $seqfile]
+    close $seqfile
+
+    # check format identifier:
+    if { [string range $data 0 7] != "CHAPMSEQ" } {
+        error "ERROR: $filename is not a CHAP mesh sequence file."
+    }
+
+    # read header:
+    binary scan $data @8iuiuiuiur version num_frames num_vertices ring_size \
+        quant_step
+    set offset 28
+
+    # property names:
+    binary scan $data @${offset}iu num_properties
+    incr offset 4
+    set property_names {}
+    for {set i 0} {$i < $num_properties} {incr i} {
+        binary scan $data @${offset}iu name_length
+        incr offset 4
+        lappend property_names \
+            [string range $data $offset [expr $offset + $name_length - 1]]
+        incr offset $name_length
+    }
+
+    # faces:
+    binary scan $data @${offset}iu num_faces
+    incr offset 4
+    binary scan $data @${offset}i[expr 3*$num_faces] faces
+    incr offset [expr 12*$num_faces]
+
+    # read frames:
+    set num_rings [expr $num_vertices / $ring_size]
+    set num_coords [expr 3*$num_vertices]
+    set coords {}
+    set frames {}
+    for {set i 0} {$i < $num_frames} {incr i} {
+
+        # frame type and time stamp:
+        binary scan $data @${offset}cur frame_type time
+        incr offset 5
+
+        # decode vertex coordinates:
+        if { $frame_type == 0 } {
+            binary scan $data @${offset}r${num_coords} coords
+            incr offset [expr 4*$num_coords]
+            set positions $coords
+        } elseif { $frame_type == 1 } {
+            binary scan $data @${offset}i${num_coords} coords
+            incr offset [expr 4*$num_coords]
+        } elseif { $frame_type == 2 } {
+            binary scan $data @${offset}s${num_coords} deltas
+            incr offset [expr 2*$num_coords]
+            set updated {}
+            foreach c $coords d $deltas {
+                lappend updated [expr {$c + $d}]
+            }
+            set coords $updated
+        } else {
+            error "ERROR: Unknown frame type in $filename."
+        }
+
+        # convert quantised coordinates to positions:
+        if { $frame_type != 0 } {
+            set positions {}
+            foreach c $coords {
+                lappend positions [expr {$c*$quant_step}]
+            }
+        }
+
+        # property values per ring:
+        set properties [dict create]
+        foreach name $property_names {
+            binary scan $data @${offset}r${num_rings} values
+            incr offset [expr 4*$num_rings]
+            dict set properties $name $values
+        }
+
+        lappend frames [dict create time $time positions $positions \
+                                    properties $properties]
+    }
+
+    return [dict create ring_size $ring_size property_names $property_names \
+                        faces $faces frames $frames]
+}
+
+
+# Draws one frame of a mesh sequence, coloured by the given property on the
+# VMD colour scale. The colour scale spans the range of the property over 
+# all frames. If the property does not exist, the first one is used.
+#
+# INPUT:
+# seq - dictionary created by import_mesh_sequence
+# frame_idx - index of frame to draw (clamped to available frames)
+# property - name of property used for colouring
+proc draw_mesh_sequence_frame {seq frame_idx property} {
+
+    # select frame:
+    set frames [dict get $seq frames]
+    set num_frames [llength $frames]
+    if { $frame_idx >= $num_frames } {
+        set frame_idx [expr $num_frames - 1]
+    }
+    set frame [lindex $frames $frame_idx]
+    set positions [dict get $frame positions]
+    set ring_size [dict get $seq ring_size]
+
+    # select property and find its range over all frames:
+    if { [lsearch -exact [dict get $seq property_names] $property] < 0 } {
+        set property [lindex [dict get $seq property_names] 0]
+    }
+    set lo Inf
+    set hi -Inf
+    foreach f $frames {
+        foreach v [dict get $f properties $property] {
+            if { $v < $lo } { set lo $v }
+            if { $v > $hi } { set hi $v }
+        }
+    }
+    set range [expr {$hi - $lo}]
+    if { $range <= 0.0 } {
+        set range 1.0
+    }
+    set values [dict get $frame properties $property]
+
+    # colour scale indices:
+    set col_lo [colorinfo num]
+    set col_num [expr [colorinfo max] - $col_lo]
+
+    # loop over faces and draw them:
+    foreach {ia ib ic} [dict get $seq faces] {
+
+        # face colour from average of vertex values:
+        set value [expr {([lindex $values [expr {$ia / $ring_size}]] + \
+                          [lindex $values [expr {$ib / $ring_size}]] + \
+                          [lindex $values [expr {$ic / $ring_size}]])/3.0}]
+        set scalar [expr {($value - $lo)/$range}]
+        draw color [expr {$col_lo + int($scalar*($col_num - 1))}]
+
+        # draw triangle:
+        draw triangle [lrange $positions [expr {3*$ia}] [expr {3*$ia + 2}]] \
+                      [lrange $positions [expr {3*$ib}] [expr {3*$ib + 2}]] \
+                      [lrange $positions [expr {3*$ic}] [expr {3*$ic + 2}]]
+    }
+}
+
+
+# Sets up redrawing of the mesh sequence whenever the frame of the top 
+# molecule changes. The stride must equal the -out-anim-stride used in CHAP
+# so that each trajectory frame is mapped to the right surface.
+#
+# INPUT:
+# seq - dictionary created by import_mesh_sequence
+# property - name of property used for colouring
+# stride - number of trajectory frames per mesh sequence frame
+proc animate_mesh_sequence {seq property stride} {
+
+    variable SEQUENCE
+    variable PROPERTY
+    variable STRIDE
+
+    set SEQUENCE $seq
+    set PROPERTY $property
+    set STRIDE $stride
+
+    # redraw on frame change:
+    trace add variable ::vmd_frame([molinfo top]) write \
+        MSEQ::draw_mesh_sequence_callback
+    draw_mesh_sequence_callback
+}
+
+
+# Callback function that redraws the mesh sequence when frame changes.
+#
+# INPUTS:
+# args - callback arguments
+proc draw_mesh_sequence_callback {args} {
+
+    variable SEQUENCE
+    variable PROPERTY
+    variable STRIDE
+
+    # map trajectory frame to mesh sequence frame:
+    set frnr [molinfo top get frame]
+    set frame_idx [expr $frnr / $STRIDE]
+
+    # delete all current drawings:
+    draw delete all
+
+    # draw frame:
+    draw_mesh_sequence_frame $SEQUENCE $frame_idx $PROPERTY
+}
+
+}
@@ -43,6 +43,9 @@ if { [file exists $WOBJ_FILE] == 0 } {
 # source library with Wavefront OBJ parser:
 source $WOBJ_FILE
 
+# mesh sequence library is expected alongside wobj.tcl:
+source [file join [file dirname $WOBJ_FILE] mesh_sequence.tcl]
+
 # global settings:
 axes location Off
 color Display Background white
@@ -52,13 +55,17 @@ display ambientocclusion on
 display rendermode GLSL
 
 # have arguments been passed from command line?
-if { [llength $argv] == 3 } {
+if { [llength $argv] >= 3 } {
     
     # get file names from input arguments:
     set FILE_STRUCTURE [lindex $argv 0]
     set FILE_PORE_SURFACE [lindex $argv 1]
     set PROPERTY [lindex $argv 2]
 
+    # optional surface animation and stride used to write it:
+    set FILE_ANIMATION [lindex $argv 3]
+    set ANIMATION_STRIDE [lindex $argv 4]
+
 } else {
 
     # have arguments been set in console?
@@ -78,6 +85,12 @@ if { [llength $argv] == 3 } {
         set PROPERTY ""
     }
 }
+if { [info exists FILE_ANIMATION] == 0 } {
+    set FILE_ANIMATION ""
+}
+if { [info exists ANIMATION_STRIDE] == 0 || $ANIMATION_STRIDE == "" } {
+    set ANIMATION_STRIDE 1
+}
 
 # check that required files exist:
 if { [file exists $FILE_STRUCTURE] == 0 } {
@@ -130,9 +143,19 @@ mol modmaterial 2 top AOEdgy
 # ADD PORE SURFACE
 ###############################################################################
 
-# import an OBJ file:
-set obj [WOBJ::import_wobj $FILE_PORE_SURFACE]
+# animated surface replaces static surface if given:
+if { $FILE_ANIMATION != "" } {
+
+    # import mesh sequence and redraw it on every frame change:
+    set seq [MSEQ::import_mesh_sequence $FILE_ANIMATION]
+    MSEQ::animate_mesh_sequence $seq $PROPERTY $ANIMATION_STRIDE
 
-# draw OBJ mesh:
-WOBJ::draw_wobj $obj $PROPERTY
+} else {
+
+    # import an OBJ file:
+    set obj [WOBJ::import_wobj $FILE_PORE_SURFACE]
+
+    # draw OBJ mesh:
+    WOBJ::draw_wobj $obj $PROPERTY
+}
 
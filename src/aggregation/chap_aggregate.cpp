@@ -0,0 +1,365 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+#include <gromacs/options/basicoptions.h>
+
+#include "aggregation/chap_aggregate.hpp"
+
+#include "config/config.hpp"
+
+#include "io/colour.hpp"
+#include "io/json_doc_importer.hpp"
+#include "io/pdb_io.hpp"
+
+using namespace gmx;
+
+
+/*!
+ * Constructor for the ChapAggregate module.
+ */
+ChapAggregate::ChapAggregate()
+    : refJsonIsSet_(false)
+    , refPdbIsSet_(false)
+    , outputSupportRangeIsSet_(false)
+    , outputState_(false)
+{
+
+}
+
+
+/*!
+ * No settings need to be changed for this module.
+ */
+void
+ChapAggregate::init(CommandLineModuleSettings * /*settings*/)
+{
+
+}
+
+
+/*!
+ * Sets the help text and declares the input and output options. Output 
+ * options carry the same names and defaults as in the chap tool.
+ */
+void
+ChapAggregate::initOptions(
+        IOptionsContainer *options,
+        ICommandLineOptionsModuleSettings *settings)
+{
+    // HELP TEXT
+    //-------------------------------------------------------------------------
+
+    // set help text:
+    static const char *const desc[] = {
+        "chap-aggregate regenerates the results of a CHAP run from the frame "
+        "stream files retained with -out-detailed, so that output parameters "
+        "can be changed without repeating the path finding. Stream files "
+        "given with -f are treated as replicates of the same pathway and "
+        "are aggregated in parallel. Residue information is taken from the "
+        "results file of the original run given with -ref-json. "
+        "Alternatively, aggregation states written with -out-state by runs "
+        "over different time windows can be merged using -state."};
+    settings -> setHelpText(desc);
+
+
+    // INPUT OPTIONS
+    // ------------------------------------------------------------------------
+
+    options -> addOption(StringOption("f")
+                         .storeVector(&streamFileNames_)
+                         .multiValue()
+                         .description("Frame stream files written by CHAP "
+                                      "for a single pathway. Several files "
+                                      "(e.g. one per replicate trajectory) "
+                                      "are pooled."));
+
+    options -> addOption(StringOption("state")
+                         .storeVector(&stateFileNames_)
+                         .multiValue()
+                         .description("Aggregation state files written with "
+                                      "-out-state by runs over different "
+                                      "time windows of the same pathway. "
+                                      "These are merged instead of reading "
+                                      "stream files."));
+
+    options -> addOption(StringOption("ref-json")
+                         .store(&refJsonFileName_)
+                         .storeIsSet(&refJsonIsSet_)
+                         .description("JSON results file of the original "
+                                      "CHAP run from which residue names, "
+                                      "chains, and hydrophobicities are "
+                                      "taken. Required with -f."));
+
+    options -> addOption(StringOption("ref-pdb")
+                         .store(&refPdbFileName_)
+                         .storeIsSet(&refPdbIsSet_)
+                         .description("Structure file (e.g. the PDB file "
+                                      "written by the original CHAP run) in "
+                                      "which pore-lining and pore-facing "
+                                      "residues are annotated. No PDB file "
+                                      "is written if this is not given."));
+
+
+    // OUTPUT OPTIONS
+    // ------------------------------------------------------------------------
+
+    options -> addOption(StringOption("out-filename")
+                         .store(&outputBaseFileName_)
+                         .defaultValue("output")
+                         .description("File name for output files without "
+                                      "file extension."));
+
+    options -> addOption(IntegerOption("out-num-points")
+                         .store(&outputNumPoints_)
+                         .defaultValue(1000)
+                         .description("Number of spatial sample points that "
+                                      "are written to the JSON output file."));
+
+    options -> addOption(RealOption("out-extrap-dist")
+                         .store(&outputExtrapDist_)
+                         .defaultValue(0.0)
+                         .description("Extrapolation distance beyond the "
+                                      "pathway endpoints for both JSON and "
+                                      "OBJ output."));
+
+    options -> addOption(RealOption("out-support-range")
+                         .storeVector(&outputSupportRange_)
+                         .storeIsSet(&outputSupportRangeIsSet_)
+                         .valueCount(2)
+                         .description("Fixed lower and upper end of the range "
+                                      "of spatial sample points. By default, "
+                                      "this range is determined from the "
+                                      "pathway endpoints in all frames."));
+
+    const char * const allowedEnergyAnchor[] = {"endpoints",
+                                                "mean_endpoints",
+                                                "support_range"};
+    outputEnergyAnchor_ = eEnergyAnchorEndpoints;
+    options -> addOption(EnumOption<eEnergyAnchor>("out-energy-anchor")
+                         .enumValue(allowedEnergyAnchor)
+                         .store(&outputEnergyAnchor_)
+                         .description("Points at which the energy profile is "
+                                      "set to zero. The default uses the "
+                                      "outermost pathway endpoints over all "
+                                      "frames, mean_endpoints the mean "
+                                      "endpoint positions, and support_range "
+                                      "the ends of the extrapolated profile."));
+
+    options -> addOption(RealOption("out-grid-dist")
+                         .store(&outputGridSampleDist_)
+                         .defaultValue(0.15)
+                         .description("Controls the sampling distance of "
+                                      "vertices on the pathway surface which "
+                                      "are subsequently interpolated to yield "
+                                      "a smooth surface. Very small values "
+                                      "may yield visual artifacts."));
+
+    options -> addOption(RealOption("out-vis-tweak")
+                         .store(&outputCorrectionThreshold_)
+                         .defaultValue(0.1)
+                         .description("Visual tweaking factor that controls "
+                                      "the smoothness of the pathway surface "
+                                      "in the OBJ output. Varies between -1 "
+                                      "and 1 (exculisvely), where larger "
+                                      "values result in a smoother surface. "
+                                      "Negative values may result in "
+                                      "visualisation artifacts."));
+
+    const char * const allowedMeshFormat[] = {"obj",
+                                              "ply"};
+    outputMeshFormat_ = eMeshFormatObj;
+    options -> addOption(EnumOption<eMeshFormat>("out-mesh-format")
+                         .enumValue(allowedMeshFormat)
+                         .store(&outputMeshFormat_)
+                         .description("File format for the pathway surface, "
+                                      "either OBJ and MTL or binary PLY."));
+
+    options -> addOption(RealOption("out-mesh-tol")
+                         .store(&outputMeshTolerance_)
+                         .defaultValue(0.0)
+                         .description("If positive, vertex rings on the "
+                                      "pathway surface are placed adaptively "
+                                      "with this tolerance (in nm). Zero uses "
+                                      "evenly spaced rings."));
+
+    options -> addOption(IntegerOption("out-mesh-max-vert")
+                         .store(&outputMeshMaxVertices_)
+                         .defaultValue(12850)
+                         .description("Maximum number of vertices per "
+                                      "pathway surface if -out-mesh-tol is "
+                                      "positive."));
+
+    options -> addOption(IntegerOption("out-anim-stride")
+                         .store(&outputAnimStride_)
+                         .defaultValue(0)
+                         .description("If positive, every n-th frame of the "
+                                      "first stream file is written to a "
+                                      "surface animation file. Zero disables "
+                                      "the animation output."));
+
+    options -> addOption(RealOption("out-anim-quant")
+                         .store(&outputAnimQuantStep_)
+                         .defaultValue(0.01)
+                         .description("Quantisation step (in Ang) for vertex "
+                                      "coordinates in the surface "
+                                      "animation."));
+
+    options -> addOption(BooleanOption("out-state")
+                         .store(&outputState_)
+                         .defaultValue(false)
+                         .description("If true, the aggregation state is "
+                                      "written to a JSON file that can be "
+                                      "merged with others using -state."));
+}
+
+
+/*!
+ * Checks the validity of the user-provided parameters.
+ */
+void
+ChapAggregate::optionsFinished()
+{
+    if( streamFileNames_.empty() == stateFileNames_.empty() )
+    {
+        throw std::runtime_error("Either stream files (-f) or aggregation "
+                                 "state files (-state) must be given.");
+    }
+    if( !streamFileNames_.empty() && !refJsonIsSet_ )
+    {
+        throw std::runtime_error("Parameter -ref-json is required when "
+                                 "aggregating stream files.");
+    }
+    if( outputSupportRangeIsSet_ && 
+        outputSupportRange_.at(1) <= outputSupportRange_.at(0) )
+    {
+        throw std::runtime_error("Upper end of -out-support-range must be "
+                                 "larger than lower end.");
+    }
+    if( outputNumPoints_ < 2 )
+    {
+        throw std::runtime_error("Parameter -out-num-points must be at "
+                                 "least two.");
+    }
+    if( outputExtrapDist_ < 0.0 )
+    {
+        throw std::runtime_error("Parameter -out-extrap-dist may not be "
+                                 "negative.");
+    }
+    if( outputGridSampleDist_ <= 0.0 )
+    {
+        throw std::runtime_error("Parameter -out-grid-dist must be strictly "
+                                 "positive.");
+    }
+    if( outputCorrectionThreshold_ >= 1.0 or 
+        outputCorrectionThreshold_ <= -1.0)
+    {
+        throw std::runtime_error("Parameter -out-vis-teak must be in interval "
+                                 "(-1, 1).");
+    }
+}
+
+
+/*!
+ * Aggregates the stream files and writes the JSON, PDB, and surface output.
+ */
+int
+ChapAggregate::run()
+{
+    // set output parameters:
+    FrameStreamAggregator aggregator(streamFileNames_);
+    aggregator.setNumPoints(outputNumPoints_);
+    aggregator.setExtrapDist(outputExtrapDist_);
+    if( outputSupportRangeIsSet_ )
+    {
+        aggregator.setSupportRange(
+                outputSupportRange_.at(0), 
+                outputSupportRange_.at(1));
+    }
+    aggregator.setEnergyAnchor(outputEnergyAnchor_);
+    aggregator.setGridSampleDist(outputGridSampleDist_);
+    aggregator.setCorrectionThreshold(outputCorrectionThreshold_);
+    aggregator.setAdaptiveResolution(
+            outputMeshTolerance_, 
+            std::max(outputMeshMaxVertices_, 0));
+    aggregator.setMeshFormat(outputMeshFormat_);
+    aggregator.setAnimation(
+            outputBaseFileName_ + "_animation.msq",
+            std::max(outputAnimStride_, 0),
+            outputAnimQuantStep_);
+
+    ResidueInformationProvider resInfo;
+    if( stateFileNames_.empty() )
+    {
+        // residue information is read lazily from original results file:
+        JsonDocImporter jdi;
+        rapidjson::Document residueSummary = jdi.member(
+                refJsonFileName_, 
+                "residueSummary");
+        resInfo.fromResidueSummary(residueSummary);
+
+        // read stream files and form time averages:
+        aggregator.aggregate();
+    }
+    else
+    {
+        // states already contain residue information and support points:
+        aggregator.mergeStates(stateFileNames_, resInfo);
+    }
+
+    // annotate reference structure:
+    if( refPdbIsSet_ )
+    {
+        PdbStructure structure;
+        structure.fromFile(refPdbFileName_);
+        aggregator.writePdb(outputBaseFileName_ + ".pdb", structure);
+    }
+
+    // write results file:
+    aggregator.writeJson(outputBaseFileName_ + ".json", resInfo);
+
+    // write state for further merging:
+    if( outputState_ )
+    {
+        aggregator.writeState(outputBaseFileName_ + "_state.json", resInfo);
+    }
+
+    // load colour palettes from JSON file:
+    std::map<std::string, ColourPalette> palettes;
+    if( outputMeshFormat_ == eMeshFormatObj )
+    {
+        std::string paletteFilePath = chapInstallBase() + 
+                std::string("/chap/share/data/palettes/");
+        std::string paletteFileName = paletteFilePath + "default.json";
+        palettes = ColourPaletteProvider::fromJsonFile(paletteFileName);
+    }
+
+    // time-averaged pathway surface:
+    aggregator.writeSurface(outputBaseFileName_, palettes);
+
+    return 0;
+}
@@ -0,0 +1,903 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "aggregation/frame_stream_aggregator.hpp"
+
+#include "external/rapidjson/document.h"
+#include "external/rapidjson/stringbuffer.h"
+#include "external/rapidjson/writer.h"
+
+#include "geometry/cubic_spline_interp_1D.hpp"
+
+#include "io/results_json_exporter.hpp"
+#include "io/spline_curve_1D_json_converter.hpp"
+
+
+/*!
+ * Constructor sets output parameters to the defaults used by CHAP.
+ */
+FrameStreamAggregator::FrameStreamAggregator(
+        const std::vector<std::string> &streamFileNames)
+    : streamFileNames_(streamFileNames)
+    , numPoints_(1000)
+    , extrapDist_(0.0)
+    , supportRangeIsSet_(false)
+    , supportRangeLo_(0.0)
+    , supportRangeHi_(0.0)
+    , energyAnchor_(eEnergyAnchorEndpoints)
+    , gridSampleDist_(0.15)
+    , correctionThreshold_(0.1)
+    , meshTolerance_(0.0)
+    , meshMaxNumVertices_(12850)
+    , meshFormat_(eMeshFormatObj)
+    , animStride_(0)
+    , animQuantStep_(0.01)
+    , verbose_(true)
+    , replicates_(streamFileNames.size())
+{
+
+}
+
+
+/*!
+ * Sets the number of support points at which pathway profiles are evaluated.
+ */
+void
+FrameStreamAggregator::setNumPoints(size_t numPoints)
+{
+    if( numPoints < 2 )
+    {
+        throw std::logic_error("At least two support points are required.");
+    }
+    numPoints_ = numPoints;
+}
+
+
+/*!
+ * Sets the distance by which profiles and surface are extrapolated beyond the
+ * pathway endpoints.
+ */
+void
+FrameStreamAggregator::setExtrapDist(real extrapDist)
+{
+    extrapDist_ = extrapDist;
+}
+
+
+/*!
+ * Fixes the range of support points instead of deriving it from the pathway
+ * endpoints. In this case, the extrapolation distance only applies to the 
+ * pathway surface. As the support points then no longer depend on the data,
+ * states of runs over different sets of frames can be merged.
+ */
+void
+FrameStreamAggregator::setSupportRange(
+        real supportRangeLo,
+        real supportRangeHi)
+{
+    if( supportRangeHi <= supportRangeLo )
+    {
+        throw std::logic_error("Upper end of support range must be larger "
+                               "than lower end.");
+    }
+    supportRangeIsSet_ = true;
+    supportRangeLo_ = supportRangeLo;
+    supportRangeHi_ = supportRangeHi;
+}
+
+
+/*!
+ * Sets the anchor points at which the energy profile is set to zero.
+ */
+void
+FrameStreamAggregator::setEnergyAnchor(eEnergyAnchor energyAnchor)
+{
+    energyAnchor_ = energyAnchor;
+}
+
+
+/*!
+ * Sets the vertex sampling distance of the pathway surface.
+ */
+void
+FrameStreamAggregator::setGridSampleDist(real gridSampleDist)
+{
+    gridSampleDist_ = gridSampleDist;
+}
+
+
+/*!
+ * Sets the visual tweaking factor of the pathway surface.
+ */
+void
+FrameStreamAggregator::setCorrectionThreshold(real correctionThreshold)
+{
+    correctionThreshold_ = correctionThreshold;
+}
+
+
+/*!
+ * Sets the tolerance and maximum number of vertices for adaptive ring 
+ * placement on the time-averaged surface. A tolerance of zero selects evenly
+ * spaced rings.
+ */
+void
+FrameStreamAggregator::setAdaptiveResolution(
+        real tolerance,
+        size_t maxNumVertices)
+{
+    meshTolerance_ = tolerance;
+    meshMaxNumVertices_ = maxNumVertices;
+}
+
+
+/*!
+ * Sets the file format used by writeSurface().
+ */
+void
+FrameStreamAggregator::setMeshFormat(eMeshFormat meshFormat)
+{
+    meshFormat_ = meshFormat;
+}
+
+
+/*!
+ * Requests a surface animation containing every n-th frame of the first 
+ * stream file to be written during aggregate(). A stride of zero disables 
+ * the animation.
+ */
+void
+FrameStreamAggregator::setAnimation(
+        const std::string &fileName,
+        size_t stride,
+        real quantStep)
+{
+    animFileName_ = fileName;
+    animStride_ = stride;
+    animQuantStep_ = quantStep;
+}
+
+
+/*!
+ * Sets whether progress is reported on standard output.
+ */
+void
+FrameStreamAggregator::setVerbose(bool verbose)
+{
+    verbose_ = verbose;
+}
+
+
+/*!
+ * Performs both passes over all stream files. In the first pass, scalar data
+ * is collected for each replicate and pooled to determine the common support
+ * points. In the second pass, profiles and residue properties are sampled at
+ * these support points. Each pass processes the replicates in parallel. 
+ * Finally, the replicate aggregators are merged into the pooled result.
+ */
+void
+FrameStreamAggregator::aggregate()
+{
+    // sanity check:
+    if( streamFileNames_.empty() )
+    {
+        throw std::logic_error("At least one frame stream file is required "
+                               "for aggregation.");
+    }
+
+    int numReplicates = streamFileNames_.size();
+    std::vector<std::exception_ptr> errors(numReplicates);
+
+    // first pass collects scalar data of each replicate:
+    #pragma omp parallel for schedule(dynamic)
+    for(int r = 0; r < numReplicates; r++)
+    {
+        // exceptions may not propagate out of parallel region:
+        try
+        {
+            scalarPass(r);
+        }
+        catch(...)
+        {
+            errors[r] = std::current_exception();
+        }
+    }
+    for(auto &error : errors)
+    {
+        if( error )
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // pooled scalar data determines support points for all replicates:
+    PathwayAggregator pooledScalars;
+    for(auto &agg : replicates_)
+    {
+        pooledScalars.merge(agg);
+    }
+    std::vector<real> supportPoints = makeSupportPoints(pooledScalars);
+    pooledScalars.setSupportPoints(supportPoints, 0.0, 0.0);
+
+    // define anchor points at which energy is set to zero:
+    real anchorPointLo;
+    real anchorPointHi;
+    anchorPoints(pooledScalars, anchorPointLo, anchorPointHi);
+    for(auto &agg : replicates_)
+    {
+        agg.setSupportPoints(supportPoints, anchorPointLo, anchorPointHi);
+    }
+
+    // prepare exporter for surface animation:
+    MolecularPathObjExporter mpexp;
+    configureSurfaceExporter(mpexp);
+    MeshSequenceExporter animExp(
+            mpexp.resolution().second,
+            animQuantStep_);
+    if( animStride_ > 0 )
+    {
+        animExp.open(animFileName_);
+    }
+
+    // second pass samples profiles of each replicate:
+    size_t numFramesTotal = pooledScalars.numScalarFrames();
+    size_t linesProcessedTotal = 0;
+    #pragma omp parallel for schedule(dynamic)
+    for(int r = 0; r < numReplicates; r++)
+    {
+        try
+        {
+            profilePass(
+                    r, 
+                    mpexp, 
+                    animExp, 
+                    linesProcessedTotal, 
+                    numFramesTotal);
+        }
+        catch(...)
+        {
+            errors[r] = std::current_exception();
+        }
+    }
+    for(auto &error : errors)
+    {
+        if( error )
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // finalise surface animation:
+    animExp.close();
+
+    // inform user about progress:
+    if( verbose_ )
+    {
+        std::cout.precision(3);
+        std::cout<<"\rForming time averages, "
+                 <<(double)linesProcessedTotal/numFramesTotal*100
+                 <<"\% complete"
+                 <<std::endl;
+    }
+
+    // pool data over all replicates:
+    pooled_ = PathwayAggregator();
+    for(auto &agg : replicates_)
+    {
+        pooled_.merge(agg);
+    }
+}
+
+
+/*!
+ * Returns the number of replicates, i.e. of stream files.
+ */
+size_t
+FrameStreamAggregator::numReplicates() const
+{
+    return replicates_.size();
+}
+
+
+/*!
+ * Returns the aggregator of the replicate with the given index.
+ */
+const PathwayAggregator&
+FrameStreamAggregator::replicate(size_t idx) const
+{
+    return replicates_.at(idx);
+}
+
+
+/*!
+ * Returns the aggregator pooled over all replicates.
+ */
+const PathwayAggregator&
+FrameStreamAggregator::pooled() const
+{
+    return pooled_;
+}
+
+
+/*!
+ * Writes the pooled results to a JSON file. If more than one replicate has 
+ * been aggregated, the per-replicate results are added as well.
+ */
+void
+FrameStreamAggregator::writeJson(
+        const std::string &fileName,
+        const ResidueInformationProvider &resInfo) const
+{
+    // add pooled summaries, profiles, time series, and residue data:
+    ResultsJsonExporter results;
+    pooled_.addToResults(results, resInfo);
+
+    // add results of individual replicates:
+    if( replicates_.size() > 1 )
+    {
+        for(auto &agg : replicates_)
+        {
+            ResultsJsonExporter replicateResults;
+            agg.addToResults(replicateResults, resInfo);
+            results.addReplicate(replicateResults);
+        }
+    }
+
+    // write results to JSON file:
+    results.write(fileName);
+}
+
+
+/*!
+ * Assigns the time-averaged pore-lining and pore-facing attributes of each
+ * residue to the occupancy and b-factor fields of the given structure and
+ * writes it to a PDB file.
+ */
+void
+FrameStreamAggregator::writePdb(
+        const std::string &fileName,
+        PdbStructure structure) const
+{
+    structure.setPoreFacing(
+            pooled_.residueSummary("poreLining"), 
+            pooled_.residueSummary("poreFacing"));
+    PdbIo::write(fileName, structure);
+}
+
+
+/*!
+ * Writes the time-averaged pathway surface to an OBJ or PLY file. The 
+ * geometry is taken from the first frame of the first stream file and the 
+ * surface is coloured by the pooled mean profiles. Colour palettes are only
+ * used for OBJ output.
+ */
+void
+FrameStreamAggregator::writeSurface(
+        const std::string &baseFileName,
+        const std::map<std::string, ColourPalette> &palettes) const
+{
+    // sanity check:
+    if( !firstFramePath_ )
+    {
+        throw std::logic_error("Can not write pathway surface before "
+                               "aggregation.");
+    }
+
+    // retrieve averaged properties:
+    std::vector<real> supportPoints = pooled_.supportPoints();
+    std::vector<real> avgRadius = pooled_.meanProfile("radius");
+    std::vector<real> avgSolventDensity = pooled_.meanProfile("density");
+    std::vector<real> avgEnergy = pooled_.meanProfile("energy");
+    std::vector<real> avgPlHydrophobicity = pooled_.meanProfile("plHydrophobicity");
+    std::vector<real> avgPfHydrophobicity = pooled_.meanProfile("pfHydrophobicity");
+
+    // averaged properties as spline curves:
+    CubicSplineInterp1D interp;
+    auto avgRadiusSpl = interp(
+            supportPoints, 
+            avgRadius, 
+            eSplineInterpBoundaryHermite);
+    auto avgSolventDensitySpl = interp(
+            supportPoints, 
+            avgSolventDensity, 
+            eSplineInterpBoundaryHermite);
+    auto avgEnergySpl = interp(
+            supportPoints, 
+            avgEnergy, 
+            eSplineInterpBoundaryHermite);
+    auto avgPlHydrophobicitySpl = interp(
+            supportPoints, 
+            avgPlHydrophobicity, 
+            eSplineInterpBoundaryHermite);
+    auto avgPfHydrophobicitySpl = interp(
+            supportPoints, 
+            avgPfHydrophobicity, 
+            eSplineInterpBoundaryHermite);
+
+    // associate properties with pathway:
+    MolecularPath molPathAvg = *firstFramePath_;
+    molPathAvg.addScalarProperty("avg_radius", avgRadiusSpl, false);
+    molPathAvg.addScalarProperty("avg_density", avgSolventDensitySpl, false);
+    // FIXME: NaN energy values can not be exported to OBJ!
+    molPathAvg.addScalarProperty("avg_energy", avgEnergySpl, false);
+    molPathAvg.addScalarProperty("avg_pl_hydrophobicity", avgPlHydrophobicitySpl, true);
+    molPathAvg.addScalarProperty("avg_pf_hydrophobicity", avgPfHydrophobicitySpl, true);
+
+    // adaptive resolution only applies to time-averaged surface:
+    MolecularPathObjExporter mpexp;
+    configureSurfaceExporter(mpexp);
+    mpexp.setAdaptiveResolution(meshTolerance_, meshMaxNumVertices_);
+
+    // export pathway to file:
+    if( meshFormat_ == eMeshFormatPly )
+    {
+        // properties are stored per vertex and coloured by the viewer:
+        mpexp.writePly(baseFileName, molPathAvg);
+    }
+    else
+    {
+        mpexp(
+            baseFileName, 
+            "time_averaged_molecular_path", 
+            molPathAvg,
+            palettes);
+    }
+}
+
+
+/*!
+ * Writes the aggregation state of all replicates to a JSON file, from which 
+ * it can be restored and combined with the states of other runs using 
+ * mergeStates(). The state also contains the geometry of the first frame 
+ * and the residue information, so that all output can be generated from it.
+ */
+void
+FrameStreamAggregator::writeState(
+        const std::string &fileName,
+        const ResidueInformationProvider &resInfo) const
+{
+    // sanity check:
+    if( !firstFramePath_ )
+    {
+        throw std::logic_error("Can not write aggregation state before "
+                               "aggregation.");
+    }
+
+    // create JSON document:
+    rapidjson::Document doc;
+    doc.SetObject();
+    rapidjson::Document::AllocatorType &alloc = doc.GetAllocator();
+    doc.AddMember("stateVersion", 1, alloc);
+
+    // geometry of first frame:
+    rapidjson::Value firstFrame;
+    firstFrame.CopyFrom(firstFrameDoc_, alloc);
+    doc.AddMember("firstFrame", firstFrame, alloc);
+
+    // residue information in the same layout as in the results file:
+    rapidjson::Value residueInformation(rapidjson::kObjectType);
+    rapidjson::Value id(rapidjson::kArrayType);
+    rapidjson::Value name(rapidjson::kArrayType);
+    rapidjson::Value chain(rapidjson::kArrayType);
+    rapidjson::Value hydrophobicity(rapidjson::kArrayType);
+    for(auto i : pooled_.poreResIds())
+    {
+        id.PushBack(i, alloc);
+        name.PushBack(rapidjson::Value(resInfo.name(i), alloc), alloc);
+        chain.PushBack(rapidjson::Value(resInfo.chain(i), alloc), alloc);
+        hydrophobicity.PushBack(resInfo.hydrophobicity(i), alloc);
+    }
+    residueInformation.AddMember("id", id, alloc);
+    residueInformation.AddMember("name", name, alloc);
+    residueInformation.AddMember("chain", chain, alloc);
+    residueInformation.AddMember("hydrophobicity", hydrophobicity, alloc);
+    doc.AddMember("residueInformation", residueInformation, alloc);
+
+    // state of each replicate:
+    rapidjson::Value replicates(rapidjson::kArrayType);
+    for(auto &agg : replicates_)
+    {
+        replicates.PushBack(agg.stateToJson(alloc), alloc);
+    }
+    doc.AddMember("replicates", replicates, alloc);
+
+    // stringify document (NaN is permitted to preserve the exact state):
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<
+            rapidjson::StringBuffer, 
+            rapidjson::UTF8<>, 
+            rapidjson::UTF8<>, 
+            rapidjson::CrtAllocator, 
+            rapidjson::kWriteNanAndInfFlag> writer(buffer);
+    doc.Accept(writer);
+
+    // write to file:
+    std::ofstream file(fileName);
+    file<<buffer.GetString()<<std::endl;
+    file.close();
+    if( file.fail() )
+    {
+        throw std::runtime_error("Could not write aggregation state file " +
+                                 fileName + ".");
+    }
+}
+
+
+/*!
+ * Restores and merges the aggregation states written by writeState() in 
+ * several runs, typically over disjoint time windows of the same 
+ * trajectories. States are combined in order of their first time stamp, so
+ * that time series are the same as in a single run over all frames. The 
+ * replicates of each state are merged with the corresponding replicates of
+ * the other states. The residue information stored in the states is added 
+ * to the given provider.
+ */
+void
+FrameStreamAggregator::mergeStates(
+        const std::vector<std::string> &fileNames,
+        ResidueInformationProvider &resInfo)
+{
+    // sanity check:
+    if( fileNames.empty() )
+    {
+        throw std::logic_error("At least one state file is required for "
+                               "merging.");
+    }
+
+    // read all state files:
+    std::vector<rapidjson::Document> docs(fileNames.size());
+    std::vector<std::pair<real, size_t>> order;
+    for(size_t i = 0; i < fileNames.size(); i++)
+    {
+        std::ifstream file(fileNames[i]);
+        if( !file.good() )
+        {
+            throw std::runtime_error("Could not open aggregation state file "
+                                     + fileNames[i] + ".");
+        }
+        std::string content(
+                (std::istreambuf_iterator<char>(file)),
+                std::istreambuf_iterator<char>());
+        docs[i].Parse<rapidjson::kParseNanAndInfFlag>(
+                content.c_str(), 
+                content.size());
+
+        // sanity checks:
+        if( !docs[i].IsObject() || 
+            !docs[i].HasMember("stateVersion") ||
+            !docs[i].HasMember("firstFrame") ||
+            !docs[i].HasMember("residueInformation") ||
+            !docs[i].HasMember("replicates") ||
+            !docs[i]["replicates"].IsArray() ||
+            docs[i]["replicates"].Empty() ||
+            !docs[i]["replicates"][0].HasMember("timeStamps") )
+        {
+            throw std::runtime_error("File " + fileNames[i] + " is not a "
+                                     "valid aggregation state file.");
+        }
+        if( docs[i]["replicates"].Size() != docs[0]["replicates"].Size() )
+        {
+            throw std::runtime_error("Aggregation state files contain "
+                                     "different numbers of replicates.");
+        }
+
+        // order by first time stamp of main replicate:
+        const rapidjson::Value &timeStamps = 
+                docs[i]["replicates"][0]["timeStamps"];
+        real firstTime = timeStamps.Empty() ? 0.0 : timeStamps[0].GetDouble();
+        order.push_back(std::make_pair(firstTime, i));
+    }
+    std::stable_sort(order.begin(), order.end());
+
+    // merge replicate states in temporal order:
+    replicates_.assign(docs[0]["replicates"].Size(), PathwayAggregator());
+    for(auto &o : order)
+    {
+        const rapidjson::Value &replicates = docs[o.second]["replicates"];
+        for(rapidjson::SizeType r = 0; r < replicates.Size(); r++)
+        {
+            PathwayAggregator shard;
+            shard.stateFromJson(replicates[r]);
+
+            // grid must be independent of data to allow merging:
+            try
+            {
+                replicates_[r].merge(shard);
+            }
+            catch(std::logic_error &e)
+            {
+                throw std::runtime_error("Can not merge aggregation state " +
+                        fileNames[o.second] + ". " + e.what() + " Fix the "
+                        "support range and use energy anchors at the ends of "
+                        "the support range to obtain mergeable states.");
+            }
+        }
+
+        // residue information:
+        resInfo.fromResidueSummary(docs[o.second]["residueInformation"]);
+    }
+
+    // geometry is taken from earliest state:
+    setFirstFrame(docs[order.front().second]["firstFrame"]);
+
+    // pool data over all replicates:
+    pooled_ = PathwayAggregator();
+    for(auto &agg : replicates_)
+    {
+        pooled_.merge(agg);
+    }
+}
+
+
+/*!
+ * Reads the stream file of the given replicate line by line and adds the 
+ * scalar data of each frame to the replicate's aggregator.
+ */
+void
+FrameStreamAggregator::scalarPass(size_t replicateIdx)
+{
+    // open per-frame data set for reading:
+    const std::string &inFileName = streamFileNames_.at(replicateIdx);
+    std::ifstream inFile(inFileName);
+    if( !inFile.good() )
+    {
+        throw std::runtime_error("Could not open frame stream file " + 
+                                 inFileName + ".");
+    }
+
+    // read file line by line and calculate summary statistics:
+    size_t linesRead = 0;
+    std::string line;
+    while( std::getline(inFile, line) )
+    {
+        // read line into JSON document:
+        rapidjson::Document lineDoc;
+        lineDoc.Parse(line.c_str(), line.size());
+
+        // sanity checks:
+        if( !lineDoc.IsObject() )
+        {
+            std::string error = "Line " + std::to_string(linesRead) + 
+            " read from " + inFileName + " is not valid JSON object.";
+            throw std::runtime_error(error);
+        }
+    
+        // calculate summary statistics and time series:
+        replicates_[replicateIdx].addScalarFrame(lineDoc);
+        linesRead++;
+    }
+
+    // sanity check:
+    if( linesRead == 0 )
+    {
+        throw std::runtime_error("Frame stream file " + inFileName + 
+                                 " contains no frames.");
+    }
+}
+
+
+/*!
+ * Reads the stream file of the given replicate line by line and samples the
+ * profiles and residue properties of each frame. The first frame of the 
+ * first replicate is retained as geometry for the time-averaged surface and
+ * every n-th frame of the first replicate is added to the surface animation.
+ */
+void
+FrameStreamAggregator::profilePass(
+        size_t replicateIdx,
+        MolecularPathObjExporter &mpexp,
+        MeshSequenceExporter &animExp,
+        size_t &linesProcessedTotal,
+        size_t numFramesTotal)
+{
+    // open JSON data file in read mode:
+    const std::string &inFileName = streamFileNames_.at(replicateIdx);
+    std::ifstream inFile(inFileName);
+
+    // read file line by line:
+    size_t linesProcessed = 0;
+    std::string line;
+    while( std::getline(inFile, line) )
+    {
+        // only main replicate reports progress to avoid garbled output:
+        if( verbose_ && replicateIdx == 0 )
+        {
+            // counter is incremented concurrently by other replicates:
+            size_t linesProcessedSoFar;
+            #pragma omp atomic read
+            linesProcessedSoFar = linesProcessedTotal;
+
+            std::cout.precision(3);
+            std::cout<<"\rForming time averages, "
+                     <<(double)linesProcessedSoFar/numFramesTotal*100
+                     <<"\% complete"
+                     <<std::flush;
+        }
+
+        // read line into JSON document:
+        rapidjson::Document lineDoc;
+        lineDoc.Parse(line.c_str(), line.size());
+
+        // sanity checks:
+        if( !lineDoc.IsObject() )
+        {
+            std::string error = "Line " + std::to_string(linesProcessed) + 
+            " read from " + inFileName + " is not valid JSON object.";
+            throw std::runtime_error(error);
+        }
+
+        // copy first frame from here for surface output:
+        if( replicateIdx == 0 && linesProcessed == 0 )
+        {
+            setFirstFrame(lineDoc);
+        }
+
+        // add every n-th frame of main trajectory to surface animation:
+        if( replicateIdx == 0 && animStride_ > 0 && 
+            linesProcessed % animStride_ == 0 )
+        {
+            MolecularPath molPath(lineDoc);
+            molPath.addScalarProperty(
+                    "pl_hydrophobicity",
+                    SplineCurve1DJsonConverter::fromJson(
+                            lineDoc["plHydrophobicitySpline"], 1),
+                    true);
+            molPath.addScalarProperty(
+                    "pf_hydrophobicity",
+                    SplineCurve1DJsonConverter::fromJson(
+                            lineDoc["pfHydrophobicitySpline"], 1),
+                    true);
+            animExp.addFrame(
+                    lineDoc["pathSummary"]["timeStamp"][0].GetDouble(),
+                    mpexp.surfaceMesh(molPath));
+        }
+
+        // sample profiles and residue properties:
+        replicates_[replicateIdx].addProfileFrame(lineDoc);
+
+        // increment line counters:
+        linesProcessed++;
+        #pragma omp atomic
+        linesProcessedTotal++;
+    }
+
+    // sanity check:
+    if( linesProcessed != replicates_[replicateIdx].numScalarFrames() )
+    {
+        throw std::runtime_error("Number of lines read from " + inFileName + 
+                                 " differs between passes.");
+    }
+}
+
+
+/*!
+ * Determines the anchor points at which the energy profile is set to zero
+ * from the pooled scalar data according to the selected anchor type. The 
+ * support points of the given aggregator must already be set.
+ */
+void
+FrameStreamAggregator::anchorPoints(
+        const PathwayAggregator &scalars,
+        real &anchorPointLo,
+        real &anchorPointHi) const
+{
+    switch( energyAnchor_ )
+    {
+        case eEnergyAnchorMeanEndpoints:
+            anchorPointLo = scalars.scalarSummary("arcLengthLo").mean();
+            anchorPointHi = scalars.scalarSummary("arcLengthHi").mean();
+            break;
+
+        case eEnergyAnchorSupportRange:
+            anchorPointLo = scalars.supportPoints().front();
+            anchorPointHi = scalars.supportPoints().back();
+            break;
+
+        default:
+            anchorPointLo = scalars.scalarSummary("arcLengthLo").min();
+            anchorPointHi = scalars.scalarSummary("arcLengthHi").max();
+    }
+}
+
+
+/*!
+ * Applies the surface parameters to the given exporter.
+ */
+void
+FrameStreamAggregator::configureSurfaceExporter(
+        MolecularPathObjExporter &mpexp) const
+{
+    mpexp.setExtrapDist(extrapDist_);
+    mpexp.setGridSampleDist(gridSampleDist_);
+    mpexp.setCorrectionThreshold(correctionThreshold_);
+}
+
+
+/*!
+ * Returns the support points at which profiles are evaluated. These are 
+ * evenly spaced over either the fixed support range or the range of arc 
+ * length covered by the pathway in all frames extended by the extrapolation
+ * distance.
+ */
+std::vector<real>
+FrameStreamAggregator::makeSupportPoints(
+        const PathwayAggregator &scalars) const
+{
+    // range covered by support points:
+    real supportPointsLo = supportRangeLo_;
+    real supportPointsHi = supportRangeHi_;
+    if( !supportRangeIsSet_ )
+    {
+        supportPointsLo = scalars.scalarSummary("arcLengthLo").min() - 
+                extrapDist_;
+        supportPointsHi = scalars.scalarSummary("arcLengthHi").max() + 
+                extrapDist_;
+    }
+
+    // build support points:
+    std::vector<real> supportPoints;
+    real supportPointsStep = (supportPointsHi - supportPointsLo) / 
+            (numPoints_ - 1);
+    for(size_t i = 0; i < numPoints_; i++)
+    {
+        supportPoints.push_back(supportPointsLo + i*supportPointsStep);
+    }
+
+    return supportPoints;
+}
+
+
+/*!
+ * Retains the pathway geometry of the given frame document (or of the first
+ * frame stored in an aggregation state) for surface output.
+ */
+void
+FrameStreamAggregator::setFirstFrame(
+        const rapidjson::Value &frameDoc)
+{
+    firstFrameDoc_.SetObject();
+    rapidjson::Document::AllocatorType &alloc = firstFrameDoc_.GetAllocator();
+    for(auto name : {"molPathOrigPoints", 
+                     "molPathRadiusSpline", 
+                     "molPathCentreLineSpline"})
+    {
+        if( !frameDoc.HasMember(name) )
+        {
+            throw std::runtime_error("Frame does not contain member " + 
+                                     std::string(name) + ".");
+        }
+        firstFrameDoc_.AddMember(
+                rapidjson::StringRef(name),
+                rapidjson::Value(frameDoc[name], alloc),
+                alloc);
+    }
+    firstFramePath_.reset(new MolecularPath(firstFrameDoc_));
+}
@@ -0,0 +1,222 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <stdexcept>
+
+#include "aggregation/occupancy_map.hpp"
+
+
+/*!
+ * Default constructor creates an empty map without bin widths. Such a map can
+ * only be used as the target of merge(), after which it adopts the bin widths
+ * of the merged map.
+ */
+OccupancyMap::OccupancyMap()
+    : binWidthX_(0.0)
+    , binWidthY_(0.0)
+    , numFrames_(0)
+{
+
+}
+
+
+/*!
+ * Constructs an empty map with the given bin widths in either dimension.
+ */
+OccupancyMap::OccupancyMap(
+        real binWidthX, 
+        real binWidthY)
+    : binWidthX_(binWidthX)
+    , binWidthY_(binWidthY)
+    , numFrames_(0)
+{
+    if( binWidthX_ <= 0.0 || binWidthY_ <= 0.0 )
+    {
+        throw std::logic_error("Bin widths of occupancy map must be "
+                               "positive.");
+    }
+}
+
+
+/*!
+ * Increments the count of the bin containing the point (x, y). The map must
+ * have been constructed with bin widths.
+ */
+void
+OccupancyMap::add(
+        real x, 
+        real y)
+{
+    if( binWidthX_ <= 0.0 || binWidthY_ <= 0.0 )
+    {
+        throw std::logic_error("Can not add counts to occupancy map without "
+                               "bin widths.");
+    }
+    int binX = static_cast<int>(std::floor(x/binWidthX_));
+    int binY = static_cast<int>(std::floor(y/binWidthY_));
+    counts_[std::make_pair(binX, binY)]++;
+}
+
+
+/*!
+ * Adds the given count to the bin with indices (binX, binY). The map must
+ * have been constructed with bin widths.
+ */
+void
+OccupancyMap::addCount(
+        int binX, 
+        int binY, 
+        unsigned long count)
+{
+    if( binWidthX_ <= 0.0 || binWidthY_ <= 0.0 )
+    {
+        throw std::logic_error("Can not add counts to occupancy map without "
+                               "bin widths.");
+    }
+    if( count > 0 )
+    {
+        counts_[std::make_pair(binX, binY)] += count;
+    }
+}
+
+
+/*!
+ * Increments the number of frames over which counts have been accumulated.
+ */
+void
+OccupancyMap::addFrames(
+        unsigned long numFrames)
+{
+    numFrames_ += numFrames;
+}
+
+
+/*!
+ * Adds the counts and number of frames of another map to this map. Both maps
+ * must have the same bin widths, unless either of them was default 
+ * constructed.
+ */
+void
+OccupancyMap::merge(
+        const OccupancyMap &other)
+{
+    // other map without bin widths can not contain counts:
+    if( other.binWidthX_ == 0.0 && other.binWidthY_ == 0.0 )
+    {
+        numFrames_ += other.numFrames_;
+        return;
+    }
+
+    // adopt bin widths if this map was default constructed:
+    if( binWidthX_ == 0.0 && binWidthY_ == 0.0 )
+    {
+        binWidthX_ = other.binWidthX_;
+        binWidthY_ = other.binWidthY_;
+    }
+
+    // sanity check:
+    if( binWidthX_ != other.binWidthX_ || binWidthY_ != other.binWidthY_ )
+    {
+        throw std::logic_error("Can not merge occupancy maps with different "
+                               "bin widths.");
+    }
+
+    // add up counts and frame numbers:
+    for(auto &bin : other.counts_)
+    {
+        counts_[bin.first] += bin.second;
+    }
+    numFrames_ += other.numFrames_;
+}
+
+
+/*!
+ * Returns the bin width in the first dimension.
+ */
+real
+OccupancyMap::binWidthX() const
+{
+    return binWidthX_;
+}
+
+
+/*!
+ * Returns the bin width in the second dimension.
+ */
+real
+OccupancyMap::binWidthY() const
+{
+    return binWidthY_;
+}
+
+
+/*!
+ * Returns the number of frames over which counts have been accumulated.
+ */
+unsigned long
+OccupancyMap::numFrames() const
+{
+    return numFrames_;
+}
+
+
+/*!
+ * Returns the count in the bin with indices (binX, binY), which is zero for
+ * bins that have never been visited.
+ */
+unsigned long
+OccupancyMap::count(
+        int binX, 
+        int binY) const
+{
+    auto it = counts_.find(std::make_pair(binX, binY));
+    if( it == counts_.end() )
+    {
+        return 0;
+    }
+    return it -> second;
+}
+
+
+/*!
+ * Returns the counts of all visited bins, ordered by bin index in the first
+ * and then in the second dimension.
+ */
+const std::map<std::pair<int, int>, unsigned long>&
+OccupancyMap::counts() const
+{
+    return counts_;
+}
+
+
+/*!
+ * Returns true if no bin has been visited.
+ */
+bool
+OccupancyMap::empty() const
+{
+    return counts_.empty();
+}
+
@@ -0,0 +1,916 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <stdexcept>
+
+#include "aggregation/boltzmann_energy_calculator.hpp"
+#include "aggregation/number_density_calculator.hpp"
+#include "aggregation/pathway_aggregator.hpp"
+
+#include "geometry/linear_spline_interp_1D.hpp"
+#include "geometry/spline_curve_1D.hpp"
+
+#include "io/occupancy_map_json_converter.hpp"
+#include "io/spline_curve_1D_json_converter.hpp"
+#include "io/summary_statistics_json_converter.hpp"
+#include "io/summary_statistics_vector_json_converter.hpp"
+
+#include "path-finding/molecular_path.hpp"
+
+
+/*
+ * Names of scalar pathway properties for which summary statistics are formed.
+ */
+static const std::vector<std::string> scalarSummaryNames = {
+        "argMinRadius",
+        "minRadius",
+        "length",
+        "volume",
+        "numPath",
+        "numSample",
+        "solventRangeLo",
+        "solventRangeHi",
+        "argMinSolventDensity",
+        "minSolventDensity",
+        "arcLengthLo",
+        "arcLengthHi",
+        "bandWidth"};
+
+/*
+ * Names of scalar pathway properties for which time series are recorded.
+ */
+static const std::vector<std::string> scalarTimeSeriesNames = {
+        "argMinRadius",
+        "minRadius",
+        "length",
+        "volume",
+        "numPath",
+        "numSample",
+        "argMinSolventDensity",
+        "minSolventDensity",
+        "bandWidth"};
+
+/*
+ * Names of pathway profiles for which summary statistics are formed.
+ */
+static const std::vector<std::string> profileSummaryNames = {
+        "radius",
+        "plHydrophobicity",
+        "pfHydrophobicity",
+        "density",
+        "energy"};
+
+/*
+ * Names of pathway profiles for which time series are recorded.
+ */
+static const std::vector<std::string> profileTimeSeriesNames = {
+        "radius",
+        "density",
+        "plHydrophobicity",
+        "pfHydrophobicity"};
+
+/*
+ * Names of residue properties for which summary statistics are formed.
+ */
+static const std::vector<std::string> residueSummaryNames = {
+        "s",
+        "rho",
+        "phi",
+        "poreLining",
+        "poreFacing",
+        "poreRadius",
+        "solventDensity",
+        "x",
+        "y",
+        "z"};
+
+/*
+ * Solvent occupancy maps with the frame stream data set and column holding 
+ * the second bin index and the name of the corresponding bin width in the 
+ * pathway summary.
+ */
+static const std::vector<std::vector<std::string>> occupancyMapSpecs = {
+        {"sRho", "sRhoOccupancy", "binRho", "occupancyBinWidthRho"},
+        {"sPhi", "sPhiOccupancy", "binPhi", "occupancyBinWidthPhi"}};
+
+
+/*!
+ * Updates the summary statistics and time series of all scalar pathway
+ * properties with the data in the given frame document. In the first frame,
+ * the IDs of the pore-forming residues are also read from the document.
+ */
+void
+PathwayAggregator::addScalarFrame(
+        rapidjson::Document &frameDoc)
+{
+    // sanity check:
+    if( !frameDoc.IsObject() || !frameDoc.HasMember("pathSummary") )
+    {
+        throw std::runtime_error("Frame document does not contain pathway "
+                                 "summary data.");
+    }
+    const rapidjson::Value &pathSummary = frameDoc["pathSummary"];
+
+    // calculate summary statistics of aggregate variables:
+    for(auto name : scalarSummaryNames)
+    {
+        scalarSummaries_[name].update(pathSummary[name.c_str()][0].GetDouble());
+    }
+
+    // get time stamp of current frame:
+    timeStamps_.push_back(pathSummary["timeStamp"][0].GetDouble());
+
+    // get scalar time series data:
+    for(auto name : scalarTimeSeriesNames)
+    {
+        scalarTimeSeries_[name].push_back(
+                pathSummary[name.c_str()][0].GetDouble());
+    }
+
+    // in first frame, also read residue IDs of pore forming group (these are
+    // absent if residue positions were excluded from the stream):
+    if( numScalarFrames_ == 0 )
+    {
+        if( frameDoc.HasMember("residuePositions") )
+        {
+            const rapidjson::Value &resId = 
+                    frameDoc["residuePositions"]["resId"];
+            for(size_t i = 0; i < resId.Size(); i++)
+            {
+                poreResIds_.push_back(resId[i].GetDouble());
+            }
+        }
+
+        // prepare summary statistics for residue properties:
+        for(auto name : residueSummaryNames)
+        {
+            residueSummaries_[name].resize(poreResIds_.size());
+        }
+    }
+
+    // increment frame counter:
+    numScalarFrames_++;
+}
+
+
+/*!
+ * Creates an evenly spaced set of support points spanning the range of arc
+ * length covered by the pathway in all frames seen by addScalarFrame(),
+ * extended by the given extrapolation distance in either direction. The
+ * pathway endpoints serve as anchor points at which the energy profile is
+ * set to zero.
+ */
+void
+PathwayAggregator::supportPointsFromScalars(
+        size_t numPoints,
+        real extrapDist)
+{
+    // sanity check:
+    if( numScalarFrames_ == 0 )
+    {
+        throw std::logic_error("Can not determine support points before "
+                               "scalar data has been added.");
+    }
+
+    // range covered by pathway:
+    real anchorPointLo = scalarSummaries_["arcLengthLo"].min();
+    real anchorPointHi = scalarSummaries_["arcLengthHi"].max();
+
+    // build support points:
+    std::vector<real> supportPoints;
+    real supportPointsLo = anchorPointLo - extrapDist;
+    real supportPointsHi = anchorPointHi + extrapDist;
+    real supportPointsStep = (supportPointsHi - supportPointsLo) / (numPoints - 1);
+    for(size_t i = 0; i < numPoints; i++)
+    {
+        supportPoints.push_back(supportPointsLo + i*supportPointsStep);
+    }
+
+    // set support points and initialise profile containers:
+    setSupportPoints(supportPoints, anchorPointLo, anchorPointHi);
+}
+
+
+/*!
+ * Sets the support points at which pathway profiles are evaluated as well as
+ * the anchor points at which the energy is set to zero. All profile data
+ * collected so far is discarded.
+ */
+void
+PathwayAggregator::setSupportPoints(
+        const std::vector<real> &supportPoints,
+        real anchorPointLo,
+        real anchorPointHi)
+{
+    supportPoints_ = supportPoints;
+    anchorPointLo_ = anchorPointLo;
+    anchorPointHi_ = anchorPointHi;
+
+    // reset profile data:
+    anchorEnergyLo_ = SummaryStatistics();
+    anchorEnergyHi_ = SummaryStatistics();
+    for(auto name : profileSummaryNames)
+    {
+        profileSummaries_[name].assign(
+                supportPoints_.size(),
+                SummaryStatistics());
+    }
+    for(auto name : profileTimeSeriesNames)
+    {
+        profileTimeSeries_[name].clear();
+    }
+    numProfileFrames_ = 0;
+}
+
+
+/*!
+ * Samples the pathway profiles of the given frame document at the support
+ * points and updates the profile summary statistics and time series. Also
+ * updates the summary statistics of all residue properties.
+ */
+void
+PathwayAggregator::addProfileFrame(
+        rapidjson::Document &frameDoc)
+{
+    // sanity check:
+    if( supportPoints_.empty() )
+    {
+        throw std::logic_error("Support points must be set before profile "
+                               "data can be added.");
+    }
+
+    // create molecular path:
+    MolecularPath molPath(frameDoc);
+
+    // sample radius at support points and add to summary statistics:
+    std::vector<real> radiusSample = molPath.sampleRadii(supportPoints_);
+    SummaryStatistics::updateMultiple(
+            profileSummaries_["radius"],
+            radiusSample);
+    profileTimeSeries_["radius"].push_back(radiusSample);
+
+    // sample points from hydrophobicity splines:
+    SplineCurve1D pfHydrophobicitySpline = SplineCurve1DJsonConverter::fromJson(
+            frameDoc["pfHydrophobicitySpline"], 1);
+    std::vector<real> pfHydrophobicitySample =
+            pfHydrophobicitySpline.evaluateMultiple(supportPoints_, 0);
+    SummaryStatistics::updateMultiple(
+            profileSummaries_["pfHydrophobicity"],
+            pfHydrophobicitySample);
+    profileTimeSeries_["pfHydrophobicity"].push_back(pfHydrophobicitySample);
+
+    SplineCurve1D plHydrophobicitySpline = SplineCurve1DJsonConverter::fromJson(
+            frameDoc["plHydrophobicitySpline"], 1);
+    std::vector<real> plHydrophobicitySample =
+            plHydrophobicitySpline.evaluateMultiple(supportPoints_, 0);
+    SummaryStatistics::updateMultiple(
+            profileSummaries_["plHydrophobicity"],
+            plHydrophobicitySample);
+    profileTimeSeries_["plHydrophobicity"].push_back(plHydrophobicitySample);
+
+    // sample points from solvent density spline:
+    SplineCurve1D solventDensitySpline = SplineCurve1DJsonConverter::fromJson(
+            frameDoc["solventDensitySpline"], 1);
+    std::vector<real> solventDensitySample =
+            solventDensitySpline.evaluateMultiple(supportPoints_, 0);
+
+    // get total number of particles in sample for this time step:
+    int totalNumber = frameDoc["pathSummary"]["numSample"][0].GetDouble();
+
+    // convert to number density and add to summary statistic:
+    // TODO this should be done in per-frame analysis:
+    NumberDensityCalculator ndc;
+    solventDensitySample = ndc(
+            solventDensitySample,
+            radiusSample,
+            totalNumber);
+    SummaryStatistics::updateMultiple(
+            profileSummaries_["density"],
+            solventDensitySample);
+    profileTimeSeries_["density"].push_back(solventDensitySample);
+
+    // convert to energy and add to summary statistic:
+    BoltzmannEnergyCalculator bec;
+    std::vector<real> energySample = bec.calculate(solventDensitySample);
+    SummaryStatistics::updateMultiple(
+            profileSummaries_["energy"],
+            energySample);
+
+    // calculate energy at anchor points by linear interpolation:
+    LinearSplineInterp1D interp;
+    auto energySpline = interp(supportPoints_, energySample);
+    anchorEnergyLo_.update( energySpline.evaluate(anchorPointLo_, 0) );
+    anchorEnergyHi_.update( energySpline.evaluate(anchorPointHi_, 0) );
+
+    // loop over all pore forming residues (if residue data was streamed):
+    if( !poreResIds_.empty() )
+    {
+        if( !frameDoc.HasMember("residuePositions") )
+        {
+            throw std::runtime_error("Frame document does not contain "
+                                     "residue positions.");
+        }
+        const rapidjson::Value &resPos = frameDoc["residuePositions"];
+        for(size_t i = 0; i < poreResIds_.size(); i++)
+        {
+            for(auto name : {"s", "rho", "phi", "poreLining", "poreFacing",
+                             "poreRadius", "x", "y", "z"})
+            {
+                residueSummaries_[name].at(i).update(
+                        resPos[name][i].GetDouble());
+            }
+
+            // residue-local number density requires post-processing:
+            real rad = resPos["poreRadius"][i].GetDouble();
+            real den = resPos["solventDensity"][i].GetDouble();
+            residueSummaries_["solventDensity"].at(i).update(
+                    den*totalNumber/(M_PI*rad*rad));
+        }
+    }
+
+    // accumulate solvent occupancy maps (if these were streamed):
+    for(auto &spec : occupancyMapSpecs)
+    {
+        if( !frameDoc.HasMember(spec[1].c_str()) )
+        {
+            continue;
+        }
+        const rapidjson::Value &pathSummary = frameDoc["pathSummary"];
+        const rapidjson::Value &bins = frameDoc[spec[1].c_str()];
+        OccupancyMap frameMap(
+                pathSummary["occupancyBinWidthS"][0].GetDouble(),
+                pathSummary[spec[3].c_str()][0].GetDouble());
+        frameMap.addFrames(1);
+        for(rapidjson::SizeType i = 0; i < bins["count"].Size(); i++)
+        {
+            frameMap.addCount(
+                    std::lround(bins["binS"][i].GetDouble()),
+                    std::lround(bins[spec[2].c_str()][i].GetDouble()),
+                    std::lround(bins["count"][i].GetDouble()));
+        }
+        occupancyMaps_[spec[0]].merge(frameMap);
+    }
+
+    // increment frame counter:
+    numProfileFrames_++;
+}
+
+
+/*!
+ * Merges the aggregation state of another aggregator into this one. Summary
+ * statistics are merged so that they describe the pooled set of frames,
+ * while time series of the other aggregator are appended to those of this
+ * aggregator. Both aggregators must use the same support points, energy 
+ * anchor points, and pore-forming residues (unless one of them is still 
+ * empty), otherwise a logic_error is thrown. Means and variances are pooled
+ * from the partial moments, so the result agrees with aggregating all frames
+ * in a single aggregator up to floating point rounding.
+ */
+void
+PathwayAggregator::merge(
+        const PathwayAggregator &other)
+{
+    // nothing to do if other aggregator has seen no data:
+    if( other.numScalarFrames_ == 0 )
+    {
+        return;
+    }
+
+    // if this aggregator has seen no data, simply copy other:
+    if( numScalarFrames_ == 0 )
+    {
+        *this = other;
+        return;
+    }
+
+    // sanity checks:
+    if( supportPoints_ != other.supportPoints_ )
+    {
+        throw std::logic_error("Can not merge pathway aggregates with "
+                               "different support points.");
+    }
+    if( poreResIds_ != other.poreResIds_ )
+    {
+        throw std::logic_error("Can not merge pathway aggregates with "
+                               "different pore-forming residues.");
+    }
+    if( anchorPointLo_ != other.anchorPointLo_ ||
+        anchorPointHi_ != other.anchorPointHi_ )
+    {
+        throw std::logic_error("Can not merge pathway aggregates with "
+                               "different energy anchor points.");
+    }
+
+    // merge scalar summaries and append time series:
+    numScalarFrames_ += other.numScalarFrames_;
+    timeStamps_.insert(
+            timeStamps_.end(),
+            other.timeStamps_.begin(),
+            other.timeStamps_.end());
+    for(auto &summary : scalarSummaries_)
+    {
+        summary.second.merge(other.scalarSummaries_.at(summary.first));
+    }
+    for(auto &ts : scalarTimeSeries_)
+    {
+        const std::vector<real> &otherTs = other.scalarTimeSeries_.at(ts.first);
+        ts.second.insert(ts.second.end(), otherTs.begin(), otherTs.end());
+    }
+
+    // merge profile summaries and append time series:
+    numProfileFrames_ += other.numProfileFrames_;
+    anchorEnergyLo_.merge(other.anchorEnergyLo_);
+    anchorEnergyHi_.merge(other.anchorEnergyHi_);
+    for(auto &profile : profileSummaries_)
+    {
+        SummaryStatistics::mergeMultiple(
+                profile.second,
+                other.profileSummaries_.at(profile.first));
+    }
+    for(auto &ts : profileTimeSeries_)
+    {
+        const std::vector<std::vector<real>> &otherTs =
+                other.profileTimeSeries_.at(ts.first);
+        ts.second.insert(ts.second.end(), otherTs.begin(), otherTs.end());
+    }
+
+    // merge residue summaries:
+    for(auto &res : residueSummaries_)
+    {
+        SummaryStatistics::mergeMultiple(
+                res.second,
+                other.residueSummaries_.at(res.first));
+    }
+
+    // merge occupancy maps:
+    for(auto &map : other.occupancyMaps_)
+    {
+        occupancyMaps_[map.first].merge(map.second);
+    }
+}
+
+
+/*!
+ * Returns the number of frames added with addScalarFrame().
+ */
+size_t
+PathwayAggregator::numScalarFrames() const
+{
+    return numScalarFrames_;
+}
+
+
+/*!
+ * Returns the number of frames added with addProfileFrame() since the
+ * support points were last set.
+ */
+size_t
+PathwayAggregator::numProfileFrames() const
+{
+    return numProfileFrames_;
+}
+
+
+/*!
+ * Returns the support points at which pathway profiles are evaluated.
+ */
+const std::vector<real>&
+PathwayAggregator::supportPoints() const
+{
+    return supportPoints_;
+}
+
+
+/*!
+ * Returns the IDs of the pore-forming residues.
+ */
+const std::vector<int>&
+PathwayAggregator::poreResIds() const
+{
+    return poreResIds_;
+}
+
+
+/*!
+ * Returns the summary statistics of the named scalar pathway property.
+ */
+const SummaryStatistics&
+PathwayAggregator::scalarSummary(
+        const std::string &name) const
+{
+    return scalarSummaries_.at(name);
+}
+
+
+/*!
+ * Returns the summary statistics of the named residue property.
+ */
+const std::vector<SummaryStatistics>&
+PathwayAggregator::residueSummary(
+        const std::string &name) const
+{
+    return residueSummaries_.at(name);
+}
+
+
+/*!
+ * Returns the named solvent occupancy map (sRho or sPhi). Throws if no such
+ * map was contained in the frame stream.
+ */
+const OccupancyMap&
+PathwayAggregator::occupancyMap(
+        const std::string &name) const
+{
+    return occupancyMaps_.at(name);
+}
+
+
+/*!
+ * Returns the summary statistics of the named pathway profile. For the
+ * energy profile, the profile is shifted so that the mean energy at the
+ * anchor points is zero.
+ */
+std::vector<SummaryStatistics>
+PathwayAggregator::profileSummary(
+        const std::string &name) const
+{
+    std::vector<SummaryStatistics> profile = profileSummaries_.at(name);
+
+    // shift of energy profile so that energy at anchor points is zero:
+    if( name == "energy" )
+    {
+        real shift = -0.5*(anchorEnergyLo_.mean() + anchorEnergyHi_.mean());
+        for(auto &s : profile)
+        {
+            s.shift(shift);
+        }
+    }
+
+    return profile;
+}
+
+
+/*!
+ * Returns the mean of the named pathway profile at each support point.
+ */
+std::vector<real>
+PathwayAggregator::meanProfile(
+        const std::string &name) const
+{
+    std::vector<real> mean;
+    mean.reserve(supportPoints_.size());
+    for(auto &s : profileSummary(name))
+    {
+        mean.push_back(s.mean());
+    }
+
+    return mean;
+}
+
+
+/*!
+ * Adds the aggregated pathway summary, profiles, time series, and residue
+ * summaries to the given results document.
+ */
+void
+PathwayAggregator::addToResults(
+        ResultsJsonExporter &results,
+        const ResidueInformationProvider &resInfo) const
+{
+    // add summary statistics for scalar variables describing the pathway:
+    results.addPathwaySummary("argMinRadius", scalarSummary("argMinRadius"));
+    results.addPathwaySummary("minRadius", scalarSummary("minRadius"));
+    results.addPathwaySummary("length", scalarSummary("length"));
+    results.addPathwaySummary("volume", scalarSummary("volume"));
+    results.addPathwaySummary("numPathway", scalarSummary("numPath"));
+    results.addPathwaySummary("numSample", scalarSummary("numSample"));
+    results.addPathwaySummary("argMinSolventDensity", scalarSummary("argMinSolventDensity"));
+    results.addPathwaySummary("minSolventDensity", scalarSummary("minSolventDensity"));
+    results.addPathwaySummary("bandWidth", scalarSummary("bandWidth"));
+
+    // add time-averaged pathway profiles:
+    results.addSupportPoints(supportPoints_);
+    results.addPathwayProfile("radius", profileSummary("radius"));
+    results.addPathwayProfile("plHydrophobicity", profileSummary("plHydrophobicity"));
+    results.addPathwayProfile("pfHydrophobicity", profileSummary("pfHydrophobicity"));
+    results.addPathwayProfile("density", profileSummary("density"));
+    results.addPathwayProfile("energy", profileSummary("energy"));
+
+    // add scalar time series data to output:
+    results.addTimeStamps(timeStamps_);
+    results.addPathwayScalarTimeSeries("argMinRadius", scalarTimeSeries_.at("argMinRadius"));
+    results.addPathwayScalarTimeSeries("minRadius", scalarTimeSeries_.at("minRadius"));
+    results.addPathwayScalarTimeSeries("length", scalarTimeSeries_.at("length"));
+    results.addPathwayScalarTimeSeries("volume", scalarTimeSeries_.at("volume"));
+    results.addPathwayScalarTimeSeries("numPathway", scalarTimeSeries_.at("numPath"));
+    results.addPathwayScalarTimeSeries("numSample", scalarTimeSeries_.at("numSample"));
+    results.addPathwayScalarTimeSeries("argMinSolventDensity", scalarTimeSeries_.at("argMinSolventDensity"));
+    results.addPathwayScalarTimeSeries("minSolventDensity", scalarTimeSeries_.at("minSolventDensity"));
+    results.addPathwayScalarTimeSeries("bandWidth", scalarTimeSeries_.at("bandWidth"));
+
+    // add vector-valued time series data to output:
+    results.addPathwayGridPoints(timeStamps_, supportPoints_);
+    results.addPathwayProfileTimeSeries("radius", profileTimeSeries_.at("radius"));
+    results.addPathwayProfileTimeSeries("density", profileTimeSeries_.at("density"));
+    results.addPathwayProfileTimeSeries("plHydrophobicity", profileTimeSeries_.at("plHydrophobicity"));
+    results.addPathwayProfileTimeSeries("pfHydrophobicity", profileTimeSeries_.at("pfHydrophobicity"));
+
+    // add per-residue data to output document:
+    results.addResidueInformation(poreResIds_, resInfo);
+    for(auto name : residueSummaryNames)
+    {
+        results.addResidueSummary(name, residueSummary(name));
+    }
+
+    // add solvent occupancy maps to output document:
+    for(auto &map : occupancyMaps_)
+    {
+        results.addOccupancyMap(map.first, map.second);
+    }
+}
+
+
+/*
+ * Auxiliary function to convert a vector of reals to a JSON array.
+ */
+static rapidjson::Value
+realVectorToJson(
+        const std::vector<real> &vec,
+        rapidjson::Document::AllocatorType &alloc)
+{
+    rapidjson::Value array(rapidjson::kArrayType);
+    array.Reserve(vec.size(), alloc);
+    for(auto v : vec)
+    {
+        array.PushBack(v, alloc);
+    }
+    return array;
+}
+
+
+/*
+ * Auxiliary function to convert a JSON array to a vector of reals.
+ */
+static std::vector<real>
+realVectorFromJson(
+        const rapidjson::Value &array)
+{
+    std::vector<real> vec;
+    vec.reserve(array.Size());
+    for(auto it = array.Begin(); it != array.End(); it++)
+    {
+        vec.push_back(it -> GetDouble());
+    }
+    return vec;
+}
+
+
+/*!
+ * Converts the complete aggregation state, i.e. all summary statistics in 
+ * their internal representation, all time series, the support and anchor 
+ * points, and the pore-forming residue IDs, to a JSON object.
+ */
+rapidjson::Value
+PathwayAggregator::stateToJson(
+        rapidjson::Document::AllocatorType &alloc) const
+{
+    rapidjson::Value state(rapidjson::kObjectType);
+
+    // frame counters and time stamps:
+    state.AddMember("numScalarFrames", 
+                    static_cast<uint64_t>(numScalarFrames_), 
+                    alloc);
+    state.AddMember("numProfileFrames", 
+                    static_cast<uint64_t>(numProfileFrames_), 
+                    alloc);
+    state.AddMember("timeStamps", realVectorToJson(timeStamps_, alloc), alloc);
+
+    // scalar summaries and time series:
+    rapidjson::Value scalarSummaries(rapidjson::kObjectType);
+    for(auto &summary : scalarSummaries_)
+    {
+        scalarSummaries.AddMember(
+                rapidjson::Value(summary.first, alloc),
+                SummaryStatisticsJsonConverter::convertState(
+                        summary.second, alloc),
+                alloc);
+    }
+    state.AddMember("scalarSummaries", scalarSummaries, alloc);
+    rapidjson::Value scalarTimeSeries(rapidjson::kObjectType);
+    for(auto &ts : scalarTimeSeries_)
+    {
+        scalarTimeSeries.AddMember(
+                rapidjson::Value(ts.first, alloc),
+                realVectorToJson(ts.second, alloc),
+                alloc);
+    }
+    state.AddMember("scalarTimeSeries", scalarTimeSeries, alloc);
+
+    // support and anchor points:
+    state.AddMember(
+            "supportPoints", 
+            realVectorToJson(supportPoints_, alloc), 
+            alloc);
+    state.AddMember("anchorPointLo", anchorPointLo_, alloc);
+    state.AddMember("anchorPointHi", anchorPointHi_, alloc);
+    state.AddMember(
+            "anchorEnergyLo", 
+            SummaryStatisticsJsonConverter::convertState(
+                    anchorEnergyLo_, alloc),
+            alloc);
+    state.AddMember(
+            "anchorEnergyHi", 
+            SummaryStatisticsJsonConverter::convertState(
+                    anchorEnergyHi_, alloc),
+            alloc);
+
+    // profile summaries and time series:
+    rapidjson::Value profileSummaries(rapidjson::kObjectType);
+    for(auto &profile : profileSummaries_)
+    {
+        profileSummaries.AddMember(
+                rapidjson::Value(profile.first, alloc),
+                SummaryStatisticsVectorJsonConverter::convertState(
+                        profile.second, alloc),
+                alloc);
+    }
+    state.AddMember("profileSummaries", profileSummaries, alloc);
+    rapidjson::Value profileTimeSeries(rapidjson::kObjectType);
+    for(auto &ts : profileTimeSeries_)
+    {
+        rapidjson::Value frames(rapidjson::kArrayType);
+        for(auto &frame : ts.second)
+        {
+            frames.PushBack(realVectorToJson(frame, alloc), alloc);
+        }
+        profileTimeSeries.AddMember(
+                rapidjson::Value(ts.first, alloc),
+                frames,
+                alloc);
+    }
+    state.AddMember("profileTimeSeries", profileTimeSeries, alloc);
+
+    // residue summaries:
+    rapidjson::Value poreResIds(rapidjson::kArrayType);
+    for(auto id : poreResIds_)
+    {
+        poreResIds.PushBack(id, alloc);
+    }
+    state.AddMember("poreResIds", poreResIds, alloc);
+    rapidjson::Value residueSummaries(rapidjson::kObjectType);
+    for(auto &res : residueSummaries_)
+    {
+        residueSummaries.AddMember(
+                rapidjson::Value(res.first, alloc),
+                SummaryStatisticsVectorJsonConverter::convertState(
+                        res.second, alloc),
+                alloc);
+    }
+    state.AddMember("residueSummaries", residueSummaries, alloc);
+
+    // solvent occupancy maps:
+    rapidjson::Value occupancyMaps(rapidjson::kObjectType);
+    for(auto &map : occupancyMaps_)
+    {
+        occupancyMaps.AddMember(
+                rapidjson::Value(map.first, alloc),
+                OccupancyMapJsonConverter::convert(map.second, alloc),
+                alloc);
+    }
+    state.AddMember("occupancyMaps", occupancyMaps, alloc);
+
+    return state;
+}
+
+
+/*!
+ * Restores the aggregation state from a JSON object created by 
+ * stateToJson(). Any data previously held by this aggregator is discarded.
+ */
+void
+PathwayAggregator::stateFromJson(
+        const rapidjson::Value &state)
+{
+    // sanity check:
+    for(auto name : {"numScalarFrames", "numProfileFrames", "timeStamps", 
+                     "scalarSummaries", "scalarTimeSeries", "supportPoints",
+                     "anchorPointLo", "anchorPointHi", "anchorEnergyLo",
+                     "anchorEnergyHi", "profileSummaries", 
+                     "profileTimeSeries", "poreResIds", "residueSummaries"})
+    {
+        if( !state.IsObject() || !state.HasMember(name) )
+        {
+            throw std::runtime_error("Aggregation state does not contain "
+                                     "member " + std::string(name) + ".");
+        }
+    }
+
+    // reset all data:
+    *this = PathwayAggregator();
+
+    // frame counters and time stamps:
+    numScalarFrames_ = state["numScalarFrames"].GetUint64();
+    numProfileFrames_ = state["numProfileFrames"].GetUint64();
+    timeStamps_ = realVectorFromJson(state["timeStamps"]);
+
+    // scalar summaries and time series:
+    const rapidjson::Value &scalarSummaries = state["scalarSummaries"];
+    for(auto it = scalarSummaries.MemberBegin(); 
+        it != scalarSummaries.MemberEnd(); 
+        it++)
+    {
+        scalarSummaries_[it -> name.GetString()] = 
+                SummaryStatisticsJsonConverter::fromState(it -> value);
+    }
+    const rapidjson::Value &scalarTimeSeries = state["scalarTimeSeries"];
+    for(auto it = scalarTimeSeries.MemberBegin(); 
+        it != scalarTimeSeries.MemberEnd(); 
+        it++)
+    {
+        scalarTimeSeries_[it -> name.GetString()] = 
+                realVectorFromJson(it -> value);
+    }
+
+    // support and anchor points:
+    supportPoints_ = realVectorFromJson(state["supportPoints"]);
+    anchorPointLo_ = state["anchorPointLo"].GetDouble();
+    anchorPointHi_ = state["anchorPointHi"].GetDouble();
+    anchorEnergyLo_ = SummaryStatisticsJsonConverter::fromState(
+            state["anchorEnergyLo"]);
+    anchorEnergyHi_ = SummaryStatisticsJsonConverter::fromState(
+            state["anchorEnergyHi"]);
+
+    // profile summaries and time series:
+    const rapidjson::Value &profileSummaries = state["profileSummaries"];
+    for(auto it = profileSummaries.MemberBegin(); 
+        it != profileSummaries.MemberEnd(); 
+        it++)
+    {
+        profileSummaries_[it -> name.GetString()] = 
+                SummaryStatisticsVectorJsonConverter::fromState(it -> value);
+    }
+    const rapidjson::Value &profileTimeSeries = state["profileTimeSeries"];
+    for(auto it = profileTimeSeries.MemberBegin(); 
+        it != profileTimeSeries.MemberEnd(); 
+        it++)
+    {
+        std::vector<std::vector<real>> &ts = 
+                profileTimeSeries_[it -> name.GetString()];
+        for(auto frame = it -> value.Begin(); 
+            frame != it -> value.End(); 
+            frame++)
+        {
+            ts.push_back(realVectorFromJson(*frame));
+        }
+    }
+
+    // residue summaries:
+    const rapidjson::Value &poreResIds = state["poreResIds"];
+    for(auto it = poreResIds.Begin(); it != poreResIds.End(); it++)
+    {
+        poreResIds_.push_back(it -> GetInt());
+    }
+    const rapidjson::Value &residueSummaries = state["residueSummaries"];
+    for(auto it = residueSummaries.MemberBegin(); 
+        it != residueSummaries.MemberEnd(); 
+        it++)
+    {
+        residueSummaries_[it -> name.GetString()] = 
+                SummaryStatisticsVectorJsonConverter::fromState(it -> value);
+    }
+
+    // solvent occupancy maps (optional, as not every stream contains them):
+    if( state.HasMember("occupancyMaps") )
+    {
+        const rapidjson::Value &occupancyMaps = state["occupancyMaps"];
+        for(auto it = occupancyMaps.MemberBegin(); 
+            it != occupancyMaps.MemberEnd(); 
+            it++)
+        {
+            occupancyMaps_[it -> name.GetString()] = 
+                    OccupancyMapJsonConverter::fromJson(it -> value);
+        }
+    }
+}
@@ -151,6 +151,55 @@ ResidueInformationProvider::hydrophobicityFromJson(
 }
 
 
+/*!
+ * Restores residue names, chain IDs, and hydrophobicities from the residue
+ * summary of a CHAP results file, i.e. from an object containing the arrays
+ * "id", "name", "chain", and "hydrophobicity". This allows results to be 
+ * regenerated without access to the topology. Residues whose hydrophobicity
+ * was not a finite number receive the default hydrophobicity.
+ */
+void
+ResidueInformationProvider::fromResidueSummary(
+        const rapidjson::Value &residueSummary)
+{
+    // sanity checks:
+    if( !residueSummary.IsObject() ||
+        !residueSummary.HasMember("id") || 
+        !residueSummary.HasMember("name") ||
+        !residueSummary.HasMember("chain") ||
+        !residueSummary.HasMember("hydrophobicity") )
+    {
+        throw std::runtime_error("Residue summary does not contain residue "
+                                 "information.");
+    }
+    const rapidjson::Value &id = residueSummary["id"];
+    const rapidjson::Value &name = residueSummary["name"];
+    const rapidjson::Value &chain = residueSummary["chain"];
+    const rapidjson::Value &hydrophobicity = residueSummary["hydrophobicity"];
+    if( !id.IsArray() || !name.IsArray() || !chain.IsArray() ||
+        !hydrophobicity.IsArray() ||
+        name.Size() != id.Size() || chain.Size() != id.Size() ||
+        hydrophobicity.Size() != id.Size() )
+    {
+        throw std::runtime_error("Residue information arrays in residue "
+                                 "summary must have equal length.");
+    }
+
+    // add to internal storage containers:
+    for(rapidjson::SizeType i = 0; i < id.Size(); i++)
+    {
+        int resId = id[i].GetInt();
+        std::string resName = name[i].GetString();
+        name_[resId] = resName;
+        chain_[resId] = chain[i].GetString();
+        if( hydrophobicity[i].IsNumber() )
+        {
+            hydrophobicity_[resName] = hydrophobicity[i].GetDouble();
+        }
+    }
+}
+
+
 /*!
  * Set default hydrophobicity that will be used for residues for which no 
  * lookup table entry exists.
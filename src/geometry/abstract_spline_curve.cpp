@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 #include "geometry/abstract_spline_curve.hpp"
 
@@ -141,3 +142,110 @@ AbstractSplineCurve::findInterval(const real &evalPoint)
     return idx;
 }
 
+
+
+/*!
+ * Returns true if the spline can be represented by the polynomials returned
+ * from powerBasisCoefs(), i.e. if it is at most of cubic degree and its knot
+ * vector is clamped (as is the case for all splines created by the 
+ * interpolation classes), so that the spans between the first and last knot
+ * are exactly the spans with full support.
+ */
+bool
+AbstractSplineCurve::hasPolynomialSpans() const
+{
+    return degree_ <= maxPolynomialDegree_ &&
+           nKnots_ > 2*degree_ + 1 &&
+           knots_[degree_] == knots_.front() &&
+           knots_[nKnots_ - degree_ - 1] == knots_.back();
+}
+
+
+/*!
+ * Auxiliary function that computes the coefficients of the polynomial that
+ * the spline reduces to on the knot span with the given index, i.e. 
+ *
+ *  \f[
+ *
+ *      f(s) = \sum_{k=0}^{d} c_k (s - t_j)^k \quad \text{for} \quad
+ *      t_j \leq s < t_{j+1}
+ *
+ *  \f]
+ *
+ * where ctrl contains the control points \f$ d_{j-p}, \dots, d_j \f$ affecting
+ * this span (for curves in more than one dimension this is called once per 
+ * dimension). The coefficients are obtained as \f$ c_k = f^{(k)}(t_j)/k! \f$, 
+ * where the derivatives are evaluated by applying de Boor's algorithm to the 
+ * control points of the derivative splines. Expanding about the left knot of 
+ * the span keeps the local coordinate small and hence the coefficients well 
+ * conditioned. No heap memory is allocated. Returns false if the span has
+ * zero length.
+ */
+bool
+AbstractSplineCurve::powerBasisCoefs(
+        int span,
+        SpanPolynomial ctrl,
+        SpanPolynomial &coefs) const
+{
+    if( degree_ > maxPolynomialDegree_ )
+    {
+        throw std::logic_error("Piecewise polynomial representation is only "
+                               "available for splines up to cubic degree.");
+    }
+
+    coefs.fill(0.0);
+
+    real a = knots_[span];
+    if( !(knots_[span + 1] > a) )
+    {
+        return false;
+    }
+
+    real factorial = 1.0;
+    for(int k = 0; k <= degree_; k++)
+    {
+        // degree of k-th derivative spline (control points in ctrl[k..p]):
+        int q = degree_ - k;
+
+        // evaluate derivative at left knot via de Boor's algorithm:
+        SpanPolynomial w = ctrl;
+        for(int r = 1; r <= q; r++)
+        {
+            for(int i = degree_; i >= k + r; i--)
+            {
+                int idx = span - degree_ + i;
+                real alpha = (a - knots_[idx])/
+                             (knots_[idx + q + 1 - r] - knots_[idx]);
+                w[i] = (1.0 - alpha)*w[i - 1] + alpha*w[i];
+            }
+        }
+        if( k > 0 )
+        {
+            factorial *= k;
+        }
+        coefs[k] = w[degree_]/factorial;
+
+        // control points of next derivative spline:
+        for(int i = degree_; i > k; i--)
+        {
+            int idx = span - degree_ + i;
+            ctrl[i] = q*(ctrl[i] - ctrl[i - 1])/(knots_[idx + q] - knots_[idx]);
+        }
+    }
+
+    return true;
+}
+
+
+/*!
+ * Replaces the coefficients of a span polynomial by those of its derivative.
+ */
+void
+AbstractSplineCurve::differentiatePolynomial(SpanPolynomial &coefs)
+{
+    for(int k = 0; k < maxPolynomialDegree_; k++)
+    {
+        coefs[k] = (k + 1)*coefs[k + 1];
+    }
+    coefs[maxPolynomialDegree_] = 0.0;
+}
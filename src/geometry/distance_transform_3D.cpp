@@ -0,0 +1,233 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <limits>
+#include <stdexcept>
+
+#include "geometry/distance_transform_3D.hpp"
+
+
+/*!
+ * Constructor. Sets up a transform for a grid with the given number of 
+ * voxels along each axis.
+ */
+DistanceTransform3D::DistanceTransform3D(
+        int numX, 
+        int numY, 
+        int numZ)
+    : numX_(numX)
+    , numY_(numY)
+    , numZ_(numZ)
+{
+    // sanity check:
+    if( numX_ < 1 || numY_ < 1 || numZ_ < 1 )
+    {
+        throw std::logic_error("Distance transform grid must have at least "
+                               "one voxel along each axis.");
+    }
+}
+
+
+/*!
+ * Returns the total number of voxels in the grid.
+ */
+int
+DistanceTransform3D::numVoxels() const
+{
+    return numX_*numY_*numZ_;
+}
+
+
+/*!
+ * Computes the squared distance of each voxel to the nearest voxel for 
+ * which isFeature is nonzero.
+ */
+std::vector<real>
+DistanceTransform3D::squaredDistances(
+        const std::vector<char> &isFeature) const
+{
+    // sanity check:
+    if( isFeature.size() != static_cast<size_t>(numVoxels()) )
+    {
+        throw std::logic_error("Feature mask size does not match distance "
+                               "transform grid.");
+    }
+
+    // feature voxels have zero distance, all others are yet unreached:
+    std::vector<real> dist(isFeature.size());
+    for(size_t i = 0; i < isFeature.size(); i++)
+    {
+        dist[i] = isFeature[i] ? 0.0 : std::numeric_limits<real>::infinity();
+    }
+
+    // separable transform along each axis:
+    transformAxis(dist, 0);
+    transformAxis(dist, 1);
+    transformAxis(dist, 2);
+
+    return dist;
+}
+
+
+/*!
+ * Applies the one-dimensional transform to all grid lines parallel to the
+ * given axis.
+ */
+void
+DistanceTransform3D::transformAxis(
+        std::vector<real> &dist,
+        int axis) const
+{
+    // length and stride of lines along this axis:
+    int len = numX_;
+    int stride = 1;
+    if( axis == 1 )
+    {
+        len = numY_;
+        stride = numX_;
+    }
+    else if( axis == 2 )
+    {
+        len = numZ_;
+        stride = numX_*numY_;
+    }
+    int numLines = numVoxels()/len;
+
+    #pragma omp parallel
+    {
+        // per-thread line buffers:
+        std::vector<real> f(len);
+        std::vector<real> d(len);
+        std::vector<int> v(len);
+        std::vector<double> z(len + 1);
+
+        #pragma omp for schedule(static)
+        for(int l = 0; l < numLines; l++)
+        {
+            // first voxel of this line:
+            int start = l*numX_;
+            if( axis == 1 )
+            {
+                start = l % numX_ + numX_*numY_*(l/numX_);
+            }
+            else if( axis == 2 )
+            {
+                start = l;
+            }
+
+            // transform line in buffer:
+            for(int p = 0; p < len; p++)
+            {
+                f[p] = dist[start + p*stride];
+            }
+            transformLine(f, d, v, z);
+            for(int p = 0; p < len; p++)
+            {
+                dist[start + p*stride] = d[p];
+            }
+        }
+    }
+}
+
+
+/*!
+ * One-dimensional squared distance transform of a sampled function f by 
+ * computing the lower envelope of the parabolas rooted at each sample. 
+ * Samples with infinite value do not contribute to the envelope. The 
+ * buffers v and z hold the envelope's parabola locations and the 
+ * boundaries between them.
+ */
+void
+DistanceTransform3D::transformLine(
+        const std::vector<real> &f,
+        std::vector<real> &d,
+        std::vector<int> &v,
+        std::vector<double> &z)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    int n = f.size();
+
+    // build lower envelope of parabolas:
+    int k = -1;
+    for(int q = 0; q < n; q++)
+    {
+        // unreached samples do not contribute:
+        if( f[q] == std::numeric_limits<real>::infinity() )
+        {
+            continue;
+        }
+
+        // first parabola extends over entire line:
+        if( k < 0 )
+        {
+            k = 0;
+            v[0] = q;
+            z[0] = -inf;
+            z[1] = inf;
+            continue;
+        }
+
+        // remove parabolas hidden by the new one:
+        // (terminates at the latest for k = 0, as z[0] is minus infinity)
+        double s;
+        while( true )
+        {
+            int r = v[k];
+            s = ((f[q] + static_cast<double>(q)*q) 
+              - (f[r] + static_cast<double>(r)*r))/(2.0*(q - r));
+            if( s > z[k] )
+            {
+                break;
+            }
+            k--;
+        }
+
+        // append new parabola:
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = inf;
+    }
+
+    // no finite sample on this line:
+    if( k < 0 )
+    {
+        for(int p = 0; p < n; p++)
+        {
+            d[p] = std::numeric_limits<real>::infinity();
+        }
+        return;
+    }
+
+    // evaluate lower envelope:
+    k = 0;
+    for(int p = 0; p < n; p++)
+    {
+        while( z[k + 1] < p )
+        {
+            k++;
+        }
+        d[p] = static_cast<real>(p - v[k])*(p - v[k]) + f[v[k]];
+    }
+}
@@ -0,0 +1,387 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "geometry/power_diagram_2D.hpp"
+
+
+/*!
+ * Constructs the power diagram of the given sites and weights, restricted to
+ * the rectangle spanned by lo and hi. Sites may lie outside the rectangle.
+ */
+PowerDiagram2D::PowerDiagram2D(
+        const std::vector<Point> &sites,
+        const std::vector<real> &weights,
+        const Point &lo,
+        const Point &hi)
+    : sites_(sites)
+    , weights_(weights)
+    , lo_(lo)
+    , hi_(hi)
+    , maxWeight_(-std::numeric_limits<real>::infinity())
+{
+    // sanity checks:
+    if( sites_.size() != weights_.size() )
+    {
+        throw std::logic_error("Number of weights does not match number of "
+                               "sites in power diagram.");
+    }
+    if( !(lo_[0] < hi_[0]) || !(lo_[1] < hi_[1]) )
+    {
+        throw std::logic_error("Bounding rectangle of power diagram has no "
+                               "area.");
+    }
+
+    if( sites_.empty() )
+    {
+        return;
+    }
+
+    // largest weight enters the clipping termination criterion:
+    maxWeight_ = *std::max_element(weights_.begin(), weights_.end());
+
+    // bin sites and construct each cell:
+    buildGrid();
+    cells_.resize(sites_.size());
+    std::vector<CellVertex> buffer;
+    buffer.reserve(16);
+    for(size_t i = 0; i < sites_.size(); i++)
+    {
+        constructCell(i, buffer);
+    }
+}
+
+
+/*!
+ * Returns the number of sites in the diagram.
+ */
+size_t
+PowerDiagram2D::numSites() const
+{
+    return sites_.size();
+}
+
+
+/*!
+ * Returns the vertices of the power cell of the i-th site in counterclockwise
+ * order. The cell is empty if the site is hidden by other sites or if its
+ * cell does not intersect the bounding rectangle.
+ */
+const std::vector<PowerDiagram2D::CellVertex>&
+PowerDiagram2D::cell(size_t i) const
+{
+    return cells_.at(i);
+}
+
+
+/*!
+ * Returns the power of point x with respect to the i-th site.
+ */
+real
+PowerDiagram2D::power(size_t i, const Point &x) const
+{
+    real dx = x[0] - sites_[i][0];
+    real dy = x[1] - sites_[i][1];
+    return dx*dx + dy*dy - weights_[i];
+}
+
+
+/*!
+ * Returns the index of the site in whose power cell the point x lies, i.e. 
+ * the site with respect to which x has the smallest power.
+ */
+size_t
+PowerDiagram2D::locate(const Point &x) const
+{
+    if( sites_.empty() )
+    {
+        throw std::logic_error("Can not locate point in empty power "
+                               "diagram.");
+    }
+
+    size_t idx = 0;
+    real minPower = power(0, x);
+    for(size_t i = 1; i < sites_.size(); i++)
+    {
+        real p = power(i, x);
+        if( p < minPower )
+        {
+            minPower = p;
+            idx = i;
+        }
+    }
+
+    return idx;
+}
+
+
+/*!
+ * Bins all sites on a uniform grid covering both the sites and the bounding
+ * rectangle. The grid spacing is chosen such that there are about two sites
+ * per grid cell on average.
+ */
+void
+PowerDiagram2D::buildGrid()
+{
+    // extent of grid:
+    Point gridHi = hi_;
+    gridLo_ = lo_;
+    for(auto &site : sites_)
+    {
+        for(int d = 0; d < 2; d++)
+        {
+            gridLo_[d] = std::min(gridLo_[d], site[d]);
+            gridHi[d] = std::max(gridHi[d], site[d]);
+        }
+    }
+    real area = (gridHi[0] - gridLo_[0])*(gridHi[1] - gridLo_[1]);
+    gridSpacing_ = std::sqrt(2.0*area/sites_.size());
+    gridNumX_ = static_cast<int>((gridHi[0] - gridLo_[0])/gridSpacing_) + 1;
+    gridNumY_ = static_cast<int>((gridHi[1] - gridLo_[1])/gridSpacing_) + 1;
+
+    // count sites per grid cell:
+    std::vector<size_t> siteCell(sites_.size());
+    gridOffsets_.assign(gridNumX_*gridNumY_ + 1, 0);
+    for(size_t i = 0; i < sites_.size(); i++)
+    {
+        int gx = gridIndex(sites_[i][0], gridLo_[0], gridNumX_);
+        int gy = gridIndex(sites_[i][1], gridLo_[1], gridNumY_);
+        siteCell[i] = gx*gridNumY_ + gy;
+        gridOffsets_[siteCell[i] + 1]++;
+    }
+    for(size_t c = 1; c < gridOffsets_.size(); c++)
+    {
+        gridOffsets_[c] += gridOffsets_[c - 1];
+    }
+
+    // sort sites into grid cells:
+    std::vector<size_t> fill(gridOffsets_.begin(), gridOffsets_.end() - 1);
+    gridSites_.resize(sites_.size());
+    for(size_t i = 0; i < sites_.size(); i++)
+    {
+        gridSites_[fill[siteCell[i]]++] = i;
+    }
+}
+
+
+/*!
+ * Constructs the power cell of the i-th site by clipping the bounding 
+ * rectangle with the half planes of neighbouring sites, which are visited in
+ * rings of grid cells around the site. A site at distance \f$ d \f$ can only 
+ * intersect the current cell if 
+ *
+ * \f[
+ *      d < R + \sqrt{R^2 - w_i + w_{max}}
+ * \f]
+ *
+ * where \f$ R \f$ is the largest distance of a cell vertex from the site. 
+ * Once the inner edge of a ring exceeds this distance, the cell is final.
+ */
+void
+PowerDiagram2D::constructCell(
+        size_t i,
+        std::vector<CellVertex> &buffer)
+{
+    // start from bounding rectangle (counterclockwise):
+    std::vector<CellVertex> &poly = cells_[i];
+    poly.clear();
+    poly.push_back({{lo_[0], lo_[1]}, eBoxLoX, eBoxLoY});
+    poly.push_back({{hi_[0], lo_[1]}, eBoxLoY, eBoxHiX});
+    poly.push_back({{hi_[0], hi_[1]}, eBoxHiX, eBoxHiY});
+    poly.push_back({{lo_[0], hi_[1]}, eBoxHiY, eBoxLoX});
+
+    // grid cell of this site:
+    const Point &p = sites_[i];
+    int ci = gridIndex(p[0], gridLo_[0], gridNumX_);
+    int cj = gridIndex(p[1], gridLo_[1], gridNumY_);
+
+    // visit rings of grid cells around site:
+    int maxRing = std::max(gridNumX_, gridNumY_);
+    for(int k = 0; k <= maxRing; k++)
+    {
+        // check if sites in this ring can still intersect the cell:
+        if( k >= 2 )
+        {
+            real rSq = 0.0;
+            for(auto &v : poly)
+            {
+                real dx = v.pos[0] - p[0];
+                real dy = v.pos[1] - p[1];
+                rSq = std::max(rSq, dx*dx + dy*dy);
+            }
+            real secRad = std::sqrt(rSq) 
+                        + std::sqrt(std::max<real>(
+                                0.0, rSq - weights_[i] + maxWeight_));
+            if( (k - 1)*gridSpacing_ > secRad )
+            {
+                return;
+            }
+        }
+
+        // loop over perimeter of ring:
+        for(int gx = ci - k; gx <= ci + k; gx++)
+        {
+            if( gx < 0 || gx >= gridNumX_ )
+            {
+                continue;
+            }
+            int step = (gx == ci - k || gx == ci + k) ? 1 : 2*k;
+            for(int gy = cj - k; gy <= cj + k; gy += step)
+            {
+                if( gy < 0 || gy >= gridNumY_ )
+                {
+                    continue;
+                }
+
+                size_t c = gx*gridNumY_ + gy;
+                for(size_t s = gridOffsets_[c]; s < gridOffsets_[c + 1]; s++)
+                {
+                    size_t j = gridSites_[s];
+                    if( j != i && !clipCell(i, j, poly, buffer) )
+                    {
+                        // cell is empty:
+                        poly.clear();
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/*!
+ * Clips the cell polygon of site i with the half plane in which the power
+ * with respect to site i does not exceed the power with respect to site j.
+ * Coordinates are taken relative to site i for numerical stability. Returns
+ * false if the clipped cell is empty. Coincident sites with equal weights are
+ * assigned to the site with the lower index.
+ */
+bool
+PowerDiagram2D::clipCell(
+        size_t i,
+        size_t j,
+        std::vector<CellVertex> &poly,
+        std::vector<CellVertex> &buffer) const
+{
+    // half plane is 2*(x - p_i)*d <= c:
+    real dx = sites_[j][0] - sites_[i][0];
+    real dy = sites_[j][1] - sites_[i][1];
+    real c = dx*dx + dy*dy - weights_[j] + weights_[i];
+
+    // coincident sites:
+    if( dx == 0.0 && dy == 0.0 )
+    {
+        return !( c < 0.0 || (c == 0.0 && j < i) );
+    }
+
+    // signed distance function (positive outside of half plane):
+    auto side = [&](const CellVertex &v)
+    {
+        return 2.0*((v.pos[0] - sites_[i][0])*dx 
+                  + (v.pos[1] - sites_[i][1])*dy) - c;
+    };
+
+    // quick checks for half plane containing or excluding cell:
+    real sMin = std::numeric_limits<real>::infinity();
+    real sMax = -std::numeric_limits<real>::infinity();
+    for(auto &v : poly)
+    {
+        real s = side(v);
+        sMin = std::min(sMin, s);
+        sMax = std::max(sMax, s);
+    }
+    if( sMax <= 0.0 )
+    {
+        return true;
+    }
+    if( sMin > 0.0 )
+    {
+        return false;
+    }
+
+    // Sutherland-Hodgman clipping that keeps track of edge generators:
+    buffer.clear();
+    size_t n = poly.size();
+    for(size_t k = 0; k < n; k++)
+    {
+        const CellVertex &cur = poly[k];
+        const CellVertex &nxt = poly[(k + 1) % n];
+        real sCur = side(cur);
+        real sNxt = side(nxt);
+        bool curIn = (sCur <= 0.0);
+        bool nxtIn = (sNxt <= 0.0);
+
+        if( curIn )
+        {
+            // vertex on clipping line from which cell continues along line:
+            buffer.push_back(cur);
+            if( sCur == 0.0 && !nxtIn )
+            {
+                buffer.back().nextGenerator = static_cast<int>(j);
+            }
+        }
+        if( (sCur < 0.0 && !nxtIn) || (!curIn && sNxt < 0.0) )
+        {
+            real t = sCur/(sCur - sNxt);
+            CellVertex isec;
+            isec.pos[0] = cur.pos[0] + t*(nxt.pos[0] - cur.pos[0]);
+            isec.pos[1] = cur.pos[1] + t*(nxt.pos[1] - cur.pos[1]);
+            isec.nextGenerator = curIn ? static_cast<int>(j) 
+                                       : cur.nextGenerator;
+            buffer.push_back(isec);
+        }
+    }
+
+    // degenerate polygons count as empty:
+    if( buffer.size() < 3 )
+    {
+        return false;
+    }
+
+    // update incoming edge generators:
+    for(size_t k = 0; k < buffer.size(); k++)
+    {
+        buffer[k].prevGenerator = 
+                buffer[(k + buffer.size() - 1) % buffer.size()].nextGenerator;
+    }
+    poly.swap(buffer);
+
+    return true;
+}
+
+
+/*!
+ * Returns the grid index of a coordinate, clamped to the grid range.
+ */
+int
+PowerDiagram2D::gridIndex(real x, real lo, int num) const
+{
+    int idx = static_cast<int>(std::floor((x - lo)/gridSpacing_));
+    return std::min(std::max(idx, 0), num - 1);
+}
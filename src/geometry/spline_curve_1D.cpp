@@ -22,10 +22,13 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-#include <functional>
+#include <limits>
+#include <stdexcept>
 
-#include <boost/math/tools/minima.hpp>
+#include <boost/math/tools/roots.hpp>
 
 #include "geometry/spline_curve_1D.hpp"
 
@@ -103,15 +106,26 @@ SplineCurve1D::evaluate(
 
 /*!
  * Public interface for evaluating the spline curve at mutliple points. Uses
- * constant extrapolation.
+ * constant extrapolation. If the evaluation points are sorted in ascending
+ * order (as is the case for all support point samples), this delegates to
+ * evaluateSorted().
  */
 std::vector<real>
 SplineCurve1D::evaluateMultiple(
         const std::vector<real> &eval, 
         unsigned int deriv)
 {
+    // fast path for sorted evaluation points:
+    if( hasPolynomialSpans() && std::is_sorted(eval.begin(), eval.end()) )
+    {
+        std::vector<std::vector<real>> values;
+        evaluateSorted(eval, deriv, values);
+        return std::move(values[deriv]);
+    }
+
     // evaluate spline at each point:
     std::vector<real> values;
+    values.reserve(eval.size());
     for(auto e : eval)
     {
         values.push_back( evaluate(e, deriv) );
@@ -121,6 +135,120 @@ SplineCurve1D::evaluateMultiple(
 }
 
 
+/*!
+ * Evaluates the spline curve and its derivatives up to order maxDeriv at a 
+ * set of evaluation points sorted in ascending order. On return, 
+ * values[k][i] holds the k-th derivative at eval[i]. The buffers are resized 
+ * as needed, so that repeated calls with the same number of points do not
+ * allocate memory.
+ *
+ * Rather than locating the knot span and evaluating the B-spline basis for
+ * each point separately, this walks the knot spans linearly alongside the 
+ * evaluation points and evaluates the local polynomial of each span with 
+ * Horner's scheme. The loop over the points in a span is free of branches and
+ * is vectorised across points. As in evaluate(), constant extrapolation is
+ * used outside the knot range. Requires a clamped knot vector and a degree of
+ * at most three.
+ */
+void
+SplineCurve1D::evaluateSorted(
+        const std::vector<real> &eval,
+        unsigned int maxDeriv,
+        std::vector<std::vector<real>> &values) const
+{
+    if( !hasPolynomialSpans() )
+    {
+        throw std::logic_error("Sorted evaluation requires a clamped spline "
+                               "of at most cubic degree.");
+    }
+    if( !std::is_sorted(eval.begin(), eval.end()) )
+    {
+        throw std::logic_error("Evaluation points must be sorted in "
+                               "ascending order.");
+    }
+
+    // prepare output buffers:
+    size_t numPoints = eval.size();
+    values.resize(maxDeriv + 1);
+    for(auto &v : values)
+    {
+        v.resize(numPoints);
+    }
+
+    // constant extrapolation below knot range:
+    size_t i = 0;
+    if( numPoints > 0 && eval.front() < knots_.front() )
+    {
+        real valueLo = boundaryValue(false);
+        for(; i < numPoints && eval[i] < knots_.front(); i++)
+        {
+            values[0][i] = valueLo;
+            for(unsigned int k = 1; k <= maxDeriv; k++)
+            {
+                values[k][i] = 0.0;
+            }
+        }
+    }
+
+    // walk knot spans alongside evaluation points:
+    int lastSpan = nKnots_ - degree_ - 2;
+    for(int j = degree_; j <= lastSpan && i < numPoints; j++)
+    {
+        // find points in this span (last span is closed on the right):
+        real b = knots_[j + 1];
+        size_t end = i;
+        while( end < numPoints && 
+               (eval[end] < b || (j == lastSpan && eval[end] == b)) )
+        {
+            end++;
+        }
+        
+        SpanPolynomial coefs;
+        if( end == i || !spanPolynomial(j, coefs) )
+        {
+            continue;
+        }
+
+        // evaluate polynomial and its derivatives:
+        const real a = knots_[j];
+        const real *x = eval.data();
+        for(unsigned int k = 0; k <= maxDeriv; k++)
+        {
+            real *out = values[k].data();
+            const SpanPolynomial c = coefs;
+            #pragma omp simd
+            for(size_t m = i; m < end; m++)
+            {
+                real u = x[m] - a;
+                real value = c[maxPolynomialDegree_];
+                for(int l = maxPolynomialDegree_ - 1; l >= 0; l--)
+                {
+                    value = value*u + c[l];
+                }
+                out[m] = value;
+            }
+            differentiatePolynomial(coefs);
+        }
+
+        i = end;
+    }
+
+    // constant extrapolation above knot range:
+    if( i < numPoints )
+    {
+        real valueHi = boundaryValue(true);
+        for(; i < numPoints; i++)
+        {
+            values[0][i] = valueHi;
+            for(unsigned int k = 1; k <= maxDeriv; k++)
+            {
+                values[k][i] = 0.0;
+            }
+        }
+    }
+}
+
+
 /*!
  * Helper function for evaluating the spline curve at points inside the range 
  * covered by the knot vector.
@@ -222,51 +350,408 @@ SplineCurve1D::length() const
 
 
 /*!
- * Returns a pair struct of argmin and min of function value.
+ * Returns a pair struct of argmin and min of function value over the interval
+ * given by lim.
+ *
+ * Since the spline is a piecewise polynomial, the minimum is found exactly by
+ * comparing the function value at the interval ends with its value at all
+ * roots of the first derivative inside each knot span. For cubic splines, the
+ * latter are simply the roots of a quadratic, so that the cost of this method
+ * is linear in the number of knots and no sampling is required. Outside the
+ * knot range the spline is constant (see evaluate()), hence the minimum is
+ * always attained at a point inside both lim and the knot range if these
+ * overlap.
+ */
+std::pair<real, real>
+SplineCurve1D::minimum(const std::pair<real, real> &lim) const
+{
+    return extremum(lim, false);
+}
+
+
+/*!
+ * Returns a pair struct of argmax and max of function value over the interval
+ * given by lim. See minimum() for details.
  */
 std::pair<real, real>
-SplineCurve1D::minimum(const std::pair<real, real> &lim)
+SplineCurve1D::maximum(const std::pair<real, real> &lim) const
+{
+    return extremum(lim, true);
+}
+
+
+/*!
+ * Returns the integral of the squared spline function over the interval given
+ * by lim, i.e.
+ *
+ *  \f[
+ *
+ *      I = \int_{s_0}^{s_1} \left( f(s) \right)^2 ds
+ *
+ *  \f]
+ *
+ * The integrand is a polynomial of degree \f$ 2d \f$ on each knot span and is
+ * integrated analytically, so that the result is exact irrespective of the
+ * spacing of the knots. Parts of the interval outside the knot range are 
+ * accounted for by the constant extrapolation used in evaluate().
+ */
+real
+SplineCurve1D::integrateSquared(const std::pair<real, real> &lim) const
+{
+    if( lim.first > lim.second )
+    {
+        throw std::logic_error("Lower integration limit exceeds upper "
+                               "integration limit.");
+    }
+
+    real integral = 0.0;
+
+    // loop over knot spans:
+    for(int j = degree_; j < nKnots_ - degree_ - 1; j++)
+    {
+        // intersection of span and integration interval in local coordinates:
+        real a = knots_[j];
+        real uLo = std::max(lim.first, a) - a;
+        real uHi = std::min(lim.second, knots_[j + 1]) - a;
+        if( uLo >= uHi )
+        {
+            continue;
+        }
+
+        SpanPolynomial coefs;
+        if( !spanPolynomial(j, coefs) )
+        {
+            continue;
+        }
+
+        // coefficients of squared polynomial:
+        std::array<real, 2*maxPolynomialDegree_ + 1> sqCoefs;
+        sqCoefs.fill(0.0);
+        for(int k = 0; k <= degree_; k++)
+        {
+            for(int l = 0; l <= degree_; l++)
+            {
+                sqCoefs[k + l] += coefs[k]*coefs[l];
+            }
+        }
+
+        // integrate term by term:
+        real powLo = uLo;
+        real powHi = uHi;
+        for(int k = 0; k <= 2*degree_; k++)
+        {
+            integral += sqCoefs[k]*(powHi - powLo)/(k + 1);
+            powLo *= uLo;
+            powHi *= uHi;
+        }
+    }
+
+    // contributions from constant extrapolation beyond the knot range:
+    real domLo = knots_[degree_];
+    real domHi = knots_[nKnots_ - degree_ - 1];
+    if( lim.first < domLo )
+    {
+        real value = boundaryValue(false);
+        integral += value*value*(std::min(lim.second, domLo) - lim.first);
+    }
+    if( lim.second > domHi )
+    {
+        real value = boundaryValue(true);
+        integral += value*value*(lim.second - std::max(lim.first, domHi));
+    }
+
+    return integral;
+}
+
+
+/*!
+ * Returns all points inside the interval given by lim at which the spline
+ * takes on the given level in ascending order.
+ *
+ * Each knot span is split into monotonic pieces at the roots of the first
+ * derivative and roots are bracketed on each piece with a sign change, which
+ * guarantees that no root is missed. The bracketed roots are then refined with
+ * the TOMS 748 algorithm. Only the range covered by the knot vector is 
+ * searched, as the spline is constant outside of it.
+ */
+std::vector<real>
+SplineCurve1D::roots(
+        const std::pair<real, real> &lim,
+        real level) const
 {
     // internal parameters:
-    real maxSampleDist = 0.1;
     boost::uintmax_t maxIter = 100;
+    boost::math::tools::eps_tolerance<real> tol(
+            std::numeric_limits<real>::digits - 4);
 
-    // draw sample of values and find minimum:
-    real length = lim.second - lim.first;
-    int nSamples = std::ceil(length/maxSampleDist);
-    real sampleDist = length/nSamples;
-    std::vector<real> par;
-    std::vector<real> val;
-    for(int i = 0; i < nSamples; i++)
+    std::vector<real> roots;
+    for(int j = degree_; j < nKnots_ - degree_ - 1; j++)
     {
-        par.push_back( lim.first + i*sampleDist );
-        val.push_back( evaluate(par.back(), 0) );
+        // intersection of span and search interval in local coordinates:
+        real a = knots_[j];
+        real uLo = std::max(lim.first, a) - a;
+        real uHi = std::min(lim.second, knots_[j + 1]) - a;
+        if( uLo > uHi )
+        {
+            continue;
+        }
+
+        SpanPolynomial coefs;
+        if( !spanPolynomial(j, coefs) )
+        {
+            continue;
+        }
+        coefs[0] -= level;
+
+        // split span into monotonic pieces:
+        std::array<real, 2> crit;
+        int numCrit = criticalPoints(coefs, uLo, uHi, crit);
+        std::array<real, 4> bounds;
+        bounds[0] = uLo;
+        for(int k = 0; k < numCrit; k++)
+        {
+            bounds[k + 1] = crit[k];
+        }
+        bounds[numCrit + 1] = uHi;
+
+        // find root on each piece:
+        auto poly = [&](real u){ return evaluatePolynomial(coefs, u); };
+        for(int k = 0; k <= numCrit; k++)
+        {
+            real u0 = bounds[k];
+            real u1 = bounds[k + 1];
+            real f0 = poly(u0);
+            real f1 = poly(u1);
+
+            std::vector<real> pieceRoots;
+            if( f0 == 0.0 )
+            {
+                pieceRoots.push_back(a + u0);
+            }
+            if( f0*f1 < 0.0 )
+            {
+                boost::uintmax_t numIter = maxIter;
+                std::pair<real, real> bracket;
+                bracket = boost::math::tools::toms748_solve(
+                        poly, u0, u1, f0, f1, tol, numIter);
+                pieceRoots.push_back(a + 0.5*(bracket.first + bracket.second));
+            }
+            if( f1 == 0.0 )
+            {
+                pieceRoots.push_back(a + u1);
+            }
+
+            // roots at shared piece boundaries are only reported once:
+            for(auto r : pieceRoots)
+            {
+                if( roots.empty() || r != roots.back() )
+                {
+                    roots.push_back(r);
+                }
+            }
+        }
+    }
+
+    return roots;
+}
+
+
+/*!
+ * Auxiliary function that computes the coefficients of the polynomial that
+ * the spline reduces to on the knot span with the given index, expanded about
+ * the left knot of the span (see AbstractSplineCurve::powerBasisCoefs()). 
+ * Returns false if the span has zero length.
+ */
+bool
+SplineCurve1D::spanPolynomial(int span, SpanPolynomial &coefs) const
+{
+    SpanPolynomial ctrl;
+    ctrl.fill(0.0);
+    for(int i = 0; i <= degree_ && i <= maxPolynomialDegree_; i++)
+    {
+        ctrl[i] = ctrlPoints_[span - degree_ + i];
+    }
+
+    return powerBasisCoefs(span, ctrl, coefs);
+}
+
+
+/*!
+ * Auxiliary function returning the spline value at the lower or upper end of
+ * the knot range, i.e. the value used in constant extrapolation.
+ */
+real
+SplineCurve1D::boundaryValue(bool upper) const
+{
+    SpanPolynomial coefs;
+    if( upper )
+    {
+        for(int j = nKnots_ - degree_ - 2; j >= degree_; j--)
+        {
+            if( spanPolynomial(j, coefs) )
+            {
+                return evaluatePolynomial(coefs, knots_[j + 1] - knots_[j]);
+            }
+        }
+    }
+    else
+    {
+        for(int j = degree_; j < nKnots_ - degree_ - 1; j++)
+        {
+            if( spanPolynomial(j, coefs) )
+            {
+                return coefs[0];
+            }
+        }
+    }
+
+    throw std::logic_error("Spline has no knot span of nonzero length.");
+}
+
+
+/*!
+ * Auxiliary function for finding the minimum or maximum of the spline over a
+ * given interval. See minimum() for details.
+ */
+std::pair<real, real>
+SplineCurve1D::extremum(
+        const std::pair<real, real> &lim,
+        bool findMaximum) const
+{
+    if( lim.first > lim.second )
+    {
+        throw std::logic_error("Lower interval limit exceeds upper interval "
+                               "limit.");
+    }
+
+    // minimise the negative function when looking for a maximum:
+    real sign = findMaximum ? -1.0 : 1.0;
+
+    bool found = false;
+    std::pair<real, real> best(lim.first, 0.0);
+    for(int j = degree_; j < nKnots_ - degree_ - 1; j++)
+    {
+        // intersection of span and search interval in local coordinates:
+        real a = knots_[j];
+        real uLo = std::max(lim.first, a) - a;
+        real uHi = std::min(lim.second, knots_[j + 1]) - a;
+        if( uLo > uHi )
+        {
+            continue;
+        }
+
+        SpanPolynomial coefs;
+        if( !spanPolynomial(j, coefs) )
+        {
+            continue;
+        }
+
+        // candidates are interval ends and critical points:
+        std::array<real, 4> cand;
+        std::array<real, 2> crit;
+        int numCrit = criticalPoints(coefs, uLo, uHi, crit);
+        cand[0] = uLo;
+        cand[1] = uHi;
+        for(int k = 0; k < numCrit; k++)
+        {
+            cand[k + 2] = crit[k];
+        }
+
+        for(int k = 0; k < numCrit + 2; k++)
+        {
+            real value = evaluatePolynomial(coefs, cand[k]);
+            if( !found || sign*value < sign*best.second )
+            {
+                best = std::make_pair(a + cand[k], value);
+                found = true;
+            }
+        }
+    }
+
+    // interval lies entirely in the constant extrapolation region:
+    if( !found )
+    {
+        best.second = boundaryValue(lim.first > knots_[degree_]);
+    }
+
+    return best;
+}
+
+
+/*!
+ * Auxiliary function that finds the roots of the derivative of a span 
+ * polynomial in the open interval (uLo, uHi). As the polynomial is at most 
+ * cubic, this only requires solving a quadratic equation, which is done in a
+ * numerically stable manner. Returns the number of roots written to crit in
+ * ascending order.
+ */
+int
+SplineCurve1D::criticalPoints(
+        const SpanPolynomial &coefs,
+        real uLo,
+        real uHi,
+        std::array<real, 2> &crit) const
+{
+    // derivative is A*u^2 + B*u + C:
+    real A = 3.0*coefs[3];
+    real B = 2.0*coefs[2];
+    real C = coefs[1];
+
+    std::array<real, 2> cand;
+    int numCand = 0;
+    if( A == 0.0 )
+    {
+        if( B != 0.0 )
+        {
+            cand[numCand++] = -C/B;
+        }
+    }
+    else
+    {
+        real disc = B*B - 4.0*A*C;
+        if( disc >= 0.0 )
+        {
+            real q = -0.5*(B + std::copysign(std::sqrt(disc), B));
+            cand[numCand++] = q/A;
+            if( q != 0.0 )
+            {
+                cand[numCand++] = C/q;
+            }
+        }
     }
- 
-    // find smallest sample radius:
-    auto itMin = std::min_element(val.begin(), val.end());
-    int idxMin = std::distance(val.begin(), itMin);
 
-    // determine bracketing interval:
-    real sMin = par[idxMin - 1];
-    real sMax = par[idxMin + 1];
-    if( itMin == val.begin() )
+    // keep roots inside interval in ascending order:
+    if( numCand == 2 && cand[1] < cand[0] )
     {
-        sMin = par[idxMin];
-        sMax = par[idxMin + 1];
+        std::swap(cand[0], cand[1]);
     }
-    else if( itMin == val.end() )
+    int numCrit = 0;
+    for(int k = 0; k < numCand; k++)
     {
-        sMin = par[idxMin - 1];
-        sMax = par[idxMin];
+        if( cand[k] > uLo && cand[k] < uHi )
+        {
+            crit[numCrit++] = cand[k];
+        }
     }
 
-    // find exact location of minimum through Brent's method:
-    return boost::math::tools::brent_find_minima(
-            std::bind(&SplineCurve1D::evaluate, this, std::placeholders::_1, 0),
-            sMin,
-            sMax,
-            std::numeric_limits<real>::digits,
-            maxIter);    
+    return numCrit;
 }
 
+
+/*!
+ * Evaluates a span polynomial at the given local coordinate using Horner's
+ * scheme.
+ */
+real
+SplineCurve1D::evaluatePolynomial(
+        const SpanPolynomial &coefs,
+        real u) const
+{
+    real value = coefs[maxPolynomialDegree_];
+    for(int k = maxPolynomialDegree_ - 1; k >= 0; k--)
+    {
+        value = value*u + coefs[k];
+    }
+
+    return value;
+}
@@ -23,7 +23,9 @@
 
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <stdexcept>
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
@@ -109,6 +111,177 @@ SplineCurve3D::evaluate(
 }
 
 
+/*!
+ * Public interface for evaluating the spline curve at multiple points. Uses
+ * linear extrapolation. If the evaluation points are sorted in ascending 
+ * order (as is the case for all samples along the centre line), this 
+ * delegates to evaluateSorted().
+ */
+std::vector<gmx::RVec>
+SplineCurve3D::evaluateMultiple(
+        const std::vector<real> &eval,
+        unsigned int deriv)
+{
+    // fast path for sorted evaluation points:
+    if( hasPolynomialSpans() && std::is_sorted(eval.begin(), eval.end()) )
+    {
+        std::vector<std::vector<gmx::RVec>> values;
+        evaluateSorted(eval, deriv, values);
+        return std::move(values[deriv]);
+    }
+
+    // evaluate spline at each point:
+    std::vector<gmx::RVec> values;
+    values.reserve(eval.size());
+    for(auto e : eval)
+    {
+        values.push_back( evaluate(e, deriv) );
+    }
+
+    return values;
+}
+
+
+/*!
+ * Evaluates the spline curve and its derivatives up to order maxDeriv at a 
+ * set of evaluation points sorted in ascending order. On return, 
+ * values[k][i] holds the k-th derivative at eval[i]. The buffers are resized 
+ * as needed, so that repeated calls with the same number of points do not
+ * allocate memory.
+ *
+ * This walks the knot spans linearly alongside the evaluation points and 
+ * evaluates the local polynomial of each span and dimension with Horner's 
+ * scheme in a branch free loop that is vectorised across points. As in 
+ * evaluate(), linear extrapolation is used outside the knot range. Requires a
+ * clamped knot vector and a degree of at most three.
+ */
+void
+SplineCurve3D::evaluateSorted(
+        const std::vector<real> &eval,
+        unsigned int maxDeriv,
+        std::vector<std::vector<gmx::RVec>> &values) const
+{
+    if( !hasPolynomialSpans() )
+    {
+        throw std::logic_error("Sorted evaluation requires a clamped spline "
+                               "of at most cubic degree.");
+    }
+    if( !std::is_sorted(eval.begin(), eval.end()) )
+    {
+        throw std::logic_error("Evaluation points must be sorted in "
+                               "ascending order.");
+    }
+
+    // prepare output buffers:
+    size_t numPoints = eval.size();
+    values.resize(maxDeriv + 1);
+    for(auto &v : values)
+    {
+        v.resize(numPoints);
+    }
+
+    // linear extrapolation from given boundary:
+    auto extrapolate = [&](size_t m, real boundary, 
+                           const std::array<SpanPolynomial, DIM> &coefs, 
+                           real u)
+    {
+        for(int d = 0; d < DIM; d++)
+        {
+            real offset = ((coefs[d][3]*u + coefs[d][2])*u + coefs[d][1])*u 
+                        + coefs[d][0];
+            real slope = (3.0*coefs[d][3]*u + 2.0*coefs[d][2])*u 
+                       + coefs[d][1];
+            values[0][m][d] = offset + (eval[m] - boundary)*slope;
+            if( maxDeriv >= 1 )
+            {
+                values[1][m][d] = slope;
+            }
+            for(unsigned int k = 2; k <= maxDeriv; k++)
+            {
+                values[k][m][d] = 0.0;
+            }
+        }
+    };
+
+    // extrapolation below knot range:
+    size_t i = 0;
+    if( numPoints > 0 && eval.front() < knots_.front() )
+    {
+        std::array<SpanPolynomial, DIM> coefs;
+        int j = degree_;
+        while( !spanPolynomials(j, coefs) )
+        {
+            j++;
+        }
+        for(; i < numPoints && eval[i] < knots_.front(); i++)
+        {
+            extrapolate(i, knots_.front(), coefs, 0.0);
+        }
+    }
+
+    // walk knot spans alongside evaluation points:
+    int lastSpan = nKnots_ - degree_ - 2;
+    for(int j = degree_; j <= lastSpan && i < numPoints; j++)
+    {
+        // find points in this span (last span is closed on the right):
+        real b = knots_[j + 1];
+        size_t end = i;
+        while( end < numPoints && 
+               (eval[end] < b || (j == lastSpan && eval[end] == b)) )
+        {
+            end++;
+        }
+
+        std::array<SpanPolynomial, DIM> coefs;
+        if( end == i || !spanPolynomials(j, coefs) )
+        {
+            continue;
+        }
+
+        // evaluate polynomial and its derivatives in each dimension:
+        const real a = knots_[j];
+        const real *x = eval.data();
+        for(unsigned int k = 0; k <= maxDeriv; k++)
+        {
+            gmx::RVec *out = values[k].data();
+            for(int d = 0; d < DIM; d++)
+            {
+                const SpanPolynomial c = coefs[d];
+                #pragma omp simd
+                for(size_t m = i; m < end; m++)
+                {
+                    real u = x[m] - a;
+                    real value = c[maxPolynomialDegree_];
+                    for(int l = maxPolynomialDegree_ - 1; l >= 0; l--)
+                    {
+                        value = value*u + c[l];
+                    }
+                    out[m][d] = value;
+                }
+                differentiatePolynomial(coefs[d]);
+            }
+        }
+
+        i = end;
+    }
+
+    // extrapolation above knot range:
+    if( i < numPoints )
+    {
+        std::array<SpanPolynomial, DIM> coefs;
+        int j = lastSpan;
+        while( !spanPolynomials(j, coefs) )
+        {
+            j--;
+        }
+        for(; i < numPoints; i++)
+        {
+            extrapolate(i, knots_.back(), coefs, knots_[j + 1] - knots_[j]);
+        }
+    }
+}
+
+
 /*!
  * Auxiliary function for evaluating the spline curve at points inside the 
  * range covered by knots.
@@ -211,6 +384,35 @@ SplineCurve3D::computeLinearCombination(const SparseBasis &basis)
 }
 
 
+/*!
+ * Auxiliary function that computes the coefficients of the polynomials that
+ * each component of the curve reduces to on the given knot span (see
+ * AbstractSplineCurve::powerBasisCoefs()). Returns false if the span has zero
+ * length.
+ */
+bool
+SplineCurve3D::spanPolynomials(
+        int span,
+        std::array<SpanPolynomial, DIM> &coefs) const
+{
+    for(int d = 0; d < DIM; d++)
+    {
+        SpanPolynomial ctrl;
+        ctrl.fill(0.0);
+        for(int i = 0; i <= degree_ && i <= maxPolynomialDegree_; i++)
+        {
+            ctrl[i] = ctrlPoints_[span - degree_ + i][d];
+        }
+        if( !powerBasisCoefs(span, ctrl, coefs[d]) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
 
 /*!
  * Change the internal representation of the curve such that it is 
@@ -361,15 +563,20 @@ SplineCurve3D::speed(const real &eval)
  *
  *      [0] - distance along the arc of the curve
  *      [1] - squared (!) distance from the curve at closest point
- *      [2] - angular coordinate; this is not yet implemented
+ *      [2] - angular coordinate in the interval \f$ [-\pi, \pi) \f$
+ *
+ * The angular coordinate is measured in the plane normal to the curve at the
+ * closest point, see angularCoordinate(). As this requires two additional 
+ * spline evaluations, it is only computed if the angular flag is set and is
+ * zero otherwise.
  *
  * Note that this function assumes that the curve is parameterised by arc 
  * length!
- *
- * \todo implement angular coordinate!
  */
 gmx::RVec 
-SplineCurve3D::cartesianToCurvilinear(const gmx::RVec &cartPoint)
+SplineCurve3D::cartesianToCurvilinear(
+        const gmx::RVec &cartPoint,
+        bool angular)
 {
     // find index of interval containing closest point on spline curve:
     unsigned int idx = closestSplinePoint(cartPoint);
@@ -421,14 +628,72 @@ SplineCurve3D::cartesianToCurvilinear(const gmx::RVec &cartPoint)
         proj = altProj;
     }
   
-    // TODO: calculate angular coordinate!
-    proj[PP] = 0.0;
+    // calculate angular coordinate only if requested:
+    proj[PP] = angular ? angularCoordinate(cartPoint, proj[SS]) : 0.0;
 
     // return point in curvilinear coordinates:
     return proj;
 }
 
 
+/*!
+ * Auxiliary function that computes the angle of a point around the curve at
+ * the given arc length. The angle is measured in the plane normal to the 
+ * curve tangent from a reference direction, which is obtained by projecting
+ * the Cartesian axis least aligned with the overall direction of the curve 
+ * (i.e. the vector from its first to its last control point) onto this 
+ * plane. For a pore aligned with the z-axis, the angle is thus measured from
+ * the x-axis. Points on the curve itself have an angular coordinate of zero.
+ */
+real
+SplineCurve3D::angularCoordinate(
+        const gmx::RVec &cartPoint,
+        real arcLength)
+{
+    // unit tangent and displacement from curve:
+    gmx::RVec tangent = evaluate(arcLength, 1);
+    unitv(tangent, tangent);
+    gmx::RVec disp;
+    rvec_sub(cartPoint, evaluate(arcLength, 0), disp);
+
+    // reference axis least aligned with overall curve direction:
+    gmx::RVec dir;
+    rvec_sub(ctrlPoints_.back(), ctrlPoints_.front(), dir);
+    int refDim = XX;
+    for(int i = YY; i <= ZZ; i++)
+    {
+        if( std::abs(dir[i]) < std::abs(dir[refDim]) )
+        {
+            refDim = i;
+        }
+    }
+
+    // project reference axis onto normal plane:
+    gmx::RVec normal(0.0, 0.0, 0.0);
+    normal[refDim] = 1.0;
+    real proj = iprod(normal, tangent);
+    for(int i = XX; i <= ZZ; i++)
+    {
+        normal[i] -= proj*tangent[i];
+    }
+    if( norm2(normal) < std::numeric_limits<real>::epsilon() )
+    {
+        return 0.0;
+    }
+    unitv(normal, normal);
+    gmx::RVec binormal;
+    cprod(tangent, normal, binormal);
+
+    // angle in normal plane:
+    real phi = std::atan2(iprod(disp, binormal), iprod(disp, normal));
+    if( phi >= M_PI )
+    {
+        phi -= 2.0*M_PI;
+    }
+    return phi;
+}
+
+
 /*!
  * Auxiliary function for finding the closest point on a spline curve that 
  * returns the corresponding spline interval index. First, a set of reference
@@ -23,6 +23,9 @@
 
 
 #include <cmath>
+#include <stdexcept>
+
+#include <unistd.h>
 
 #include "gromacs/analysisdata/dataframe.h"
 
@@ -50,18 +53,72 @@ AnalysisDataJsonFrameExporter::flags() const
  * file already exists, its content will be deleted, otherwise the file will be
  * created empty. The file stream is closed before the end of this function and
  * will be reopened for each individual frame.
+ *
+ * If a resume line count has been set, the first lines of the existing file
+ * are retained instead by truncating the file after them, and new frames are
+ * appended. An exception is thrown if the file contains fewer lines (or, if a
+ * resume byte offset has been set, fewer bytes) than expected.
  */
 void
 AnalysisDataJsonFrameExporter::dataStarted(
         gmx::AbstractAnalysisData* /* data */)
 {
-    // open file and overwrite if it already exists:
-    file_.open(fileName_.c_str(), std::fstream::out);
-
-    // TODO: header?
+    // no frames retained, open file and overwrite if it already exists:
+    if( resumeLineCount_ == 0 )
+    {
+        file_.open(fileName_.c_str(), std::fstream::out);
+        file_.close();
+        fileSize_ = 0;
+        return;
+    }
 
-    // close file:
+    // find end of lines to be retained from previous run:
+    file_.open(fileName_.c_str(), std::fstream::in | std::fstream::binary);
+    if( resumeByteOffsetIsSet_ )
+    {
+        // offset must lie within file and directly follow a line break:
+        char lastChar = 0;
+        if( resumeByteOffset_ > 0 )
+        {
+            file_.seekg(resumeByteOffset_ - 1);
+            file_.get(lastChar);
+        }
+        if( !file_.good() || lastChar != '\n' )
+        {
+            file_.close();
+            throw std::runtime_error("Can not resume from file " + fileName_ +
+                                     ", which is shorter than recorded in "
+                                     "checkpoint.");
+        }
+        fileSize_ = resumeByteOffset_;
+    }
+    else
+    {
+        // scan file for line breaks (without keeping its content):
+        size_t numLines = 0;
+        fileSize_ = 0;
+        std::string line;
+        while( numLines < resumeLineCount_ && std::getline(file_, line) )
+        {
+            numLines++;
+            fileSize_ += line.size() + 1;
+        }
+        if( numLines != resumeLineCount_ || file_.eof() )
+        {
+            file_.close();
+            throw std::runtime_error("Can not resume from file " + fileName_ +
+                                     ", which contains fewer frames than "
+                                     "recorded in checkpoint.");
+        }
+    }
     file_.close();
+
+    // discard frames written after checkpoint (new frames are appended):
+    if( truncate(fileName_.c_str(), static_cast<off_t>(fileSize_)) != 0 )
+    {
+        throw std::runtime_error("Could not truncate file " + fileName_ + 
+                                 " for resuming.");
+    }
 }
 
 
@@ -75,6 +132,9 @@ void
 AnalysisDataJsonFrameExporter::frameStarted(
         const gmx::AnalysisDataFrameHeader &frame)
 {   
+    // no points added to this frame yet:
+    frameHasPoints_ = false;
+
     // calling setObject will call destructor and deallocate data:
     json_.SetObject();
     rapidjson::Document::AllocatorType& allocator = json_.GetAllocator();
@@ -88,12 +148,18 @@ AnalysisDataJsonFrameExporter::frameStarted(
     // add object for each data set:
     for(auto it = dataSetNames_.begin(); it != dataSetNames_.end(); it++)
     {
+        // skip data sets excluded from output:
+        int colIdx = std::distance(dataSetNames_.begin(), it);
+        if( !dataSetIsEnabled(colIdx) )
+        {
+            continue;
+        }
+
         // create an empty dataset object to be filled when points are added:
         rapidjson::Value dataSet;
         dataSet.SetObject();
 
         // loop over column names and add arrays for each column:
-        int colIdx = std::distance(dataSetNames_.begin(), it);
         for(auto colName : columnNames_[colIdx])
         {
             // prepare array for column:
@@ -124,17 +190,30 @@ void
 AnalysisDataJsonFrameExporter::pointsAdded(
         const gmx::AnalysisDataPointSetRef &points)
 {
+    // ignore data sets not handled by this exporter:
+    if( points.dataSetIndex() < static_cast<int>(dataSetOffset_) ||
+        points.dataSetIndex() >= static_cast<int>(dataSetOffset_ + dataSetNames_.size()) )
+    {
+        return;
+    }
+    size_t dataSetIdx = points.dataSetIndex() - dataSetOffset_;
+    if( !dataSetIsEnabled(dataSetIdx) )
+    {
+        return;
+    }
+    frameHasPoints_ = true;
+
     // create an allocator:
     rapidjson::Document::AllocatorType& allocator = json_.GetAllocator();
 
     // obtain name of data set:
-    std::string dataSetName = dataSetNames_.at(points.dataSetIndex());    
+    std::string dataSetName = dataSetNames_.at(dataSetIdx);    
 
     // loop over all columns:
     for(size_t i = 0; i < points.values().size(); i++)
     {
         // obtain name of column:
-        std::string columnName = columnNames_.at(points.dataSetIndex()).at(i);
+        std::string columnName = columnNames_.at(dataSetIdx).at(i);
 
         // sanity check:
         if( std::isnan( points.values().at(i).value() ) )
@@ -168,6 +247,12 @@ void
 AnalysisDataJsonFrameExporter::frameFinished(
         const gmx::AnalysisDataFrameHeader& /*frame*/)
 {
+    // frames without data for this exporter are not written:
+    if( !frameHasPoints_ )
+    {
+        return;
+    }
+
     // open output file separately for each frame:
     file_.open(fileName_.c_str(), std::fstream::app);
 
@@ -179,6 +264,7 @@ AnalysisDataJsonFrameExporter::frameFinished(
     // stringify JSON document and add it to file as new line:
     std::string jsonLine(buffer.GetString(), buffer.GetSize());
     file_<<jsonLine<<std::endl;
+    fileSize_ += jsonLine.size() + 1;
 
     // TODO: should probably check if write was successful
 
@@ -234,3 +320,82 @@ AnalysisDataJsonFrameExporter::setColumnNames(
     columnNames_ = columnNames;
 }
 
+
+/*!
+ * Sets the index of the first data set handled by this exporter. The data 
+ * sets named in setDataSetNames() are taken to be the ones starting at this 
+ * index. Defaults to zero.
+ */
+void
+AnalysisDataJsonFrameExporter::setDataSetOffset(
+        size_t offset)
+{
+    dataSetOffset_ = offset;
+}
+
+
+/*!
+ * Sets the number of lines of an existing file that are retained when data 
+ * export starts. Defaults to zero, in which case any existing file is 
+ * overwritten.
+ */
+void
+AnalysisDataJsonFrameExporter::setResumeLineCount(
+        size_t numLines)
+{
+    resumeLineCount_ = numLines;
+}
+
+
+/*!
+ * Sets the size in bytes of the part of an existing file that is retained 
+ * when data export starts, i.e. the value of fileSize() at the time the 
+ * retained frames were checkpointed. Only used if a resume line count has
+ * been set as well.
+ */
+void
+AnalysisDataJsonFrameExporter::setResumeByteOffset(
+        uint64_t numBytes)
+{
+    resumeByteOffset_ = numBytes;
+    resumeByteOffsetIsSet_ = true;
+}
+
+
+/*!
+ * Returns the number of bytes in the output file, including any frames 
+ * retained from a previous run.
+ */
+uint64_t
+AnalysisDataJsonFrameExporter::fileSize() const
+{
+    return fileSize_;
+}
+
+
+/*!
+ * Sets which of the data sets named in setDataSetNames() are written to the
+ * output file. Data sets for which the mask is false are omitted from the 
+ * JSON object of each frame. An empty mask (the default) enables all data 
+ * sets.
+ */
+void
+AnalysisDataJsonFrameExporter::setDataSetMask(
+        const std::vector<bool> &dataSetMask)
+{
+    dataSetMask_ = dataSetMask;
+}
+
+
+/*!
+ * Returns true if the data set with the given index (relative to the data set
+ * offset) is to be written to the output file.
+ */
+bool
+AnalysisDataJsonFrameExporter::dataSetIsEnabled(
+        size_t dataSetIdx) const
+{
+    return dataSetMask_.empty() || 
+           ( dataSetIdx < dataSetMask_.size() && dataSetMask_[dataSetIdx] );
+}
+
@@ -0,0 +1,397 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+#include "io/buffered_text_writer.hpp"
+
+
+/*!
+ * Constructor. The buffer size determines how many characters are collected
+ * before they are written to the file and the precision sets the number of 
+ * significant digits used for floating point numbers (at most 15).
+ */
+BufferedTextWriter::BufferedTextWriter(
+        size_t bufferSize,
+        int precision)
+    : bufferSize_(bufferSize)
+    , precision_(std::max(1, std::min(precision, 15)))
+{
+    buffer_.reserve(bufferSize_ + 256);
+}
+
+
+/*!
+ * Destructor writes any remaining buffered output.
+ */
+BufferedTextWriter::~BufferedTextWriter()
+{
+    if( file_.is_open() )
+    {
+        flush();
+        file_.close();
+    }
+}
+
+
+/*!
+ * Opens the file of the given name for writing. An existing file is 
+ * overwritten.
+ */
+void
+BufferedTextWriter::open(const std::string &fileName)
+{
+    fileName_ = fileName;
+    buffer_.clear();
+    file_.open(fileName.c_str(), std::ofstream::out | std::ofstream::binary);
+    if( !file_.is_open() )
+    {
+        throw std::runtime_error("Could not open file " + fileName + 
+                                 " for writing.");
+    }
+}
+
+
+/*!
+ * Writes any remaining buffered output and closes the file.
+ */
+void
+BufferedTextWriter::close()
+{
+    flush();
+    file_.close();
+    if( file_.fail() )
+    {
+        throw std::runtime_error("Could not write file " + fileName_ + ".");
+    }
+}
+
+
+/*!
+ * Appends a single character.
+ */
+BufferedTextWriter&
+BufferedTextWriter::operator<<(char c)
+{
+    buffer_.push_back(c);
+    if( buffer_.size() >= bufferSize_ )
+    {
+        flush();
+    }
+    return *this;
+}
+
+
+/*!
+ * Appends a null-terminated string.
+ */
+BufferedTextWriter&
+BufferedTextWriter::operator<<(const char *str)
+{
+    buffer_.append(str);
+    if( buffer_.size() >= bufferSize_ )
+    {
+        flush();
+    }
+    return *this;
+}
+
+
+/*!
+ * Appends a string.
+ */
+BufferedTextWriter&
+BufferedTextWriter::operator<<(const std::string &str)
+{
+    buffer_.append(str);
+    if( buffer_.size() >= bufferSize_ )
+    {
+        flush();
+    }
+    return *this;
+}
+
+
+/*!
+ * Appends a signed integer in decimal notation.
+ */
+BufferedTextWriter&
+BufferedTextWriter::operator<<(int value)
+{
+    return *this<<static_cast<long>(value);
+}
+
+
+/*!
+ * Appends a signed integer in decimal notation.
+ */
+BufferedTextWriter&
+BufferedTextWriter::operator<<(long value)
+{
+    if( value < 0 )
+    {
+        buffer_.push_back('-');
+        writeUnsigned(0UL - static_cast<unsigned long>(value));
+    }
+    else
+    {
+        writeUnsigned(static_cast<unsigned long>(value));
+    }
+    return *this;
+}
+
+
+/*!
+ * Appends an unsigned integer in decimal notation.
+ */
+BufferedTextWriter&
+BufferedTextWriter::operator<<(unsigned int value)
+{
+    writeUnsigned(value);
+    return *this;
+}
+
+
+/*!
+ * Appends an unsigned integer in decimal notation.
+ */
+BufferedTextWriter&
+BufferedTextWriter::operator<<(unsigned long value)
+{
+    writeUnsigned(value);
+    return *this;
+}
+
+
+/*!
+ * Appends a floating point number formatted by formatFloat().
+ */
+BufferedTextWriter&
+BufferedTextWriter::operator<<(float value)
+{
+    return *this<<static_cast<double>(value);
+}
+
+
+/*!
+ * Appends a floating point number formatted by formatFloat().
+ */
+BufferedTextWriter&
+BufferedTextWriter::operator<<(double value)
+{
+    formatFloat(value, precision_, buffer_);
+    if( buffer_.size() >= bufferSize_ )
+    {
+        flush();
+    }
+    return *this;
+}
+
+
+/*!
+ * Appends the given value with the given number of significant digits to a 
+ * string. The output is identical to the %g conversion of printf (and hence
+ * to default std::ostream formatting) in the C locale, i.e. fixed notation 
+ * is used for decimal exponents between -4 and the precision and scientific
+ * notation otherwise, and trailing zeros are removed. Digits are obtained by
+ * scaling and rounding in double precision, which is exact unless the value
+ * is close to a rounding tie (see roundSignificant()). Such values are rare 
+ * and are formatted with snprintf instead, replacing the decimal separator
+ * of the current locale with a point.
+ */
+void
+BufferedTextWriter::formatFloat(
+        double value,
+        int precision,
+        std::string &out)
+{
+    // special values:
+    if( std::isnan(value) )
+    {
+        out.append("nan");
+        return;
+    }
+    if( std::isinf(value) )
+    {
+        out.append(value < 0.0 ? "-inf" : "inf");
+        return;
+    }
+    if( std::signbit(value) )
+    {
+        out.push_back('-');
+        value = -value;
+    }
+    if( value == 0.0 )
+    {
+        out.push_back('0');
+        return;
+    }
+
+    // decimal exponent:
+    int exponent = std::floor(std::log10(value));
+
+    // round to given number of significant digits, extreme exponents would
+    // overflow the scaling factor and values close to a tie can not be 
+    // rounded reliably after scaling, so these are left to printf:
+    long long lower = std::llround(std::pow(10.0, precision - 1));
+    long long upper = lower*10;
+    long long mantissa = 0;
+    bool isExact = exponent >= -290 && exponent <= 290 &&
+            roundSignificant(value, precision - 1 - exponent, mantissa);
+    if( isExact && mantissa < lower )
+    {
+        // log10 was rounded up:
+        exponent--;
+        isExact = roundSignificant(value, precision - 1 - exponent, mantissa);
+    }
+    if( isExact && mantissa >= upper )
+    {
+        // rounding carried into next decade:
+        exponent++;
+        isExact = roundSignificant(value, precision - 1 - exponent, mantissa);
+    }
+    if( !isExact )
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.*g", precision, value);
+        for(char *c = buf; *c != '\0'; c++)
+        {
+            // replace locale-specific decimal separator:
+            if( *c != 'e' && *c != '-' && *c != '+' && (*c < '0' || *c > '9') )
+            {
+                *c = '.';
+            }
+        }
+        out.append(buf);
+        return;
+    }
+    std::string digits = std::to_string(mantissa);
+
+    // scientific or fixed notation:
+    if( exponent < -4 || exponent >= precision )
+    {
+        out.push_back(digits[0]);
+        size_t last = digits.find_last_not_of('0');
+        if( last > 0 )
+        {
+            out.push_back('.');
+            out.append(digits, 1, last);
+        }
+        out.push_back('e');
+        out.push_back(exponent < 0 ? '-' : '+');
+        int absExp = std::abs(exponent);
+        if( absExp < 10 )
+        {
+            out.push_back('0');
+        }
+        out.append(std::to_string(absExp));
+    }
+    else if( exponent >= 0 )
+    {
+        out.append(digits, 0, exponent + 1);
+        size_t last = digits.find_last_not_of('0');
+        if( last != std::string::npos && last > static_cast<size_t>(exponent) )
+        {
+            out.push_back('.');
+            out.append(digits, exponent + 1, last - exponent);
+        }
+    }
+    else
+    {
+        out.append("0.");
+        out.append(-exponent - 1, '0');
+        size_t last = digits.find_last_not_of('0');
+        out.append(digits, 0, last + 1);
+    }
+}
+
+
+/*!
+ * Scales the given value by the given power of ten and rounds it to the 
+ * nearest integer. Negative powers divide by the corresponding positive power
+ * so that the scaling is exact for all representable powers of ten. As the
+ * scaled value is itself rounded, the result may differ from rounding the 
+ * exact decimal value if the scaled value lies within a few units in the last
+ * place of a tie (e.g. 0.15 is slightly less than the tie, but 0.15*10 is 
+ * exactly 1.5). In this case false is returned and the mantissa is not set.
+ */
+bool
+BufferedTextWriter::roundSignificant(
+        double value,
+        int power,
+        long long &mantissa)
+{
+    double scaled = (power >= 0) ? 
+            value*std::pow(10.0, power) : value/std::pow(10.0, -power);
+
+    // scaled value must be clear of a tie by more than its rounding error:
+    double tieDist = std::abs(scaled - std::floor(scaled) - 0.5);
+    if( tieDist <= 8.0*std::numeric_limits<double>::epsilon()*scaled )
+    {
+        return false;
+    }
+
+    mantissa = std::llrint(scaled);
+    return true;
+}
+
+
+/*!
+ * Writes the buffer contents to the file.
+ */
+void
+BufferedTextWriter::flush()
+{
+    file_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+}
+
+
+/*!
+ * Appends an unsigned integer in decimal notation.
+ */
+void
+BufferedTextWriter::writeUnsigned(unsigned long value)
+{
+    char digits[24];
+    int n = 0;
+    do
+    {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    }
+    while( value > 0 );
+    while( n > 0 )
+    {
+        buffer_.push_back(digits[--n]);
+    }
+    if( buffer_.size() >= bufferSize_ )
+    {
+        flush();
+    }
+}
+
@@ -293,10 +293,9 @@ std::map<std::string, ColourPalette>
 ColourPaletteProvider::fromJsonFile(std::string filename)
 {
     // import colour palette definitions from JSON file:
-    JsonDocImporter import;
-    auto doc = import(filename);
+    InsituJsonDocument doc(filename);
 
     // document parsing is handles by separate function:
-    return fromJsonDoc(doc);
+    return fromJsonDoc(doc.doc());
 }
 
@@ -21,26 +21,240 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <exception>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHAP_HAVE_MMAP
+#endif
+
+#include "external/rapidjson/filereadstream.h"
+#include "external/rapidjson/reader.h"
+
 #include "io/json_doc_importer.hpp"
 
 
+namespace
+{
+
+/*!
+ * \brief SAX handler that forwards only the events belonging to the value at
+ * a given path of object keys to a document.
+ *
+ * Parsing is aborted as soon as the value is complete, so that the remainder
+ * of the file is never read. An empty path selects the root value.
+ */
+class JsonMemberFilter
+{
+    public:
+
+        JsonMemberFilter(
+                rapidjson::Document &doc,
+                const std::vector<std::string> &path)
+            : doc_(doc)
+            , path_(path)
+            , depth_(0)
+            , matchDepth_(0)
+            , keyMatched_(false)
+            , atTarget_(path.empty())
+            , capturing_(false)
+            , captureDepth_(0)
+            , done_(false)
+        {
+        
+        }
+
+        // returns true if value was found completely:
+        bool done() const { return done_; }
+
+        // scalar values:
+        bool Null() { return scalar() && (!capturing_ || doc_.Null()) && more(); }
+        bool Bool(bool b) { return scalar() && (!capturing_ || doc_.Bool(b)) && more(); }
+        bool Int(int i) { return scalar() && (!capturing_ || doc_.Int(i)) && more(); }
+        bool Uint(unsigned u) { return scalar() && (!capturing_ || doc_.Uint(u)) && more(); }
+        bool Int64(int64_t i) { return scalar() && (!capturing_ || doc_.Int64(i)) && more(); }
+        bool Uint64(uint64_t u) { return scalar() && (!capturing_ || doc_.Uint64(u)) && more(); }
+        bool Double(double d) { return scalar() && (!capturing_ || doc_.Double(d)) && more(); }
+        bool RawNumber(const char *str, rapidjson::SizeType len, bool)
+        {
+            return scalar() && (!capturing_ || doc_.RawNumber(str, len, true)) && more();
+        }
+        bool String(const char *str, rapidjson::SizeType len, bool)
+        {
+            return scalar() && (!capturing_ || doc_.String(str, len, true)) && more();
+        }
+
+        // object keys:
+        bool Key(const char *str, rapidjson::SizeType len, bool)
+        {
+            if( capturing_ )
+            {
+                return doc_.Key(str, len, true);
+            }
+
+            // does key extend the matched path?
+            if( matchDepth_ == depth_ && depth_ <= path_.size() &&
+                path_[depth_ - 1].compare(0, std::string::npos, str, len) == 0 )
+            {
+                if( depth_ == path_.size() )
+                {
+                    atTarget_ = true;
+                }
+                else
+                {
+                    keyMatched_ = true;
+                }
+            }
+            return true;
+        }
+
+        // containers:
+        bool StartObject() { return start(true); }
+        bool StartArray() { return start(false); }
+        bool EndObject(rapidjson::SizeType n)
+        {
+            return end() && (!capturing_ || doc_.EndObject(n)) && more();
+        }
+        bool EndArray(rapidjson::SizeType n)
+        {
+            return end() && (!capturing_ || doc_.EndArray(n)) && more();
+        }
+
+    private:
+
+        rapidjson::Document &doc_;
+        const std::vector<std::string> &path_;
+
+        // position in document:
+        size_t depth_;
+        size_t matchDepth_;
+        bool keyMatched_;
+        bool atTarget_;
+
+        // capture state:
+        bool capturing_;
+        size_t captureDepth_;
+        bool done_;
+
+        // handles start of scalar value:
+        bool scalar()
+        {
+            keyMatched_ = false;
+            if( atTarget_ )
+            {
+                capturing_ = true;
+                captureDepth_ = depth_;
+                atTarget_ = false;
+            }
+            return true;
+        }
+
+        // handles start of container:
+        bool start(bool isObject)
+        {
+            if( atTarget_ )
+            {
+                capturing_ = true;
+                captureDepth_ = depth_;
+                atTarget_ = false;
+            }
+            depth_++;
+            if( !capturing_ && (depth_ == 1 || (keyMatched_ && isObject)) )
+            {
+                matchDepth_ = depth_;
+            }
+            keyMatched_ = false;
+            if( capturing_ )
+            {
+                return isObject ? doc_.StartObject() : doc_.StartArray();
+            }
+            return true;
+        }
+
+        // handles end of container:
+        bool end()
+        {
+            depth_--;
+            if( matchDepth_ > depth_ )
+            {
+                matchDepth_ = depth_;
+            }
+            return true;
+        }
+
+        // returns false to terminate parsing once value is complete:
+        bool more()
+        {
+            if( capturing_ && depth_ == captureDepth_ )
+            {
+                done_ = true;
+                return false;
+            }
+            return true;
+        }
+};
+
+
+/*!
+ * \brief Generator for GenericDocument::Populate() which streams through a 
+ * file and produces the SAX events of a single member.
+ */
+class JsonMemberGenerator
+{
+    public:
+
+        JsonMemberGenerator(
+                std::FILE *file,
+                const std::vector<std::string> &path)
+            : file_(file)
+            , path_(path)
+            , found_(false)
+        {
+        
+        }
+
+        bool found() const { return found_; }
+
+        bool operator()(rapidjson::Document &doc)
+        {
+            char buffer[65536];
+            rapidjson::FileReadStream stream(file_, buffer, sizeof(buffer));
+            JsonMemberFilter filter(doc, path_);
+            rapidjson::Reader reader;
+            reader.Parse(stream, filter);
+            found_ = filter.done();
+            return found_;
+        }
+
+    private:
+
+        std::FILE *file_;
+        const std::vector<std::string> &path_;
+        bool found_;
+};
+
+} // namespace
+
+
 /*!
  * Returns a JSON document corresponding to the given JSON file.
  */
 rapidjson::Document
 JsonDocImporter::operator()(std::string fileName)
 {
-    // read entire file into memory:
-    std::stringstream ss;
-    std::ifstream file;
-    file.open(fileName.c_str());
+    // open file positioned at its end:
+    std::ifstream file(
+            fileName.c_str(), 
+            std::ifstream::binary | std::ifstream::ate);
 
     // make sure file could be opened:
     if( !file.is_open() )
@@ -48,13 +262,17 @@ JsonDocImporter::operator()(std::string fileName)
         throw std::runtime_error("ERROR: Could not open file " + fileName + ".");
     }
 
-    // read file into string stream:
-    ss << file.rdbuf();
+    // read entire file into a single buffer:
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ifstream::beg);
+    std::vector<char> buffer(size + 1);
+    file.read(buffer.data(), size);
+    buffer[size] = '\0';
     file.close();
 
-    // create JSON document from file:
+    // create JSON document from buffer:
     rapidjson::Document json;
-    json.Parse<0>(ss.str().c_str());
+    json.Parse<0>(buffer.data(), size);
 
     // check validity of JSON object:
     if( json.IsObject() == false )
@@ -66,3 +284,194 @@ JsonDocImporter::operator()(std::string fileName)
     return json;
 }
 
+
+/*!
+ * Returns a document containing only the value at the given path in the 
+ * given JSON file. The path consists of object keys separated by slashes, 
+ * e.g. "pathSummary/minRadius". The file is parsed as a stream until the 
+ * value is complete, so that only the requested value is ever held in 
+ * memory, which makes this suitable for multi-gigabyte results files.
+ */
+rapidjson::Document
+JsonDocImporter::member(
+        const std::string &fileName,
+        const std::string &path)
+{
+    // split path into keys:
+    std::vector<std::string> keys;
+    std::stringstream pathStream(path);
+    std::string key;
+    while( std::getline(pathStream, key, '/') )
+    {
+        if( !key.empty() )
+        {
+            keys.push_back(key);
+        }
+    }
+
+    // open file:
+    std::FILE *file = std::fopen(fileName.c_str(), "rb");
+    if( file == nullptr )
+    {
+        throw std::runtime_error("ERROR: Could not open file " + fileName + ".");
+    }
+
+    // stream through file and build document from requested member only:
+    JsonMemberGenerator generator(file, keys);
+    rapidjson::Document json;
+    json.Populate(generator);
+    std::fclose(file);
+
+    // was member found?
+    if( !generator.found() )
+    {
+        throw std::runtime_error("ERROR: Could not find member " + path + 
+                                 " in file " + fileName + ".");
+    }
+
+    return json;
+}
+
+
+/*!
+ * Constructor maps (or reads) the given file and parses it in-situ.
+ */
+InsituJsonDocument::InsituJsonDocument(const std::string &fileName)
+    : buffer_(nullptr)
+    , size_(fileSize(fileName))
+    , isMapped_(false)
+    , allocator_(std::max<size_t>(size_/4, 64*1024))
+    , doc_(&allocator_)
+{
+    // try memory mapping first and fall back on buffered read:
+    if( !mapFile(fileName) )
+    {
+        readFile(fileName);
+    }
+
+    // parse in-situ, i.e. strings are not copied:
+    doc_.ParseInsitu(buffer_);
+
+    // check validity of JSON object:
+    if( doc_.HasParseError() || !doc_.IsObject() )
+    {
+        unmapFile();
+        throw std::invalid_argument("Invalid JSON object in " + fileName + ".");
+    }
+}
+
+
+/*!
+ * Destructor unmaps the file if necessary.
+ */
+InsituJsonDocument::~InsituJsonDocument()
+{
+    unmapFile();
+}
+
+
+/*!
+ * Returns a reference to the parsed document.
+ */
+rapidjson::Document&
+InsituJsonDocument::doc()
+{
+    return doc_;
+}
+
+
+/*!
+ * Returns the size of the given file in bytes.
+ */
+size_t
+InsituJsonDocument::fileSize(const std::string &fileName)
+{
+    std::ifstream file(
+            fileName.c_str(), 
+            std::ifstream::binary | std::ifstream::ate);
+    if( !file.is_open() )
+    {
+        throw std::runtime_error("ERROR: Could not open file " + fileName + ".");
+    }
+    return file.tellg();
+}
+
+
+/*!
+ * Maps the file privately into memory. In-situ parsing requires a null 
+ * terminated buffer, which is provided by the zero padding of the last page
+ * unless the file size is an exact multiple of the page size. Returns false 
+ * if the file could not be mapped.
+ */
+bool
+InsituJsonDocument::mapFile(const std::string &fileName)
+{
+#ifdef CHAP_HAVE_MMAP
+    // need zero padding after end of file:
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if( size_ == 0 || pageSize <= 0 || size_ % pageSize == 0 )
+    {
+        return false;
+    }
+
+    // map file copy-on-write:
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if( fd < 0 )
+    {
+        return false;
+    }
+    void *addr = mmap(
+            nullptr, 
+            size_, 
+            PROT_READ | PROT_WRITE, 
+            MAP_PRIVATE, 
+            fd, 
+            0);
+    close(fd);
+    if( addr == MAP_FAILED )
+    {
+        return false;
+    }
+
+    buffer_ = static_cast<char*>(addr);
+    isMapped_ = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+/*!
+ * Releases the memory mapping, if any.
+ */
+void
+InsituJsonDocument::unmapFile()
+{
+#ifdef CHAP_HAVE_MMAP
+    if( isMapped_ )
+    {
+        munmap(buffer_, size_);
+        isMapped_ = false;
+    }
+#endif
+}
+
+
+/*!
+ * Reads the file into a null terminated buffer.
+ */
+void
+InsituJsonDocument::readFile(const std::string &fileName)
+{
+    std::ifstream file(fileName.c_str(), std::ifstream::binary);
+    if( !file.is_open() )
+    {
+        throw std::runtime_error("ERROR: Could not open file " + fileName + ".");
+    }
+    fallbackBuffer_.resize(size_ + 1);
+    file.read(fallbackBuffer_.data(), size_);
+    fallbackBuffer_[size_] = '\0';
+    buffer_ = fallbackBuffer_.data();
+}
+
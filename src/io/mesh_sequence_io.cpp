@@ -0,0 +1,322 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "io/binary_io.hpp"
+#include "io/mesh_sequence_io.hpp"
+
+
+/*!
+ * Constructor. The ring size is the number of consecutive vertices on which 
+ * each property is constant. A non-positive quantisation step disables 
+ * quantisation and delta encoding, so that coordinates are stored as single
+ * precision floats.
+ */
+MeshSequenceExporter::MeshSequenceExporter(
+        size_t ringSize,
+        real quantStep)
+    : ringSize_(ringSize)
+    , quantStep_(quantStep)
+    , numVertices_(0)
+    , numFrames_(0)
+{
+    // sanity checks:
+    if( ringSize_ == 0 )
+    {
+        throw std::logic_error("Ring size of MeshSequenceExporter must be "
+                               "positive.");
+    }
+    if( quantStep_ < 0.0 )
+    {
+        quantStep_ = 0.0;
+    }
+}
+
+
+/*!
+ * Opens a new mesh sequence file of the given name. The header is written 
+ * only once the first frame is added.
+ */
+void
+MeshSequenceExporter::open(const std::string &fileName)
+{
+    fileName_ = fileName;
+    numFrames_ = 0;
+    prevQuant_.clear();
+    propertyNames_.clear();
+    seq_.open(fileName.c_str(), std::fstream::out | std::fstream::binary);
+    if( !seq_.is_open() )
+    {
+        throw std::runtime_error("Could not open mesh sequence file " + 
+                                 fileName + ".");
+    }
+}
+
+
+/*!
+ * Appends a frame to the sequence. The first frame defines the topology and 
+ * property names and all subsequent meshes must agree with it.
+ */
+void
+MeshSequenceExporter::addFrame(
+        real time,
+        const PlyMesh &mesh)
+{
+    // sanity checks:
+    if( !seq_.is_open() )
+    {
+        throw std::logic_error("MeshSequenceExporter must be opened before "
+                               "adding frames.");
+    }
+    if( !mesh.valid() )
+    {
+        throw std::logic_error("MeshSequenceExporter encountered invalid "
+                               "mesh.");
+    }
+
+    // first frame defines topology:
+    if( numFrames_ == 0 )
+    {
+        writeHeader(mesh);
+    }
+    checkTopology(mesh);
+
+    // write vertex data:
+    writeVertices(mesh, time);
+
+    // write one property value per ring:
+    for(auto &prop : mesh.properties_)
+    {
+        for(size_t i = 0; i < numVertices_; i += ringSize_)
+        {
+            writeLittleEndian(seq_, static_cast<float>(prop.second[i]));
+        }
+    }
+
+    numFrames_++;
+}
+
+
+/*!
+ * Updates the number of frames recorded in the header and closes the file.
+ */
+void
+MeshSequenceExporter::close()
+{
+    if( !seq_.is_open() )
+    {
+        return;
+    }
+
+    // patch frame count in header:
+    if( numFrames_ > 0 )
+    {
+        seq_.seekp(numFramesPos_);
+        writeLittleEndian(seq_, numFrames_);
+    }
+
+    // close file stream:
+    seq_.close();
+    if( seq_.fail() )
+    {
+        throw std::runtime_error("Could not write mesh sequence file " + 
+                                 fileName_ + ".");
+    }
+}
+
+
+/*!
+ * Returns the number of frames added since the file was opened.
+ */
+size_t
+MeshSequenceExporter::numFrames() const
+{
+    return numFrames_;
+}
+
+
+/*!
+ * Writes the file header, including the faces and property names of the 
+ * given mesh, which is used as reference topology for all frames.
+ */
+void
+MeshSequenceExporter::writeHeader(const PlyMesh &mesh)
+{
+    // reference topology:
+    numVertices_ = mesh.vertices_.size();
+    if( numVertices_ % ringSize_ != 0 )
+    {
+        throw std::logic_error("Number of vertices is not a multiple of ring "
+                               "size in MeshSequenceExporter.");
+    }
+    for(auto &prop : mesh.properties_)
+    {
+        propertyNames_.push_back(prop.first);
+    }
+
+    // format identifier:
+    seq_.write("CHAPMSEQ", 8);
+    writeLittleEndian(seq_, version_);
+
+    // placeholder for number of frames:
+    numFramesPos_ = seq_.tellp();
+    writeLittleEndian(seq_, static_cast<uint32_t>(0));
+
+    // format parameters:
+    writeLittleEndian(seq_, static_cast<uint32_t>(numVertices_));
+    writeLittleEndian(seq_, static_cast<uint32_t>(ringSize_));
+    writeLittleEndian(seq_, static_cast<float>(quantStep_));
+
+    // property names:
+    writeLittleEndian(seq_, static_cast<uint32_t>(propertyNames_.size()));
+    for(auto &name : propertyNames_)
+    {
+        writeLittleEndian(seq_, static_cast<uint32_t>(name.size()));
+        seq_.write(name.data(), name.size());
+    }
+
+    // faces:
+    writeLittleEndian(seq_, static_cast<uint32_t>(mesh.faces_.size()));
+    for(auto &face : mesh.faces_)
+    {
+        for(auto idx : face)
+        {
+            writeLittleEndian(seq_, static_cast<int32_t>(idx));
+        }
+    }
+}
+
+
+/*!
+ * Writes frame type, time stamp and vertex coordinates. In quantised mode, a
+ * delta frame is written if possible and a key frame otherwise.
+ */
+void
+MeshSequenceExporter::writeVertices(
+        const PlyMesh &mesh,
+        real time)
+{
+    // unquantised coordinates:
+    if( quantStep_ == 0.0 )
+    {
+        writeLittleEndian(seq_, static_cast<uint8_t>(eMeshFrameFloat));
+        writeLittleEndian(seq_, static_cast<float>(time));
+        for(auto &vert : mesh.vertices_)
+        {
+            for(int j = 0; j < DIM; j++)
+            {
+                writeLittleEndian(seq_, static_cast<float>(vert[j]));
+            }
+        }
+        return;
+    }
+
+    // quantise coordinates:
+    std::vector<int32_t> quant;
+    quant.reserve(DIM*numVertices_);
+    for(auto &vert : mesh.vertices_)
+    {
+        for(int j = 0; j < DIM; j++)
+        {
+            double q = std::round(vert[j]/quantStep_);
+            if( std::fabs(q) > std::numeric_limits<int32_t>::max() )
+            {
+                throw std::runtime_error("Vertex coordinate exceeds range of "
+                                         "quantisation in "
+                                         "MeshSequenceExporter.");
+            }
+            quant.push_back(static_cast<int32_t>(q));
+        }
+    }
+
+    // can frame be delta encoded?
+    bool isDelta = !prevQuant_.empty();
+    for(size_t i = 0; isDelta && i < quant.size(); i++)
+    {
+        int64_t delta = static_cast<int64_t>(quant[i]) - prevQuant_[i];
+        if( delta < std::numeric_limits<int16_t>::min() ||
+            delta > std::numeric_limits<int16_t>::max() )
+        {
+            isDelta = false;
+        }
+    }
+
+    // write key or delta frame:
+    if( isDelta )
+    {
+        writeLittleEndian(seq_, static_cast<uint8_t>(eMeshFrameDelta));
+        writeLittleEndian(seq_, static_cast<float>(time));
+        for(size_t i = 0; i < quant.size(); i++)
+        {
+            writeLittleEndian(
+                    seq_, 
+                    static_cast<int16_t>(quant[i] - prevQuant_[i]));
+        }
+    }
+    else
+    {
+        writeLittleEndian(seq_, static_cast<uint8_t>(eMeshFrameKey));
+        writeLittleEndian(seq_, static_cast<float>(time));
+        for(auto q : quant)
+        {
+            writeLittleEndian(seq_, q);
+        }
+    }
+
+    // keep as reference for next frame:
+    prevQuant_ = std::move(quant);
+}
+
+
+/*!
+ * Checks that a mesh has the same number of vertices and the same properties
+ * as the first frame. Faces are not compared for efficiency.
+ */
+void
+MeshSequenceExporter::checkTopology(const PlyMesh &mesh)
+{
+    if( mesh.vertices_.size() != numVertices_ )
+    {
+        throw std::logic_error("Number of vertices differs from first frame "
+                               "in MeshSequenceExporter.");
+    }
+    if( mesh.properties_.size() != propertyNames_.size() )
+    {
+        throw std::logic_error("Number of properties differs from first frame "
+                               "in MeshSequenceExporter.");
+    }
+    for(size_t i = 0; i < propertyNames_.size(); i++)
+    {
+        if( mesh.properties_[i].first != propertyNames_[i] )
+        {
+            throw std::logic_error("Property " + mesh.properties_[i].first +
+                                   " not present in first frame of "
+                                   "MeshSequenceExporter.");
+        }
+    }
+}
+
@@ -23,9 +23,13 @@
 
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iomanip>
+#include <limits>
+#include <queue>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 #include <gromacs/math/vec.h>
@@ -51,14 +55,44 @@ RegularVertexGrid::RegularVertexGrid(
 
 
 /*!
- * Adds a vertex at the given coordinates for the given property.
+ * Adds a new property layer to the grid and returns its index, which is to be
+ * used when adding vertices for this property. If the property already 
+ * exists, the index of the existing layer is returned.
+ */
+size_t
+RegularVertexGrid::addProperty(
+        const std::string &p)
+{
+    // property already exists:
+    auto it = std::find(p_.begin(), p_.end(), p);
+    if( it != p_.end() )
+    {
+        return std::distance(p_.begin(), it);
+    }
+
+    // allocate memory for new layer:
+    size_t layerSize = s_.size()*phi_.size();
+    p_.push_back(p);
+    vertices_.resize(vertices_.size() + layerSize, gmx::RVec(0.0, 0.0, 0.0));
+    weights_.resize(weights_.size() + layerSize, 0.0);
+    isSet_.resize(isSet_.size() + layerSize, false);
+
+    // normals are no longer valid:
+    normals_.clear();
+
+    return p_.size() - 1;
+}
+
+
+/*!
+ * Adds a vertex at the given coordinates for the property with index k.
  */
 void
 RegularVertexGrid::addVertex(
         size_t i, 
         size_t j,
-        std::string p,
-        gmx::RVec vertex, 
+        size_t k,
+        const gmx::RVec &vertex, 
         real weight)
 {
     // TODO: this situation should really be handled by a NaN colour
@@ -67,40 +101,64 @@ RegularVertexGrid::addVertex(
         weight = 0.5;
     }
 
-    p_.insert(p);
-    std::tuple<size_t, size_t, std::string> key(i, j, p);
-    vertices_[key] = vertex;
-    weights_[key] = weight;
+    size_t idx = linearIndex(i, j, k);
+    vertices_.at(idx) = vertex;
+    weights_[idx] = weight;
+    isSet_[idx] = true;
 }
 
 
 /*!
- * Returns a vector of all vertices for a given property.
+ * Returns the index of the given property and throws an exception if this 
+ * property is not present in the grid.
  */
-std::vector<gmx::RVec>
-RegularVertexGrid::vertices(
-        std::string p)
+size_t
+RegularVertexGrid::propertyIndex(
+        const std::string &p) const
 {
-    // build linearly indexed vector from dual indexed map:
-    std::vector<gmx::RVec> vert;
-    vert.reserve(vertices_.size());
-    for(size_t i = 0; i < s_.size(); i++)
+    auto it = std::find(p_.begin(), p_.end(), p);
+    if( it == p_.end() )
     {
-        for(size_t j = 0; j < phi_.size(); j++)
+        throw std::logic_error("Property " + p + " not found in "
+                               "RegularVertexGrid.");
+    }
+    return std::distance(p_.begin(), it);
+}
+
+
+/*!
+ * Throws an exception unless all vertices for the property with index k have
+ * been set.
+ */
+void
+RegularVertexGrid::checkComplete(
+        size_t k) const
+{
+    size_t layerSize = s_.size()*phi_.size();
+    for(size_t idx = k*layerSize; idx < (k + 1)*layerSize; idx++)
+    {
+        if( !isSet_[idx] )
         {
-            std::tuple<size_t, size_t, std::string> key(i, j, p);
-            if( vertices_.find(key) != vertices_.end() )
-            {
-                vert.push_back(vertices_[key]); 
-            }
-            else
-            {
-                throw std::logic_error("Invalid vertex reference encountered.");
-            }
+            throw std::logic_error("Invalid vertex reference encountered.");
         }
     }
+}
 
-    return vert;
+
+/*!
+ * Returns a vector of all vertices for a given property.
+ */
+std::vector<gmx::RVec>
+RegularVertexGrid::vertices(
+        const std::string &p)
+{
+    size_t k = propertyIndex(p);
+    checkComplete(k);
+
+    // vertices of each property are contiguous:
+    return std::vector<gmx::RVec>(
+            vertices_.begin() + linearIndex(0, 0, k),
+            vertices_.begin() + linearIndex(0, 0, k + 1));
 }
 
 
@@ -109,97 +167,61 @@ RegularVertexGrid::vertices(
  */
 std::vector<gmx::RVec>
 RegularVertexGrid::normals(
-        std::string p)
+        const std::string &p)
 {
-    std::vector<gmx::RVec> norm;
-    norm.reserve(normals_.size());
-    for(size_t i = 0; i < s_.size(); i++)
+    size_t k = propertyIndex(p);
+    if( normals_.size() != vertices_.size() )
     {
-        for(size_t j = 0; j < phi_.size(); j++)
-        {
-            std::tuple<size_t, size_t, std::string> key(i, j, p);
-            if( normals_.find(key) != normals_.end() )
-            {
-                norm.push_back(normals_[key]); 
-            }
-            else
-            {
-                throw std::logic_error("Invalid vertex normal reference "
-                                       "encountered.");
-            }
-        }
+        throw std::logic_error("Invalid vertex normal reference "
+                               "encountered.");
     }
 
-    return norm;
+    // normals of each property are contiguous:
+    return std::vector<gmx::RVec>(
+            normals_.begin() + linearIndex(0, 0, k),
+            normals_.begin() + linearIndex(0, 0, k + 1));
 }
 
 
 /*!
- * Calculates vertex normals from triangular faces.
+ * Calculates vertex normals from triangular faces. This is done once for all
+ * properties, i.e. this function only needs to be called after all vertices
+ * have been added.
  */
 void
 RegularVertexGrid::normalsFromFaces()
 {
     // array sizes for index wrap:
-    int mI = s_.size();
-    int mJ = phi_.size();
+    size_t mI = s_.size();
+    size_t mJ = phi_.size();
 
-    for(auto p : p_)
+    normals_.assign(vertices_.size(), gmx::RVec(0.0, 0.0, 0.0));
+    for(size_t k = 0; k < p_.size(); k++)
     {
-        for(int i = 0; i < s_.size(); i++)
+        checkComplete(k);
+
+        for(size_t i = 0; i < mI; i++)
         {
-            for(int j = 0; j < phi_.size(); j++)
+            // neighbouring rows (endpoints along spline are not wrapped):
+            size_t iLowr = (i == 0) ? i : i - 1;
+            size_t iUppr = (i == mI - 1) ? i : i + 1;
+
+            for(size_t j = 0; j < mJ; j++)
             {
-                // index pairs for neighbouring vertices:
-                std::tuple<size_t, size_t, std::string> crntKey(
-                        i, 
-                        j,
-                        p);
-                std::tuple<size_t, size_t, std::string> leftKey(
-                        i, 
-                        (j - 1 + mJ) % mJ,
-                        p);
-                std::tuple<size_t, size_t, std::string> rghtKey(
-                        i, 
-                        (j + 1 + mJ) % mJ,
-                        p);
-                std::tuple<size_t, size_t, std::string> upprKey(
-                        (i + 1 + mI) % mI, 
-                        j,
-                        p);
-                std::tuple<size_t, size_t, std::string> lowrKey((
-                        i - 1 + mI) % mI, 
-                        j,
-                        p);
-                std::tuple<size_t, size_t, std::string> dglrKey(
-                        (i - 1 + mI) % mI, 
-                        (j + 1 + mJ) % mJ,
-                        p);
-                std::tuple<size_t, size_t, std::string> dgulKey(
-                        (i + 1 + mI) % mI, 
-                        (j - 1 + mJ) % mJ,
-                        p);
-
-                // handle endpoints in direction along spline:
-                if( i == 0 )
-                {
-                    lowrKey = crntKey; 
-                    dglrKey = crntKey;
-                }
-                if( i == s_.size() - 1 )
-                {
-                    upprKey = crntKey;
-                    dgulKey = crntKey;
-                }
+                // neighbouring columns (wrapped around circumference):
+                size_t jLeft = (j + mJ - 1) % mJ;
+                size_t jRght = (j + 1) % mJ;
 
                 // neighbouring vertices:
-                gmx::RVec crntVert = vertices_.at(crntKey);
-                gmx::RVec leftVert = vertices_.at(leftKey);
-                gmx::RVec rghtVert = vertices_.at(rghtKey);
-                gmx::RVec upprVert = vertices_.at(upprKey);
-                gmx::RVec lowrVert = vertices_.at(lowrKey);
-                gmx::RVec dglrVert = vertices_.at(dglrKey);
-                gmx::RVec dgulVert = vertices_.at(dgulKey);
+                const gmx::RVec &crntVert = vertices_[linearIndex(i, j, k)];
+                const gmx::RVec &leftVert = vertices_[linearIndex(i, jLeft, k)];
+                const gmx::RVec &rghtVert = vertices_[linearIndex(i, jRght, k)];
+                const gmx::RVec &upprVert = vertices_[linearIndex(iUppr, j, k)];
+                const gmx::RVec &lowrVert = vertices_[linearIndex(iLowr, j, k)];
+                const gmx::RVec &dglrVert = (i == 0) ? 
+                        crntVert : vertices_[linearIndex(iLowr, jRght, k)];
+                const gmx::RVec &dgulVert = (i == mI - 1) ? 
+                        crntVert : vertices_[linearIndex(iUppr, jLeft, k)];
 
                 // initialise normal as null vector:
                 gmx::RVec norm(0.0, 0.0, 0.0);
@@ -240,7 +262,7 @@ RegularVertexGrid::normalsFromFaces()
                 unitv(norm, norm);
                 
                 // add to container of normals:
-                normals_[crntKey] = norm;
+                normals_[linearIndex(i, j, k)] = norm;
             }
         }
     }
@@ -252,27 +274,17 @@ RegularVertexGrid::normalsFromFaces()
  */
 std::vector<std::pair<gmx::RVec, real>>
 RegularVertexGrid::weightedVertices(
-        std::string p)
+        const std::string &p)
 {
-    // build linearly indexed vector from dual indexed map:
+    size_t k = propertyIndex(p);
+    checkComplete(k);
+
+    // vertices of each property are contiguous:
     std::vector<std::pair<gmx::RVec, real>> vert;
-    vert.reserve(vertices_.size());
-    for(size_t i = 0; i < s_.size(); i++)
+    vert.reserve(s_.size()*phi_.size());
+    for(size_t idx = linearIndex(0, 0, k); idx < linearIndex(0, 0, k + 1); idx++)
     {
-        for(size_t j = 0; j < phi_.size(); j++)
-        {
-            std::tuple<size_t, size_t, std::string> key(i, j, p);
-            if( vertices_.find(key) != vertices_.end() && 
-                weights_.find(key) != weights_.end() )
-            {
-                std::pair<gmx::RVec, real> vertex(vertices_[key], weights_[key]);
-                vert.push_back(vertex); 
-            }
-            else
-            {
-                throw std::logic_error("Invalid vertex reference encountered.");
-            }
-        }
+        vert.push_back(std::make_pair(vertices_[idx], weights_[idx])); 
     }
 
     return vert;
@@ -283,7 +295,8 @@ RegularVertexGrid::weightedVertices(
  * Returns colour scale for the given property.
  */
 ColourScale
-RegularVertexGrid::colourScale(std::string p)
+RegularVertexGrid::colourScale(
+        const std::string &p)
 {
     return colourScales_.at(p);
 }
@@ -310,15 +323,14 @@ RegularVertexGrid::addTriangleNorm(
  */
 std::vector<WavefrontObjFace>
 RegularVertexGrid::faces(
-        std::string p)
+        const std::string &p)
 {
     // sanity checks:
-    if( phi_.size() * s_.size() * p_.size() != vertices_.size() )
+    size_t propIdx = propertyIndex(p);
+    for(size_t k = 0; k < p_.size(); k++)
     {
-        throw std::logic_error("RegularVertexGrid cannot generate faces "
-                               "on incomplete grid.");
+        checkComplete(k);
     }
-
     if( !normals_.empty() && normals_.size() != vertices_.size() )
     {
         throw std::logic_error("Number of vertex normals does not equal "
@@ -328,15 +340,15 @@ RegularVertexGrid::faces(
     // find scalar property data range:
     real minRange = std::numeric_limits<real>::max();
     real maxRange = std::numeric_limits<real>::min();
-    for(auto it = weights_.begin(); it != weights_.end(); it++)
+    for(auto w : weights_)
     {
-        if( it -> second < minRange )
+        if( w < minRange )
         {
-            minRange = it -> second;
+            minRange = w;
         }
-        if( it -> second > maxRange )
+        if( w > maxRange )
         {
-            maxRange = it -> second;
+            maxRange = w;
         }
     }
 
@@ -347,37 +359,28 @@ RegularVertexGrid::faces(
     colourScales_.insert(std::pair<std::string, ColourScale>(p, colScale));
 
     // number of vertices per property grid:
-    size_t propIdx = std::distance(p_.begin(), find(p_.begin(), p_.end(), p));
-    size_t vertOffset = s_.size() * phi_.size() * propIdx;
+    size_t vertOffset = linearIndex(0, 0, propIdx);
 
     // preallocate face vector:
     std::vector<WavefrontObjFace> faces;
-    faces.reserve(phi_.size()*s_.size());
+    faces.reserve(2*phi_.size()*s_.size());
 
-    // loop over grid:
+    // loop over grid (last column wraps around to first):
     for(size_t i = 0; i < s_.size() - 1; i++)
     {
-        for(size_t j = 0; j < phi_.size() - 1; j++)
+        for(size_t j = 0; j < phi_.size(); j++)
         {
+            size_t jNext = (j + 1) % phi_.size();
+
             // calculate linear indices:
-            int kbl = vertOffset + i * phi_.size() + j; 
-            int kbr = kbl + 1;
+            int kbl = vertOffset + i*phi_.size() + j; 
+            int kbr = vertOffset + i*phi_.size() + jNext;
             int ktl = kbl + phi_.size();
             int ktr = kbr + phi_.size();
 
-            // vertex keys:
-            std::tuple<size_t, size_t, std::string> keyBl(i,     j,     p);
-            std::tuple<size_t, size_t, std::string> keyBr(i,     j + 1, p);
-            std::tuple<size_t, size_t, std::string> keyTl(i + 1, j,     p);
-            std::tuple<size_t, size_t, std::string> keyTr(i + 1, j + 1, p);
-
             // face weight is average of vertex weights:
-            real scalarA = weights_.at(keyBl) 
-                         + weights_.at(keyTr) 
-                         + weights_.at(keyTl);
-            real scalarB = weights_.at(keyBl) 
-                         + weights_.at(keyBr) 
-                         + weights_.at(keyTr);
+            real scalarA = weights_[kbl] + weights_[ktr] + weights_[ktl];
+            real scalarB = weights_[kbl] + weights_[kbr] + weights_[ktr];
             scalarA /= 3.0;
             scalarB /= 3.0;
 
@@ -409,55 +412,6 @@ RegularVertexGrid::faces(
         }
     }
 
-    // wrap around:
-    for(size_t i = 0; i < s_.size() - 1; i++)
-    {
-        // calculate linear indices:
-        int kbl = vertOffset + i*phi_.size() + phi_.size() - 1; 
-        int kbr = vertOffset + i*phi_.size();
-        int ktl = kbl + phi_.size();
-        int ktr = kbr + phi_.size();
-
-        // vertex keys:
-        std::tuple<size_t, size_t, std::string> keyBl(i, phi_.size() - 1, p);
-        std::tuple<size_t, size_t, std::string> keyBr(i, 0, p);
-        std::tuple<size_t, size_t, std::string> keyTl(i + 1, phi_.size() - 1, p);
-        std::tuple<size_t, size_t, std::string> keyTr(i + 1, 0, p);
-
-        // face weight is average of vertex weights:
-        real scalarA = weights_[keyBl] + weights_[keyTr] + weights_[keyTl];
-        real scalarB = weights_[keyBl] + weights_[keyBr] + weights_[keyTr];
-        scalarA /= 3.0;
-        scalarB /= 3.0;
-
-        // name of material from colour scale:
-        std::string mtlNameA = colScale.scalarToColourName(scalarA); 
-        std::string mtlNameB = colScale.scalarToColourName(scalarB); 
-
-        // two faces per square:
-        if( normals_.empty() )
-        {
-            faces.push_back( WavefrontObjFace(
-                    {kbl + 1, ktr + 1, ktl + 1},
-                    mtlNameA) );
-            faces.push_back( WavefrontObjFace(
-                    {kbl + 1, kbr + 1, ktr + 1},
-                    mtlNameB) );
-        }
-        else
-        {
-
-            faces.push_back( WavefrontObjFace(
-                    {kbl + 1, ktr + 1, ktl + 1},
-                    {kbl + 1, ktr + 1, ktl + 1},
-                    mtlNameA) );
-            faces.push_back( WavefrontObjFace(
-                    {kbl + 1, kbr + 1, ktr + 1},
-                    {kbl + 1, kbr + 1, ktr + 1},
-                    mtlNameB) );
-        }
-    }
-
     // return face vector:
     return faces;
 }
@@ -471,6 +425,8 @@ MolecularPathObjExporter::MolecularPathObjExporter()
     : extrapDist_(0.0)
     , gridSampleDist_(-1.0)
     , correctionThreshold_(0.1)
+    , adaptiveTolerance_(0.0)
+    , maxNumVertices_(numLen_*numPhi_)
 {
     
 }
@@ -520,6 +476,35 @@ MolecularPathObjExporter::setCorrectionThreshold(real correctionThreshold)
 }
 
 
+/*!
+ * Enables adaptive placement of vertex rings along the pathway. The tolerance
+ * is the maximum permissible deviation (in nm) of the centre line and radius
+ * from their linear interpolation between neighbouring rings. Scalar 
+ * properties are refined until their deviation is below the resolution of 
+ * the colour scale. The total number of vertices per surface will not exceed
+ * the given maximum. A non-positive tolerance restores evenly spaced rings.
+ */
+void
+MolecularPathObjExporter::setAdaptiveResolution(
+        real tolerance,
+        size_t maxNumVertices)
+{
+    adaptiveTolerance_ = tolerance;
+    maxNumVertices_ = maxNumVertices;
+}
+
+
+/*!
+ * Returns the number of vertex rings along the pathway and the number of 
+ * vertices per ring used for the surface grid.
+ */
+std::pair<size_t, size_t>
+MolecularPathObjExporter::resolution() const
+{
+    return std::pair<size_t, size_t>(numLen_, numPhi_);
+}
+
+
 /*!
  * High level driver for exporting a MolecularPath object to an OBJ and MTL
  * file.
@@ -535,12 +520,6 @@ MolecularPathObjExporter::operator()(
     std::pair<real, real> range(molPath.sLo() - extrapDist_,
                                 molPath.sHi() + extrapDist_);
 
-    // define resolution:
-    // TODO: make this a parameter?
-    int numPhi = 50;
-    int numLen = std::pow(2, 8) + 1;
-    std::pair<size_t, size_t> resolution(numLen, numPhi);
-    
     // pathway geometry:
     auto centreLine = molPath.centreLine();
     auto pathRadius = molPath.pathRadius();
@@ -563,14 +542,16 @@ MolecularPathObjExporter::operator()(
             centreLine,
             pathRadius,
             properties,
-            resolution,
-            range);
+            ringPositions(centreLine, pathRadius, properties, numLen_, range),
+            numPhi_);
+
+    // vertex normals are computed once for all properties:
+    grid.normalsFromFaces();
 
     // loop over properties:
     for(auto prop : properties)
     {
         // obtain vertices, normals, and faces from grid:
-        grid.normalsFromFaces();
         auto vertices = grid.weightedVertices(prop.first);
         auto vertexNormals = grid.normals(prop.first);
         auto faces = grid.faces(prop.first);
@@ -649,21 +630,109 @@ MolecularPathObjExporter::operator()(
 
 
 /*!
- * Creates a regular vertex grid from a given centre line and radius spline.
- * This function loops over all given properties and for each property calls
- * generatePropertyGrid().
+ * Writes the pathway surface to a binary PLY file. The mesh is generated by 
+ * surfaceMesh().
  */
-RegularVertexGrid
-MolecularPathObjExporter::generateGrid(
+void
+MolecularPathObjExporter::writePly(
+        std::string fileName,
+        MolecularPath &molPath)
+{
+    PlyExporter plyExp;
+    plyExp.write(fileName + ".ply", surfaceMesh(molPath));
+}
+
+
+/*!
+ * Generates a triangle mesh of the pathway surface. The surface geometry is 
+ * generated only once and all scalar properties of the MolecularPath are 
+ * evaluated along the pathway and attached to the vertices as unscaled 
+ * per-vertex attributes. As in operator(), the radius is always included as a
+ * property and coordinates are converted from nm to Ang.
+ *
+ * Vertices are ordered ring by ring along the pathway, so that property 
+ * values are constant within each block of resolution().second vertices. 
+ * Unless adaptive resolution is enabled, the number of rings is always 
+ * resolution().first.
+ */
+PlyMesh
+MolecularPathObjExporter::surfaceMesh(
+        MolecularPath &molPath)
+{
+    // define evaluation range:   
+    std::pair<real, real> range(molPath.sLo() - extrapDist_,
+                                molPath.sHi() + extrapDist_);
+
+    // pathway geometry:
+    auto centreLine = molPath.centreLine();
+    auto pathRadius = molPath.pathRadius();
+
+    // pathway properties:
+    // (radius is added here to ensure that there is always one property)
+    molPath.addScalarProperty("radius", pathRadius, false);
+    auto properties = molPath.scalarProperties();   
+
+    // geometry does not depend on property, so generate it only once:
+    std::map<std::string, std::pair<SplineCurve1D, bool>> geometry;
+    geometry.insert(*properties.find("radius"));
+    RegularVertexGrid grid = generateGrid(
+            centreLine,
+            pathRadius,
+            geometry,
+            ringPositions(centreLine, pathRadius, properties, numLen_, range),
+            numPhi_);
+    grid.normalsFromFaces();
+
+    // transfer geometry to mesh (PLY uses zero-based indices):
+    PlyMesh mesh;
+    mesh.addVertices(grid.vertices("radius"));
+    mesh.addVertexNormals(grid.normals("radius"));
+    for(auto &face : grid.faces("radius"))
+    {
+        mesh.addFace({face.vertexIdx(0) - 1, 
+                      face.vertexIdx(1) - 1, 
+                      face.vertexIdx(2) - 1});
+    }
+
+    // evaluate each property once per ring of vertices:
+    for(auto &prop : properties)
+    {
+        std::vector<real> values;
+        values.reserve(grid.s_.size()*grid.phi_.size());
+        for(size_t i = 0; i < grid.s_.size(); i++)
+        {
+            real value = prop.second.first.evaluate(grid.s_[i], 0);
+            values.insert(values.end(), grid.phi_.size(), value);
+        }
+        mesh.addVertexProperty(prop.first, values);
+    }
+
+    // scale object by factor of 10 to convert nm to Ang:
+    mesh.scale(10.0);
+
+    return mesh;
+}
+
+
+/*!
+ * Determines the positions of the vertex rings along the pathway. By default,
+ * the given number of rings is spaced evenly over the evaluation range, but 
+ * if adaptive resolution is enabled, the ring positions are determined by 
+ * adaptiveRingPositions() based on the given properties.
+ */
+std::vector<real>
+MolecularPathObjExporter::ringPositions(
         SplineCurve3D &centreLine,
         SplineCurve1D &radius,
         std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
-        std::pair<size_t, size_t> resolution,
+        size_t numLen,
         std::pair<real, real> range)
 {
-    // extract resolution:
-    size_t numLen = resolution.first;
-    size_t numPhi = resolution.second;
+    // adaptive ring placement:
+    if( adaptiveTolerance_ > 0.0 )
+    {
+        return adaptiveRingPositions(centreLine, radius, properties, range);
+    }
 
     // check if number of intervals is power of two:
     int numInt = numLen - 1;
@@ -673,13 +742,32 @@ MolecularPathObjExporter::generateGrid(
                                "two.");
     }
 
-    // generate grid coordinates:
+    // evenly spaced rings:
     std::vector<real> s;
     s.reserve(numLen);
     for(int i = 0; i < numLen; i++)
     {
         s.push_back(i*(range.second - range.first)/numLen + range.first);
     }
+
+    return s;
+}
+
+
+/*!
+ * Creates a regular vertex grid from a given centre line and radius spline.
+ * This function loops over all given properties and for each property calls
+ * generatePropertyGrid().
+ */
+RegularVertexGrid
+MolecularPathObjExporter::generateGrid(
+        SplineCurve3D &centreLine,
+        SplineCurve1D &radius,
+        std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
+        const std::vector<real> &s,
+        size_t numPhi)
+{
+    // generate grid coordinates:
     std::vector<real> phi;
     phi.reserve(numPhi);
     for(size_t i = 0; i < numPhi; i++)
@@ -705,6 +793,160 @@ MolecularPathObjExporter::generateGrid(
 }
 
 
+/*!
+ * Determines the positions of vertex rings along the pathway adaptively. 
+ * Starting from a coarse, evenly spaced set of rings, the interval with the 
+ * largest error as determined by ringIntervalError() is bisected until either
+ * all errors are within tolerance or the next ring would exceed the vertex
+ * budget. Long, featureless sections of a pathway thus receive few rings, 
+ * while constrictions and regions of high curvature are resolved finely.
+ */
+std::vector<real>
+MolecularPathObjExporter::adaptiveRingPositions(
+        SplineCurve3D &centreLine,
+        SplineCurve1D &radius,
+        std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
+        std::pair<real, real> range)
+{
+    // coarse initial rings and maximum number of rings:
+    size_t numInit = (numLen_ - 1)/8 + 1;
+    size_t maxNumRings = std::max(maxNumVertices_/numPhi_, numInit);
+
+    // property ranges for normalisation:
+    std::vector<real> propertyRanges;
+    for(auto &prop : properties)
+    {
+        real lo = std::numeric_limits<real>::max();
+        real hi = -std::numeric_limits<real>::max();
+        for(size_t i = 0; i < numLen_; i++)
+        {
+            real value = prop.second.first.evaluate(
+                    range.first + i*(range.second - range.first)/(numLen_ - 1),
+                    0);
+            lo = std::min(lo, value);
+            hi = std::max(hi, value);
+        }
+        propertyRanges.push_back(hi - lo);
+    }
+
+    // queue of intervals ordered by error:
+    typedef std::pair<real, std::pair<real, real>> ErrorInterval;
+    std::priority_queue<ErrorInterval> intervals;
+    real ds = (range.second - range.first)/(numInit - 1);
+    for(size_t i = 0; i < numInit - 1; i++)
+    {
+        real sLo = range.first + i*ds;
+        real sHi = range.first + (i + 1)*ds;
+        intervals.push(ErrorInterval(
+                ringIntervalError(
+                        centreLine, radius, properties, propertyRanges,
+                        sLo, sHi),
+                std::make_pair(sLo, sHi)));
+    }
+
+    // bisect worst interval until tolerance or vertex budget is reached:
+    size_t numRings = numInit;
+    while( numRings < maxNumRings && intervals.top().first > 1.0 )
+    {
+        real sLo = intervals.top().second.first;
+        real sHi = intervals.top().second.second;
+        real sMid = 0.5*(sLo + sHi);
+        intervals.pop();
+
+        intervals.push(ErrorInterval(
+                ringIntervalError(
+                        centreLine, radius, properties, propertyRanges,
+                        sLo, sMid),
+                std::make_pair(sLo, sMid)));
+        intervals.push(ErrorInterval(
+                ringIntervalError(
+                        centreLine, radius, properties, propertyRanges,
+                        sMid, sHi),
+                std::make_pair(sMid, sHi)));
+        numRings++;
+    }
+
+    // ring positions are interval endpoints:
+    std::vector<real> s;
+    s.reserve(numRings);
+    s.push_back(range.second);
+    while( !intervals.empty() )
+    {
+        s.push_back(intervals.top().second.first);
+        intervals.pop();
+    }
+    std::sort(s.begin(), s.end());
+
+    return s;
+}
+
+
+/*!
+ * Estimates the error of representing the surface between two vertex rings 
+ * by linear interpolation. The centre line, radius, and all properties are 
+ * evaluated at the quarter points of the interval and compared to the linear
+ * interpolant between its endpoints. Geometric deviations are measured 
+ * relative to the adaptive tolerance and property deviations relative to the
+ * resolution of the colour scale times the range of the property, so that 
+ * values above one indicate that the interval should be refined.
+ */
+real
+MolecularPathObjExporter::ringIntervalError(
+        SplineCurve3D &centreLine,
+        SplineCurve1D &radius,
+        std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
+        const std::vector<real> &propertyRanges,
+        real sLo,
+        real sHi)
+{
+    // values at interval endpoints:
+    gmx::RVec centreLo = centreLine.evaluate(sLo, 0);
+    gmx::RVec centreHi = centreLine.evaluate(sHi, 0);
+    real radiusLo = radius.evaluate(sLo, 0);
+    real radiusHi = radius.evaluate(sHi, 0);
+
+    real error = 0.0;
+    for(real t : {0.25, 0.5, 0.75})
+    {
+        real eval = (1.0 - t)*sLo + t*sHi;
+
+        // deviation of centre line from chord (due to curvature):
+        gmx::RVec centre = centreLine.evaluate(eval, 0);
+        gmx::RVec chord;
+        for(int j = 0; j < DIM; j++)
+        {
+            chord[j] = centre[j] - (1.0 - t)*centreLo[j] - t*centreHi[j];
+        }
+        error = std::max(error, norm(chord)/adaptiveTolerance_);
+
+        // deviation of radius:
+        real rad = radius.evaluate(eval, 0);
+        real radDev = std::fabs(rad - (1.0 - t)*radiusLo - t*radiusHi);
+        error = std::max(error, radDev/adaptiveTolerance_);
+
+        // deviation of scalar properties:
+        size_t i = 0;
+        for(auto &prop : properties)
+        {
+            if( propertyRanges[i] > 0.0 )
+            {
+                SplineCurve1D &spl = prop.second.first;
+                real dev = std::fabs(
+                        spl.evaluate(eval, 0) - 
+                        (1.0 - t)*spl.evaluate(sLo, 0) - 
+                        t*spl.evaluate(sHi, 0));
+                error = std::max(
+                        error, 
+                        dev/(colourTolerance_*propertyRanges[i]));
+            }
+            i++;
+        }
+    }
+
+    return error;
+}
+
+
 /*!
  * This function creates the actual vertices used in the RegularVertexGrid and
  * calculates the colour property by sampling the given spline curve at the
@@ -729,19 +971,17 @@ MolecularPathObjExporter::generatePropertyGrid(
     size_t numLen = s.size();
 
     // sample points, radii, and tangents along molecular path:
-    std::vector<gmx::RVec> centres;
-    centres.reserve(s.size());
-    std::vector<gmx::RVec> tangents;
-    tangents.reserve(s.size());
-    std::vector<real> radii;
-    radii.reserve(s.size());
-    for(auto eval : s)
+    std::vector<gmx::RVec> centres(s.size());
+    std::vector<gmx::RVec> tangents(s.size());
+    std::vector<real> radii(s.size());
+    #pragma omp parallel for
+    for(size_t i = 0; i < s.size(); i++)
     {
-        centres.push_back( centreLine.evaluate(eval, 0) );
-        gmx::RVec tv = centreLine.tangentVec(eval);
+        centres[i] = centreLine.evaluate(s[i], 0);
+        gmx::RVec tv = centreLine.tangentVec(s[i]);
         unitv(tv, tv);
-        tangents.push_back(tv);
-        radii.push_back( radius.evaluate(eval, 0) );
+        tangents[i] = tv;
+        radii[i] = radius.evaluate(s[i], 0);
     }
 
     // sample normals along molecular path:
@@ -753,80 +993,54 @@ MolecularPathObjExporter::generatePropertyGrid(
     // calculate sample points on pathway:
     // ------------------------------------------------------------------------
 
-    // ring of vertices for each pathway coordinate:
-    std::vector<gmx::RVec> vertRing(phi.size());
-    std::map<int, std::vector<gmx::RVec>> vertexRings;
-    
-    // first vertex ring:
-    int idxLen = 0;
-    for(size_t k = 0; k < phi.size(); k++)
+    // first and last ring followed by intermediate rings in bisection order:
+    // (each ring only depends on the sampled centre line, so that all rings 
+    // can be built independently of each other)
+    int numInt = numLen - 1;
+    std::vector<std::array<int, 3>> ringIndices;
+    ringIndices.push_back({0, 0, 0});
+    ringIndices.push_back({numInt, numInt, numInt});
+    for(int i = 1; i <= numLen; i *= 2)
     {
-        // rotate normal vector:
-        gmx::RVec rotNormal = rotateAboutAxis(
-                normals[idxLen], 
-                tangents[idxLen],
-                phi[k]);
-
-        // generate vertex:
-        gmx::RVec vertex = centres[idxLen];
-        vertex[XX] += radii[idxLen]*rotNormal[XX];
-        vertex[YY] += radii[idxLen]*rotNormal[YY];
-        vertex[ZZ] += radii[idxLen]*rotNormal[ZZ];
-
-        // add to vertex ring:
-        vertRing[k] = vertex;
+        for(int j = 1; j < i; j += 2)
+        {
+            ringIndices.push_back({j*numInt/i,
+                                   (j - 1)*numInt/i,
+                                   (j + 1)*numInt/i});
+        }
     }
-    vertexRings[idxLen] = vertRing;
 
-    // last vertex ring:
-    idxLen = s.size() - 1;
-    for(size_t k = 0; k < phi.size(); k++)
+    // build vertex rings in parallel:
+    std::vector<std::vector<gmx::RVec>> rings(
+            ringIndices.size(), 
+            std::vector<gmx::RVec>(phi.size()));
+    std::vector<char> hasClashes(ringIndices.size(), 0);
+    #pragma omp parallel for schedule(dynamic, 8)
+    for(size_t r = 0; r < ringIndices.size(); r++)
     {
-        // rotate normal vector:
-        gmx::RVec rotNormal = rotateAboutAxis(
-                normals[idxLen], 
-                tangents[idxLen],
-                phi[k]);
-
-        // generate vertex:
-        gmx::RVec vertex = centres[idxLen];
-        vertex[XX] += radii[idxLen]*rotNormal[XX];
-        vertex[YY] += radii[idxLen]*rotNormal[YY];
-        vertex[ZZ] += radii[idxLen]*rotNormal[ZZ];
-
-        // add to vertex ring:
-        vertRing[k] = vertex;
-    }
-    vertexRings[idxLen] = vertRing;
-
+        int idxLen = ringIndices[r][0];
+        int idxLower = ringIndices[r][1];
+        int idxUpper = ringIndices[r][2];
+        bool checkClashes = r > 1;
 
-    // build intermediate vertex rings:    
-    for(int i = 1; i <= numLen; i *= 2)
-    {
-        for(int j = 1; j < i; j += 2)
+        // create ring of vertices:
+        for(size_t k = 0; k < phi.size(); k++)
         {
-            idxLen = j*(numLen - 1)/i;
-            int idxLower = (j - 1)*(numLen - 1)/i;
-            int idxUpper = (j + 1)*(numLen - 1)/i;
-
-            // create ring of vertices:
-            bool hasClashes = false;
-            for(size_t k = 0; k < phi.size(); k ++)
+            // rotate normal vector:
+            gmx::RVec rotNormal = rotateAboutAxis(
+                    normals[idxLen], 
+                    tangents[idxLen],
+                    phi[k]);
+
+            // generate vertex:
+            gmx::RVec vertex = centres[idxLen];
+            vertex[XX] += radii[idxLen]*rotNormal[XX];
+            vertex[YY] += radii[idxLen]*rotNormal[YY];
+            vertex[ZZ] += radii[idxLen]*rotNormal[ZZ];
+
+            // first and last ring are never checked for clashes:
+            if( checkClashes )
             {
-                // rotate normal vector:
-                gmx::RVec rotNormal = rotateAboutAxis(
-                        normals[idxLen], 
-                        tangents[idxLen],
-                        phi[k]);
-
-                // generate vertex:
-                gmx::RVec vertex = centres[idxLen];
-                vertex[XX] += radii[idxLen]*rotNormal[XX];
-                vertex[YY] += radii[idxLen]*rotNormal[YY];
-                vertex[ZZ] += radii[idxLen]*rotNormal[ZZ];
-
-                // TODO: the below goes in separate function?
-
                 // difference vectors in neighbouring discs:
                 gmx::RVec a;
                 rvec_sub(vertex, centres[idxLower], a);
@@ -844,20 +1058,23 @@ MolecularPathObjExporter::generatePropertyGrid(
                     cosB > -correctionThreshold_ )
                 {
                     // set crash flag to true and terminate loop:
-                    hasClashes = true;
+                    hasClashes[r] = 1;
                     break;
                 }
-
-                // add to vertex ring:
-                vertRing[k] = vertex;
-            }
-   
-            // will ignore all vertex rings with clashes:
-            if( !hasClashes )
-            {
-                vertexRings[idxLen] = vertRing;
             }
-            hasClashes = false;
+
+            // add to vertex ring:
+            rings[r][k] = vertex;
+        }
+    }
+
+    // will ignore all vertex rings with clashes:
+    std::map<int, std::vector<gmx::RVec>> vertexRings;
+    for(size_t r = 0; r < ringIndices.size(); r++)
+    {
+        if( !hasClashes[r] )
+        {
+            vertexRings[ringIndices[r][0]] = std::move(rings[r]);
         }
     }
 
@@ -866,7 +1083,8 @@ MolecularPathObjExporter::generatePropertyGrid(
     // ------------------------------------------------------------------------
 
     // interpolate support points on each equal-phi line:
-    std::vector<SplineCurve3D> curves;
+    std::vector<SplineCurve3D> curves(phi.size());
+    #pragma omp parallel for
     for(size_t k = 0; k < phi.size(); k++)
     {
         // extract support points and parameterisation for interpolation:
@@ -883,7 +1101,7 @@ MolecularPathObjExporter::generatePropertyGrid(
 
         // interpolate these points:
         CubicSplineInterp3D interp;
-        curves.push_back( interp(param, points, eSplineInterpBoundaryHermite) );
+        curves[k] = interp(param, points, eSplineInterpBoundaryHermite);
     }
 
 
@@ -899,7 +1117,21 @@ MolecularPathObjExporter::generatePropertyGrid(
     }
     shiftAndScale(prop, property.second.second);
 
+    // evaluate vertex positions on each ring in parallel:
+    std::vector<gmx::RVec> vertices(grid.s_.size()*grid.phi_.size());
+    #pragma omp parallel for
+    for(size_t i = 0; i < grid.s_.size(); i++)
+    {
+        for(size_t k = 0; k < grid.phi_.size(); k++)
+        {
+            vertices[i*grid.phi_.size() + k] = curves[k].evaluate(
+                    grid.s_[i], 
+                    0);
+        }
+    }
+
     // loop over target grid coordinates and add vertices:
+    size_t propIdx = grid.addProperty(property.first);
     for(size_t i = 0; i < grid.s_.size(); i++)
     {
         for(size_t k = 0; k < grid.phi_.size(); k++)
@@ -907,8 +1139,8 @@ MolecularPathObjExporter::generatePropertyGrid(
             grid.addVertex(
                     i, 
                     k, 
-                    property.first, 
-                    curves[k].evaluate(grid.s_[i], 0),
+                    propIdx,
+                    vertices[i*grid.phi_.size() + k],
                     prop[i]);
         }
     }
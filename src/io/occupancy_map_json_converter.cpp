@@ -0,0 +1,148 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "io/occupancy_map_json_converter.hpp"
+
+
+/*!
+ * Converts the given OccupancyMap to a JSON object containing a dense grid
+ * of counts spanning all visited bins.
+ */
+rapidjson::Value
+OccupancyMapJsonConverter::convert(
+        const OccupancyMap &map,
+        rapidjson::Document::AllocatorType &alloc)
+{
+    // find range of visited bins:
+    int loX = 0;
+    int loY = 0;
+    int numX = 0;
+    int numY = 0;
+    if( !map.empty() )
+    {
+        loX = map.counts().begin() -> first.first;
+        int hiX = map.counts().rbegin() -> first.first;
+        loY = std::numeric_limits<int>::max();
+        int hiY = std::numeric_limits<int>::min();
+        for(auto &bin : map.counts())
+        {
+            loY = std::min(loY, bin.first.second);
+            hiY = std::max(hiY, bin.first.second);
+        }
+        numX = hiX - loX + 1;
+        numY = hiY - loY + 1;
+    }
+
+    // fill dense grid in row-major order:
+    std::vector<unsigned long> grid(numX*numY, 0);
+    for(auto &bin : map.counts())
+    {
+        grid.at((bin.first.first - loX)*numY + bin.first.second - loY) = 
+                bin.second;
+    }
+    rapidjson::Value counts(rapidjson::kArrayType);
+    counts.Reserve(grid.size(), alloc);
+    for(auto c : grid)
+    {
+        counts.PushBack(static_cast<uint64_t>(c), alloc);
+    }
+
+    // assemble JSON object:
+    rapidjson::Value obj(rapidjson::kObjectType);
+    obj.AddMember("numFrames", static_cast<uint64_t>(map.numFrames()), alloc);
+    rapidjson::Value binWidth(rapidjson::kArrayType);
+    binWidth.PushBack(map.binWidthX(), alloc);
+    binWidth.PushBack(map.binWidthY(), alloc);
+    obj.AddMember("binWidth", binWidth, alloc);
+    rapidjson::Value binLo(rapidjson::kArrayType);
+    binLo.PushBack(loX, alloc);
+    binLo.PushBack(loY, alloc);
+    obj.AddMember("binLo", binLo, alloc);
+    rapidjson::Value shape(rapidjson::kArrayType);
+    shape.PushBack(numX, alloc);
+    shape.PushBack(numY, alloc);
+    obj.AddMember("shape", shape, alloc);
+    obj.AddMember("counts", counts, alloc);
+
+    // return object:
+    return obj;
+}
+
+
+/*!
+ * Restores an OccupancyMap from a JSON object created by convert().
+ */
+OccupancyMap
+OccupancyMapJsonConverter::fromJson(
+        const rapidjson::Value &obj)
+{
+    // sanity checks:
+    if( !obj.IsObject() ||
+        !obj.HasMember("numFrames") ||
+        !obj.HasMember("binWidth") ||
+        !obj.HasMember("binLo") ||
+        !obj.HasMember("shape") ||
+        !obj.HasMember("counts") )
+    {
+        throw std::runtime_error("Invalid occupancy map.");
+    }
+    int loX = obj["binLo"][0].GetInt();
+    int loY = obj["binLo"][1].GetInt();
+    int numX = obj["shape"][0].GetInt();
+    int numY = obj["shape"][1].GetInt();
+    const rapidjson::Value &counts = obj["counts"];
+    if( !counts.IsArray() || 
+        counts.Size() != static_cast<rapidjson::SizeType>(numX*numY) )
+    {
+        throw std::runtime_error("Number of counts in occupancy map does not "
+                                 "match its shape.");
+    }
+
+    // a map without bin widths was never filled:
+    real binWidthX = obj["binWidth"][0].GetDouble();
+    real binWidthY = obj["binWidth"][1].GetDouble();
+    OccupancyMap map;
+    if( binWidthX > 0.0 && binWidthY > 0.0 )
+    {
+        map = OccupancyMap(binWidthX, binWidthY);
+    }
+    map.addFrames(obj["numFrames"].GetUint64());
+
+    // add nonzero counts:
+    for(int i = 0; i < numX; i++)
+    {
+        for(int j = 0; j < numY; j++)
+        {
+            map.addCount(loX + i, loY + j, counts[i*numY + j].GetUint64());
+        }
+    }
+
+    return map;
+}
+
@@ -51,6 +51,33 @@ PdbStructure::fromTopology(
 }
 
 
+/*!
+ * Creates a PdbStructure from a structure file in any format readable by 
+ * Gromacs, e.g. from a PDB file previously written by CHAP. This is used to
+ * annotate a structure when no topology is available. As with 
+ * fromTopology(), the atom data is not copied, hence the topology read here
+ * is intentionally kept alive.
+ */
+void
+PdbStructure::fromFile(
+        const std::string &fileName)
+{
+    // read structure and coordinates:
+    t_topology *topol = new t_topology;
+    read_tps_conf(
+            fileName.c_str(),       // structure file name
+            topol,                  // topology to fill
+            &ePBC_,                 // periodic BC
+            &coords_,               // atom coordinates
+            nullptr,                // velocities are not needed
+            box_,                   // box matrix
+            false);                 // masses are not needed
+
+    // retrieve list of atoms in structure:
+    atoms_ = topol -> atoms;
+}
+
+
 /*!
  * Sets the occupancy and bfac fields of the PDB file to the time averaged 
  * pore-lining and pore-facing attributes.
@@ -0,0 +1,222 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "io/binary_io.hpp"
+#include "io/ply_io.hpp"
+
+
+/*!
+ * Adds vertices to the mesh.
+ */
+void
+PlyMesh::addVertices(
+        const std::vector<gmx::RVec> &vertices)
+{
+    vertices_.insert(vertices_.end(), vertices.begin(), vertices.end());
+}
+
+
+/*!
+ * Adds vertex normals to the mesh. There must be one normal per vertex.
+ */
+void
+PlyMesh::addVertexNormals(
+        const std::vector<gmx::RVec> &normals)
+{
+    normals_.insert(normals_.end(), normals.begin(), normals.end());
+}
+
+
+/*!
+ * Adds a named scalar property with one value per vertex.
+ */
+void
+PlyMesh::addVertexProperty(
+        const std::string &name,
+        const std::vector<real> &values)
+{
+    properties_.push_back(std::make_pair(name, values));
+}
+
+
+/*!
+ * Adds a triangular face given by three zero-based vertex indices.
+ */
+void
+PlyMesh::addFace(
+        const std::array<int, 3> &face)
+{
+    faces_.push_back(face);
+}
+
+
+/*!
+ * Returns a flag indicating if the mesh is valid, i.e. whether there is 
+ * either no normal or one normal per vertex, each property has one value per 
+ * vertex, and all faces reference existing vertices.
+ */
+bool
+PlyMesh::valid() const
+{
+    // one normal per vertex:
+    if( !normals_.empty() && normals_.size() != vertices_.size() )
+    {
+        return false;
+    }
+
+    // one property value per vertex:
+    for(auto &prop : properties_)
+    {
+        if( prop.second.size() != vertices_.size() )
+        {
+            return false;
+        }
+    }
+
+    // are all referenced vertices present?
+    for(auto &face : faces_)
+    {
+        for(auto idx : face)
+        {
+            if( idx < 0 || idx >= static_cast<int>(vertices_.size()) )
+            {
+                return false;
+            }
+        }
+    }
+
+    // if nothing failed, return true:
+    return true;
+}
+
+
+/*!
+ * Scales all vertex positions by the given factor. As in 
+ * WavefrontObjObject::scale(), the centre of geometry is scaled along with 
+ * the mesh, so that this amounts to a scaling of all positions about the 
+ * origin (e.g. to convert from nm to Ang).
+ */
+void
+PlyMesh::scale(real fac)
+{
+    for(auto &vert : vertices_)
+    {
+        svmul(fac, vert, vert);
+    }
+}
+
+
+/*!
+ * Writes a mesh to a binary PLY file of the given name.
+ */
+void
+PlyExporter::write(
+        const std::string &fileName,
+        const PlyMesh &mesh)
+{
+    // sanity checks:
+    if( !mesh.valid() )
+    {
+        throw std::logic_error("PlyExporter encountered invalid mesh.");
+    }
+
+    // open file stream:
+    ply_.open(fileName.c_str(), std::fstream::out | std::fstream::binary);
+
+    // write plain text header:
+    writeHeader(mesh);
+
+    // write vertex data:
+    for(size_t i = 0; i < mesh.vertices_.size(); i++)
+    {
+        for(int j = 0; j < DIM; j++)
+        {
+            writeLittleEndian(ply_, static_cast<float>(mesh.vertices_[i][j]));
+        }
+        if( !mesh.normals_.empty() )
+        {
+            for(int j = 0; j < DIM; j++)
+            {
+                writeLittleEndian(ply_, static_cast<float>(mesh.normals_[i][j]));
+            }
+        }
+        for(auto &prop : mesh.properties_)
+        {
+            writeLittleEndian(ply_, static_cast<float>(prop.second[i]));
+        }
+    }
+
+    // write face data:
+    for(auto &face : mesh.faces_)
+    {
+        writeLittleEndian(ply_, static_cast<uint8_t>(face.size()));
+        for(auto idx : face)
+        {
+            writeLittleEndian(ply_, static_cast<int32_t>(idx));
+        }
+    }
+
+    // close file stream:
+    ply_.close();
+    if( ply_.fail() )
+    {
+        throw std::runtime_error("Could not write PLY file " + fileName + ".");
+    }
+}
+
+
+/*!
+ * Writes the plain text PLY header describing vertex and face elements.
+ */
+void
+PlyExporter::writeHeader(const PlyMesh &mesh)
+{
+    ply_<<"ply\n";
+    ply_<<"format binary_little_endian 1.0\n";
+    ply_<<"comment produced by CHAP\n";
+
+    // vertex element:
+    ply_<<"element vertex "<<mesh.vertices_.size()<<"\n";
+    ply_<<"property float x\n";
+    ply_<<"property float y\n";
+    ply_<<"property float z\n";
+    if( !mesh.normals_.empty() )
+    {
+        ply_<<"property float nx\n";
+        ply_<<"property float ny\n";
+        ply_<<"property float nz\n";
+    }
+    for(auto &prop : mesh.properties_)
+    {
+        ply_<<"property float "<<prop.first<<"\n";
+    }
+
+    // face element:
+    ply_<<"element face "<<mesh.faces_.size()<<"\n";
+    ply_<<"property list uchar int vertex_indices\n";
+    ply_<<"end_header\n";
+}
+
@@ -31,6 +31,7 @@
 #include "config/config.hpp"
 #include "config/version.hpp"
 
+#include "io/occupancy_map_json_converter.hpp"
 #include "io/results_json_exporter.hpp"
 #include "io/summary_statistics_json_converter.hpp"
 #include "io/summary_statistics_vector_json_converter.hpp"
@@ -78,6 +79,11 @@ ResultsJsonExporter::ResultsJsonExporter()
     rapidjson::Value residueSummary;
     residueSummary.SetObject();
     doc_.AddMember("residueSummary", residueSummary, alloc);
+
+    // create a solvent occupancy object:
+    rapidjson::Value solventOccupancy;
+    solventOccupancy.SetObject();
+    doc_.AddMember("solventOccupancy", solventOccupancy, alloc);
 }
 
 
@@ -384,6 +390,68 @@ ResultsJsonExporter::addResidueSummary(
 }
 
 
+/*!
+ * Adds a two-dimensional occupancy map of solvent particles to the output 
+ * document. The map is written as a dense grid of counts, see 
+ * OccupancyMapJsonConverter.
+ */
+void
+ResultsJsonExporter::addOccupancyMap(
+        std::string name,
+        const OccupancyMap &map)
+{
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // convert occupancy map:
+    rapidjson::Value mapObj = OccupancyMapJsonConverter::convert(map, alloc);
+
+    // add to output document:
+    doc_["solventOccupancy"].AddMember(toVal(name), mapObj, alloc);
+}
+
+
+/*!
+ * Adds the results of an individual replicate to the output document. All 
+ * data contained in the replicate's document except for the reproducibility
+ * information is copied into a new element of the replicates array, which is
+ * created upon the first call to this function.
+ */
+void
+ResultsJsonExporter::addReplicate(
+        const ResultsJsonExporter &replicate)
+{
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // create replicates array if necessary:
+    if( !doc_.HasMember("replicates") )
+    {
+        rapidjson::Value replicates(rapidjson::kArrayType);
+        doc_.AddMember("replicates", replicates, alloc);
+    }
+
+    // copy all results data of replicate:
+    rapidjson::Value rep(rapidjson::kObjectType);
+    for(auto it = replicate.doc_.MemberBegin(); 
+        it != replicate.doc_.MemberEnd(); 
+        it++)
+    {
+        if( it -> name == "reproducibilityInformation" )
+        {
+            continue;
+        }
+
+        rapidjson::Value name(it -> name, alloc);
+        rapidjson::Value value(it -> value, alloc);
+        rep.AddMember(name, value, alloc);
+    }
+
+    // add to output document:
+    doc_["replicates"].PushBack(rep, alloc);
+}
+
+
 /*!
  * Writes the JSON document to a file of the given name.
  */
@@ -22,6 +22,8 @@
 // THE SOFTWARE.
 
 
+#include <stdexcept>
+
 #include "io/summary_statistics_json_converter.hpp"
 
 
@@ -63,3 +65,53 @@ SummaryStatisticsJsonConverter::convert(
     return sumStatsObject;
 }
 
+
+/*!
+ * Converts the internal state of the given SummaryStatistics object to a JSON
+ * object from which it can be restored exactly using fromState().
+ */
+rapidjson::Value
+SummaryStatisticsJsonConverter::convertState(
+        const SummaryStatistics &sumStats,
+        rapidjson::Document::AllocatorType &alloc)
+{
+    rapidjson::Value stateObject;
+    stateObject.SetObject();
+    stateObject.AddMember("num", sumStats.num(), alloc);
+    stateObject.AddMember("min", sumStats.min(), alloc);
+    stateObject.AddMember("max", sumStats.max(), alloc);
+    stateObject.AddMember("mean", sumStats.mean(), alloc);
+    stateObject.AddMember(
+            "sumSquaredMeanDiff", 
+            sumStats.sumSquaredMeanDiff(), 
+            alloc);
+    return stateObject;
+}
+
+
+/*!
+ * Restores a SummaryStatistics object from a JSON object created by
+ * convertState().
+ */
+SummaryStatistics
+SummaryStatisticsJsonConverter::fromState(
+        const rapidjson::Value &state)
+{
+    // sanity checks:
+    if( !state.IsObject() || 
+        !state.HasMember("num") || 
+        !state.HasMember("min") ||
+        !state.HasMember("max") || 
+        !state.HasMember("mean") ||
+        !state.HasMember("sumSquaredMeanDiff") )
+    {
+        throw std::runtime_error("Invalid summary statistics state.");
+    }
+
+    return SummaryStatistics(
+            state["min"].GetDouble(),
+            state["max"].GetDouble(),
+            state["mean"].GetDouble(),
+            state["sumSquaredMeanDiff"].GetDouble(),
+            state["num"].GetInt());
+}
@@ -25,6 +25,7 @@
 #include "io/summary_statistics_vector_json_converter.hpp"
 
 #include <iostream>
+#include <stdexcept>
 
 /*!
  * Converts given vector of summary statistics into JSON object.
@@ -61,3 +62,86 @@ SummaryStatisticsVectorJsonConverter::convert(
     return sumStatsObject;
 }
 
+
+/*!
+ * Converts the internal state of each element of the given vector of summary
+ * statistics into a JSON object of arrays, from which the vector can be
+ * restored exactly using fromState().
+ */
+rapidjson::Value
+SummaryStatisticsVectorJsonConverter::convertState(
+        const std::vector<SummaryStatistics> &sumStats,
+        rapidjson::Document::AllocatorType &alloc)
+{
+    // build arrays for each state variable:
+    rapidjson::Value num(rapidjson::kArrayType);
+    rapidjson::Value min(rapidjson::kArrayType);
+    rapidjson::Value max(rapidjson::kArrayType);
+    rapidjson::Value mean(rapidjson::kArrayType);
+    rapidjson::Value sumSquaredMeanDiff(rapidjson::kArrayType);
+    for(auto &sumStat : sumStats)
+    {
+        num.PushBack(sumStat.num(), alloc);
+        min.PushBack(sumStat.min(), alloc);
+        max.PushBack(sumStat.max(), alloc);
+        mean.PushBack(sumStat.mean(), alloc);
+        sumSquaredMeanDiff.PushBack(sumStat.sumSquaredMeanDiff(), alloc);
+    }
+
+    // add arrays to JSON object and return:
+    rapidjson::Value stateObject;
+    stateObject.SetObject();
+    stateObject.AddMember("num", num, alloc);
+    stateObject.AddMember("min", min, alloc);
+    stateObject.AddMember("max", max, alloc);
+    stateObject.AddMember("mean", mean, alloc);
+    stateObject.AddMember("sumSquaredMeanDiff", sumSquaredMeanDiff, alloc);
+    return stateObject;
+}
+
+
+/*!
+ * Restores a vector of summary statistics from a JSON object created by 
+ * convertState().
+ */
+std::vector<SummaryStatistics>
+SummaryStatisticsVectorJsonConverter::fromState(
+        const rapidjson::Value &state)
+{
+    // sanity checks:
+    if( !state.IsObject() || 
+        !state.HasMember("num") || 
+        !state.HasMember("min") ||
+        !state.HasMember("max") || 
+        !state.HasMember("mean") ||
+        !state.HasMember("sumSquaredMeanDiff") )
+    {
+        throw std::runtime_error("Invalid summary statistics state.");
+    }
+    const rapidjson::Value &num = state["num"];
+    const rapidjson::Value &min = state["min"];
+    const rapidjson::Value &max = state["max"];
+    const rapidjson::Value &mean = state["mean"];
+    const rapidjson::Value &sumSquaredMeanDiff = state["sumSquaredMeanDiff"];
+    if( min.Size() != num.Size() || max.Size() != num.Size() ||
+        mean.Size() != num.Size() || sumSquaredMeanDiff.Size() != num.Size() )
+    {
+        throw std::runtime_error("Summary statistics state arrays must have "
+                                 "equal length.");
+    }
+
+    // restore individual summary statistics:
+    std::vector<SummaryStatistics> sumStats;
+    sumStats.reserve(num.Size());
+    for(rapidjson::SizeType i = 0; i < num.Size(); i++)
+    {
+        sumStats.push_back(SummaryStatistics(
+                min[i].GetDouble(),
+                max[i].GetDouble(),
+                mean[i].GetDouble(),
+                sumSquaredMeanDiff[i].GetDouble(),
+                num[i].GetInt()));
+    }
+
+    return sumStats;
+}
@@ -84,7 +84,7 @@ WavefrontMtlObject::addMaterial(WavefrontMtlMaterial material)
 void
 WavefrontMtlExporter::write(std::string fileName, WavefrontMtlObject object)
 {
-    file_.open(fileName.c_str(), std::fstream::out);
+    file_.open(fileName);
     
     // loop over materials:
     for(auto material : object.materials_)
@@ -106,7 +106,7 @@ WavefrontMtlExporter::write(std::string fileName, WavefrontMtlObject object)
 void
 WavefrontMtlExporter::writeMaterialName(std::string name)
 {
-    file_<<"newmtl "<<name<<std::endl;
+    file_<<"newmtl "<<name<<'\n';
 }
 
 
@@ -116,7 +116,7 @@ WavefrontMtlExporter::writeMaterialName(std::string name)
 void
 WavefrontMtlExporter::writeAmbientColour(const gmx::RVec &col)
 {
-    file_<<"Ka "<<col[XX]<<" "<<col[YY]<<" "<<col[ZZ]<<std::endl;
+    file_<<"Ka "<<col[XX]<<" "<<col[YY]<<" "<<col[ZZ]<<'\n';
 }
 
 
@@ -126,7 +126,7 @@ WavefrontMtlExporter::writeAmbientColour(const gmx::RVec &col)
 void
 WavefrontMtlExporter::writeDiffuseColour(const gmx::RVec &col)
 {
-    file_<<"Kd "<<col[XX]<<" "<<col[YY]<<" "<<col[ZZ]<<std::endl;
+    file_<<"Kd "<<col[XX]<<" "<<col[YY]<<" "<<col[ZZ]<<'\n';
 }
 
 
@@ -136,6 +136,6 @@ WavefrontMtlExporter::writeDiffuseColour(const gmx::RVec &col)
 void
 WavefrontMtlExporter::writeSpecularColour(const gmx::RVec &col)
 {
-    file_<<"Ks "<<col[XX]<<" "<<col[YY]<<" "<<col[ZZ]<<std::endl;
+    file_<<"Ks "<<col[XX]<<" "<<col[YY]<<" "<<col[ZZ]<<'\n';
 }
 
@@ -360,7 +360,7 @@ WavefrontObjExporter::write(std::string fileName,
     }
 
     // open file stream:
-    obj_.open(fileName.c_str(), std::fstream::out);
+    obj_.open(fileName);
 
     // writer header comment:
     writeComment("produced by CHAP");
@@ -372,14 +372,14 @@ WavefrontObjExporter::write(std::string fileName,
     writeObject(object.name_);
 
     // write vertices:
-    obj_<<std::endl;
+    obj_<<'\n';
     for(unsigned int i = 0; i < object.vertices_.size(); i++)
     {
         writeVertex(object.vertices_[i]);
     }
 
     // write vertex normals:
-    obj_<<std::endl;
+    obj_<<'\n';
     for(unsigned int i = 0; i < object.normals_.size(); i++)
     {
         writeVertexNormal(object.normals_[i]);
@@ -410,7 +410,7 @@ WavefrontObjExporter::write(std::string fileName,
 void
 WavefrontObjExporter::writeComment(std::string comment)
 {
-    obj_ <<"# "<<comment<<std::endl;
+    obj_ <<"# "<<comment<<'\n';
 }
 
 
@@ -423,7 +423,7 @@ WavefrontObjExporter::writeMaterialLibrary(std::string mtl)
     // library set?
     if( mtl != "" )
     {
-        obj_<<"mtllib "<<mtl<<std::endl;
+        obj_<<"mtllib "<<mtl<<'\n';
     }
 }
 
@@ -434,8 +434,8 @@ WavefrontObjExporter::writeMaterialLibrary(std::string mtl)
 void
 WavefrontObjExporter::writeGroup(std::string group)
 {
-    obj_ <<std::endl;
-    obj_ <<"g "<<group<<std::endl;
+    obj_ <<'\n';
+    obj_ <<"g "<<group<<'\n';
 }
 
 
@@ -445,8 +445,8 @@ WavefrontObjExporter::writeGroup(std::string group)
 void
 WavefrontObjExporter::writeObject(std::string object)
 {
-    obj_ <<std::endl;
-    obj_ <<"o "<<object<<std::endl;
+    obj_ <<'\n';
+    obj_ <<"o "<<object<<'\n';
 }
 
 
@@ -459,7 +459,7 @@ WavefrontObjExporter::writeVertex(std::pair<gmx::RVec, real> vertex)
     obj_<<"v "<<vertex.first[XX]<<" "
               <<vertex.first[YY]<<" "
               <<vertex.first[ZZ]<<" "
-              <<vertex.second<<std::endl;
+              <<vertex.second<<'\n';
 }
 
 
@@ -471,7 +471,7 @@ WavefrontObjExporter::writeVertexNormal(gmx::RVec norm)
 {
     obj_<<"vn "<<norm[XX]<<" "
                <<norm[YY]<<" "
-               <<norm[ZZ]<<std::endl;
+               <<norm[ZZ]<<'\n';
 }
 
 
@@ -488,7 +488,7 @@ WavefrontObjExporter::writeFace(const WavefrontObjFace &face)
         if( face.mtlName_ != crntMtlName_ )
         {
             crntMtlName_ = face.mtlName_;
-            obj_<<"usemtl "<<face.mtlName_<<std::endl;
+            obj_<<"usemtl "<<face.mtlName_<<'\n';
         }
     }
 
@@ -507,6 +507,6 @@ WavefrontObjExporter::writeFace(const WavefrontObjFace &face)
         obj_<<" ";
     }
 
-    obj_<<std::endl;
+    obj_<<'\n';
 }
 
@@ -0,0 +1,324 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <iostream>
+
+#include "optim/fixed_nelder_mead_module.hpp"
+
+
+/*!
+ * Constructor. Creates a FixedNelderMeadModule object with default values for
+ * all optional parameters.
+ */
+template<int D>
+FixedNelderMeadModule<D>::FixedNelderMeadModule()
+    : maxIter_(0)
+    , initShiftFac_(0.0)
+    , simplexTol_(0.0)
+    , valueTol_(0.0)
+    , contractionPar_(0.5)
+    , expansionPar_(2.0)
+    , reflectionPar_(1.0)
+    , shrinkagePar_(0.5)
+    , numIter_(0)
+{
+
+}
+
+
+/*!
+ * Setter function for parameters. Recognises the same parameters as 
+ * NelderMeadModule::setParams(), i.e. nmMaxIter and nmInitShift (both 
+ * required) as well as nmContractionPar, nmExpansionPar, nmReflectionPar, 
+ * nmShrinkagePar, nmSimplexTol, and nmValueTol.
+ */
+template<int D>
+void
+FixedNelderMeadModule<D>::setParams(std::map<std::string, real> params)
+{
+    // number of iterations:
+    if( params.find("nmMaxIter") != params.end() )
+    {
+        maxIter_ = params["nmMaxIter"];
+    }
+    else
+    {
+        std::cerr<<"ERROR: Maximum number of Nelder-Mead iterations not specified!"<<std::endl;
+        std::abort();
+    }
+
+    // shift factor:
+    if( params.find("nmInitShift") != params.end() )
+    {
+        initShiftFac_ = params["nmInitShift"];
+    }
+    else
+    {
+        std::cerr<<"ERROR: Shift factor for initial vertex generation not specified!"<<std::endl;
+        std::abort();
+    }
+
+    // optional parameters:
+    if( params.find("nmContractionPar") != params.end() )
+    {
+        contractionPar_ = params["nmContractionPar"];
+    }
+    if( params.find("nmExpansionPar") != params.end() )
+    {
+        expansionPar_ = params["nmExpansionPar"];
+    }
+    if( params.find("nmReflectionPar") != params.end() )
+    {
+        reflectionPar_ = params["nmReflectionPar"];
+    }
+    if( params.find("nmShrinkagePar") != params.end() )
+    {
+        shrinkagePar_ = params["nmShrinkagePar"];
+    }
+    if( params.find("nmSimplexTol") != params.end() )
+    {
+        simplexTol_ = params["nmSimplexTol"];
+    }
+    if( params.find("nmValueTol") != params.end() )
+    {
+        valueTol_ = params["nmValueTol"];
+    }
+}
+
+
+/*!
+ * Sets the objective function to be maximised.
+ */
+template<int D>
+void
+FixedNelderMeadModule<D>::setObjFun(FixedObjectiveFunction<D> objFun)
+{
+    objFun_ = objFun;
+}
+
+
+/*!
+ * Creates the initial simplex from one guess point by perturbing each of its
+ * coordinates in turn by the initial shift (see 
+ * NelderMeadModule::setInitGuess()). The objective function is not evaluated
+ * at any vertex.
+ */
+template<int D>
+void
+FixedNelderMeadModule<D>::setInitGuess(const std::array<real, D> &guess)
+{
+    for(int i = 0; i < D + 1; i++)
+    {
+        simplex_[i].first = guess;
+        if( i > 0 )
+        {
+            simplex_[i].first[i - 1] += initShiftFac_;
+        }
+    }
+}
+
+
+/*!
+ * Performs the Nelder-Mead optimisation loop. Should only be called once
+ * parameters, objective function, and initial point have been set. The loop
+ * terminates early once the simplex has converged.
+ */
+template<int D>
+void
+FixedNelderMeadModule<D>::optimise()
+{
+    // evaluate objective function at all vertices:
+    for(auto &vert : simplex_)
+    {
+        vert.second = objFun_(vert.first);
+    }
+    sortSimplex();
+
+    // Nelder-Mead main loop:
+    for(numIter_ = 0; numIter_ < maxIter_; numIter_++)
+    {
+        // has simplex converged:
+        if( isConverged() )
+        {
+            break;
+        }
+
+        // recalculate centroid:
+        calcCentroid();
+
+        // calculate the reflected point:
+        FixedOptimSpacePoint<D> reflectedPoint = centroid_;
+        reflectedPoint.scale(1.0 + reflectionPar_);
+        reflectedPoint.addScaled(simplex_.front(), -reflectionPar_);
+        reflectedPoint.second = objFun_(reflectedPoint.first);
+
+        // reflected point better than second worst?
+        if( simplex_[1].second < reflectedPoint.second )
+        {
+            // reflected point better than best?
+            if( simplex_.back().second < reflectedPoint.second )
+            {
+                // calculate expansion point:
+                FixedOptimSpacePoint<D> expandedPoint = centroid_;
+                expandedPoint.scale(1.0 - expansionPar_);
+                expandedPoint.addScaled(reflectedPoint, expansionPar_);
+                expandedPoint.second = objFun_(expandedPoint.first);
+
+                // accept better of expanded and reflected point:
+                if( expandedPoint.second < reflectedPoint.second )
+                {
+                    simplex_.front() = expandedPoint;
+                }
+                else
+                {
+                    simplex_.front() = reflectedPoint;
+                }
+            }
+            else
+            {
+                // accept reflected point:
+                simplex_.front() = reflectedPoint;
+            }
+        }
+        else
+        {
+            // calculate contraction point: 
+            FixedOptimSpacePoint<D> contractedPoint = centroid_;
+            contractedPoint.scale(1.0 - contractionPar_);
+            contractedPoint.addScaled(simplex_.front(), contractionPar_);
+            contractedPoint.second = objFun_(contractedPoint.first);
+
+            // contracted point better than worst?
+            if( simplex_.front().second < contractedPoint.second )
+            {
+                // accept contracted point:
+                simplex_.front() = contractedPoint;
+            }
+            else
+            { 
+                // shrink all but the best vertex towards it:
+                for(int i = 0; i < D; i++)
+                {
+                    simplex_[i].scale(shrinkagePar_);
+                    simplex_[i].addScaled(simplex_.back(), 1.0 - shrinkagePar_);
+                    simplex_[i].second = objFun_(simplex_[i].first);
+                }
+            }
+        }
+
+        // ensure vertices are sorted:
+        sortSimplex();
+    }
+}
+
+
+/*!
+ * Returns the best point in optimisation space. Only meaningful if called
+ * after optimise().
+ */
+template<int D>
+FixedOptimSpacePoint<D>
+FixedNelderMeadModule<D>::getOptimPoint() const
+{
+    return simplex_.back();
+}
+
+
+/*!
+ * Returns the number of iterations performed by the last call to optimise().
+ */
+template<int D>
+int
+FixedNelderMeadModule<D>::numIterations() const
+{
+    return numIter_;
+}
+
+
+/*!
+ * Sorts the simplex vertices by increasing objective function value, so that
+ * the worst vertex comes first and the best vertex last.
+ */
+template<int D>
+void
+FixedNelderMeadModule<D>::sortSimplex()
+{
+    std::sort(simplex_.begin(), 
+              simplex_.end(), 
+              CompFixedOptimSpacePoints<D>());
+}
+
+
+/*!
+ * Calculates the centroid of all except the first (i.e. worst) vertex of the 
+ * simplex.
+ */
+template<int D>
+void
+FixedNelderMeadModule<D>::calcCentroid()
+{
+    centroid_.first.fill(0.0);
+    for(int i = 1; i < D + 1; i++)
+    {
+        centroid_.add(simplex_[i]);
+    }
+    centroid_.scale(1.0/D);
+}
+
+
+/*!
+ * Checks whether the simplex has converged, i.e. whether no vertex is further
+ * than the simplex tolerance from the best vertex and the objective function
+ * values at all vertices differ by no more than the value tolerance.
+ */
+template<int D>
+bool
+FixedNelderMeadModule<D>::isConverged() const
+{
+    // spread of function values:
+    // (also fails if any value is infinite or undefined)
+    real valueSpread = simplex_.back().second - simplex_.front().second;
+    if( !(valueSpread <= valueTol_) )
+    {
+        return false;
+    }
+
+    // largest distance from best vertex:
+    for(int i = 0; i < D; i++)
+    {
+        if( simplex_[i].dist2(simplex_.back()) > simplexTol_*simplexTol_ )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// explicit instantiation for in-plane optimisation:
+template class FixedNelderMeadModule<2>;
+
@@ -0,0 +1,376 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "optim/fixed_simulated_annealing_module.hpp"
+
+
+/*!
+ * Constructor. Creates a FixedSimulatedAnnealingModule object with early 
+ * termination disabled.
+ */
+template<int D>
+FixedSimulatedAnnealingModule<D>::FixedSimulatedAnnealingModule()
+    : seed_(0)
+    , stream_(0)
+    , maxCoolingIter_(0)
+    , convIter_(0)
+    , convTol_(0.0)
+    , minAccRate_(0.0)
+    , initTemp_(0.0)
+    , temp_(0.0)
+    , coolingFactor_(0.0)
+    , stepLengthFactor_(0.0)
+    , crntCost_(0.0)
+    , candCost_(0.0)
+    , bestCost_(0.0)
+    , numCoolingIter_(0)
+{
+    crntState_.fill(0.0);
+    candState_.fill(0.0);
+    bestState_.fill(0.0);
+}
+
+
+/*!
+ * Sets parameters of the simulated annealing algorithm. Recognises the same 
+ * parameters as SimulatedAnnealingModule::setParams(), i.e. saMaxCoolingIter,
+ * saInitTemp, saCoolingFactor, and saStepLengthFactor (all required) as well
+ * as saConvIter, saConvTol, and saMinAccRate. The key of the random number
+ * engine is taken from saRandomSeed (defaults to zero), which must be an 
+ * integer exactly representable as real. Also allocates the buffers needed 
+ * for the convergence criteria.
+ */
+template<int D>
+void
+FixedSimulatedAnnealingModule<D>::setParams(std::map<std::string, real> params)
+{
+    // number of cooling iterations:
+    if( params.find("saMaxCoolingIter") != params.end() )
+    {
+        maxCoolingIter_ = params["saMaxCoolingIter"];
+    }
+    else
+    {
+        std::cerr<<"ERROR: No maximum number of cooling iterations given!"<<std::endl;
+        std::abort();
+    }
+
+    // initial temperature:
+    if( params.find("saInitTemp") != params.end() )
+    {
+        initTemp_ = params["saInitTemp"];
+        temp_ = initTemp_;
+    }
+    else
+    {
+        std::cerr<<"ERROR: No initial temperature given!"<<std::endl;
+        std::abort();
+    }
+
+    // cooling factor:
+    if( params.find("saCoolingFactor") != params.end() )
+    {
+        coolingFactor_ = params["saCoolingFactor"];
+    }
+    else
+    {
+        std::cerr<<"ERROR: No cooling factor given!"<<std::endl;
+        std::abort();
+    }
+
+    // step length factor:
+    if( params.find("saStepLengthFactor") != params.end() )
+    {
+        stepLengthFactor_ = params["saStepLengthFactor"];
+    }
+    else
+    {
+        std::cerr<<"ERROR: No step length factor given!"<<std::endl;
+        std::abort();
+    }
+
+    // random number engine key:
+    if( params.find("saRandomSeed") != params.end() )
+    {
+        // only integers that are exactly representable as real are valid:
+        real seed = params["saRandomSeed"];
+        if( !(seed >= 0.0) || 
+            seed >= std::ldexp(1.0, std::numeric_limits<real>::digits) ||
+            seed != std::floor(seed) )
+        {
+            std::cerr<<"ERROR: Random seed "<<seed<<" is not an exactly "
+                     <<"representable non-negative integer, use "
+                     <<"setRandomSeed() instead!"<<std::endl;
+            std::abort();
+        }
+        seed_ = static_cast<uint64_t>(seed);
+    }
+
+    // optional convergence parameters:
+    if( params.find("saConvIter") != params.end() )
+    {
+        convIter_ = std::max(0, static_cast<int>(params["saConvIter"]));
+    }
+    if( params.find("saConvTol") != params.end() )
+    {
+        convTol_ = params["saConvTol"];
+    }
+    if( params.find("saMinAccRate") != params.end() )
+    {
+        minAccRate_ = params["saMinAccRate"];
+    }
+
+    // allocate buffers for convergence criteria:
+    windowBestCost_.resize(convIter_);
+    windowAccepted_.resize(convIter_);
+}
+
+
+/*!
+ * Sets the objective function to be maximised.
+ */
+template<int D>
+void
+FixedSimulatedAnnealingModule<D>::setObjFun(FixedObjectiveFunction<D> objFun)
+{
+    objFun_ = objFun;
+}
+
+
+/*!
+ * Sets the initial point in optimisation space from which simulated annealing
+ * is started.
+ */
+template<int D>
+void
+FixedSimulatedAnnealingModule<D>::setInitGuess(const std::array<real, D> &guess)
+{
+    crntState_ = guess;
+    candState_ = guess;
+    bestState_ = guess;
+}
+
+
+/*!
+ * Sets the key of the random number engine with full 64 bit precision. 
+ * Overrides the saRandomSeed parameter if called after setParams().
+ */
+template<int D>
+void
+FixedSimulatedAnnealingModule<D>::setRandomSeed(uint64_t seed)
+{
+    seed_ = seed;
+}
+
+
+/*!
+ * Selects the random number stream used by optimise(). Streams are 
+ * identified by the user part of the threefry counter, so that each stream
+ * can deliver \f$ 2^{64} \f$ random numbers. Stream zero under key zero is the
+ * sequence of a default-constructed engine.
+ */
+template<int D>
+void
+FixedSimulatedAnnealingModule<D>::setRandomStream(uint64_t stream)
+{
+    stream_ = stream;
+}
+
+
+/*!
+ * Evaluates the cost of the initial state and runs the annealing procedure.
+ * Temperature and random number engine are reset at the start of each call,
+ * so that a module can be reused for several runs.
+ */
+template<int D>
+void
+FixedSimulatedAnnealingModule<D>::optimise()
+{
+    // position random number engine at start of selected stream:
+    rng_.seed(seed_);
+    rng_.restart(stream_, 0);
+    candGenDistr_.reset();
+    candAccDistr_.reset();
+    temp_ = initTemp_;
+
+    crntCost_ = objFun_(crntState_);
+    candCost_ = crntCost_;
+    bestCost_ = crntCost_;
+
+    annealIsotropic();
+}
+
+
+/*!
+ * Returns the best point found and the corresponding objective function 
+ * value.
+ */
+template<int D>
+FixedOptimSpacePoint<D>
+FixedSimulatedAnnealingModule<D>::getOptimPoint() const
+{
+    FixedOptimSpacePoint<D> res;
+    res.first = bestState_;
+    res.second = bestCost_;
+    return res;
+}
+
+
+/*!
+ * Returns the number of cooling iterations performed by the last call to 
+ * optimise().
+ */
+template<int D>
+int
+FixedSimulatedAnnealingModule<D>::getNumCoolingIter() const
+{
+    return numCoolingIter_;
+}
+
+
+/*!
+ * Isotropic annealing procedure with exponential cooling and optional early 
+ * termination (see SimulatedAnnealingModule::annealIsotropic()).
+ */
+template<int D>
+void
+FixedSimulatedAnnealingModule<D>::annealIsotropic()
+{
+    // reset counter and convergence buffers:
+    numCoolingIter_ = 0;
+    std::fill(windowBestCost_.begin(), windowBestCost_.end(), bestCost_);
+    std::fill(windowAccepted_.begin(), windowAccepted_.end(), 0);
+    int numWindowAccepted = 0;
+
+    // at least one step is taken, as in SimulatedAnnealingModule:
+    while(true)
+    {
+        // generate candidate state by isotropic step:
+        for(int i = 0; i < D; i++)
+        {
+            candState_[i] = crntState_[i] + stepLengthFactor_*candGenDistr_(rng_);
+        }
+        candCost_ = objFun_(candState_);
+
+        // accept candidate?
+        bool accepted = acceptCandidateState();
+        if( accepted )
+        {
+            crntState_ = candState_;
+            crntCost_ = candCost_;
+            if( candCost_ > bestCost_ )
+            {
+                bestState_ = candState_;
+                bestCost_ = candCost_;
+            }
+        }
+
+        // reduce temperature:
+        temp_ *= coolingFactor_;
+        numCoolingIter_++;
+
+        // maximum step number reached?
+        if( numCoolingIter_ >= maxCoolingIter_ )
+        {
+            return;
+        }
+
+        // convergence criteria:
+        if( convIter_ > 0 )
+        {
+            int slot = numCoolingIter_ % convIter_;
+            real pastBestCost = windowBestCost_[slot];
+            numWindowAccepted += accepted - windowAccepted_[slot];
+            windowBestCost_[slot] = bestCost_;
+            windowAccepted_[slot] = accepted;
+
+            if( numCoolingIter_ >= convIter_ )
+            {
+                if( bestCost_ - pastBestCost <= convTol_ )
+                {
+                    return;
+                }
+                if( numWindowAccepted < minAccRate_*convIter_ )
+                {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+
+/*!
+ * Decides whether to accept a candidate state according to the Metropolis 
+ * criterion (see SimulatedAnnealingModule::acceptCandidateState()).
+ */
+template<int D>
+bool
+FixedSimulatedAnnealingModule<D>::acceptCandidateState()
+{
+    real accProb = std::min(std::exp( (candCost_ - crntCost_)/temp_ ), 1.0f);
+    real r = candAccDistr_(rng_);
+    return (r < accProb);
+}
+
+
+// explicit instantiation for in-plane optimisation:
+template class FixedSimulatedAnnealingModule<2>;
+
+
+/*!
+ * Returns the random number stream of a simulated annealing run in path 
+ * finding, which is identified by the frame (bits 24 to 63 of the stream 
+ * index), the chain of consecutive runs within this frame (bits 16 to 23), 
+ * and the plane within this chain (bits 0 to 15). As all three indices are 
+ * known before a run starts, results are independent of the order in which 
+ * frames, chains, and planes are processed. The frame field is wide enough
+ * for the frame index combined with replicate and pathway index even in very
+ * long trajectories, while the plane index is bounded by the maximum number 
+ * of probe steps, which is checked before the analysis starts.
+ *
+ * \throws std::out_of_range If any index does not fit into its bit field.
+ */
+uint64_t
+annealingStream(uint64_t frame, uint64_t chain, uint64_t plane)
+{
+    if( frame >= (UINT64_C(1) << 40) || 
+        chain >= (UINT64_C(1) << 8) || 
+        plane >= (UINT64_C(1) << 16) )
+    {
+        throw std::out_of_range("Frame, chain, or plane index exceeds range "
+                                "of simulated annealing random number "
+                                "streams.");
+    }
+
+    return (frame << 24) | (chain << 16) | plane;
+}
+
@@ -32,6 +32,9 @@
  * properties.
  */
 NelderMeadModule::NelderMeadModule()
+    : simplexTol_(0.0)
+    , valueTol_(0.0)
+    , numIter_(0)
 {
 
 }
@@ -61,6 +64,8 @@ NelderMeadModule::~NelderMeadModule()
  *   - nmExpansionPar: factor used in expansion step (defaults to 2.0)
  *   - nmReflectionPar: factor used in reflection step (defaults to 1.0)
  *   - nmShrinkagePar: factor used in shrinkage step (defaults to  0.5)
+ *   - nmSimplexTol: tolerance on the largest distance of any vertex from the best vertex (defaults to 0.0)
+ *   - nmValueTol: tolerance on the spread of objective function values across the simplex (defaults to 0.0)
  */
 void
 NelderMeadModule::setParams(std::map<std::string, real> params)
@@ -126,6 +131,26 @@ NelderMeadModule::setParams(std::map<std::string, real> params)
     {
         shrinkagePar_ = 0.5;
     }
+
+    // simplex diameter tolerance:
+    if( params.find("nmSimplexTol") != params.end() )
+    {
+        simplexTol_ = params["nmSimplexTol"];
+    }
+    else
+    {
+        simplexTol_ = 0.0;
+    }
+
+    // function value spread tolerance:
+    if( params.find("nmValueTol") != params.end() )
+    {
+        valueTol_ = params["nmValueTol"];
+    }
+    else
+    {
+        valueTol_ = 0.0;
+    }
 }
 
 
@@ -176,7 +201,8 @@ NelderMeadModule::setInitGuess(std::vector<real> guess)
 
 /*!
  * Performs the Nelder-Mead optimisation loop. Should only be called once
- * parameters, objective function, and initial point have been set.
+ * parameters, objective function, and initial point have been set. The loop
+ * terminates early once the simplex has converged (see isConverged()).
  */
 void
 NelderMeadModule::optimise()
@@ -199,15 +225,21 @@ NelderMeadModule::optimise()
         vert -> second = objFun_(vert -> first);
     }
 
+    // sort vertices by function values:
+    // (vertices are kept sorted at the end of each iteration)
+    std::sort(simplex_.begin(), 
+              simplex_.end(), 
+              CompOptimSpacePoints());
+
     // Nelder-Mead main loop:
-    for(int i = 0; i < maxIter_; i++)
+    for(numIter_ = 0; numIter_ < maxIter_; numIter_++)
     {       
-        // sort vertices by function values:
-        std::sort(simplex_.begin(), 
-                  simplex_.end(), 
-                  CompOptimSpacePoints());
-       
-       
+        // has simplex converged:
+        if( isConverged() )
+        {
+            break;
+        }
+
         // recalculate centroid:
         calcCentroid();
 
@@ -302,6 +334,18 @@ NelderMeadModule::getOptimPoint()
 }
 
 
+/*!
+ * Returns the number of iterations performed by the last call to optimise().
+ * This is less than the maximum number of iterations if the simplex has 
+ * converged early.
+ */
+int
+NelderMeadModule::numIterations() const
+{
+    return numIter_;
+}
+
+
 /*!
  * Calculates the centroid of all except the first vertex of the simplex. This 
  * is usually the worst vertex.
@@ -324,3 +368,34 @@ NelderMeadModule::calcCentroid()
         centroid_.scale(fac);
 }
 
+
+/*!
+ * Checks whether the simplex has converged. This is the case if no vertex is 
+ * further than the simplex tolerance from the best vertex and the objective
+ * function values at all vertices differ by no more than the value tolerance.
+ * Assumes that the vertices are sorted.
+ */
+bool
+NelderMeadModule::isConverged()
+{
+    // spread of function values:
+    // (also fails if any value is infinite or undefined)
+    real valueSpread = simplex_.back().second - simplex_.front().second;
+    if( !(valueSpread <= valueTol_) )
+    {
+        return false;
+    }
+
+    // largest distance from best vertex:
+    real simplexTolSq = simplexTol_*simplexTol_;
+    std::vector<OptimSpacePoint>::iterator it;
+    for(it = simplex_.begin(); it != simplex_.end() - 1; it++)
+    {
+        if( it -> dist2(simplex_.back()) > simplexTolSq )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
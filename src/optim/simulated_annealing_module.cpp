@@ -22,8 +22,11 @@
 // THE SOFTWARE.
 
 
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <numeric>
+#include <vector>
 #include <functional>
 
 #include "optim/simulated_annealing_module.hpp"
@@ -34,6 +37,12 @@
  * not set any of its properties.
  */
 SimulatedAnnealingModule::SimulatedAnnealingModule()
+    : seed_(0)
+    , stream_(0)
+    , convIter_(0)
+    , convTol_(0.0)
+    , minAccRate_(0.0)
+    , numCoolingIter_(0)
 {
 
 }
@@ -51,19 +60,32 @@ SimulatedAnnealingModule::~SimulatedAnnealingModule()
 /*!
  * Sets parameters of the simulated annealing algorithm. Will throw an error
  * if any required parameter without defaults is not set. Ignores unknown 
- * parameters.
+ * parameters. The key of the random number engine is taken from saRandomSeed
+ * (defaults to zero), which must be an integer exactly representable as real
+ * (larger keys can be set with setRandomSeed()). The optional convergence parameters are saConvIter (window of
+ * cooling iterations, zero disables early termination), saConvTol (minimal 
+ * improvement of the best cost within the window, defaults to zero), and
+ * saMinAccRate (minimal fraction of accepted candidates within the window, 
+ * defaults to zero).
  */
 void
 SimulatedAnnealingModule::setParams(std::map<std::string, real> params)
 {
-    // PRNG seed:
-    if( params.find("saSeed") != params.end() )
+    // random number engine key:
+    if( params.find("saRandomSeed") != params.end() )
     {
-        seed_ = params["saSeed"];
-    }
-    else
-    {
-        // TODO: random seed!
+        // only integers that are exactly representable as real are valid:
+        real seed = params["saRandomSeed"];
+        if( !(seed >= 0.0) || 
+            seed >= std::ldexp(1.0, std::numeric_limits<real>::digits) ||
+            seed != std::floor(seed) )
+        {
+            std::cerr<<"ERROR: Random seed "<<seed<<" is not an exactly "
+                     <<"representable non-negative integer, use "
+                     <<"setRandomSeed() instead!"<<std::endl;
+            std::abort();
+        }
+        seed_ = static_cast<uint64_t>(seed);
     }
     
     // number of cooling iterations:
@@ -109,6 +131,36 @@ SimulatedAnnealingModule::setParams(std::map<std::string, real> params)
         std::cerr<<"ERROR: No step length factor given!"<<std::endl;
         std::abort();
     }
+
+    // convergence window:
+    if( params.find("saConvIter") != params.end() )
+    {
+        convIter_ = params["saConvIter"];
+    }
+    else
+    {
+        convIter_ = 0;
+    }
+
+    // stagnation tolerance:
+    if( params.find("saConvTol") != params.end() )
+    {
+        convTol_ = params["saConvTol"];
+    }
+    else
+    {
+        convTol_ = 0.0;
+    }
+
+    // minimal acceptance rate:
+    if( params.find("saMinAccRate") != params.end() )
+    {
+        minAccRate_ = params["saMinAccRate"];
+    }
+    else
+    {
+        minAccRate_ = 0.0;
+    }
 }
 
 
@@ -141,12 +193,41 @@ SimulatedAnnealingModule::setInitGuess(std::vector<real> guess)
 
 
 /*!
- * Implements the optimisation class interface. Wraps around the anneal() 
- * function, which stems from the original version of this class.
+ * Sets the key of the random number engine with full 64 bit precision. 
+ * Overrides the saRandomSeed parameter if called after setParams().
+ */
+void
+SimulatedAnnealingModule::setRandomSeed(uint64_t seed)
+{
+    seed_ = seed;
+}
+
+
+/*!
+ * Selects the random number stream used by optimise() (see 
+ * FixedSimulatedAnnealingModule::setRandomStream()).
+ */
+void
+SimulatedAnnealingModule::setRandomStream(uint64_t stream)
+{
+    stream_ = stream;
+}
+
+
+/*!
+ * Implements the optimisation class interface. Positions the random number 
+ * engine at the start of the selected stream, so that repeated calls give 
+ * identical results, and wraps around the anneal() function, which stems from
+ * the original version of this class.
  */
 void
 SimulatedAnnealingModule::optimise()
 {
+    rng_.seed(seed_);
+    rng_.restart(stream_, 0);
+    candGenDistr_.reset();
+    candAccDistr_.reset();
+
     anneal();
 }
 
@@ -191,12 +272,23 @@ SimulatedAnnealingModule::anneal()
  * Nonadaptive version of the annealing procedure. At each temperature, the 
  * cost function is evaluated exactly once and candidate states are always 
  * generated by making a small step in a isotropically random direction.
+ *
+ * If a convergence window of \f$ N \f$ cooling iterations is set, the 
+ * procedure terminates as soon as at least \f$ N \f$ iterations have been 
+ * performed and either the best cost has improved by no more than the 
+ * convergence tolerance over the last \f$ N \f$ iterations or less than the 
+ * minimal acceptance rate of candidates has been accepted within them.
  */
 void
 SimulatedAnnealingModule::annealIsotropic()
 {
     // initialise counter:
-    int nCoolingIter = 0;
+    numCoolingIter_ = 0;
+
+    // ring buffers of best cost and acceptance over convergence window:
+    std::vector<real> windowBestCost(convIter_, bestCost_);
+    std::vector<char> windowAccepted(convIter_, 0);
+    int numWindowAccepted = 0;
 
     // start annealing loop:
     while(true)
@@ -208,7 +300,8 @@ SimulatedAnnealingModule::annealIsotropic()
         candCost_ = objFun_(candState_);
 
         // accept candidate?
-        if( acceptCandidateState() == true )
+        bool accepted = acceptCandidateState();
+        if( accepted == true )
         {
             // candidate state becomes current state:
             crntState_ = candState_;
@@ -223,13 +316,40 @@ SimulatedAnnealingModule::annealIsotropic()
 
         // reduce temperature:
         cool();
-        nCoolingIter++;
+        numCoolingIter_++;
 
         // maximum step number reached?
-        if( nCoolingIter >= maxCoolingIter_ )
+        if( numCoolingIter_ >= maxCoolingIter_ )
         {
             return;
         }
+
+        // convergence criteria:
+        if( convIter_ > 0 )
+        {
+            // best cost and acceptance one window ago are overwritten:
+            int slot = numCoolingIter_ % convIter_;
+            real pastBestCost = windowBestCost[slot];
+            numWindowAccepted += accepted - windowAccepted[slot];
+            windowBestCost[slot] = bestCost_;
+            windowAccepted[slot] = accepted;
+
+            // only check once a full window is available:
+            if( numCoolingIter_ >= convIter_ )
+            {
+                // stagnation of best cost:
+                if( bestCost_ - pastBestCost <= convTol_ )
+                {
+                    return;
+                }
+
+                // too few candidates accepted:
+                if( numWindowAccepted < minAccRate_*convIter_ )
+                {
+                    return;
+                }
+            }
+        }
     }
 }
 
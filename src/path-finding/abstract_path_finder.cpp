@@ -32,12 +32,18 @@
  * Constructor sets parameter values to nonsensical values and flags to false.
  */
 PathFindingParameters::PathFindingParameters()
-    : probeStepLength_(-1.0)
+    : nbhCutoff_(-1.0)
+    , nbhCutoffIsSet_(false)
+    , probeStepLength_(-1.0)
     , probeStepLengthIsSet_(false)
     , maxProbeRadius_(-1.0)
     , maxProbeRadiusIsSet_(false)
     , maxProbeSteps_(0)
     , maxProbeStepsIsSet_(false)
+    , randomSeed_(0)
+    , randomSeedIsSet_(false)
+    , frameIndex_(0)
+    , frameIndexIsSet_(false)
 {
 
 }
@@ -87,6 +93,29 @@ PathFindingParameters::setMaxProbeSteps(int maxProbeSteps)
 }
 
 
+/*!
+ * Sets key of the random number engine used in simulated annealing.
+ */
+void
+PathFindingParameters::setRandomSeed(uint64_t randomSeed)
+{
+    randomSeed_ = randomSeed;
+    randomSeedIsSet_ = true;
+}
+
+
+/*!
+ * Sets index of the frame in which the path is found, which selects the 
+ * random number streams used in simulated annealing (see annealingStream()).
+ */
+void
+PathFindingParameters::setFrameIndex(uint64_t frameIndex)
+{
+    frameIndex_ = frameIndex;
+    frameIndexIsSet_ = true;
+}
+
+
 /*!
  * Returns neighbourhood search cutoff.
  *
@@ -203,6 +232,64 @@ PathFindingParameters::maxProbeStepsIsSet() const
 }
 
 
+/*!
+ * Returns key of random number engine.
+ *
+ * \throws std::logic_error If parameter value unset.
+ */
+uint64_t
+PathFindingParameters::randomSeed() const
+{
+    if( randomSeedIsSet_ )
+    {
+        return randomSeed_;
+    }
+    else
+    {
+        throw std::logic_error("Parameter randomSeed is not set.");
+    }
+}
+
+
+/*!
+ * Returns flag indicating if key of random number engine has been set.
+ */
+bool
+PathFindingParameters::randomSeedIsSet() const
+{
+    return randomSeedIsSet_;
+}
+
+
+/*!
+ * Returns frame index.
+ *
+ * \throws std::logic_error If parameter value unset.
+ */
+uint64_t
+PathFindingParameters::frameIndex() const
+{
+    if( frameIndexIsSet_ )
+    {
+        return frameIndex_;
+    }
+    else
+    {
+        throw std::logic_error("Parameter frameIndex is not set.");
+    }
+}
+
+
+/*!
+ * Returns flag indicating if frame index has been set.
+ */
+bool
+PathFindingParameters::frameIndexIsSet() const
+{
+    return frameIndexIsSet_;
+}
+
+
 
 /*!
  * \brief Constructor to be used in initialiser list of derived classes. 
@@ -214,6 +301,8 @@ AbstractPathFinder::AbstractPathFinder(std::map<std::string, real> params)
     : params_(params)
     , path_()
     , radii_()
+    , saIter_()
+    , nmIter_()
 {
 
 }
@@ -231,6 +320,38 @@ AbstractPathFinder::getMolecularPath()
 }
 
 
+/*!
+ * Returns the number of simulated annealing cooling iterations performed for
+ * each path point. Zero is reported for all points if the path finder does 
+ * not record this information.
+ */
+std::vector<int>
+AbstractPathFinder::pathSaIterations() const
+{
+    if( saIter_.size() != path_.size() )
+    {
+        return std::vector<int>(path_.size(), 0);
+    }
+    return saIter_;
+}
+
+
+/*!
+ * Returns the number of Nelder-Mead iterations performed for each path point.
+ * Zero is reported for all points if the path finder does not record this 
+ * information.
+ */
+std::vector<int>
+AbstractPathFinder::pathNmIterations() const
+{
+    if( nmIter_.size() != path_.size() )
+    {
+        return std::vector<int>(path_.size(), 0);
+    }
+    return nmIter_;
+}
+
+
 /*!
  * Setter function for parameters. On the base class, only changes the flag.
  */
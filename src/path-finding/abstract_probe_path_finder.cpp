@@ -23,29 +23,63 @@
 
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <iostream>
 #include <limits>
+#include <stdexcept>
+
+#include <gromacs/math/vec.h>
 
 #include "path-finding/abstract_probe_path_finder.hpp"
 
 
 /*!
- * Constructor.
+ * Constructor. The van der Waals radii are held by reference and must be 
+ * ordered like the pore-forming atoms passed to prepareNeighborhoodSearch().
+ * The caller is responsible for keeping the radius array alive for the 
+ * lifetime of the path finder.
  */
 AbstractProbePathFinder::AbstractProbePathFinder(
         std::map<std::string, real> params,
         gmx::RVec initProbePos,
-        std::vector<real> vdwRadii)
+        const std::vector<real> &vdwRadii)
     : AbstractPathFinder(params)
     , vdwRadii_(vdwRadii)
     , initProbePos_(initProbePos)
     , crntProbePos_()
+    , randomSeed_(0)
+    , frameIndex_(0)
     , nbh_()
+    , nbhSkin_(0.0)
+    , freeDistCutoff_(0.0)
+    , useNbhList_(false)
 {
     // TODO: probe radius not really used, may be factored out?
     probeRadius_ = 0.0;
 
+    // key of random number engine (limited to precision of real here, larger
+    // keys are passed via setParameters()):
+    if( params.find("saRandomSeed") != params.end() )
+    {
+        real seed = params["saRandomSeed"];
+        if( !(seed >= 0.0) || 
+            seed >= std::ldexp(1.0, std::numeric_limits<real>::digits) ||
+            seed != std::floor(seed) )
+        {
+            throw std::runtime_error("Parameter saRandomSeed must be a "
+                                     "non-negative integer that is exactly "
+                                     "representable as real.");
+        }
+        randomSeed_ = static_cast<uint64_t>(seed);
+    }
+
+    // skin of cached neighbour list:
+    if( params.find("pfNbhSkin") != params.end() )
+    {
+        nbhSkin_ = params["pfNbhSkin"];
+    }
+
     // find maximum vdw radius:
     maxVdwRadius_ = *std::max_element(vdwRadii.begin(), vdwRadii.end());
 }
@@ -54,15 +88,29 @@ AbstractProbePathFinder::AbstractProbePathFinder(
 /*!
  * Sets parameters of the AnalysisNeighborhood object maintained by this class
  * and initialises an AnalysisneighborhoodSearch.
+ *
+ * If useSkin is true and a positive pfNbhSkin parameter was given, the search
+ * cutoff is extended by the skin and findMinimalFreeDistance() evaluates the
+ * free distance from cached neighbour lists, which are only rebuilt once the
+ * probe has moved further than the skin from the point the list was built
+ * around. Only particles within the original cutoff contribute to the free 
+ * distance, so that results do not depend on the skin. Derived classes that
+ * start pair searches themselves should therefore not request a skin.
  */
 void
 AbstractProbePathFinder::prepareNeighborhoodSearch(
     t_pbc *pbc,
     gmx::AnalysisNeighborhoodPositions porePos,
-    real cutoff)
+    real cutoff,
+    bool useSkin)
 {
+    // cached neighbour lists require finite skin and cutoff:
+    useNbhList_ = useSkin && nbhSkin_ > 0.0 && cutoff > 0.0;
+    freeDistCutoff_ = cutoff;
+    nbhList_ = ProbeNeighbourList();
+
     // prepare analysis neighborhood:
-    nbh_.setCutoff(cutoff);
+    nbh_.setCutoff(useNbhList_ ? cutoff + nbhSkin_ : cutoff);
     nbh_.setXYMode(false);
     nbh_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Automatic);
 
@@ -71,13 +119,69 @@ AbstractProbePathFinder::prepareNeighborhoodSearch(
 }
 
 
+/*!
+ * Takes the key of the random number engine and the frame index from the
+ * path finding parameters if they are set. The key given here takes 
+ * precedence over the saRandomSeed parameter, as it is not limited to the
+ * precision of real.
+ */
+void
+AbstractProbePathFinder::setRandomStreamParameters(
+        const PathFindingParameters &params)
+{
+    if( params.randomSeedIsSet() )
+    {
+        randomSeed_ = params.randomSeed();
+    }
+    if( params.frameIndexIsSet() )
+    {
+        frameIndex_ = params.frameIndex();
+    }
+}
+
+
+/*!
+ * Finds the minimal free distance at a point in optimisation space, which is
+ * converted to configuration space with optimToConfig().
+ */
+real
+AbstractProbePathFinder::findMinimalFreeDistance(
+        const std::array<real, 2> &optimSpacePos)
+{
+    return findMinimalFreeDistance(optimToConfig(optimSpacePos));
+}
+
+
+/*!
+ * Finds the minimal free distance at a point in configuration space, using 
+ * the neighbour list maintained by this class if applicable. Not safe for
+ * concurrent use, threads should pass their own neighbour list instead.
+ */
+real
+AbstractProbePathFinder::findMinimalFreeDistance(
+        const gmx::RVec &probePos)
+{
+    return findMinimalFreeDistance(probePos, nbhList_);
+}
+
+
 /*!
  * Finds the minimal free distance, i.e. the shortest distance between the 
- * probe and the closest van-der-Waals surface.
+ * probe and the closest van-der-Waals surface. This does not depend on the 
+ * current probe position, so that several threads may evaluate it 
+ * concurrently as long as each uses its own neighbour list (the neighbourhood
+ * search supports concurrent pair searches).
+ *
+ * If cached neighbour lists are enabled (see prepareNeighborhoodSearch()), 
+ * the given list is rebuilt around the probe position if it is invalid or the
+ * probe has left the skin around its reference point, and the free distance
+ * is found by scanning the listed particles. Otherwise a grid pair search is
+ * started for each call.
  */
 real
 AbstractProbePathFinder::findMinimalFreeDistance(
-        std::vector<real> optimSpacePos)
+        const gmx::RVec &probePos,
+        ProbeNeighbourList &nbhList)
 {
     // internal variables:
     real pairDist;              // distance between probe and pore atom
@@ -91,11 +195,45 @@ AbstractProbePathFinder::findMinimalFreeDistance(
     // points will then lead to kinks in the spline!
     real minimalFreeDistance = std::numeric_limits<real>::infinity();            // radius of maximal non-overlapping sphere
 
-    // convert point in optimisation space to point in configuration space:
-    gmx::AnalysisNeighborhoodPositions probePos(optimToConfig(optimSpacePos).as_vec());
+    // scan cached neighbour list:
+    if( useNbhList_ )
+    {
+        // rebuild list if probe has left skin:
+        gmx::RVec shift;
+        rvec_sub(probePos, nbhList.refPos, shift);
+        if( !nbhList.isValid || norm2(shift) > nbhSkin_*nbhSkin_ )
+        {
+            buildNeighbourList(probePos, nbhList);
+            clear_rvec(shift);
+        }
+
+        // loop over all listed particles within cutoff:
+        real cutoffSq = freeDistCutoff_*freeDistCutoff_;
+        for(size_t i = 0; i < nbhList.dx.size(); i++)
+        {
+            gmx::RVec dx;
+            rvec_sub(nbhList.dx[i], shift, dx);
+            real pairDistSq = norm2(dx);
+            if( pairDistSq > cutoffSq )
+            {
+                continue;
+            }
+
+            pairDist = std::sqrt(pairDistSq);
+            if( (pairDist - nbhList.vdwRadii[i] - probeRadius_) < minimalFreeDistance )
+            {
+                minimalFreeDistance = pairDist - nbhList.vdwRadii[i];
+            }
+        }
+
+        return minimalFreeDistance;
+    }
+
+    // position of probe in neighbourhood search:
+    gmx::AnalysisNeighborhoodPositions probeNbhPos(probePos.as_vec());
 
     // begin a pair search:
-    gmx::AnalysisNeighborhoodPairSearch nbPairSearch = nbSearch_.startPairSearch(probePos);
+    gmx::AnalysisNeighborhoodPairSearch nbPairSearch = nbSearch_.startPairSearch(probeNbhPos);
 
     // loop over all pairs:
     gmx::AnalysisNeighborhoodPair pair;
@@ -106,7 +244,7 @@ AbstractProbePathFinder::findMinimalFreeDistance(
         pairDist = std::sqrt(pair.distance2());
 
         // get vdW radius of reference atom:
-        poreAtomVdwRadius = vdwRadii_.at(pair.refIndex());
+        poreAtomVdwRadius = vdwRadii_[pair.refIndex()];
 
         // update void radius if necessary:
         if( (pairDist - poreAtomVdwRadius - probeRadius_) < minimalFreeDistance )
@@ -119,3 +257,31 @@ AbstractProbePathFinder::findMinimalFreeDistance(
     return minimalFreeDistance; 
 }
 
+
+/*!
+ * Rebuilds a neighbour list around the given reference point from a grid 
+ * pair search with the cutoff extended by the skin. Distance vectors point 
+ * from the reference point to the closest periodic image of each particle.
+ */
+void
+AbstractProbePathFinder::buildNeighbourList(
+        const gmx::RVec &refPos,
+        ProbeNeighbourList &nbhList)
+{
+    nbhList.refPos = refPos;
+    nbhList.dx.clear();
+    nbhList.vdwRadii.clear();
+
+    gmx::AnalysisNeighborhoodPositions refNbhPos(refPos.as_vec());
+    gmx::AnalysisNeighborhoodPairSearch nbPairSearch = 
+            nbSearch_.startPairSearch(refNbhPos);
+    gmx::AnalysisNeighborhoodPair pair;
+    while( nbPairSearch.findNextPair(&pair) )
+    {
+        nbhList.dx.push_back(gmx::RVec(pair.dx()));
+        nbhList.vdwRadii.push_back(vdwRadii_[pair.refIndex()]);
+    }
+
+    nbhList.isValid = true;
+    nbhList.numBuilds++;
+}
@@ -0,0 +1,837 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include <gromacs/math/vec.h>
+
+#include "geometry/distance_transform_3D.hpp"
+#include "optim/fixed_nelder_mead_module.hpp"
+#include "path-finding/distance_transform_path_finder.hpp"
+
+
+/*!
+ * Constructor. The grid spacing is read from the parameter map under the key
+ * pfGridSpacing and defaults to 0.1 nm.
+ */
+DistanceTransformPathFinder::DistanceTransformPathFinder(
+        std::map<std::string, real> params,
+        gmx::RVec initProbePos,
+        gmx::RVec chanDirVec,
+        t_pbc *pbc,
+        gmx::AnalysisNeighborhoodPositions porePos,
+        const std::vector<real> &vdwRadii)
+    : AbstractProbePathFinder(params, initProbePos, vdwRadii)
+    , porePos_(porePos)
+    , pbc_(pbc)
+    , chanDirVec_(chanDirVec)
+    , orthVecU_(0.0, 0.0, 0.0)
+    , orthVecW_(0.0, 0.0, 0.0)
+    , gridSpacing_(0.1)
+    , gridDim_(3, 0)
+    , gridOrigin_(0.0, 0.0, 0.0)
+    , probeVoxel_({{0, 0, 0}})
+    , crntOrthVecU_(0.0, 0.0, 0.0)
+    , crntOrthVecW_(0.0, 0.0, 0.0)
+{
+    // grid spacing:
+    if( params.find("pfGridSpacing") != params.end() )
+    {
+        gridSpacing_ = params["pfGridSpacing"];
+    }
+    if( !(gridSpacing_ > 0.0) )
+    {
+        throw std::runtime_error("Grid spacing for distance transform path "
+                                 "finding must be positive.");
+    }
+
+    // tolerance threshold for norm of vector (which should be unit vectors):
+    real nonZeroTol = std::numeric_limits<real>::epsilon();
+    if( norm(chanDirVec_) < nonZeroTol )
+    {
+        throw std::runtime_error("Channel direction vector has norm close to "
+                                 "zero. Please provide a finite-length channel "
+                                 "direction vector with -pf-chan-dir-vec.");
+    }
+
+    // normalise channel direction vector:
+    unitv(chanDirVec_, chanDirVec_);
+
+    // generate first orthogonal vector:
+    orthVecU_ = gmx::RVec(-chanDirVec_[YY], chanDirVec_[XX], 0.0);
+    if( norm(orthVecU_) < nonZeroTol )
+    {
+        // try different permutation:
+        orthVecU_ = gmx::RVec(-chanDirVec_[ZZ], 0.0, chanDirVec_[XX]);
+        if( norm(orthVecU_) < nonZeroTol )
+        {
+            throw std::logic_error("Distance transform path finder could "
+                                   "not generate an orthogonal vector.");
+        }
+    }
+
+    // normalise first orthogonal vector:
+    unitv(orthVecU_, orthVecU_);
+
+    // generate second orthogonal vector:
+    // (this will already be normalised)
+    cprod(chanDirVec_, orthVecU_, orthVecW_);
+}
+
+
+/*!
+ * Set parameters for path-finding.
+ */
+void
+DistanceTransformPathFinder::setParameters(
+        const PathFindingParameters &params)
+{
+    // set parameters:
+    probeStepLength_ = params.probeStepLength();
+    maxProbeRadius_ = params.maxProbeRadius();
+    maxProbeSteps_ = params.maxProbeSteps();
+
+    // has cutoff been set by user:
+    if( params.nbhCutoffIsSet() )
+    {
+        // user given cutoff:
+        nbhCutoff_ = params.nbhCutoff();
+    }
+    else
+    {
+        // calculate cutoff automatically:
+        real safetyMargin = std::sqrt(std::numeric_limits<real>::epsilon());
+        nbhCutoff_ = params.maxProbeRadius() + maxVdwRadius_ + safetyMargin;
+    }
+
+    // set flag to true:
+    parametersSet_ = true;
+}
+
+
+/*!
+ * Execute path-finding algorithm.
+ */
+void
+DistanceTransformPathFinder::findPath()
+{
+    // sanity check:
+    if( !parametersSet_ )
+    {
+        throw std::logic_error("Path finding parameters have not been set.");
+    }
+
+    // set up grid around pore-forming atoms:
+    std::vector<gmx::RVec> atomPos;
+    std::vector<real> atomVdwRadii;
+    buildGrid(atomPos, atomVdwRadii);
+
+    // free distance of each voxel and widest path through the pore:
+    std::vector<real> freeDist = freeDistances(atomPos, atomVdwRadii);
+    std::vector<int> voxelPath = widestPath(freeDist);
+
+    // smooth out staircase of voxel path:
+    // (end points are kept fixed)
+    int halfWindow = 2;
+    std::vector<gmx::RVec> smoothPath(voxelPath.size());
+    for(int i = 0; i < static_cast<int>(voxelPath.size()); i++)
+    {
+        int width = std::min(halfWindow, 
+                std::min(i, static_cast<int>(voxelPath.size()) - 1 - i));
+        gmx::RVec sum(0.0, 0.0, 0.0);
+        for(int j = i - width; j <= i + width; j++)
+        {
+            rvec_inc(sum, voxelPosition(voxelPath[j]));
+        }
+        svmul(1.0/(2*width + 1), sum, smoothPath[i]);
+    }
+
+    // arc length along voxel path:
+    std::vector<real> arcLength(1, 0.0);
+    for(size_t i = 1; i < smoothPath.size(); i++)
+    {
+        gmx::RVec seg;
+        rvec_sub(smoothPath[i], smoothPath[i - 1], seg);
+        arcLength.push_back(arcLength.back() + norm(seg));
+    }
+
+    // resample path with probe step length:
+    int numSteps = std::ceil(arcLength.back()/probeStepLength_);
+    numSteps = std::max(2, std::min(numSteps, 2*maxProbeSteps_));
+    std::vector<gmx::RVec> points;
+    size_t seg = 1;
+    for(int i = 0; i <= numSteps; i++)
+    {
+        real s = arcLength.back()*i/numSteps;
+        while( seg + 1 < arcLength.size() && arcLength[seg] < s )
+        {
+            seg++;
+        }
+        if( seg >= arcLength.size() )
+        {
+            points.push_back(smoothPath.back());
+            continue;
+        }
+        real len = arcLength[seg] - arcLength[seg - 1];
+        real t = len > 0.0 ? (s - arcLength[seg - 1])/len : 0.0;
+        t = std::min<real>(std::max<real>(t, 0.0), 1.0);
+        gmx::RVec p;
+        for(int k = 0; k < DIM; k++)
+        {
+            p[k] = (1.0 - t)*smoothPath[seg - 1][k] + t*smoothPath[seg][k];
+        }
+        points.push_back(p);
+    }
+
+    // refine points onto continuous free distance function:
+    prepareNeighborhoodSearch(
+            pbc_,
+            porePos_,
+            nbhCutoff_,
+            true);
+    refinePath(points);
+}
+
+
+/*!
+ * Collects the pore-forming atoms and sets up a grid covering their bounding
+ * box. Atom positions are returned in the coordinate system spanned by 
+ * orthVecU_, orthVecW_, and chanDirVec_ with the initial probe position as 
+ * origin, where periodic images closest to the initial probe position are
+ * used. The grid extends beyond the van der Waals spheres of all atoms by
+ * more than the maximum probe radius, so that its boundary lies in bulk. It 
+ * is aligned such that the initial probe position is the centre of a voxel.
+ */
+void
+DistanceTransformPathFinder::buildGrid(
+        std::vector<gmx::RVec> &atomPos,
+        std::vector<real> &atomVdwRadii)
+{
+    // enumerate all atoms without cutoff:
+    prepareNeighborhoodSearch(
+            pbc_,
+            porePos_,
+            0.0);
+    gmx::AnalysisNeighborhoodPositions probePos(initProbePos_.as_vec());
+    gmx::AnalysisNeighborhoodPairSearch nbPairSearch = 
+            nbSearch_.startPairSearch(probePos);
+
+    // transform atoms into grid coordinate system and find bounding box:
+    gmx::RVec boxLo(std::numeric_limits<real>::infinity(),
+                    std::numeric_limits<real>::infinity(),
+                    std::numeric_limits<real>::infinity());
+    gmx::RVec boxHi(-std::numeric_limits<real>::infinity(),
+                    -std::numeric_limits<real>::infinity(),
+                    -std::numeric_limits<real>::infinity());
+    gmx::AnalysisNeighborhoodPair pair;
+    while( nbPairSearch.findNextPair(&pair) )
+    {
+        gmx::RVec dx(pair.dx());
+        gmx::RVec pos(iprod(dx, orthVecU_), 
+                      iprod(dx, orthVecW_), 
+                      iprod(dx, chanDirVec_));
+
+        atomPos.push_back(pos);
+        atomVdwRadii.push_back(vdwRadii_[pair.refIndex()]);
+        for(int d = 0; d < DIM; d++)
+        {
+            boxLo[d] = std::min(boxLo[d], pos[d]);
+            boxHi[d] = std::max(boxHi[d], pos[d]);
+        }
+    }
+
+    // sanity checks:
+    if( atomPos.empty() )
+    {
+        throw std::runtime_error("No pore-forming atoms found for distance "
+                                 "transform path finding.");
+    }
+    for(int d = 0; d < DIM; d++)
+    {
+        if( boxLo[d] > 0.0 || boxHi[d] < 0.0 )
+        {
+            throw std::runtime_error("Initial probe position lies outside the "
+                                     "bounding box of the pathway selection. "
+                                     "Please check -pf-init-probe-pos.");
+        }
+    }
+
+    // grid covers bounding box plus margin, so that boundary lies in bulk:
+    real margin = maxProbeRadius_ + maxVdwRadius_ + gridSpacing_;
+    double numVoxels = 1.0;
+    for(int d = 0; d < DIM; d++)
+    {
+        int numBelow = std::ceil((margin - boxLo[d])/gridSpacing_);
+        int numAbove = std::ceil((boxHi[d] + margin)/gridSpacing_);
+        gridDim_[d] = numBelow + numAbove + 1;
+        gridOrigin_[d] = -numBelow*gridSpacing_;
+        probeVoxel_[d] = numBelow;
+        numVoxels *= gridDim_[d];
+    }
+    if( numVoxels > std::numeric_limits<int>::max() - 2 )
+    {
+        throw std::runtime_error("Distance transform grid is too large. "
+                                 "Consider increasing the grid spacing with "
+                                 "-pf-grid-spacing.");
+    }
+}
+
+
+/*!
+ * Estimates the free distance at each voxel. Voxels outside the van der 
+ * Waals spheres of all atoms are assigned the distance to the nearest 
+ * occupied voxel less half a grid spacing, capped at the maximum probe 
+ * radius. Occupied voxels are assigned the (negative) free distance to the
+ * surface of the atom they penetrate most deeply, so that a widest path 
+ * still exists if the pore is occluded on the grid.
+ */
+std::vector<real>
+DistanceTransformPathFinder::freeDistances(
+        const std::vector<gmx::RVec> &atomPos,
+        const std::vector<real> &atomVdwRadii) const
+{
+    int nx = gridDim_[XX];
+    int ny = gridDim_[YY];
+    int nz = gridDim_[ZZ];
+    DistanceTransform3D edt(nx, ny, nz);
+
+    // mark voxels covered by van der Waals spheres:
+    std::vector<char> isOccupied(edt.numVoxels(), 0);
+    std::vector<real> freeDist(edt.numVoxels(), maxProbeRadius_);
+    for(size_t a = 0; a < atomPos.size(); a++)
+    {
+        // range of voxels in bounding box of sphere:
+        real r = atomVdwRadii[a];
+        int lo[DIM];
+        int hi[DIM];
+        for(int d = 0; d < DIM; d++)
+        {
+            lo[d] = std::max(0, static_cast<int>(std::ceil(
+                    (atomPos[a][d] - r - gridOrigin_[d])/gridSpacing_)));
+            hi[d] = std::min(gridDim_[d] - 1, static_cast<int>(std::floor(
+                    (atomPos[a][d] + r - gridOrigin_[d])/gridSpacing_)));
+        }
+
+        // mark voxels inside sphere:
+        for(int k = lo[ZZ]; k <= hi[ZZ]; k++)
+        {
+            real dz = gridOrigin_[ZZ] + k*gridSpacing_ - atomPos[a][ZZ];
+            for(int j = lo[YY]; j <= hi[YY]; j++)
+            {
+                real dy = gridOrigin_[YY] + j*gridSpacing_ - atomPos[a][YY];
+                for(int i = lo[XX]; i <= hi[XX]; i++)
+                {
+                    real dx = gridOrigin_[XX] + i*gridSpacing_ - atomPos[a][XX];
+                    real dist = std::sqrt(dx*dx + dy*dy + dz*dz) - r;
+                    if( dist < 0.0 )
+                    {
+                        int idx = i + nx*(j + ny*k);
+                        freeDist[idx] = isOccupied[idx] 
+                                      ? std::min(freeDist[idx], dist) 
+                                      : dist;
+                        isOccupied[idx] = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // distance of free voxels to nearest occupied voxel:
+    std::vector<real> sqDist = edt.squaredDistances(isOccupied);
+    for(size_t i = 0; i < sqDist.size(); i++)
+    {
+        if( !isOccupied[i] )
+        {
+            real dist = gridSpacing_*(std::sqrt(sqDist[i]) - 0.5);
+            freeDist[i] = std::min(dist, maxProbeRadius_);
+        }
+    }
+
+    return freeDist;
+}
+
+
+/*!
+ * Finds the widest path between the two openings of the pore. 
+ *
+ * In the grid slice through the initial probe position, only voxels in the
+ * cross section of the pore (see poreCrossSection()) are passable. This 
+ * splits the bulk (see bulkVoxels()) into the openings on either side of the
+ * slice, which are connected only through the pore, and each is represented
+ * by a virtual cap node. Voxels are added in order of decreasing free 
+ * distance (ties are broken by voxel index to keep the result 
+ * deterministic) and joined to those of their 26 neighbours that have been
+ * added before, unless both are already connected. Neighbours are joined in 
+ * order of decreasing free distance, so that on either side of the 
+ * bottleneck the tree path ascends towards the bulk rather than drifting 
+ * along the protein surface. Bulk voxels are also joined to the cap node on
+ * their side of the slice. This grows the maximum
+ * spanning tree of the voxel graph until both caps are connected, at which
+ * point the tree path between the caps is the widest path. The path is 
+ * traced from the cap in channel direction to the opposite cap and then 
+ * truncated to the section between the points where it first reaches the 
+ * maximum probe radius on either side of its narrowest point.
+ *
+ * Returns the linear voxel indices along the path.
+ */
+std::vector<int>
+DistanceTransformPathFinder::widestPath(
+        const std::vector<real> &freeDist) const
+{
+    int nx = gridDim_[XX];
+    int ny = gridDim_[YY];
+    int nz = gridDim_[ZZ];
+    int numVoxels = nx*ny*nz;
+
+    // virtual nodes for lower and upper end cap:
+    int lowerCap = numVoxels;
+    int upperCap = numVoxels + 1;
+
+    // openings and passable part of slice through initial probe position:
+    std::vector<char> isBulk = bulkVoxels(freeDist);
+    std::vector<char> inSection = poreCrossSection(freeDist);
+    int probeSlice = probeVoxel_[ZZ];
+
+    // passable voxels sorted by decreasing free distance:
+    std::vector<int> order;
+    order.reserve(numVoxels);
+    for(int k = 0; k < nz; k++)
+    {
+        for(int j = 0; j < ny; j++)
+        {
+            for(int i = 0; i < nx; i++)
+            {
+                if( k != probeSlice || inSection[i + nx*j] )
+                {
+                    order.push_back(i + nx*(j + ny*k));
+                }
+            }
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&freeDist](int a, int b)
+    {
+        return freeDist[a] > freeDist[b];
+    });
+
+    // union-find structure with path halving:
+    std::vector<int> parent(numVoxels + 2);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto findRoot = [&parent](int v)
+    {
+        while( parent[v] != v )
+        {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    };
+
+    // grow maximum spanning tree until caps are connected:
+    std::vector<char> isAdded(numVoxels, 0);
+    std::vector<std::pair<int, int>> treeEdges;
+    std::vector<int> neighbours;
+    for(size_t n = 0; n < order.size(); n++)
+    {
+        int v = order[n];
+        int i = v % nx;
+        int j = (v/nx) % ny;
+        int k = v/(nx*ny);
+        isAdded[v] = 1;
+
+        // candidate neighbours including virtual cap nodes:
+        neighbours.clear();
+        if( isBulk[v] && k < probeSlice )
+        {
+            neighbours.push_back(lowerCap);
+        }
+        if( isBulk[v] && k > probeSlice )
+        {
+            neighbours.push_back(upperCap);
+        }
+        for(int dk = -1; dk <= 1; dk++)
+        {
+            for(int dj = -1; dj <= 1; dj++)
+            {
+                for(int di = -1; di <= 1; di++)
+                {
+                    if( i + di < 0 || i + di >= nx ||
+                        j + dj < 0 || j + dj >= ny ||
+                        k + dk < 0 || k + dk >= nz )
+                    {
+                        continue;
+                    }
+                    int w = v + di + nx*(dj + ny*dk);
+                    if( w != v && isAdded[w] )
+                    {
+                        neighbours.push_back(w);
+                    }
+                }
+            }
+        }
+
+        // join to neighbours not yet connected, widest first, so that the
+        // tree path ascends the distance transform towards the openings:
+        std::stable_sort(neighbours.begin(), neighbours.end(), 
+                [&freeDist, numVoxels](int a, int b)
+        {
+            // virtual cap nodes come first:
+            return b < numVoxels && 
+                   (a >= numVoxels || freeDist[a] > freeDist[b]);
+        });
+        for(auto w : neighbours)
+        {
+            int rootV = findRoot(v);
+            int rootW = findRoot(w);
+            if( rootV != rootW )
+            {
+                parent[rootV] = rootW;
+                treeEdges.push_back(std::make_pair(v, w));
+            }
+        }
+
+        // stop once caps are connected:
+        if( findRoot(lowerCap) == findRoot(upperCap) )
+        {
+            break;
+        }
+    }
+
+    // sanity check:
+    if( findRoot(lowerCap) != findRoot(upperCap) )
+    {
+        throw std::logic_error("Failed to connect pore openings on distance "
+                               "transform grid.");
+    }
+
+    // tree adjacency in compressed row format:
+    std::vector<int> offsets(numVoxels + 3, 0);
+    for(auto &e : treeEdges)
+    {
+        offsets[e.first + 1]++;
+        offsets[e.second + 1]++;
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<int> adjacent(offsets.back());
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for(auto &e : treeEdges)
+    {
+        adjacent[fill[e.first]++] = e.second;
+        adjacent[fill[e.second]++] = e.first;
+    }
+
+    // breadth first search for tree path from upper to lower cap:
+    std::vector<int> predecessor(numVoxels + 2, -1);
+    std::vector<int> queue(1, upperCap);
+    predecessor[upperCap] = upperCap;
+    for(size_t q = 0; q < queue.size() && predecessor[lowerCap] < 0; q++)
+    {
+        int v = queue[q];
+        for(int a = offsets[v]; a < offsets[v + 1]; a++)
+        {
+            if( predecessor[adjacent[a]] < 0 )
+            {
+                predecessor[adjacent[a]] = v;
+                queue.push_back(adjacent[a]);
+            }
+        }
+    }
+    std::vector<int> path;
+    for(int v = predecessor[lowerCap]; v != upperCap; v = predecessor[v])
+    {
+        path.push_back(v);
+    }
+    std::reverse(path.begin(), path.end());
+
+    // truncate path where it enters bulk on either side of bottleneck:
+    int bottleneck = 0;
+    for(size_t i = 0; i < path.size(); i++)
+    {
+        if( freeDist[path[i]] < freeDist[path[bottleneck]] )
+        {
+            bottleneck = i;
+        }
+    }
+    int first = std::max(bottleneck - 1, 0);
+    while( first > 0 && freeDist[path[first]] < maxProbeRadius_ )
+    {
+        first--;
+    }
+    int last = std::min(bottleneck + 1, static_cast<int>(path.size()) - 1);
+    while( last < static_cast<int>(path.size()) - 1 && 
+           freeDist[path[last]] < maxProbeRadius_ )
+    {
+        last++;
+    }
+
+    return std::vector<int>(path.begin() + first, path.begin() + last + 1);
+}
+
+
+/*!
+ * Refines path points by maximising the free distance in the plane 
+ * perpendicular to the local path tangent with the Nelder-Mead method. The 
+ * end points lie in bulk and are not refined, their radius is set to the
+ * maximum probe radius as for the probe-based path finders.
+ */
+void
+DistanceTransformPathFinder::refinePath(
+        const std::vector<gmx::RVec> &points)
+{
+    // cost function is minimal free distance function:
+    FixedObjectiveFunction<2> objFun;
+    objFun = [this](const std::array<real, 2> &optimSpacePos)
+    {
+        return findMinimalFreeDistance(optimSpacePos);
+    };
+
+    path_.clear();
+    radii_.clear();
+    nmIter_.clear();
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        // end points are not refined:
+        if( i == 0 || i == points.size() - 1 )
+        {
+            path_.push_back(points[i]);
+            radii_.push_back(maxProbeRadius_);
+            nmIter_.push_back(0);
+            continue;
+        }
+
+        // local tangent from neighbouring points:
+        gmx::RVec tangent;
+        rvec_sub(points[i + 1], points[i - 1], tangent);
+        unitv(tangent, tangent);
+
+        // in-plane basis from projection of global orthogonal vectors:
+        gmx::RVec ref = orthVecU_;
+        if( std::fabs(iprod(ref, tangent)) > 0.5 )
+        {
+            ref = orthVecW_;
+        }
+        gmx::RVec proj;
+        svmul(iprod(ref, tangent), tangent, proj);
+        rvec_sub(ref, proj, crntOrthVecU_);
+        unitv(crntOrthVecU_, crntOrthVecU_);
+        cprod(tangent, crntOrthVecU_, crntOrthVecW_);
+
+        // optimise in plane through Nelder-Mead optimisation:
+        crntProbePos_ = points[i];
+        FixedNelderMeadModule<2> nmm;
+        nmm.setObjFun(objFun);
+        nmm.setParams(params_);
+        nmm.setInitGuess({{0.0, 0.0}});
+        nmm.optimise();
+
+        // add result to path container:
+        path_.push_back(optimToConfig(nmm.getOptimPoint().first));
+        radii_.push_back(nmm.getOptimPoint().second);
+        nmIter_.push_back(nmm.numIterations());
+    }
+}
+
+
+/*!
+ * Returns the position of the voxel with the given linear index in 
+ * configuration space.
+ */
+gmx::RVec
+DistanceTransformPathFinder::voxelPosition(int idx) const
+{
+    int nx = gridDim_[XX];
+    int ny = gridDim_[YY];
+    real u = gridOrigin_[XX] + (idx % nx)*gridSpacing_;
+    real w = gridOrigin_[YY] + ((idx/nx) % ny)*gridSpacing_;
+    real s = gridOrigin_[ZZ] + (idx/(nx*ny))*gridSpacing_;
+
+    gmx::RVec pos;
+    for(int d = 0; d < DIM; d++)
+    {
+        pos[d] = initProbePos_[d] + u*orthVecU_[d] + w*orthVecW_[d] 
+               + s*chanDirVec_[d];
+    }
+    return pos;
+}
+
+
+/*!
+ * Identifies the bulk, i.e. all voxels at which the free distance reaches 
+ * the maximum probe radius and which are connected to the boundary of the 
+ * grid through such voxels. Wide cavities enclosed by the pore-forming atoms
+ * are therefore not considered bulk.
+ */
+std::vector<char>
+DistanceTransformPathFinder::bulkVoxels(
+        const std::vector<real> &freeDist) const
+{
+    int nx = gridDim_[XX];
+    int ny = gridDim_[YY];
+    int nz = gridDim_[ZZ];
+
+    // flood fill from open voxels on grid boundary:
+    std::vector<char> isBulk(freeDist.size(), 0);
+    std::vector<int> queue;
+    for(int v = 0; v < static_cast<int>(freeDist.size()); v++)
+    {
+        int i = v % nx;
+        int j = (v/nx) % ny;
+        int k = v/(nx*ny);
+        bool onBoundary = i == 0 || i == nx - 1 || j == 0 || j == ny - 1 ||
+                          k == 0 || k == nz - 1;
+        if( onBoundary && freeDist[v] >= maxProbeRadius_ )
+        {
+            isBulk[v] = 1;
+            queue.push_back(v);
+        }
+    }
+    for(size_t q = 0; q < queue.size(); q++)
+    {
+        int v = queue[q];
+        int i = v % nx;
+        int j = (v/nx) % ny;
+        int k = v/(nx*ny);
+        for(int dk = -1; dk <= 1; dk++)
+        {
+            for(int dj = -1; dj <= 1; dj++)
+            {
+                for(int di = -1; di <= 1; di++)
+                {
+                    if( i + di < 0 || i + di >= nx ||
+                        j + dj < 0 || j + dj >= ny ||
+                        k + dk < 0 || k + dk >= nz )
+                    {
+                        continue;
+                    }
+                    int w = v + di + nx*(dj + ny*dk);
+                    if( !isBulk[w] && freeDist[w] >= maxProbeRadius_ )
+                    {
+                        isBulk[w] = 1;
+                        queue.push_back(w);
+                    }
+                }
+            }
+        }
+    }
+
+    return isBulk;
+}
+
+
+/*!
+ * Determines the cross section of the pore in the grid slice through the 
+ * initial probe position, i.e. the region of unoccupied voxels in this slice
+ * that are connected to the voxel of the initial probe position through 
+ * voxels sharing a face. If the initial probe position lies inside an atom,
+ * the closest unoccupied voxel in the slice is used instead. The cross 
+ * section must be enclosed by the pore-forming atoms, as otherwise the 
+ * openings on either side of the slice would be connected around the 
+ * outside of the protein.
+ *
+ * Returns a mask over the voxels of the slice with linear index 
+ * \f$ i + n_x j \f$.
+ */
+std::vector<char>
+DistanceTransformPathFinder::poreCrossSection(
+        const std::vector<real> &freeDist) const
+{
+    int nx = gridDim_[XX];
+    int ny = gridDim_[YY];
+    int sliceOffset = nx*ny*probeVoxel_[ZZ];
+
+    // start from unoccupied voxel closest to initial probe position:
+    int start = -1;
+    int minSqDist = std::numeric_limits<int>::max();
+    for(int j = 0; j < ny; j++)
+    {
+        for(int i = 0; i < nx; i++)
+        {
+            int di = i - probeVoxel_[XX];
+            int dj = j - probeVoxel_[YY];
+            if( freeDist[sliceOffset + i + nx*j] > 0.0 && 
+                di*di + dj*dj < minSqDist )
+            {
+                start = i + nx*j;
+                minSqDist = di*di + dj*dj;
+            }
+        }
+    }
+
+    // flood fill over unoccupied voxels sharing a face:
+    std::vector<char> inSection(nx*ny, 0);
+    std::vector<int> queue(1, start);
+    inSection[start] = 1;
+    for(size_t q = 0; q < queue.size(); q++)
+    {
+        int i = queue[q] % nx;
+        int j = queue[q]/nx;
+        if( i == 0 || i == nx - 1 || j == 0 || j == ny - 1 )
+        {
+            throw std::runtime_error("Initial probe position does not lie "
+                                     "inside a pore enclosed by the pathway "
+                                     "selection in the plane perpendicular to "
+                                     "the channel direction vector. Please "
+                                     "check -pf-init-probe-pos and "
+                                     "-pf-chan-dir-vec.");
+        }
+        std::array<int, 4> neighbours = {{queue[q] - 1, queue[q] + 1, 
+                                          queue[q] - nx, queue[q] + nx}};
+        for(auto w : neighbours)
+        {
+            if( !inSection[w] && freeDist[sliceOffset + w] > 0.0 )
+            {
+                inSection[w] = 1;
+                queue.push_back(w);
+            }
+        }
+    }
+
+    return inSection;
+}
+
+
+/*!
+ * Converts between the two-dimensional optimisation space representation to 
+ * the three-dimensional configuration space representation. A point in 
+ * optimisation space is represented by its position in terms of the basis
+ * vectors crntOrthVecU_ and crntOrthVecW_ spanning the plane perpendicular 
+ * to the path at the current probe position.
+ */
+gmx::RVec
+DistanceTransformPathFinder::optimToConfig(
+        const std::array<real, 2> &optimSpacePos)
+{
+    gmx::RVec configSpacePos;
+    for(int d = 0; d < DIM; d++)
+    {
+        configSpacePos[d] = crntProbePos_[d] 
+                          + optimSpacePos[0]*crntOrthVecU_[d]
+                          + optimSpacePos[1]*crntOrthVecW_[d];
+    }
+    return configSpacePos;
+}
@@ -22,13 +22,17 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <iostream>
 #include <limits>
+#include <numeric>
 
 #include <gromacs/math/vec.h>
 
-#include "optim/simulated_annealing_module.hpp"
-#include "optim/nelder_mead_module.hpp"
+#include "optim/fixed_simulated_annealing_module.hpp"
+#include "optim/fixed_nelder_mead_module.hpp"
 
 #include "path-finding/inplane_optimised_probe_path_finder.hpp"
 
@@ -42,14 +46,29 @@ InplaneOptimisedProbePathFinder::InplaneOptimisedProbePathFinder(
         gmx::RVec chanDirVec,
         t_pbc *pbc,
         gmx::AnalysisNeighborhoodPositions porePos,
-        std::vector<real> vdwRadii)
+        const std::vector<real> &vdwRadii)
     : AbstractProbePathFinder(params, initProbePos, vdwRadii)
     , porePos_(porePos)
     , pbc_(pbc)
     , chanDirVec_(chanDirVec)
     , orthVecU_(0.0, 0.0, 0.0)
     , orthVecW_(0.0, 0.0, 0.0)
+    , numInitStarts_(1)
 {
+    // number of independent optimisations of initial position:
+    if( params.find("saNumStarts") != params.end() )
+    {
+        numInitStarts_ = std::max(1, static_cast<int>(params["saNumStarts"]));
+    }
+
+    // each start is a separate chain of random number streams:
+    if( numInitStarts_ > 256 )
+    {
+        throw std::runtime_error("Number of simulated annealing starts may "
+                                 "not exceed 256. Please decrease "
+                                 "-sa-num-starts.");
+    }
+
     // tolerance threshold for norm of vector (which should be unit vectors):
     real nonZeroTol = std::numeric_limits<real>::epsilon();
     if( norm(chanDirVec_) < nonZeroTol )
@@ -142,13 +161,18 @@ InplaneOptimisedProbePathFinder::setParameters(
         nbhCutoff_ = params.maxProbeRadius() + maxVdwRadius_ + safetyMargin;
     }
 
+    // random number streams:
+    setRandomStreamParameters(params);
+
     // set flag to true:
     parametersSet_ = true;
 }
 
 
 /*!
- * Execute path-finding algorithm.
+ * Execute path-finding algorithm. The forward and backward sweeps run 
+ * concurrently and their results are joined afterwards, so that the path 
+ * points are ordered in channel direction.
  */
 void
 InplaneOptimisedProbePathFinder::findPath()
@@ -163,60 +187,138 @@ InplaneOptimisedProbePathFinder::findPath()
     prepareNeighborhoodSearch(
             pbc_,
             porePos_,
-            nbhCutoff_);
+            nbhCutoff_,
+            true);
 
     // optimise initial position:
     optimiseInitialPos();
-    
-    // advance forward:
-    advanceAndOptimise(true);
 
-    // revert array:
-    std::reverse(path_.begin(), path_.end());
-    std::reverse(radii_.begin(), radii_.end());
-    
-    // advance backward:
-    advanceAndOptimise(false);
+    // advance forward and backward concurrently:
+    // (exceptions must not escape the parallel region)
+    ProbeSweep forwardSweep;
+    ProbeSweep backwardSweep;
+    std::exception_ptr forwardError;
+    std::exception_ptr backwardError;
+    #pragma omp parallel sections
+    {
+        #pragma omp section
+        {
+            try
+            {
+                advanceAndOptimise(true, forwardSweep);
+            }
+            catch(...)
+            {
+                forwardError = std::current_exception();
+            }
+        }
+        #pragma omp section
+        {
+            try
+            {
+                advanceAndOptimise(false, backwardSweep);
+            }
+            catch(...)
+            {
+                backwardError = std::current_exception();
+            }
+        }
+    }
+    if( forwardError )
+    {
+        std::rethrow_exception(forwardError);
+    }
+    if( backwardError )
+    {
+        std::rethrow_exception(backwardError);
+    }
+
+    // join reversed forward sweep, initial point, and backward sweep:
+    path_.insert(path_.begin(), 
+                 forwardSweep.path.rbegin(), 
+                 forwardSweep.path.rend());
+    radii_.insert(radii_.begin(), 
+                  forwardSweep.radii.rbegin(), 
+                  forwardSweep.radii.rend());
+    saIter_.insert(saIter_.begin(), 
+                   forwardSweep.saIter.rbegin(), 
+                   forwardSweep.saIter.rend());
+    nmIter_.insert(nmIter_.begin(), 
+                   forwardSweep.nmIter.rbegin(), 
+                   forwardSweep.nmIter.rend());
+    path_.insert(path_.end(), 
+                 backwardSweep.path.begin(), 
+                 backwardSweep.path.end());
+    radii_.insert(radii_.end(), 
+                  backwardSweep.radii.begin(), 
+                  backwardSweep.radii.end());
+    saIter_.insert(saIter_.end(), 
+                   backwardSweep.saIter.begin(), 
+                   backwardSweep.saIter.end());
+    nmIter_.insert(nmIter_.end(), 
+                   backwardSweep.nmIter.begin(), 
+                   backwardSweep.nmIter.end());
 }
 
 
 /*!
- * Optimise initial position of probe.
+ * Optimise initial position of probe. The in-plane optimisation is started
+ * numInitStarts_ times on different random number streams (concurrently if
+ * OpenMP is available) and the largest free radius found is used. Ties are 
+ * resolved in favour of the lowest stream index to keep the result 
+ * independent of the number of threads. The reported number of iterations
+ * is the total over all starts.
  */
 void
 InplaneOptimisedProbePathFinder::optimiseInitialPos()
 {
-    // set current probe position to initial probe position: 
-    crntProbePos_ = initProbePos_;
-
-    // initial state in optimisation space is always null vector:
-    std::vector<real> initState = {0.0, 0.0};
-    
-    // cost function is minimal free distance function:
-    ObjectiveFunction objFun;
-    objFun = std::bind(&InplaneOptimisedProbePathFinder::findMinimalFreeDistance, 
-                       this, std::placeholders::_1);
-
-    // optimise in plane through simulated annealing:
-    SimulatedAnnealingModule sam;
-    sam.setObjFun(objFun);
-    sam.setParams(params_);
-    sam.setInitGuess(initState);
-    sam.optimise();
+    // independent optimisations of initial position:
+    std::vector<FixedOptimSpacePoint<2>> optima(numInitStarts_);
+    std::vector<int> saIter(numInitStarts_, 0);
+    std::vector<int> nmIter(numInitStarts_, 0);
+    std::vector<std::exception_ptr> errors(numInitStarts_);
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < numInitStarts_; i++)
+    {
+        try
+        {
+            ProbeNeighbourList nbhList;
+            optima[i] = optimiseInPlane(
+                    initProbePos_, 
+                    annealingStream(frameIndex_, i, 0), 
+                    nbhList, 
+                    saIter[i], 
+                    nmIter[i]);
+        }
+        catch(...)
+        {
+            errors[i] = std::current_exception();
+        }
+    }
+    for(auto &error : errors)
+    {
+        if( error )
+        {
+            std::rethrow_exception(error);
+        }
+    }
 
-    // refine with Nelder-Mead optimisation:
-    NelderMeadModule nmm;
-    nmm.setObjFun(objFun);
-    nmm.setParams(params_);
-    nmm.setInitGuess(sam.getOptimPoint().first);
-    nmm.optimise();
+    // select best optimum:
+    int best = 0;
+    for(int i = 1; i < numInitStarts_; i++)
+    {
+        if( optima[i].second > optima[best].second )
+        {
+            best = i;
+        }
+    }
        
     // set initial position to its optimal value:
-    initProbePos_ = optimToConfig(nmm.getOptimPoint().first);
+    initProbePos_ = inplaneToConfig(initProbePos_, optima[best].first);
 
     // handle situation where cutoff radius was too small:
     // (or otherwise no particle was found within cutoff radius)
-    if( std::isinf( nmm.getOptimPoint().second ) )
+    if( std::isinf( optima[best].second ) )
     {
         throw std::runtime_error("Pore radius at initial probe position is "
                                  "infinite. Consider increasing the maximum "
@@ -226,19 +328,26 @@ InplaneOptimisedProbePathFinder::optimiseInitialPos()
     }
 
     // add path support point and associated radius to container:
-    path_.push_back(initProbePos_);
-    radii_.push_back(nmm.getOptimPoint().second);   
+    path_.assign(1, initProbePos_);
+    radii_.assign(1, optima[best].second);
+    saIter_.assign(1, std::accumulate(saIter.begin(), saIter.end(), 0));
+    nmIter_.assign(1, std::accumulate(nmIter.begin(), nmIter.end(), 0));
 }
 
 
 /*!
- * Optimise probe position in subsequent parallel planes.
+ * Optimise probe position in subsequent parallel planes. Only touches local
+ * state and the given sweep container, so that the forward and backward 
+ * sweeps can run concurrently. The neighbour list is carried over from plane
+ * to plane, as the probe usually stays within its skin for several steps.
  */
 void
-InplaneOptimisedProbePathFinder::advanceAndOptimise(bool forward)
+InplaneOptimisedProbePathFinder::advanceAndOptimise(
+        bool forward,
+        ProbeSweep &sweep)
 {
     // set previous position to initial point:
-    crntProbePos_ = initProbePos_;
+    gmx::RVec probePos = initProbePos_;
 
     // set up direction vector for forward/backward marching:
     gmx::RVec direction(chanDirVec_);
@@ -249,61 +358,106 @@ InplaneOptimisedProbePathFinder::advanceAndOptimise(bool forward)
         direction[ZZ] = -direction[ZZ];
     }
 
-    // initial state in optimisation space is always null vector:
-    std::vector<real> initState = {0.0, 0.0};
-
-    // cost function is minimal free distance function:
-    ObjectiveFunction objFun;
-    objFun = std::bind(&InplaneOptimisedProbePathFinder::findMinimalFreeDistance, 
-                       this, std::placeholders::_1);
+    // chain of random number streams of this sweep:
+    // (planes are counted from one, plane zero is the initial position)
+    uint64_t chain = forward ? 0 : 1;
 
+    // neighbour list of this sweep:
+    ProbeNeighbourList nbhList;
 
     // advance probe in direction of (inverse) channel direction vector:
     int numProbeSteps = 0;
     while(true)
     {
         // advance probe position to next plane:
-        crntProbePos_[XX] = crntProbePos_[XX] + probeStepLength_*direction[XX];
-        crntProbePos_[YY] = crntProbePos_[YY] + probeStepLength_*direction[YY];
-        crntProbePos_[ZZ] = crntProbePos_[ZZ] + probeStepLength_*direction[ZZ]; 
-
-        // optimise in plane through simulated annealing:
-        SimulatedAnnealingModule sam;
-        sam.setObjFun(objFun);
-        sam.setParams(params_);
-        sam.setInitGuess(initState);
-        sam.optimise();
-
-        // refine with Nelder-Mead optimisation:
-        NelderMeadModule nmm;
-        nmm.setObjFun(objFun);
-        nmm.setParams(params_);
-        nmm.setInitGuess(sam.getOptimPoint().first);
-        nmm.optimise();
+        probePos[XX] = probePos[XX] + probeStepLength_*direction[XX];
+        probePos[YY] = probePos[YY] + probeStepLength_*direction[YY];
+        probePos[ZZ] = probePos[ZZ] + probeStepLength_*direction[ZZ]; 
+
+        // optimise in plane:
+        int saIter = 0;
+        int nmIter = 0;
+        FixedOptimSpacePoint<2> optim = optimiseInPlane(
+                probePos,
+                annealingStream(frameIndex_, chain, numProbeSteps + 1),
+                nbhList,
+                saIter,
+                nmIter);
  
         // current position becomes best position in plane: 
-        crntProbePos_ = optimToConfig(nmm.getOptimPoint().first);
+        probePos = inplaneToConfig(probePos, optim.first);
                
         // increment probe step counter:
         numProbeSteps++;      
 
         // add result to path container: 
-        path_.push_back(crntProbePos_);
-        radii_.push_back(nmm.getOptimPoint().second);     
+        sweep.path.push_back(probePos);
+        sweep.radii.push_back(optim.second);
+        sweep.saIter.push_back(saIter);
+        sweep.nmIter.push_back(nmIter);
 
         // check termination conditions:
         if( numProbeSteps >= maxProbeSteps_ )
         {
             break;
         }
-        if( nmm.getOptimPoint().second > maxProbeRadius_ )
+        if( optim.second > maxProbeRadius_ )
         {
             break;
         }
     }
 
     // change radius of ultimate point to match the desired cutoff exactly:
-    radii_.back() = maxProbeRadius_;
+    sweep.radii.back() = maxProbeRadius_;
+}
+
+
+/*!
+ * Maximises the free distance in the plane through planeOrigin that is 
+ * orthogonal to the channel direction vector, first by simulated annealing on
+ * the given random number stream and then by Nelder-Mead refinement. Free 
+ * distances are evaluated from the given neighbour list. Returns the optimum
+ * in terms of the in-plane basis vectors and sets the number of iterations 
+ * performed by either method.
+ */
+FixedOptimSpacePoint<2>
+InplaneOptimisedProbePathFinder::optimiseInPlane(
+        const gmx::RVec &planeOrigin,
+        uint64_t stream,
+        ProbeNeighbourList &nbhList,
+        int &saIter,
+        int &nmIter)
+{
+    // cost function is minimal free distance function:
+    FixedObjectiveFunction<2> objFun;
+    objFun = [this, &planeOrigin, &nbhList](
+            const std::array<real, 2> &optimSpacePos)
+    {
+        return findMinimalFreeDistance(
+                inplaneToConfig(planeOrigin, optimSpacePos),
+                nbhList);
+    };
+
+    // optimise in plane through simulated annealing:
+    // (initial state in optimisation space is always null vector)
+    FixedSimulatedAnnealingModule<2> sam;
+    sam.setObjFun(objFun);
+    sam.setParams(params_);
+    sam.setInitGuess({{0.0, 0.0}});
+    sam.setRandomSeed(randomSeed_);
+    sam.setRandomStream(stream);
+    sam.optimise();
+
+    // refine with Nelder-Mead optimisation:
+    FixedNelderMeadModule<2> nmm;
+    nmm.setObjFun(objFun);
+    nmm.setParams(params_);
+    nmm.setInitGuess(sam.getOptimPoint().first);
+    nmm.optimise();
+
+    saIter = sam.getNumCoolingIter();
+    nmIter = nmm.numIterations();
+    return nmm.getOptimPoint();
 }
 
 
@@ -312,21 +466,34 @@ InplaneOptimisedProbePathFinder::advanceAndOptimise(bool forward)
  * the three-dimensional configuration space representation. A point in 
  * optimisation space is represented by its position on terms of the in-plane
  * basis spanning vectors orthVecU_ and orthVecW_, which are both orthogonal
- * to the channel direction vector.
+ * to the channel direction vector, relative to the given plane origin.
  */
 gmx::RVec
-InplaneOptimisedProbePathFinder::optimToConfig(std::vector<real> optimSpacePos)
+InplaneOptimisedProbePathFinder::inplaneToConfig(
+        const gmx::RVec &planeOrigin,
+        const std::array<real, 2> &optimSpacePos) const
 {
     // get configuration space position via orthogonal vectors:
     gmx::RVec configSpacePos;
-    configSpacePos[XX] = crntProbePos_[XX] + optimSpacePos[0]*orthVecU_[XX]
-                                           + optimSpacePos[1]*orthVecW_[XX];
-    configSpacePos[YY] = crntProbePos_[YY] + optimSpacePos[0]*orthVecU_[YY]
-                                           + optimSpacePos[1]*orthVecW_[YY];
-    configSpacePos[ZZ] = crntProbePos_[ZZ] + optimSpacePos[0]*orthVecU_[ZZ] 
-                                           + optimSpacePos[1]*orthVecW_[ZZ];
+    configSpacePos[XX] = planeOrigin[XX] + optimSpacePos[0]*orthVecU_[XX]
+                                         + optimSpacePos[1]*orthVecW_[XX];
+    configSpacePos[YY] = planeOrigin[YY] + optimSpacePos[0]*orthVecU_[YY]
+                                         + optimSpacePos[1]*orthVecW_[YY];
+    configSpacePos[ZZ] = planeOrigin[ZZ] + optimSpacePos[0]*orthVecU_[ZZ] 
+                                         + optimSpacePos[1]*orthVecW_[ZZ];
     
     // return configuration space position:
     return(configSpacePos);
 }
 
+
+/*!
+ * Implements the conversion interface of AbstractProbePathFinder with the 
+ * current probe position as plane origin.
+ */
+gmx::RVec
+InplaneOptimisedProbePathFinder::optimToConfig(
+        const std::array<real, 2> &optimSpacePos)
+{
+    return inplaneToConfig(crntProbePos_, optimSpacePos);
+}
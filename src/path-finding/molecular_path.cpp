@@ -28,7 +28,6 @@
 #include <limits>
 #include <ctime>
 
-#include <boost/math/tools/minima.hpp>
 
 #include <gromacs/pbcutil/pbc.h>
 #include <gromacs/selection/nbsearch.h>
@@ -258,17 +257,21 @@ MolecularPath::~MolecularPath()
  *
  * The return value is a vector of points in spline coordinates ordered in the 
  * same way as the input vector. Internally, this uses mapPosition() for each 
- * input position.
+ * input position. The angular coordinate is only computed if the angular 
+ * flag is set (see SplineCurve3D::cartesianToCurvilinear()).
  */
 std::vector<gmx::RVec>
-MolecularPath::mapPositions(const std::vector<gmx::RVec> &positions)
+MolecularPath::mapPositions(
+        const std::vector<gmx::RVec> &positions,
+        bool angular)
 {
     // map all input positions onto centre line:
     std::vector<gmx::RVec> mappedPositions;
     mappedPositions.reserve(positions.size());
     for(auto pos : positions)
     {
-        mappedPositions.push_back(centreLine_.cartesianToCurvilinear(pos));
+        mappedPositions.push_back(
+                centreLine_.cartesianToCurvilinear(pos, angular));
     }
  
     // return mapped positions:
@@ -285,7 +288,9 @@ MolecularPath::mapPositions(const std::vector<gmx::RVec> &positions)
  * coordinates.
  */
 std::map<int, gmx::RVec>
-MolecularPath::mapSelection(const gmx::Selection &mapSel)
+MolecularPath::mapSelection(
+        const gmx::Selection &mapSel,
+        bool angular)
 {
     // build map of pathway mapped coordinates:
     std::map<int, gmx::RVec> mappedCoords;
@@ -293,7 +298,8 @@ MolecularPath::mapSelection(const gmx::Selection &mapSel)
     {
         unsigned int idx = mapSel.position(i).refId();
         mappedCoords[idx] = centreLine_.cartesianToCurvilinear(
-                mapSel.position(i).x());
+                mapSel.position(i).x(),
+                angular);
     }
 
     // return mapped coordinates:
@@ -569,56 +575,14 @@ MolecularPath::centreLineCtrlPoints() const
  * Finds the minimum radius of the path and the location along the centre line
  * (in the current parameterisation) of this minimum. 
  *
- * This is achieved by first sampling a set of trial points no more than 0.1
- * nm apart along the centreline and evaluating the path radius at all of these
- * points. The position of the minimum radius sample point is then used to 
- * create input to Brent's minimisation algorithm. The initial bracketing 
- * interval for Brent's algorithm is taken as one sampling point above and 
- * below the minimum radius sampling point, if this point lies somewhere in 
- * between the the centre line's endpoints. If the minimum radius sampling
- * point falls on either endpoint of the centeline, this point itself is taken
- * as one of the bracketing interval's limits.
- *
- * Note that Brent's algorithm is currently limited to a hardcoded limit of
- * 100 iterations.
+ * As the radius profile is a cubic spline, this is done exactly by means of
+ * SplineCurve1D::minimum(), which compares the radius at the pore openings
+ * with its value at the critical points inside each knot span.
  */
 std::pair<real, real>
 MolecularPath::minRadius()
 {
-    // internal parameters:
-    real maxSampleDist = 0.1;
-    boost::uintmax_t maxIter = 100;
-
-    // draw radius samples along path:
-    int nSamples = std::ceil(length_/maxSampleDist);
-    std::vector<real> s = sampleArcLength(nSamples, 0.0);
-    std::vector<real> r = sampleRadii(s);
-   
-    // find smallest sample radius:
-    auto itMin = std::min_element(r.begin(), r.end());
-    int idxMin = std::distance(r.begin(), itMin);
-
-    // determine bracketing interval:
-    real sMin = s[idxMin - 1];
-    real sMax = s[idxMin + 1];
-    if( itMin == r.begin() )
-    {
-        sMin = s[idxMin];
-        sMax = s[idxMin + 1];
-    }
-    else if( itMin == r.end() )
-    {
-        sMin = s[idxMin - 1];
-        sMax = s[idxMin];
-    }
-
-    // return minimum and arg min:    
-    return boost::math::tools::brent_find_minima(
-            std::bind(&MolecularPath::radius, this, std::placeholders::_1), 
-            sMin, 
-            sMax, 
-            std::numeric_limits<real>::digits,
-            maxIter);
+    return poreRadius_.minimum(std::make_pair(openingLo_, openingHi_));
 }
 
 
@@ -634,11 +598,10 @@ MolecularPath::minRadius()
  *
  *  where \f$ R(s) \f$ denotes the radius at a given point along the spline.
  *
- *  This integral is solved numerically by applying a sixth order Newton-Cotes
- *  scheme (Weddle's rule) in each interval between two subsequent knots. Since
- *  the path radius is \f$ \mathcal{O}(s^3) \f$ by construction, the integrand 
- *  is guaranteed to be of order \f$ \mathcal{O}(s^6) \f$ so the integration
- *  is exact.
+ *  Since the path radius is a cubic polynomial on each knot span, the 
+ *  integrand is a polynomial of degree six and the integral is evaluated
+ *  analytically by SplineCurve1D::integrateSquared(). This is exact also for
+ *  non-uniformly spaced knots.
  *
  *  The volume is nonetheless an estimate due to (i) the cross-sectional area
  *  of a path not being truly circular and (ii) the dependency of radius on
@@ -649,49 +612,8 @@ MolecularPath::minRadius()
 real
 MolecularPath::volume()
 {
-    // initialise number of intervals larger than number of spline intervals:
-    // (this ensures that function is polynomial on each interval)
-    size_t numIntervals = (poreRadius_.nKnots()) - 2*poreRadius_.degree() - 1;
-
-    // integration interval:
-    real h = length_/numIntervals;
-
-    // sample path radii:
-    int numPoints = 6*numIntervals + 1;
-    std::vector<real> radii = sampleRadii(numPoints, 0.0);
-    std::vector<real> s = sampleArcLength(numPoints, 0.0);
-  
-    // calculate squared radii:
-    std::vector<real> sqRadii;
-    sqRadii.reserve(radii.size());
-    for(size_t i = 0; i < radii.size(); i++)
-    {
-        sqRadii.push_back(radii[i]*radii[i]);
-    }
-
-    // evaluate integral using fine grained support points:
-    real integral = 0.0;
-    for(size_t i = 0; i < numIntervals; i++)
-    {
-        // index to vector of radii:
-        int idx = 6*i;
-
-        // integrate this interval using Weddle's Rule:
-        integral +=  41.0*sqRadii[idx] + 
-                    216.0*sqRadii[idx+1] +
-                     27.0*sqRadii[idx+2] +
-                    272.0*sqRadii[idx+3] + 
-                     27.0*sqRadii[idx+4] +
-                    216.0*sqRadii[idx+5] +
-                     41.0*sqRadii[idx+6];
-    }
-    integral *= h/840.0;
-
-    // multiply in constant factor:
-    integral *= PI_;
-
-    // return value of integral:
-    return integral;
+    return PI_*poreRadius_.integrateSquared(
+            std::make_pair(openingLo_, openingHi_));
 }
 
 
@@ -747,16 +669,7 @@ std::vector<gmx::RVec>
 MolecularPath::samplePoints(std::vector<real> arcLengthSample)
 {
     // evaluate spline to obtain sample points:
-    std::vector<gmx::RVec> points;
-    points.reserve(arcLengthSample.size());
-    for(size_t i = 0; i < arcLengthSample.size(); i++)
-    {
-        // evaluate spline at this point:
-        points.push_back( centreLine_.evaluate(arcLengthSample[i], 0) );
-    }
-
-    // return vector of points:
-    return points;
+    return centreLine_.evaluateMultiple(arcLengthSample, 0);
 }
 
 
@@ -783,17 +696,8 @@ MolecularPath::sampleTangents(size_t nPoints, real extrapDist)
 std::vector<gmx::RVec>
 MolecularPath::sampleTangents(std::vector<real> arcLengthSample)
 {    
-    // evaluate spline to obtain sample points:
-    std::vector<gmx::RVec> tangents;
-    tangents.reserve(arcLengthSample.size());
-    for(size_t i = 0; i < arcLengthSample.size(); i++)
-    {
-        // evaluate spline at this point:
-        tangents.push_back( centreLine_.tangentVec(arcLengthSample[i]) );
-    }
-
-    // return vector of points:
-    return tangents;
+    // evaluate spline to obtain tangents:
+    return centreLine_.evaluateMultiple(arcLengthSample, 1);
 }
 
 
@@ -831,19 +735,16 @@ MolecularPath::sampleNormTangents(size_t nPoints, real extrapDist)
 std::vector<gmx::RVec>
 MolecularPath::sampleNormTangents(std::vector<real> arcLengthSample)
 {    
-    // evaluate spline to obtain sample points:
+    // evaluate spline to obtain tangents:
     std::vector<gmx::RVec> tangents;
-    tangents.reserve(arcLengthSample.size());
-    for(size_t i = 0; i < arcLengthSample.size(); i++)
-    {
-        // evaluate spline at this point:
-        tangents.push_back( centreLine_.tangentVec(arcLengthSample[i]) );
+    tangents = centreLine_.evaluateMultiple(arcLengthSample, 1);
 
-        // normalise tangent vector:
-        unitv(tangents.back(), tangents.back());
+    // normalise tangent vectors:
+    for(auto &tangent : tangents)
+    {
+        unitv(tangent, tangent);
     }
 
-    // return vector of points:
     return tangents;
 }
 
@@ -884,22 +785,8 @@ std::vector<real>
 MolecularPath::sampleRadii(size_t nPoints,
                            real extrapDist)
 {
-    // get spacing of points in arc length:
-    real arcLenStep = sampleArcLenStep(nPoints, extrapDist);
-
-    // evaluate spline to obtain sample points:
-    std::vector<real> radii;
-    for(size_t i = 0; i < nPoints; i++)
-    {
-        // calculate evaluation point:
-        real evalPoint = openingLo_ - extrapDist + i*arcLenStep;  
-
-        // evaluate spline at this point:
-        radii.push_back( poreRadius_.evaluate(evalPoint, 0) );
-    }
-
-    // return vector of points:
-    return radii;
+    // evaluate spline at equidistant arc length values:
+    return sampleRadii(sampleArcLength(nPoints, extrapDist));
 }
 
 
@@ -909,16 +796,8 @@ MolecularPath::sampleRadii(size_t nPoints,
 std::vector<real>
 MolecularPath::sampleRadii(std::vector<real> arcLengthSample)
 {
-    // evaluate spline to obtain sample points:
-    std::vector<real> radii;
-    for(size_t i = 0; i < arcLengthSample.size(); i++)
-    {
-        // evaluate spline at this point:
-        radii.push_back( poreRadius_.evaluate(arcLengthSample[i], 0) );
-    }
-
-    // return vector of points:
-    return radii;
+    // evaluate spline to obtain radii:
+    return poreRadius_.evaluateMultiple(arcLengthSample, 0);
 }
 
 
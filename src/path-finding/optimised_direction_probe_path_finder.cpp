@@ -21,210 +21,387 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-#ifdef NOTDEFINED
+#include <gromacs/math/vec.h>
 
-#include <iostream>
-#include <cmath>
+#include "optim/fixed_simulated_annealing_module.hpp"
+#include "optim/fixed_nelder_mead_module.hpp"
 
-#include "optim/simulated_annealing_module.hpp"
 #include "path-finding/optimised_direction_probe_path_finder.hpp"
 
 
-/*
+/*!
  * Constructor.
  */
 OptimisedDirectionProbePathFinder::OptimisedDirectionProbePathFinder(
-        real probeStepLength,
-        real probeRadius,
-        real maxFreeDist,
-        int maxProbeSteps,
+        std::map<std::string, real> params,
         gmx::RVec initProbePos,
-        std::vector<real> vdwRadii,
-        gmx::AnalysisNeighborhoodSearch *nbSearch,
-        int saRandomSeed,
-        int saMaxCoolingIter,
-        int saNumCostSamples,
-        real saXi,
-        real saConvRelTol,
-        real saInitTemp,
-        real saCoolingFactor,
-        real saStepLengthFactor,
-        bool saUseAdaptiveCandGen)
-    : AbstractProbePathFinder(probeStepLength, probeRadius, maxFreeDist, 
-                              maxProbeSteps, initProbePos, vdwRadii, nbSearch,
-                              saRandomSeed, saMaxCoolingIter, saNumCostSamples,
-                              saXi, saConvRelTol, saInitTemp, saCoolingFactor,
-                              saStepLengthFactor, saUseAdaptiveCandGen)
+        gmx::RVec chanDirVec,
+        t_pbc *pbc,
+        gmx::AnalysisNeighborhoodPositions porePos,
+        const std::vector<real> &vdwRadii)
+    : AbstractProbePathFinder(params, initProbePos, vdwRadii)
+    , porePos_(porePos)
+    , pbc_(pbc)
+    , chanDirVec_(chanDirVec)
+    , dirVec_(0.0, 0.0, 0.0)
+    , orthVecU_(0.0, 0.0, 0.0)
+    , orthVecW_(0.0, 0.0, 0.0)
 {
+    // tolerance threshold for norm of vector (which should be unit vectors):
+    real nonZeroTol = std::numeric_limits<real>::epsilon();
+    if( norm(chanDirVec_) < nonZeroTol )
+    {
+        throw std::runtime_error("Channel direction vector has norm close to "
+                                 "zero. Please provide a finite-length channel "
+                                 "direction vector with -pf-chan-dir-vec.");
+    }
 
-    // initialise inverse rotation matrix as identity matrix:
-    clear_mat(inverseRotationMatrix_);
+    // normalise channel direction vector:
+    unitv(chanDirVec_, chanDirVec_);
 }
 
 
-/*
- *
+/*!
+ * Set parameters for path-finding.
  */
 void
-OptimisedDirectionProbePathFinder::findPath()
+OptimisedDirectionProbePathFinder::setParameters(
+        const PathFindingParameters &params)
 {
-    std::cout<<"Yo!"<<std::endl;
+    // set parameters:
+    probeStepLength_ = params.probeStepLength();
+    maxProbeRadius_ = params.maxProbeRadius();
+    maxProbeSteps_ = params.maxProbeSteps();
 
-    // opimise initial
-    
-    // forward
+    // has cutoff been set by user:
+    if( params.nbhCutoffIsSet() )
+    {
+        // user given cutoff:
+        nbhCutoff_ = params.nbhCutoff();
+    }
+    else
+    {
+        // calculate cutoff automatically:
+        real safetyMargin = std::sqrt(std::numeric_limits<real>::epsilon());
+        nbhCutoff_ = params.maxProbeRadius() + maxVdwRadius_ + safetyMargin;
+    }
 
-    // array inversion
+    // random number streams:
+    setRandomStreamParameters(params);
 
-    // backward
+    // set flag to true:
+    parametersSet_ = true;
 }
 
 
-/*
- *
+/*!
+ * Execute path-finding algorithm.
  */
 void
-OptimisedDirectionProbePathFinder::optimiseInitialPos()
+OptimisedDirectionProbePathFinder::findPath()
 {
+    // sanity check:
+    if( !parametersSet_ )
+    {
+        throw std::logic_error("Path finding parameters have not been set.");
+    }
+
+    // prepare neighborhood search:
+    prepareNeighborhoodSearch(
+            pbc_,
+            porePos_,
+            nbhCutoff_,
+            true);
 
+    // optimise initial position:
+    optimiseInitialPos();
+    
+    // advance forward:
+    advanceAndOptimise(true);
+
+    // revert array:
+    std::reverse(path_.begin(), path_.end());
+    std::reverse(radii_.begin(), radii_.end());
+    std::reverse(saIter_.begin(), saIter_.end());
+    std::reverse(nmIter_.begin(), nmIter_.end());
+    
+    // advance backward:
+    advanceAndOptimise(false);
 }
 
 
 /*!
- * Advances the probe position in an optimised direction until the probe radius
- * exceeds a specified limit (or a maximum number of probe steps has been 
- * exceeded).
+ * Returns the maximum angle (in radians) by which the direction of probe 
+ * motion may change between two consecutive probe steps.
  */
-void
-OptimisedDirectionProbePathFinder::advanceAndOptimise(gmx::RVec initDirection)
+real
+OptimisedDirectionProbePathFinder::maxDirChangeAngle() const
 {
-
+    return maxDirChangeAngle_;
 }
 
 
 /*!
- * Updates inverse rotation matrix used in conversion between optimisation and 
- * configuration space.
- *
- * The exact procedure is based on Rodrigues' rotation formula, from which it
- * can be derived that the rotation matrix mapping a unit vector a onto a unit
- * vector b is given by
- *
- *     R = I + K + K^2 * 1/(1+cos(alpha))
- *
- * Here I is the identity matrix, K is the cross-product matrix prescribing the
- * direction of the rotation axis in space, and alpha the angle by which 
- * vector a is rotated around that axis to be mapped onto b.
+ * Optimise initial position of probe in the plane orthogonal to the channel
+ * direction vector.
  */
 void
-OptimisedDirectionProbePathFinder::updateInverseRotationMatrix(gmx::RVec direction)
+OptimisedDirectionProbePathFinder::optimiseInitialPos()
 {
-    /*
+    // set current probe position to initial probe position: 
+    crntProbePos_ = initProbePos_;
 
-    // internal tolerance for floating point comparison:
-    real zeroTol = 1e-7;
+    // initial plane is orthogonal to channel direction vector:
+    updateDirection(chanDirVec_);
+
+    // initial state in optimisation space is always null vector:
+    std::array<real, 2> initState = {{0.0, 0.0}};
+    
+    // cost function is minimal free distance function:
+    FixedObjectiveFunction<2> objFun;
+    objFun = [this](const std::array<real, 2> &optimSpacePos)
+    {
+        return findMinimalFreeDistance(optimSpacePos);
+    };
+
+    // optimise in plane through simulated annealing:
+    FixedSimulatedAnnealingModule<2> sam;
+    sam.setObjFun(objFun);
+    sam.setParams(params_);
+    sam.setInitGuess(initState);
+    sam.setRandomSeed(randomSeed_);
+    sam.setRandomStream(annealingStream(frameIndex_, 0, 0));
+    sam.optimise();
+
+    // refine with Nelder-Mead optimisation:
+    FixedNelderMeadModule<2> nmm;
+    nmm.setObjFun(objFun);
+    nmm.setParams(params_);
+    nmm.setInitGuess(sam.getOptimPoint().first);
+    nmm.optimise();
+       
+    // set initial position to its optimal value:
+    initProbePos_ = optimToConfig(nmm.getOptimPoint().first);
+
+    // handle situation where cutoff radius was too small:
+    // (or otherwise no particle was found within cutoff radius)
+    if( std::isinf( nmm.getOptimPoint().second ) )
+    {
+        throw std::runtime_error("Pore radius at initial probe position is "
+                                 "infinite. Consider increasing the maximum "
+                                 "pore radius with -pf-max-free-dist or set "
+                                 "an appropriate cutoff for neighbourhood "
+                                 "searches explicitly with -pf-cutoff.");
+    }
 
-    // reset inverse rotation matrix to zero:
-    clear_mat(inverseRotationMatrix_);
+    // add path support point and associated radius to container:
+    path_.push_back(initProbePos_);
+    radii_.push_back(nmm.getOptimPoint().second);   
+    saIter_.push_back(sam.getNumCoolingIter());
+    nmIter_.push_back(nmm.numIterations());
+}
 
-    // get z-basis vector in rotated and standard/global system:
-    gmx::RVec stdBasisZ(0.0, 0.0, 1.0);
-    gmx::RVec rotBasisZ(direction);
-    unitv(rotBasisZ, rotBasisZ);
 
-    // calculate cosine of rotation angle: 
-    real cosRotAngle = iprod(stdBasisZ, rotBasisZ);
+/*!
+ * Advances the probe and optimises its position in the plane orthogonal to 
+ * the current direction of motion. After each step, the direction of motion
+ * is turned towards the displacement between the previous and the current 
+ * optimal probe position, where the change in direction is limited to 
+ * maxDirChangeAngle_.
+ */
+void
+OptimisedDirectionProbePathFinder::advanceAndOptimise(bool forward)
+{
+    // set previous position to initial point:
+    crntProbePos_ = initProbePos_;
 
-    // check if edge cases need to be handled:
-    if( std::abs(cosRotAngle - 1.0) < zeroTol )
+    // initial direction is (inverse) channel direction vector:
+    gmx::RVec direction(chanDirVec_);
+    if( !forward )
     {
-        // in parallel case inverse rotation matrix is identity matrix:
-        inverseRotationMatrix_[XX][XX] = 1.0;
-        inverseRotationMatrix_[YY][YY] = 1.0;
-        inverseRotationMatrix_[ZZ][ZZ] = 1.0;
+        direction[XX] = -direction[XX];
+        direction[YY] = -direction[YY];
+        direction[ZZ] = -direction[ZZ];
     }
-    else if (std::abs(cosRotAngle + 1.0) < zeroTol )
+    updateDirection(direction);
+
+    // initial state in optimisation space is always null vector:
+    std::array<real, 2> initState = {{0.0, 0.0}};
+
+    // cost function is minimal free distance function:
+    FixedObjectiveFunction<2> objFun;
+    objFun = [this](const std::array<real, 2> &optimSpacePos)
     {
-        // in anti-parallel case rotate by pi around (global) x-axis:
-        inverseRotationMatrix_[XX][XX] =  1.0;
-        inverseRotationMatrix_[XX][XX] = -1.0;
-        inverseRotationMatrix_[XX][XX] = -1.0; 
-    }
-    else
+        return findMinimalFreeDistance(optimSpacePos);
+    };
+
+    // chain of random number streams of this direction:
+    // (planes are counted from one, plane zero is the initial position)
+    uint64_t chain = forward ? 0 : 1;
+
+    // limits on change in direction:
+    real cosMaxDirChange = std::cos(maxDirChangeAngle_);
+    real sinMaxDirChange = std::sin(maxDirChangeAngle_);
+    real nonZeroTol = std::numeric_limits<real>::epsilon();
+
+    // advance probe along local pore axis:
+    int numProbeSteps = 0;
+    while(true)
     {
-        // calculate rotation axis vector:
-        gmx::RVec rotAxisVec;
-        cprod(stdBasisZ, rotBasisZ, rotAxisVec);
-
-        // calculate cross product matrix:
-        matrix rotationMatrix;
-        rotationMatrix[XX][YY] = -rotAxisVec[ZZ];
-        rotationMatrix[XX][ZZ] =  rotAxisVec[YY];
-        rotationMatrix[YY][XX] =  rotAxisVec[ZZ];
-        rotationMatrix[YY][ZZ] = -rotAxisVec[XX];
-        rotationMatrix[ZZ][XX] = -rotAxisVec[YY];
-        rotationMatrix[ZZ][YY] =  rotAxisVec[XX];
-
-        // calculate and scale square cross product matrix:
-        matrix sqCrossProdMat;
-        mmul(rotationMatrix, rotationMatrix, sqCrossProdMat);
-        msmul(sqCrossProdMat, 1.0/(1.0 + cosRotAngle), sqCrossProdMat);
-
-        // add this to inverse rotation matrix:
-        m_add(rotationMatrix, sqCrossProdMat, rotationMatrix);
-
-        // add diagonal entries to inverse roation matrix:
-        rotationMatrix[XX][XX] += 1.0;
-        rotationMatrix[YY][YY] += 1.0;
-        rotationMatrix[ZZ][ZZ] += 1.0;
-
-        // transpose this:
-        transpose(rotationMatrix, inverseRotationMatrix_);
-    }   
-
-    */
+        // advance probe position to next plane:
+        gmx::RVec prevProbePos = crntProbePos_;
+        crntProbePos_[XX] = crntProbePos_[XX] + probeStepLength_*dirVec_[XX];
+        crntProbePos_[YY] = crntProbePos_[YY] + probeStepLength_*dirVec_[YY];
+        crntProbePos_[ZZ] = crntProbePos_[ZZ] + probeStepLength_*dirVec_[ZZ]; 
+
+        // optimise in plane through simulated annealing:
+        FixedSimulatedAnnealingModule<2> sam;
+        sam.setObjFun(objFun);
+        sam.setParams(params_);
+        sam.setInitGuess(initState);
+        sam.setRandomSeed(randomSeed_);
+        sam.setRandomStream(
+                annealingStream(frameIndex_, chain, numProbeSteps + 1));
+        sam.optimise();
+
+        // refine with Nelder-Mead optimisation:
+        FixedNelderMeadModule<2> nmm;
+        nmm.setObjFun(objFun);
+        nmm.setParams(params_);
+        nmm.setInitGuess(sam.getOptimPoint().first);
+        nmm.optimise();
+ 
+        // current position becomes best position in plane: 
+        crntProbePos_ = optimToConfig(nmm.getOptimPoint().first);
+               
+        // increment probe step counter:
+        numProbeSteps++;      
+
+        // add result to path container: 
+        path_.push_back(crntProbePos_);
+        radii_.push_back(nmm.getOptimPoint().second);     
+        saIter_.push_back(sam.getNumCoolingIter());
+        nmIter_.push_back(nmm.numIterations());
+
+        // check termination conditions:
+        if( numProbeSteps >= maxProbeSteps_ )
+        {
+            break;
+        }
+        if( nmm.getOptimPoint().second > maxProbeRadius_ )
+        {
+            break;
+        }
+
+        // local pore axis is approximated by displacement in this step:
+        gmx::RVec localAxis;
+        rvec_sub(crntProbePos_, prevProbePos, localAxis);
+        unitv(localAxis, localAxis);
+
+        // limit change in direction by rotating towards local axis:
+        real cosDirChange = iprod(localAxis, dirVec_);
+        if( cosDirChange < cosMaxDirChange )
+        {
+            // component of local axis orthogonal to current direction:
+            gmx::RVec orthAxis;
+            svmul(cosDirChange, dirVec_, orthAxis);
+            rvec_sub(localAxis, orthAxis, orthAxis);
+
+            // keep current direction if axis is (anti-)parallel to it:
+            if( norm(orthAxis) < nonZeroTol )
+            {
+                continue;
+            }
+            unitv(orthAxis, orthAxis);
+
+            // rotate by maximum angle in plane spanned by both vectors:
+            localAxis[XX] = cosMaxDirChange*dirVec_[XX] + sinMaxDirChange*orthAxis[XX];
+            localAxis[YY] = cosMaxDirChange*dirVec_[YY] + sinMaxDirChange*orthAxis[YY];
+            localAxis[ZZ] = cosMaxDirChange*dirVec_[ZZ] + sinMaxDirChange*orthAxis[ZZ];
+        }
+
+        // next plane is orthogonal to updated direction:
+        updateDirection(localAxis);
+    }
+
+    // change radius of ultimate point to match the desired cutoff exactly:
+    radii_.back() = maxProbeRadius_;
 }
 
 
 /*!
- * Performs optimisation space to configuration space conversion.
- *
- * The input array optimSpacePos contains the angles theta and phi in the local
- * (rotated) coordinate system that describe the probe direction vector:
- *
- * optimSpacePos[0] = theta
- * optimSpacePos[1] = phi
- *
- * This is first converted to a cartesian representation in the rotated system,
- * which is then mapped back to the global cartesian frame. The direction 
- * vector is then added to the position vector of the probe in the previous 
- * step to obtain the new configuration space position of the probe.
+ * Sets the direction of probe motion and generates two unit vectors that 
+ * span the plane orthogonal to it, which define the optimisation space.
  */
-gmx::RVec
-OptimisedDirectionProbePathFinder::optimToConfig(std::vector<real> optimSpacePos)
+void
+OptimisedDirectionProbePathFinder::updateDirection(
+        const gmx::RVec &direction)
 {
-    /*
+    // tolerance threshold for norm of vector:
+    real nonZeroTol = std::numeric_limits<real>::epsilon();
 
-    // declare result vector:
-    gmx::RVec configSpacePos;
+    // normalise direction vector:
+    unitv(direction, dirVec_);
 
-    // calculate cartesian form of direction vector in rotated system:
-    gmx::RVec rotatedDirVec(std::sin(optimSpacePos[0]) * std::cos(optimSpacePos[1]),
-                            std::sin(optimSpacePos[0]) * std::sin(optimSpacePos[1]),
-                            std::cos(optimSpacePos[0]));
-    svmul(probeStepLength_, rotatedDirVec, rotatedDirVec);
+    // generate first orthogonal vector:
+    orthVecU_ = gmx::RVec(-dirVec_[YY], dirVec_[XX], 0.0);
 
-    // rotate back to global system:
-    mvmul(inverseRotationMatrix_, rotatedDirVec, configSpacePos);
+    // make sure it is non null vector:
+    if( norm(orthVecU_) < nonZeroTol )
+    {
+        // try different permutation:
+        orthVecU_ = gmx::RVec(-dirVec_[ZZ], 0.0, dirVec_[XX]);
+
+        // make sure it is not null vector:
+        if( norm(orthVecU_) < nonZeroTol )
+        {
+            // try different permutation:
+            orthVecU_ = gmx::RVec(0.0, -dirVec_[ZZ], dirVec_[YY]);
+
+            // make sure it is not null vector:
+            if( norm(orthVecU_) < nonZeroTol )
+            {
+                throw std::logic_error("Optimised direction probe path finder "
+                                       "could not generate an orthogonal "
+                                       "vector.");
+            }
+        }
+    }
+
+    // normalise first orthogonal vector:
+    unitv(orthVecU_, orthVecU_);
+
+    // generate second orthogonal vector:
+    // (this will already be normalised)
+    cprod(dirVec_, orthVecU_, orthVecW_);
+}
 
-    // add this to previous probe position:
-    rvec_add(configSpacePos, crntProbePos_, configSpacePos);
 
+/*!
+ * Converts between the two-dimensional optimisation space representation to 
+ * the three-dimensional configuration space representation. A point in 
+ * optimisation space is represented by its position in terms of the in-plane
+ * basis spanning vectors orthVecU_ and orthVecW_, which are both orthogonal
+ * to the current direction of probe motion.
+ */
+gmx::RVec
+OptimisedDirectionProbePathFinder::optimToConfig(
+        const std::array<real, 2> &optimSpacePos)
+{
+    // get configuration space position via orthogonal vectors:
+    gmx::RVec configSpacePos;
+    configSpacePos[XX] = crntProbePos_[XX] + optimSpacePos[0]*orthVecU_[XX]
+                                           + optimSpacePos[1]*orthVecW_[XX];
+    configSpacePos[YY] = crntProbePos_[YY] + optimSpacePos[0]*orthVecU_[YY]
+                                           + optimSpacePos[1]*orthVecW_[YY];
+    configSpacePos[ZZ] = crntProbePos_[ZZ] + optimSpacePos[0]*orthVecU_[ZZ] 
+                                           + optimSpacePos[1]*orthVecW_[ZZ];
+    
     // return configuration space position:
     return(configSpacePos);
-    */
 }
 
-#endif
-
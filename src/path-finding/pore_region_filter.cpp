@@ -0,0 +1,305 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "path-finding/pore_region_filter.hpp"
+
+
+/*
+ * Squared distance between a point and the line segment from a to b.
+ */
+static real
+segmentDistanceSq(
+        const gmx::RVec &pos,
+        const gmx::RVec &a,
+        const gmx::RVec &b)
+{
+    gmx::RVec ab;
+    gmx::RVec ap;
+    rvec_sub(b, a, ab);
+    rvec_sub(pos, a, ap);
+
+    // parameter of closest point on segment:
+    real lenSq = norm2(ab);
+    real t = 0.0;
+    if( lenSq > 0.0 )
+    {
+        t = std::min<real>(std::max<real>(iprod(ap, ab)/lenSq, 0.0), 1.0);
+    }
+
+    gmx::RVec d;
+    d[XX] = ap[XX] - t*ab[XX];
+    d[YY] = ap[YY] - t*ab[YY];
+    d[ZZ] = ap[ZZ] - t*ab[ZZ];
+    return norm2(d);
+}
+
+
+/*!
+ * Constructs a tube of the given radius around a polygonal centre line. The
+ * centre line is simplified such that no dropped point deviates by more than
+ * simplifyTol from the simplified line. The pbc pointer may be null, in which
+ * case periodicity is ignored, and must otherwise outlive the filter.
+ */
+PoreRegionFilter::PoreRegionFilter(
+        const std::vector<gmx::RVec> &centreLine,
+        real tubeRadius,
+        real simplifyTol,
+        const t_pbc *pbc)
+    : isAxis_(false)
+    , origin_(centreLine.empty() ? gmx::RVec(0.0, 0.0, 0.0) : centreLine.front())
+    , axisDir_(0.0, 0.0, 0.0)
+    , tubeRadius_(tubeRadius)
+    , pbc_(pbc)
+{
+    // sanity check:
+    if( centreLine.empty() )
+    {
+        throw std::logic_error("Can not construct pore region filter from "
+                               "empty centre line.");
+    }
+
+    // greedily drop points that are close to chord between retained points:
+    std::vector<gmx::RVec> simplified(1, centreLine.front());
+    size_t anchor = 0;
+    real tolSq = simplifyTol*simplifyTol;
+    for(size_t j = anchor + 2; j < centreLine.size(); j++)
+    {
+        for(size_t k = anchor + 1; k < j; k++)
+        {
+            if( segmentDistanceSq(centreLine[k], 
+                                  centreLine[anchor], 
+                                  centreLine[j]) > tolSq )
+            {
+                anchor = j - 1;
+                simplified.push_back(centreLine[anchor]);
+                break;
+            }
+        }
+    }
+    if( centreLine.size() > 1 )
+    {
+        simplified.push_back(centreLine.back());
+    }
+
+    // centre line is stored relative to its first point:
+    for(auto &point : simplified)
+    {
+        gmx::RVec rel;
+        rvec_sub(point, centreLine.front(), rel);
+        centreLine_.push_back(rel);
+    }
+
+    // bounding box of tube:
+    boxLo_ = gmx::RVec(0.0, 0.0, 0.0);
+    boxHi_ = gmx::RVec(0.0, 0.0, 0.0);
+    for(size_t i = 1; i < centreLine_.size(); i++)
+    {
+        for(int d = 0; d < DIM; d++)
+        {
+            boxLo_[d] = std::min(boxLo_[d], centreLine_[i][d]);
+            boxHi_[d] = std::max(boxHi_[d], centreLine_[i][d]);
+        }
+    }
+    for(int d = 0; d < DIM; d++)
+    {
+        boxLo_[d] -= tubeRadius_;
+        boxHi_[d] += tubeRadius_;
+    }
+}
+
+
+/*!
+ * Constructs a tube of the given radius around the infinite axis through 
+ * axisPoint in direction axisDir.
+ */
+PoreRegionFilter::PoreRegionFilter(
+        const gmx::RVec &axisPoint,
+        const gmx::RVec &axisDir,
+        real tubeRadius,
+        const t_pbc *pbc)
+    : centreLine_(1, gmx::RVec(0.0, 0.0, 0.0))
+    , isAxis_(true)
+    , origin_(axisPoint)
+    , axisDir_(axisDir)
+    , tubeRadius_(tubeRadius)
+    , pbc_(pbc)
+    , boxLo_(0.0, 0.0, 0.0)
+    , boxHi_(0.0, 0.0, 0.0)
+{
+    // sanity check:
+    if( norm2(axisDir_) <= 0.0 )
+    {
+        throw std::logic_error("Can not construct pore region filter from "
+                               "zero length axis.");
+    }
+    unitv(axisDir_, axisDir_);
+}
+
+
+/*!
+ * Returns the indices of all positions inside the tube.
+ */
+std::vector<int>
+PoreRegionFilter::filter(
+        const std::vector<gmx::RVec> &positions) const
+{
+    std::vector<int> inside;
+    real radiusSq = tubeRadius_*tubeRadius_;
+    for(size_t i = 0; i < positions.size(); i++)
+    {
+        gmx::RVec rel = relativePosition(positions[i]);
+
+        // cheap rejection of particles outside bounding box:
+        if( !isAxis_ &&
+            ( rel[XX] < boxLo_[XX] || rel[XX] > boxHi_[XX] ||
+              rel[YY] < boxLo_[YY] || rel[YY] > boxHi_[YY] ||
+              rel[ZZ] < boxLo_[ZZ] || rel[ZZ] > boxHi_[ZZ] ) )
+        {
+            continue;
+        }
+
+        if( minDistanceSq(rel, radiusSq) <= radiusSq )
+        {
+            inside.push_back(i);
+        }
+    }
+
+    return inside;
+}
+
+
+/*!
+ * Checks whether all given points lie at least a distance reach inside the
+ * tube, i.e. whether any search around these points with a cutoff of reach 
+ * would only find particles inside the tube.
+ */
+bool
+PoreRegionFilter::contains(
+        const std::vector<gmx::RVec> &points,
+        real reach) const
+{
+    for(auto &point : points)
+    {
+        if( distance(point) + reach > tubeRadius_ )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*!
+ * Returns the distance between a position and the centre line of the tube.
+ */
+real
+PoreRegionFilter::distance(
+        const gmx::RVec &pos) const
+{
+    return std::sqrt(minDistanceSq(relativePosition(pos), 0.0));
+}
+
+
+/*!
+ * Returns the radius of the tube.
+ */
+real
+PoreRegionFilter::tubeRadius() const
+{
+    return tubeRadius_;
+}
+
+
+/*!
+ * Returns the number of points on the simplified centre line (one for an 
+ * axis).
+ */
+size_t
+PoreRegionFilter::numCentreLinePoints() const
+{
+    return centreLine_.size();
+}
+
+
+/*!
+ * Returns the position relative to the first point of the centre line, using
+ * the periodic image closest to this point.
+ */
+gmx::RVec
+PoreRegionFilter::relativePosition(
+        const gmx::RVec &pos) const
+{
+    gmx::RVec rel;
+    if( pbc_ != nullptr )
+    {
+        pbc_dx_aiuc(pbc_, pos, origin_, rel);
+    }
+    else
+    {
+        rvec_sub(pos, origin_, rel);
+    }
+    return rel;
+}
+
+
+/*!
+ * Returns the squared distance between a position given relative to the 
+ * first centre line point and the centre line. Segments are no longer 
+ * considered once a squared distance below stopSq has been found.
+ */
+real
+PoreRegionFilter::minDistanceSq(
+        const gmx::RVec &relPos,
+        real stopSq) const
+{
+    // distance from infinite axis:
+    if( isAxis_ )
+    {
+        real along = iprod(relPos, axisDir_);
+        return std::max<real>(norm2(relPos) - along*along, 0.0);
+    }
+
+    // distance from single point:
+    if( centreLine_.size() == 1 )
+    {
+        return norm2(relPos);
+    }
+
+    // distance from segments:
+    real minDistSq = segmentDistanceSq(relPos, centreLine_[0], centreLine_[1]);
+    for(size_t i = 2; i < centreLine_.size() && minDistSq > stopSq; i++)
+    {
+        minDistSq = std::min(minDistSq, 
+                             segmentDistanceSq(relPos, 
+                                               centreLine_[i - 1], 
+                                               centreLine_[i]));
+    }
+    return minDistSq;
+}
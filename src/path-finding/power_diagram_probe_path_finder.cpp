@@ -0,0 +1,772 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <gromacs/math/vec.h>
+
+#include "path-finding/power_diagram_probe_path_finder.hpp"
+
+
+/*!
+ * Constructor.
+ */
+PowerDiagramProbePathFinder::PowerDiagramProbePathFinder(
+        std::map<std::string, real> params,
+        gmx::RVec initProbePos,
+        gmx::RVec chanDirVec,
+        t_pbc *pbc,
+        gmx::AnalysisNeighborhoodPositions porePos,
+        const std::vector<real> &vdwRadii)
+    : AbstractProbePathFinder(params, initProbePos, vdwRadii)
+    , porePos_(porePos)
+    , pbc_(pbc)
+    , chanDirVec_(chanDirVec)
+    , orthVecU_(0.0, 0.0, 0.0)
+    , orthVecW_(0.0, 0.0, 0.0)
+{
+    // tolerance threshold for norm of vector (which should be unit vectors):
+    real nonZeroTol = std::numeric_limits<real>::epsilon();
+    if( norm(chanDirVec_) < nonZeroTol )
+    {
+        throw std::runtime_error("Channel direction vector has norm close to "
+                                 "zero. Please provide a finite-length channel "
+                                 "direction vector with -pf-chan-dir-vec.");
+    }
+
+    // normalise channel direction vector:
+    unitv(chanDirVec_, chanDirVec_);
+
+    // generate first orthogonal vector:
+    orthVecU_ = gmx::RVec(-chanDirVec_[YY], chanDirVec_[XX], 0.0);
+    if( norm(orthVecU_) < nonZeroTol )
+    {
+        // try different permutation:
+        orthVecU_ = gmx::RVec(-chanDirVec_[ZZ], 0.0, chanDirVec_[XX]);
+        if( norm(orthVecU_) < nonZeroTol )
+        {
+            throw std::logic_error("Power diagram probe path finder could "
+                                   "not generate an orthogonal vector.");
+        }
+    }
+
+    // normalise first orthogonal vector:
+    unitv(orthVecU_, orthVecU_);
+
+    // generate second orthogonal vector:
+    // (this will already be normalised)
+    cprod(chanDirVec_, orthVecU_, orthVecW_);
+}
+
+
+/*!
+ * Set parameters for path-finding.
+ */
+void
+PowerDiagramProbePathFinder::setParameters(
+        const PathFindingParameters &params)
+{
+    // set parameters:
+    probeStepLength_ = params.probeStepLength();
+    maxProbeRadius_ = params.maxProbeRadius();
+    maxProbeSteps_ = params.maxProbeSteps();
+
+    // has cutoff been set by user:
+    if( params.nbhCutoffIsSet() )
+    {
+        // user given cutoff:
+        nbhCutoff_ = params.nbhCutoff();
+    }
+    else
+    {
+        // calculate cutoff automatically:
+        real safetyMargin = std::sqrt(std::numeric_limits<real>::epsilon());
+        nbhCutoff_ = params.maxProbeRadius() + maxVdwRadius_ + safetyMargin;
+    }
+
+    // set flag to true:
+    parametersSet_ = true;
+}
+
+
+/*!
+ * Execute path-finding algorithm.
+ */
+void
+PowerDiagramProbePathFinder::findPath()
+{
+    // sanity check:
+    if( !parametersSet_ )
+    {
+        throw std::logic_error("Path finding parameters have not been set.");
+    }
+
+    // prepare neighborhood search:
+    // (cutoff needs to cover all atoms within range of the search square)
+    prepareNeighborhoodSearch(
+            pbc_,
+            porePos_,
+            nbhCutoff_ + std::sqrt(2.0)*maxProbeRadius_);
+
+    // optimise initial position:
+    optimiseInitialPos();
+    
+    // advance forward:
+    advanceAndOptimise(true);
+
+    // revert array:
+    std::reverse(path_.begin(), path_.end());
+    std::reverse(radii_.begin(), radii_.end());
+    
+    // advance backward:
+    advanceAndOptimise(false);
+}
+
+
+/*!
+ * Optimise initial position of probe.
+ */
+void
+PowerDiagramProbePathFinder::optimiseInitialPos()
+{
+    // find maximal free disc in plane through initial probe position:
+    crntProbePos_ = initProbePos_;
+    std::pair<std::array<real, 2>, real> optim = maximiseFreeDisc();
+    initProbePos_ = optimToConfig(optim.first);
+
+    // handle situation where cutoff radius was too small:
+    // (or otherwise no particle was found within cutoff radius)
+    if( std::isinf(optim.second) )
+    {
+        throw std::runtime_error("Pore radius at initial probe position is "
+                                 "infinite. Consider increasing the maximum "
+                                 "pore radius with -pf-max-free-dist or set "
+                                 "an appropriate cutoff for neighbourhood "
+                                 "searches explicitly with -pf-cutoff.");
+    }
+
+    // add path support point and associated radius to container:
+    path_.push_back(initProbePos_);
+    radii_.push_back(optim.second);
+}
+
+
+/*!
+ * Find maximal free disc in subsequent parallel planes.
+ */
+void
+PowerDiagramProbePathFinder::advanceAndOptimise(bool forward)
+{
+    // set previous position to initial point:
+    crntProbePos_ = initProbePos_;
+
+    // set up direction vector for forward/backward marching:
+    gmx::RVec direction(chanDirVec_);
+    if( !forward )
+    {
+        svmul(-1.0, direction, direction);
+    }
+
+    // advance probe in direction of (inverse) channel direction vector:
+    int numProbeSteps = 0;
+    while(true)
+    {
+        // advance probe position to next plane:
+        crntProbePos_[XX] = crntProbePos_[XX] + probeStepLength_*direction[XX];
+        crntProbePos_[YY] = crntProbePos_[YY] + probeStepLength_*direction[YY];
+        crntProbePos_[ZZ] = crntProbePos_[ZZ] + probeStepLength_*direction[ZZ]; 
+
+        // current position becomes centre of maximal free disc in plane:
+        std::pair<std::array<real, 2>, real> optim = maximiseFreeDisc();
+        crntProbePos_ = optimToConfig(optim.first);
+
+        // increment probe step counter:
+        numProbeSteps++;      
+
+        // add result to path container: 
+        path_.push_back(crntProbePos_);
+        radii_.push_back(optim.second);
+
+        // check termination conditions:
+        if( numProbeSteps >= maxProbeSteps_ )
+        {
+            break;
+        }
+        if( optim.second > maxProbeRadius_ )
+        {
+            break;
+        }
+    }
+
+    // change radius of ultimate point to match the desired cutoff exactly:
+    radii_.back() = maxProbeRadius_;
+}
+
+
+/*!
+ * Finds the maximal free disc in the plane through the current probe 
+ * position. 
+ *
+ * The free distance increases when moving away from the atom in whose cell a
+ * point lies, so that steepest ascent from the current probe position first
+ * leads straight to the boundary of its cell and then follows the edges of 
+ * the diagram. The free distance along an edge is a convex function, hence it
+ * suffices to check its slope at each vertex. The ascent stops at the first
+ * vertex at which the free distance decreases along all incident edges. 
+ *
+ * This is exact only if all atoms have the same van der Waals radius. 
+ * Otherwise the cells of the power diagram differ from the regions of 
+ * nearest atom surfaces, so that the vertex found in this way merely serves
+ * as starting point for ascendFreeDistance(), which continues the ascent in 
+ * terms of the free distance to all atoms.
+ *
+ * Returns the in-plane position of its centre relative to the 
+ * current probe position (in terms of orthVecU_ and orthVecW_) and its 
+ * radius. The radius is infinite if no atoms are found within the cutoff.
+ */
+std::pair<std::array<real, 2>, real>
+PowerDiagramProbePathFinder::maximiseFreeDisc()
+{
+    // project nearby atoms onto plane:
+    projectAtoms();
+    if( planePos_.empty() )
+    {
+        return std::make_pair(std::array<real, 2>({{0.0, 0.0}}),
+                              std::numeric_limits<real>::infinity());
+    }
+
+    // power diagram over search square:
+    std::vector<real> weights(planePos_.size());
+    for(size_t i = 0; i < planePos_.size(); i++)
+    {
+        weights[i] = planeVdwRadii_[i]*planeVdwRadii_[i] - planeSqDist_[i];
+    }
+    real halfWidth = maxProbeRadius_;
+    PowerDiagram2D pd(planePos_, weights, {{-halfWidth, -halfWidth}}, 
+                      {{halfWidth, halfWidth}});
+
+    // cell containing current probe position (origin of plane):
+    size_t crntCell = pd.locate({{0.0, 0.0}});
+    const std::vector<PowerDiagram2D::CellVertex> &startCell = 
+            pd.cell(crntCell);
+
+    // free distance increases when moving directly away from atom:
+    real du = -planePos_[crntCell][0];
+    real dw = -planePos_[crntCell][1];
+    if( du == 0.0 && dw == 0.0 )
+    {
+        du = 1.0;
+    }
+
+    // find edge through which this ray leaves the cell:
+    size_t exitEdge = 0;
+    real exitParam = std::numeric_limits<real>::infinity();
+    for(size_t k = 0; k < startCell.size(); k++)
+    {
+        const PowerDiagram2D::Point &a = startCell[k].pos;
+        const PowerDiagram2D::Point &b = startCell[(k + 1) % startCell.size()].pos;
+        real eu = b[0] - a[0];
+        real ew = b[1] - a[1];
+        real denom = du*ew - dw*eu;
+        if( denom == 0.0 )
+        {
+            continue;
+        }
+        real t = (a[0]*ew - a[1]*eu)/denom;
+        real s = (a[0]*dw - a[1]*du)/denom;
+        if( t >= 0.0 && s >= 0.0 && s <= 1.0 && t < exitParam )
+        {
+            exitEdge = k;
+            exitParam = t;
+        }
+    }
+    PowerDiagram2D::Point exitPoint = {{exitParam*du, exitParam*dw}};
+    const PowerDiagram2D::CellVertex &edgeBegin = startCell[exitEdge];
+    const PowerDiagram2D::CellVertex &edgeEnd = 
+            startCell[(exitEdge + 1) % startCell.size()];
+
+    // ray leaves search square without reaching any other cell:
+    if( std::isinf(exitParam) || edgeBegin.nextGenerator < 0 )
+    {
+        PowerDiagram2D::Point centre = std::isinf(exitParam) 
+                                     ? PowerDiagram2D::Point({{0.0, 0.0}})
+                                     : exitPoint;
+        return std::make_pair(centre, freeDistance(centre));
+    }
+
+    // follow edge in direction of increasing free distance:
+    real slope = 
+            (exitPoint[0] - planePos_[crntCell][0])*
+            (edgeEnd.pos[0] - edgeBegin.pos[0]) +
+            (exitPoint[1] - planePos_[crntCell][1])*
+            (edgeEnd.pos[1] - edgeBegin.pos[1]);
+    size_t crntVertex = slope > 0.0 ? (exitEdge + 1) % startCell.size() 
+                                    : exitEdge;
+
+    // ascend along edges of the diagram until reaching a local maximum:
+    while( true )
+    {
+        const PowerDiagram2D::CellVertex &v = pd.cell(crntCell)[crntVertex];
+        if( v.prevGenerator < 0 || v.nextGenerator < 0 )
+        {
+            // reached boundary of search square:
+            break;
+        }
+        real crntValue = vertexFreeDistance(crntCell, v);
+
+        // the three edges meeting in this vertex, each given by the cell and
+        // index of its other end and by one of the atoms generating it:
+        std::array<size_t, 3> edgeCell;
+        std::array<size_t, 3> edgeVertex;
+        std::array<size_t, 3> edgeAtom;
+        size_t numEdges = 0;
+        size_t n = pd.cell(crntCell).size();
+        edgeCell[numEdges] = crntCell;
+        edgeVertex[numEdges] = (crntVertex + 1) % n;
+        edgeAtom[numEdges++] = crntCell;
+        edgeCell[numEdges] = crntCell;
+        edgeVertex[numEdges] = (crntVertex + n - 1) % n;
+        edgeAtom[numEdges++] = crntCell;
+
+        // third edge separates the cells of the two other generators:
+        size_t nextCell = v.nextGenerator;
+        const std::vector<PowerDiagram2D::CellVertex> &other = 
+                pd.cell(nextCell);
+        for(size_t k = 0; k < other.size(); k++)
+        {
+            int gPrev = other[k].prevGenerator;
+            int gNext = other[k].nextGenerator;
+            size_t m = other.size();
+            if( gPrev == static_cast<int>(crntCell) && 
+                gNext == v.prevGenerator )
+            {
+                edgeCell[numEdges] = nextCell;
+                edgeVertex[numEdges] = (k + 1) % m;
+                edgeAtom[numEdges++] = nextCell;
+                break;
+            }
+            if( gNext == static_cast<int>(crntCell) &&
+                gPrev == v.prevGenerator )
+            {
+                edgeCell[numEdges] = nextCell;
+                edgeVertex[numEdges] = (k + m - 1) % m;
+                edgeAtom[numEdges++] = nextCell;
+                break;
+            }
+        }
+
+        // move along edge of steepest ascent:
+        real bestSlope = 0.0;
+        size_t bestEdge = numEdges;
+        for(size_t e = 0; e < numEdges; e++)
+        {
+            const PowerDiagram2D::CellVertex &w = 
+                    pd.cell(edgeCell[e])[edgeVertex[e]];
+            real tu = w.pos[0] - v.pos[0];
+            real tw = w.pos[1] - v.pos[1];
+            real len = std::sqrt(tu*tu + tw*tw);
+            if( len == 0.0 )
+            {
+                continue;
+            }
+            real edgeSlope = ((v.pos[0] - planePos_[edgeAtom[e]][0])*tu +
+                              (v.pos[1] - planePos_[edgeAtom[e]][1])*tw)/len;
+            if( edgeSlope > bestSlope && 
+                vertexFreeDistance(edgeCell[e], w) > crntValue )
+            {
+                bestSlope = edgeSlope;
+                bestEdge = e;
+            }
+        }
+        if( bestEdge == numEdges )
+        {
+            break;
+        }
+        crntCell = edgeCell[bestEdge];
+        crntVertex = edgeVertex[bestEdge];
+    }
+
+    // for unequal radii, the power diagram vertex is only an approximation:
+    return ascendFreeDistance(pd.cell(crntCell)[crntVertex].pos);
+}
+
+
+/*!
+ * Collects all pore-forming atoms within the cutoff of the current probe
+ * position and stores their position projected onto the plane orthogonal to
+ * the channel direction vector, their squared distance from the plane, and 
+ * their van der Waals radius. Atoms too far from the plane to restrict the 
+ * free distance to less than the maximum probe radius are skipped.
+ */
+void
+PowerDiagramProbePathFinder::projectAtoms()
+{
+    planePos_.clear();
+    planeSqDist_.clear();
+    planeVdwRadii_.clear();
+
+    gmx::AnalysisNeighborhoodPositions probePos(crntProbePos_.as_vec());
+    gmx::AnalysisNeighborhoodPairSearch nbPairSearch = 
+            nbSearch_.startPairSearch(probePos);
+    gmx::AnalysisNeighborhoodPair pair;
+    while( nbPairSearch.findNextPair(&pair) )
+    {
+        // distance vector points from probe to atom:
+        const rvec &dx = pair.dx();
+        real h = iprod(dx, chanDirVec_);
+        real vdwRadius = vdwRadii_[pair.refIndex()];
+        if( std::abs(h) - vdwRadius > maxProbeRadius_ )
+        {
+            continue;
+        }
+
+        planePos_.push_back({{iprod(dx, orthVecU_), iprod(dx, orthVecW_)}});
+        planeSqDist_.push_back(h*h);
+        planeVdwRadii_.push_back(vdwRadius);
+    }
+}
+
+
+/*!
+ * Returns the free distance between a point in the plane and the van der 
+ * Waals surface of the i-th projected atom.
+ */
+real
+PowerDiagramProbePathFinder::freeDistance(
+        size_t i,
+        const PowerDiagram2D::Point &x) const
+{
+    real du = x[0] - planePos_[i][0];
+    real dw = x[1] - planePos_[i][1];
+    return std::sqrt(du*du + dw*dw + planeSqDist_[i]) - planeVdwRadii_[i];
+}
+
+
+/*!
+ * Returns the free distance between a point in the plane and the closest van
+ * der Waals surface of all projected atoms.
+ */
+real
+PowerDiagramProbePathFinder::freeDistance(
+        const PowerDiagram2D::Point &x) const
+{
+    real minFreeDist = std::numeric_limits<real>::infinity();
+    for(size_t i = 0; i < planePos_.size(); i++)
+    {
+        minFreeDist = std::min(minFreeDist, freeDistance(i, x));
+    }
+
+    return minFreeDist;
+}
+
+
+/*!
+ * Returns the free distance at a vertex of the i-th cell, taking into account
+ * the atoms generating the cell edges that meet in this vertex.
+ */
+real
+PowerDiagramProbePathFinder::vertexFreeDistance(
+        size_t i,
+        const PowerDiagram2D::CellVertex &v) const
+{
+    real freeDist = freeDistance(i, v.pos);
+    if( v.prevGenerator >= 0 )
+    {
+        freeDist = std::min(freeDist, freeDistance(v.prevGenerator, v.pos));
+    }
+    if( v.nextGenerator >= 0 )
+    {
+        freeDist = std::min(freeDist, freeDistance(v.nextGenerator, v.pos));
+    }
+
+    return freeDist;
+}
+
+
+/*!
+ * Local ascent of the free distance to all projected atoms from the given 
+ * starting point, which is returned together with the free distance at the
+ * local maximum.
+ *
+ * As the free distance is the minimum over the free distances to individual
+ * atoms, it is not differentiable where several atom surfaces are equally
+ * close. All atoms whose free distance lies within a tolerance of the minimum
+ * are therefore considered active and the ascent direction is the element of 
+ * minimal norm in the convex hull of their gradients (see 
+ * steepestAscentDirection()). Each step is checked against the free distance
+ * to all atoms and only accepted if it increases it. If no such step can be
+ * found, the tolerance is reduced. A local maximum in the interior of the 
+ * search square is generically a point equidistant to three atom surfaces, 
+ * which is finally located to full precision with refineVertex().
+ */
+std::pair<std::array<real, 2>, real>
+PowerDiagramProbePathFinder::ascendFreeDistance(
+        PowerDiagram2D::Point x) const
+{
+    // internal parameters:
+    int maxIter = 1000;
+    real tol = std::sqrt(std::numeric_limits<real>::epsilon())*maxProbeRadius_;
+    real activeTol = 0.1*maxProbeRadius_;
+    real halfWidth = maxProbeRadius_;
+
+    real crntValue = freeDistance(x);
+    std::vector<size_t> active;
+    for(int iter = 0; iter < maxIter && activeTol > tol; iter++)
+    {
+        // atoms close to limiting the free distance:
+        active.clear();
+        for(size_t i = 0; i < planePos_.size(); i++)
+        {
+            if( freeDistance(i, x) <= crntValue + activeTol )
+            {
+                active.push_back(i);
+            }
+        }
+
+        // backtracking line search along direction of steepest ascent:
+        PowerDiagram2D::Point dir = steepestAscentDirection(active, x);
+        real dirNorm = std::sqrt(dir[0]*dir[0] + dir[1]*dir[1]);
+        bool improved = false;
+        if( dirNorm > tol )
+        {
+            for(real step = activeTol; step > 0.01*tol; step *= 0.5)
+            {
+                PowerDiagram2D::Point trial;
+                for(int d = 0; d < 2; d++)
+                {
+                    trial[d] = x[d] + step*dir[d]/dirNorm;
+                    trial[d] = std::max(-halfWidth, 
+                                        std::min(halfWidth, trial[d]));
+                }
+                real trialValue = freeDistance(trial);
+                if( trialValue > crntValue )
+                {
+                    x = trial;
+                    crntValue = trialValue;
+                    improved = true;
+                    break;
+                }
+            }
+        }
+
+        // no ascent possible with current set of active atoms:
+        if( !improved )
+        {
+            activeTol *= 0.1;
+        }
+    }
+
+    // locate local maximum defined by three atom surfaces precisely:
+    active.clear();
+    for(size_t i = 0; i < planePos_.size(); i++)
+    {
+        if( freeDistance(i, x) <= crntValue + 10.0*tol )
+        {
+            active.push_back(i);
+        }
+    }
+    PowerDiagram2D::Point refined;
+    if( active.size() == 3 && 
+        refineVertex({{active[0], active[1], active[2]}}, x, refined) )
+    {
+        real refinedValue = freeDistance(refined);
+        if( refinedValue > crntValue )
+        {
+            x = refined;
+            crntValue = refinedValue;
+        }
+    }
+
+    return std::make_pair(x, crntValue);
+}
+
+
+/*!
+ * Returns the direction of steepest ascent of the minimum of the free 
+ * distances to the given atoms at the given point. This is the point of 
+ * minimal norm in the convex hull of the in-plane gradients of these free 
+ * distances, which is zero if the origin lies inside the hull (i.e. if there
+ * is no angular gap of more than \f$ \pi \f$ between the gradients). 
+ * Otherwise it lies on the segment between two gradients or is a gradient 
+ * itself.
+ */
+PowerDiagram2D::Point
+PowerDiagramProbePathFinder::steepestAscentDirection(
+        const std::vector<size_t> &atoms,
+        const PowerDiagram2D::Point &x) const
+{
+    PowerDiagram2D::Point zero = {{0.0, 0.0}};
+
+    // in-plane gradients of free distance to each atom:
+    std::vector<PowerDiagram2D::Point> grad;
+    std::vector<real> angles;
+    for(auto i : atoms)
+    {
+        real du = x[0] - planePos_[i][0];
+        real dw = x[1] - planePos_[i][1];
+        real dist = std::sqrt(du*du + dw*dw + planeSqDist_[i]);
+        if( du == 0.0 && dw == 0.0 )
+        {
+            return zero;
+        }
+        grad.push_back({{du/dist, dw/dist}});
+        angles.push_back(std::atan2(dw, du));
+    }
+    if( grad.empty() )
+    {
+        return zero;
+    }
+
+    // origin inside convex hull if no angular gap exceeds pi:
+    std::sort(angles.begin(), angles.end());
+    real maxGap = angles.front() + 2.0*M_PI - angles.back();
+    for(size_t k = 1; k < angles.size(); k++)
+    {
+        maxGap = std::max(maxGap, angles[k] - angles[k - 1]);
+    }
+    if( maxGap <= M_PI )
+    {
+        return zero;
+    }
+
+    // otherwise find closest point to origin on any segment between gradients:
+    PowerDiagram2D::Point best = grad.front();
+    real bestSqNorm = best[0]*best[0] + best[1]*best[1];
+    for(size_t k = 0; k < grad.size(); k++)
+    {
+        for(size_t l = k; l < grad.size(); l++)
+        {
+            real eu = grad[l][0] - grad[k][0];
+            real ew = grad[l][1] - grad[k][1];
+            real sqLen = eu*eu + ew*ew;
+            real t = 0.0;
+            if( sqLen > 0.0 )
+            {
+                t = -(grad[k][0]*eu + grad[k][1]*ew)/sqLen;
+                t = std::max(static_cast<real>(0.0), 
+                             std::min(static_cast<real>(1.0), t));
+            }
+            PowerDiagram2D::Point p = {{grad[k][0] + t*eu, 
+                                        grad[k][1] + t*ew}};
+            real sqNorm = p[0]*p[0] + p[1]*p[1];
+            if( sqNorm < bestSqNorm )
+            {
+                best = p;
+                bestSqNorm = sqNorm;
+            }
+        }
+    }
+
+    return best;
+}
+
+
+/*!
+ * Solves for the point at equal free distance to the surfaces of the three
+ * given atoms with Newton's method, starting from the given point. Returns 
+ * false if the iteration does not converge to a point close to the starting
+ * point.
+ */
+bool
+PowerDiagramProbePathFinder::refineVertex(
+        const std::array<size_t, 3> &atoms,
+        const PowerDiagram2D::Point &start,
+        PowerDiagram2D::Point &x) const
+{
+    // internal parameters:
+    int maxIter = 20;
+    real tol = std::sqrt(std::numeric_limits<real>::epsilon())*maxProbeRadius_;
+
+    x = start;
+    for(int iter = 0; iter < maxIter; iter++)
+    {
+        // free distances and their gradients:
+        std::array<real, 3> f;
+        std::array<PowerDiagram2D::Point, 3> grad;
+        for(int k = 0; k < 3; k++)
+        {
+            real du = x[0] - planePos_[atoms[k]][0];
+            real dw = x[1] - planePos_[atoms[k]][1];
+            real dist = std::sqrt(du*du + dw*dw + planeSqDist_[atoms[k]]);
+            if( dist == 0.0 )
+            {
+                return false;
+            }
+            f[k] = dist - planeVdwRadii_[atoms[k]];
+            grad[k] = {{du/dist, dw/dist}};
+        }
+
+        // Newton step for f0 - f1 = 0 and f0 - f2 = 0:
+        real g1 = f[0] - f[1];
+        real g2 = f[0] - f[2];
+        real j11 = grad[0][0] - grad[1][0];
+        real j12 = grad[0][1] - grad[1][1];
+        real j21 = grad[0][0] - grad[2][0];
+        real j22 = grad[0][1] - grad[2][1];
+        real det = j11*j22 - j12*j21;
+        if( std::abs(det) < std::numeric_limits<real>::epsilon() )
+        {
+            return false;
+        }
+        real s0 = ( j22*g1 - j12*g2)/det;
+        real s1 = (-j21*g1 + j11*g2)/det;
+        x[0] -= s0;
+        x[1] -= s1;
+
+        if( std::sqrt(s0*s0 + s1*s1) < tol )
+        {
+            // only accept solutions close to starting point:
+            real du = x[0] - start[0];
+            real dw = x[1] - start[1];
+            return std::sqrt(du*du + dw*dw) < 0.5*maxProbeRadius_;
+        }
+    }
+
+    return false;
+}
+
+
+/*!
+ * Converts between the two-dimensional in-plane representation and the 
+ * three-dimensional configuration space representation. An in-plane point is
+ * represented by its position in terms of the in-plane basis vectors 
+ * orthVecU_ and orthVecW_ relative to the current probe position.
+ */
+gmx::RVec
+PowerDiagramProbePathFinder::optimToConfig(
+        const std::array<real, 2> &optimSpacePos)
+{
+    gmx::RVec configSpacePos;
+    for(int d = 0; d < DIM; d++)
+    {
+        configSpacePos[d] = crntProbePos_[d] + optimSpacePos[0]*orthVecU_[d]
+                                             + optimSpacePos[1]*orthVecW_[d];
+    }
+
+    return configSpacePos;
+}
@@ -46,6 +46,32 @@ SummaryStatistics::SummaryStatistics()
 }
 
 
+/*!
+ * Restores summary statistics from their internal state, i.e. from the values
+ * returned by min(), max(), mean(), sumSquaredMeanDiff(), and num() of 
+ * another object. This allows aggregation to be continued from a serialised
+ * state with results identical to those of an uninterrupted aggregation. If
+ * the number of samples is zero, the default state is restored.
+ */
+SummaryStatistics::SummaryStatistics(
+        real min,
+        real max,
+        real mean,
+        real sumSquaredMeanDiff,
+        int num)
+    : SummaryStatistics()
+{
+    if( num > 0 )
+    {
+        min_ = min;
+        max_ = max;
+        mean_ = mean;
+        sumSquaredMeanDiff_ = sumSquaredMeanDiff;
+        num_ = num;
+    }
+}
+
+
 /*!
  * This method will update all summary statistics with the given new value and
  * also increment the sample counter.
@@ -105,6 +131,83 @@ SummaryStatistics::updateMultiple(
 }
 
 
+/*!
+ * Merges the summary statistics of another dataset into this one. Minimum and
+ * maximum are simply compared, while mean and sum of squared differences from
+ * the mean are combined as
+ *
+ * \f[
+ *      \bar{x} = \bar{x}_A + \delta \frac{n_B}{n_A + n_B}, \quad
+ *      M_2 = M_{2,A} + M_{2,B} + \delta^2 \frac{n_A n_B}{n_A + n_B}
+ * \f]
+ *
+ * where \f$ \delta = \bar{x}_B - \bar{x}_A \f$. This allows summary 
+ * statistics over a pooled dataset (e.g. several replicate trajectories) to be
+ * computed without revisiting the individual data points.
+ */
+void
+SummaryStatistics::merge(
+        const SummaryStatistics &other)
+{
+    // nothing to do if other object has seen no data:
+    if( other.num_ == 0 )
+    {
+        return;
+    }
+
+    // if this object has seen no data, simply copy other:
+    if( num_ == 0 )
+    {
+        *this = other;
+        return;
+    }
+
+    // updating min and max is trivial:
+    if( other.max_ > max_ )
+    {
+        max_ = other.max_;
+    }
+    if( other.min_ < min_ )
+    {
+        min_ = other.min_;
+    }
+
+    // combine mean and squared difference from mean:
+    real numTotal = num_ + other.num_;
+    real delta = other.mean_ - mean_;
+    mean_ += delta*other.num_/numTotal;
+    sumSquaredMeanDiff_ += other.sumSquaredMeanDiff_ + 
+            delta*delta*num_*other.num_/numTotal;
+
+    // update number of samples:
+    num_ += other.num_;
+}
+
+
+/*!
+ * Convenience function to merge a vector of SummaryStatistics with another
+ * vector of SummaryStatistics of the same size in an elementwise fashion.
+ */
+void
+SummaryStatistics::mergeMultiple(
+        std::vector<SummaryStatistics> &stat,
+        const std::vector<SummaryStatistics> &other)
+{
+    // sanity check:
+    if( stat.size() != other.size() )
+    {
+        throw std::logic_error("Can not merge summary statistics vectors of "
+                               "different size.");
+    }
+
+    // merge each element individually:
+    for(size_t i = 0; i < stat.size(); i++)
+    {
+        stat[i].merge(other[i]);
+    }
+}
+
+
 /*!
  * Shifts the value of minimum, maximum, and mean by the given amount. Standard
  * deviation, variance, and number of samples are unaffected. This is useful if
@@ -212,6 +315,18 @@ SummaryStatistics::num() const
 }
 
 
+/*!
+ * Getter method for the sum of squared differences from the mean, which is
+ * the internal quantity from which variance and standard deviation are 
+ * derived. Only needed for serialising the state of this object.
+ */
+real
+SummaryStatistics::sumSquaredMeanDiff() const
+{
+    return sumSquaredMeanDiff_;
+}
+
+
 /*!
  * Convenience function for converting sum of squared differences from mean to
  * variance. This is written as a separate function to be used with both the
@@ -23,20 +23,32 @@
 
 
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <memory>
 #include <string>
 
+#include <gromacs/pbcutil/pbc.h>
 #include <gromacs/random/threefry.h>
 #include <gromacs/utility/fatalerror.h>
 
 #include "trajectory-analysis/chap_trajectory_analysis.hpp"
 
 #include "aggregation/boltzmann_energy_calculator.hpp"
+#include "aggregation/frame_stream_aggregator.hpp"
 #include "aggregation/number_density_calculator.hpp"
+#include "aggregation/occupancy_map.hpp"
 
 #include "config/config.hpp"
 #include "config/dependencies.hpp"
 #include "config/version.hpp"
 
+#include "external/rapidjson/stringbuffer.h"
+#include "external/rapidjson/writer.h"
+
 #include "geometry/cubic_spline_interp_1D.hpp"
 #include "geometry/cubic_spline_interp_3D.hpp"
 #include "geometry/linear_spline_interp_1D.hpp"
@@ -60,6 +72,9 @@
 #include "path-finding/inplane_optimised_probe_path_finder.hpp"
 #include "path-finding/optimised_direction_probe_path_finder.hpp"
 #include "path-finding/naive_cylindrical_path_finder.hpp"
+#include "path-finding/power_diagram_probe_path_finder.hpp"
+#include "path-finding/distance_transform_path_finder.hpp"
+#include "path-finding/pore_region_filter.hpp"
 #include "path-finding/vdw_radius_provider.hpp"
 
 using namespace gmx;
@@ -71,13 +86,24 @@ using namespace gmx;
 ChapTrajectoryAnalysis::ChapTrajectoryAnalysis()
     : pfProbeRadius_(0.0)
     , pfMaxProbeSteps_(1e3)
+    , pfCullMargin_(-1.0)
     , pfInitProbePos_(3)
     , pfChanDirVec_(3)
     , saMaxCoolingIter_(1e3)
+    , saConvIter_(0)
+    , saNumStarts_(1)
     , saNumCostSamples_(50)
     , saInitTemp_(10.0)
     , saCoolingFactor_(0.99)
     , saStepLengthFactor_(0.01)
+    , numReplicates_(1)
+    , ensOenv_(nullptr)
+    , ensHasPbc_(false)
+    , ensEPBC_(0)
+    , checkpointInterval_(100)
+    , resume_(false)
+    , resumeNumFrames_(0)
+    , resumeLastTime_(0.0)
 {
     // register data containers:
     registerAnalysisDataset(&frameStreamData_, "frameStreamData");
@@ -132,10 +158,14 @@ ChapTrajectoryAnalysis::initOptions(
     //-------------------------------------------------------------------------
 
     options -> addOption(SelectionOption("sel-pathway")
-                         .store(&pathwaySel_).required()
+                         .storeVector(&pathwaySel_).required()
+                         .multiValue()
                          .description("Reference group that defines the "
                                       "permeation pathway (usually "
-                                      "'Protein') "));
+                                      "'Protein'). Several groups may be "
+                                      "given to analyse multiple pathways "
+                                      "in a single pass over the "
+                                      "trajectory."));
 
     options -> addOption(SelectionOption("sel-solvent")
                          .storeVector(&solventSel_)
@@ -143,6 +173,41 @@ ChapTrajectoryAnalysis::initOptions(
                                       "density of (usually 'Water')"));
 
 
+    // ENSEMBLE OPTIONS
+    // ------------------------------------------------------------------------
+
+    options -> addOption(FileNameOption("ens-traj")
+                         .filetype(eftTrajectory).inputFile()
+                         .storeVector(&ensTrajFileNames_)
+                         .multiValue()
+                         .description("Replicate trajectories of the same "
+                                      "system to be analysed alongside the "
+                                      "trajectory given with -f. Results are "
+                                      "pooled over all replicates and "
+                                      "per-replicate results are added to "
+                                      "the same output file."));
+
+
+    // CHECKPOINT OPTIONS
+    // ------------------------------------------------------------------------
+
+    options -> addOption(IntegerOption("checkpoint-interval")
+                         .store(&checkpointInterval_)
+                         .defaultValue(100)
+                         .description("Number of frames after which the "
+                                      "analysis progress is written to a "
+                                      "checkpoint file. Set to zero to "
+                                      "disable checkpointing."));
+
+    options -> addOption(BooleanOption("resume")
+                         .store(&resume_)
+                         .defaultValue(false)
+                         .description("If true, CHAP will resume an "
+                                      "interrupted run from its checkpoint "
+                                      "file and skip all frames analysed "
+                                      "before the checkpoint was written."));
+
+
     // OUTPUT OPTIONS
     // ------------------------------------------------------------------------
 
@@ -165,6 +230,33 @@ ChapTrajectoryAnalysis::initOptions(
                                       "pathway endpoints for both JSON and "
                                       "OBJ output."));
 
+    outputSupportRangeIsSet_ = false;
+    options -> addOption(RealOption("out-support-range")
+                         .storeVector(&outputSupportRange_)
+                         .storeIsSet(&outputSupportRangeIsSet_)
+                         .valueCount(2)
+                         .description("Fixed lower and upper end of the range "
+                                      "of spatial sample points. By default, "
+                                      "this range is determined from the "
+                                      "pathway endpoints in all frames. A "
+                                      "fixed range is required to merge "
+                                      "aggregation states of runs over "
+                                      "different time windows."));
+
+    const char * const allowedEnergyAnchor[] = {"endpoints",
+                                                "mean_endpoints",
+                                                "support_range"};
+    outputEnergyAnchor_ = eEnergyAnchorEndpoints;
+    options -> addOption(EnumOption<eEnergyAnchor>("out-energy-anchor")
+                         .enumValue(allowedEnergyAnchor)
+                         .store(&outputEnergyAnchor_)
+                         .description("Points at which the energy profile is "
+                                      "set to zero. The default uses the "
+                                      "outermost pathway endpoints over all "
+                                      "frames, mean_endpoints the mean "
+                                      "endpoint positions, and support_range "
+                                      "the ends of the extrapolated profile."));
+
     options -> addOption(RealOption("out-grid-dist")
                          .store(&outputGridSampleDist_)
                          .defaultValue(0.15)
@@ -185,6 +277,70 @@ ChapTrajectoryAnalysis::initOptions(
                                       "Negative values may result in "
                                       "visualisation artifacts."));
 
+    const char * const allowedMeshFormat[] = {"obj",
+                                              "ply"};
+    outputMeshFormat_ = eMeshFormatObj;
+    options -> addOption(EnumOption<eMeshFormat>("out-mesh-format")
+                         .enumValue(allowedMeshFormat)
+                         .store(&outputMeshFormat_)
+                         .description("File format for the pathway surface. "
+                                      "The default obj writes an OBJ and MTL "
+                                      "file with one coloured copy of the "
+                                      "surface per property, while ply "
+                                      "writes a binary PLY file containing "
+                                      "the surface once with all properties "
+                                      "as per-vertex attributes."));
+
+    options -> addOption(RealOption("out-mesh-tol")
+                         .store(&outputMeshTolerance_)
+                         .defaultValue(0.0)
+                         .description("If positive, vertex rings on the "
+                                      "pathway surface are placed adaptively "
+                                      "such that centre line and radius "
+                                      "deviate by at most this distance (in "
+                                      "nm) from their linear interpolation "
+                                      "between rings and property variation "
+                                      "stays below the colour resolution. "
+                                      "Zero uses evenly spaced rings."));
+
+    options -> addOption(IntegerOption("out-mesh-max-vert")
+                         .store(&outputMeshMaxVertices_)
+                         .defaultValue(12850)
+                         .description("Maximum number of vertices per "
+                                      "pathway surface if -out-mesh-tol is "
+                                      "positive."));
+
+    options -> addOption(IntegerOption("out-anim-stride")
+                         .store(&outputAnimStride_)
+                         .defaultValue(0)
+                         .description("If positive, every n-th frame of the "
+                                      "pathway surface is written to a binary "
+                                      "mesh sequence file for animation in "
+                                      "PyMOL or VMD. All frames share the "
+                                      "same surface topology. Zero disables "
+                                      "the animation output."));
+
+    options -> addOption(RealOption("out-anim-quant")
+                         .store(&outputAnimQuantStep_)
+                         .defaultValue(0.01)
+                         .description("Quantisation step (in Ang) for vertex "
+                                      "coordinates in the surface animation, "
+                                      "which are then stored as 16 bit "
+                                      "differences to the previous frame "
+                                      "where possible. Zero stores "
+                                      "uncompressed single precision "
+                                      "coordinates."));
+
+    options -> addOption(BooleanOption("out-state")
+                         .store(&outputState_)
+                         .defaultValue(false)
+                         .description("If true, CHAP will write the "
+                                      "aggregation state of each pathway to "
+                                      "a JSON file, so that the results of "
+                                      "runs over different time windows of "
+                                      "the same trajectory can be merged "
+                                      "with chap-aggregate -state."));
+
     options -> addOption(BooleanOption("out-detailed")
                          .store(&outputDetailed_)
                          .defaultValue(false)
@@ -194,12 +350,71 @@ ChapTrajectoryAnalysis::initOptions(
                                       "probe positions and spline parameters. "
                                       "This is mostly useful for debugging."));
 
+    const char * const allowedStreamLevel[] = {"profiles",
+                                               "residues",
+                                               "particles"};
+    outputStreamLevel_ = eStreamLevelParticles;
+    options -> addOption(EnumOption<eStreamLevel>("out-stream-level")
+                         .enumValue(allowedStreamLevel)
+                         .store(&outputStreamLevel_)
+                         .description("Amount of per-frame data written to "
+                                      "the frame stream. The profiles level "
+                                      "contains pathway summaries and "
+                                      "profile splines, residues adds the "
+                                      "positions of pore-forming residues, "
+                                      "and particles adds the positions of "
+                                      "all solvent particles."));
+
+    options -> addOption(BooleanOption("out-stream-sample-only")
+                         .store(&outputStreamSampleOnly_)
+                         .defaultValue(false)
+                         .description("If true, only solvent particles inside "
+                                      "the sampling region of the pathway "
+                                      "are written to the frame stream. Only "
+                                      "used with -out-stream-level "
+                                      "particles."));
+
+    options -> addOption(BooleanOption("out-occupancy")
+                         .store(&outputOccupancy_)
+                         .defaultValue(false)
+                         .description("If true, solvent particles inside the "
+                                      "sampling region are binned in each "
+                                      "frame and accumulated into occupancy "
+                                      "maps over arc length and radial "
+                                      "distance and over arc length and "
+                                      "angle."));
+
+    options -> addOption(RealOption("out-occupancy-ds")
+                         .store(&outputOccupancyBinWidthS_)
+                         .defaultValue(0.1)
+                         .description("Bin width (in nm) along the arc "
+                                      "length coordinate of the solvent "
+                                      "occupancy maps."));
+
+    options -> addOption(RealOption("out-occupancy-drho")
+                         .store(&outputOccupancyBinWidthRho_)
+                         .defaultValue(0.05)
+                         .description("Bin width (in nm) in the radial "
+                                      "direction of the solvent occupancy "
+                                      "map."));
+
+    options -> addOption(IntegerOption("out-occupancy-nphi")
+                         .store(&outputOccupancyNumBinsPhi_)
+                         .defaultValue(36)
+                         .description("Number of angular bins of the "
+                                      "solvent occupancy map. Must be even, "
+                                      "so that bin edges fall on -pi, 0, and "
+                                      "pi."));
+
 
     // PATH FINDING PARAMETERS
     //-------------------------------------------------------------------------
 
     const char * const allowedPathFindingMethod[] = {"cylindrical",
-                                                     "inplane_optim"};
+                                                     "inplane_optim",
+                                                     "direction_optim",
+                                                     "power_diagram",
+                                                     "distance_transform"};
     pfMethod_ = ePathFindingMethodInplaneOptimised;                                         
     options -> addOption(EnumOption<ePathFindingMethod>("pf-method")
                          .enumValue(allowedPathFindingMethod)
@@ -210,7 +425,23 @@ ChapTrajectoryAnalysis::initOptions(
                                       "position of a probe sphere is "
                                       "optimised in subsequent parallel "
                                       "planes so as to maximise its radius. "
-                                      "The alternative naive_cylindrical "
+                                      "The direction_optim method works "
+                                      "similarly, but aligns each plane with "
+                                      "the local pore axis and is better "
+                                      "suited to strongly curved pathways. "
+                                      "The power_diagram method also "
+                                      "maximises the probe radius in "
+                                      "parallel planes, but locates the "
+                                      "optimal position deterministically "
+                                      "from the power diagram of the atoms "
+                                      "near each plane rather than by "
+                                      "simulated annealing. "
+                                      "The distance_transform method finds "
+                                      "the widest path between both pore "
+                                      "openings on a grid of free distances "
+                                      "and does not rely on parallel "
+                                      "planes. "
+                                      "The alternative cylindrical "
                                       "simply uses a cylindrical volume as "
                                       "permeation pathway."));
 
@@ -266,6 +497,31 @@ ChapTrajectoryAnalysis::initOptions(
                          .defaultValue(1.0)
                          .description("Maximum radius of pore."));
 
+    options -> addOption(RealOption("pf-grid-spacing")
+                         .store(&pfPar_["pfGridSpacing"])
+                         .defaultValue(0.1)
+                         .description("Grid spacing used by the "
+                                      "distance_transform path finding "
+                                      "method."));
+
+    options -> addOption(RealOption("pf-nbh-skin")
+                         .store(&pfPar_["pfNbhSkin"])
+                         .defaultValue(0.2)
+                         .description("Skin of cached neighbour lists used "
+                                      "when evaluating the free distance. A "
+                                      "value of zero or less disables "
+                                      "caching."));
+
+    options -> addOption(RealOption("pf-cull-margin")
+                         .store(&pfCullMargin_)
+                         .defaultValue(-1.0)
+                         .description("Margin of the tube around the previous "
+                                      "pathway within which pore-forming "
+                                      "particles are considered in "
+                                      "probe-based path finding. A negative "
+                                      "value (the default) disables "
+                                      "culling."));
+
     options -> addOption(IntegerOption("pf-max-probe-steps")
                          .store(&pfMaxProbeSteps_)
                          .defaultValue(10000)
@@ -273,30 +529,38 @@ ChapTrajectoryAnalysis::initOptions(
                                       "moved in either direction."));
 
     options -> addOption(SelectionOption("pf-sel-ipp")
-                         .store(&ippSel_)
+                         .storeVector(&ippSel_)
                          .storeIsSet(&ippSelIsSet_)
+                         .multiValue()
                          .description("Selection of atoms whose COM will be "
                                       "used as initial probe position. If not "
                                       "set, the selection specified with "
-                                      "'sel-pathway' will be used."));
+                                      "'sel-pathway' will be used. If "
+                                      "several pathways are analysed, one "
+                                      "group per pathway must be given."));
 
     options -> addOption(RealOption("pf-init-probe-pos")
                          .storeVector(&pfInitProbePos_)
                          .storeIsSet(&pfInitProbePosIsSet_)
-                         .valueCount(3)
+                         .multiValue()
                          .description("Initial position of probe in "
                                       "probe-based pore finding algorithms. "
                                       "If set explicitly, it will overwrite "
                                       "the COM-based initial position set "
-                                      "with the ippSelflag."));
+                                      "with the ippSelflag. If several "
+                                      "pathways are analysed, three values "
+                                      "per pathway must be given."));
 
-    std::vector<real> chanDirVec_ = {0.0, 0.0, 1.0};
     options -> addOption(RealOption("pf-chan-dir-vec")
                          .storeVector(&pfChanDirVec_)
                          .storeIsSet(&pfChanDirVecIsSet_)
-                         .valueCount(3)
+                         .multiValue()
                          .description("Channel direction vector. Will be "
-                                      "normalised to unit vector internally."));
+                                      "normalised to unit vector internally. "
+                                      "If several pathways are analysed, "
+                                      "either one vector for all pathways or "
+                                      "three values per pathway may be "
+                                      "given."));
    
     // max-free-dist and largest vdW radius
     options -> addOption(DoubleOption("pf-cutoff")
@@ -328,6 +592,38 @@ ChapTrajectoryAnalysis::initOptions(
                           .description("Number of cooling iterations "
                                        "in one simulated annealing run."));
                           
+    options -> addOption(IntegerOption("sa-num-starts")
+                         .store(&saNumStarts_)
+                         .defaultValue(1)
+                         .description("Number of independent simulated "
+                                      "annealing runs used to optimise the "
+                                      "initial probe position. Runs are "
+                                      "distributed over threads."));
+
+    options -> addOption(IntegerOption("sa-conv-iter")
+                         .store(&saConvIter_)
+                         .defaultValue(0)
+                         .description("Window of cooling iterations over "
+                                      "which simulated annealing convergence "
+                                      "is assessed. A value of zero disables "
+                                      "early termination."));
+
+    options -> addOption(RealOption("sa-conv-tol")
+                         .store(&pfPar_["saConvTol"])
+                         .defaultValue(0.0)
+                         .description("Simulated annealing terminates if the "
+                                      "best pore radius has not improved by "
+                                      "more than this over the last "
+                                      "-sa-conv-iter cooling iterations."));
+
+    options -> addOption(RealOption("sa-min-acc-rate")
+                         .store(&pfPar_["saMinAccRate"])
+                         .defaultValue(0.0)
+                         .description("Simulated annealing terminates if "
+                                      "fewer than this fraction of candidate "
+                                      "states were accepted over the last "
+                                      "-sa-conv-iter cooling iterations."));
+
     options -> addOption(RealOption("sa-init-temp")
                          .store(&pfPar_["saInitTemp"])
                          .defaultValue(0.1)
@@ -357,6 +653,21 @@ ChapTrajectoryAnalysis::initOptions(
                          .description("Distance of vertices in initial "
                                       "Nelder-Mead simplex."));
 
+    options -> addOption(RealOption("nm-simplex-tol")
+                         .store(&pfPar_["nmSimplexTol"])
+                         .defaultValue(0.0)
+                         .description("Nelder-Mead optimisation terminates "
+                                      "once no simplex vertex is further "
+                                      "than this from the best vertex and "
+                                      "the radii at all vertices agree to "
+                                      "within -nm-value-tol."));
+
+    options -> addOption(RealOption("nm-value-tol")
+                         .store(&pfPar_["nmValueTol"])
+                         .defaultValue(0.0)
+                         .description("Tolerance on the spread of pore radii "
+                                      "across the Nelder-Mead simplex."));
+
 
     // PATH MAPPING PARAMETERS
     //-------------------------------------------------------------------------
@@ -479,7 +790,7 @@ ChapTrajectoryAnalysis::initOptions(
  */
 void
 ChapTrajectoryAnalysis::initAnalysis(
-        const TrajectoryAnalysisSettings& /*settings*/,
+        const TrajectoryAnalysisSettings &settings,
         const TopologyInformation &top)
 {
     // the following code ensures compatibility across Gromacs versions:
@@ -510,8 +821,13 @@ ChapTrajectoryAnalysis::initAnalysis(
     // PREPARE DATASETS
     //-------------------------------------------------------------------------
 
-    // prepare per frame data stream:
-    frameStreamData_.setDataSetCount(9);
+    // replicate frames are not seen by the runner, so each replicate has its
+    // own frame stream data that is driven from this module:
+    for(size_t r = 1; r < numReplicates_; r++)
+    {
+        ensFrameStreamData_.emplace_back(new AnalysisData());
+        ensFrameStreamData_.back() -> setMultipoint(true);
+    }
     std::vector<std::string> frameStreamDataSetNames = {
             "pathSummary",
             "molPathOrigPoints",
@@ -521,12 +837,13 @@ ChapTrajectoryAnalysis::initAnalysis(
             "solventPositions",
             "solventDensitySpline",
             "plHydrophobicitySpline",
-            "pfHydrophobicitySpline"};
+            "pfHydrophobicitySpline",
+            "sRhoOccupancy",
+            "sPhiOccupancy"};
     std::vector<std::vector<std::string>> frameStreamColumnNames;
 
 
     // prepare container for aggregated data:
-    frameStreamData_.setColumnCount(0, 14);
     frameStreamColumnNames.push_back({"timeStamp",
                                       "argMinRadius",
                                       "minRadius",
@@ -541,28 +858,33 @@ ChapTrajectoryAnalysis::initAnalysis(
                                       "arcLengthLo",
                                       "arcLengthHi",
                                       "bandWidth"});
+    if( outputOccupancy_ )
+    {
+        // occupancy bin widths are only needed to interpret occupancy maps:
+        frameStreamColumnNames.back().push_back("occupancyBinWidthS");
+        frameStreamColumnNames.back().push_back("occupancyBinWidthRho");
+        frameStreamColumnNames.back().push_back("occupancyBinWidthPhi");
+    }
 
     // prepare container for original path points:
-    frameStreamData_.setColumnCount(1, 4);
     frameStreamColumnNames.push_back({"x", 
                                       "y",
                                       "z",
-                                      "r"});
+                                      "r",
+                                      "saIter",
+                                      "nmIter"});
 
     // prepare container for path radius:
-    frameStreamData_.setColumnCount(2, 2);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrl"});
 
     // prepare container for pathway spline:
-    frameStreamData_.setColumnCount(3, 4);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrlX",
                                       "ctrlY",
                                       "ctrlZ"});
 
     // prepare container for residue mapping results:
-    frameStreamData_.setColumnCount(4, 11);
     frameStreamColumnNames.push_back({"resId",
                                       "s",
                                       "rho",
@@ -576,7 +898,6 @@ ChapTrajectoryAnalysis::initAnalysis(
                                       "z"});
 
     // prepare container for solvent mapping:
-    frameStreamData_.setColumnCount(5, 9);
     frameStreamColumnNames.push_back({"resId", 
                                       "s",
                                       "rho",
@@ -588,25 +909,71 @@ ChapTrajectoryAnalysis::initAnalysis(
                                       "z"});
 
     // prepare container for solvent density:
-    frameStreamData_.setColumnCount(6, 2);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrl"});
 
     // prepare container for hydrophobicity splines:
-    frameStreamData_.setColumnCount(7, 2);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrl"});
-    frameStreamData_.setColumnCount(8, 2);
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrl"});
 
-    // add JSON exporter to frame stream data:
-    AnalysisDataJsonFrameExporterPointer jsonFrameExporter(new AnalysisDataJsonFrameExporter);
-    jsonFrameExporter -> setDataSetNames(frameStreamDataSetNames);
-    jsonFrameExporter -> setColumnNames(frameStreamColumnNames);
-    std::string frameStreamFileName = std::string("stream_") + outputJsonFileName_;
-    jsonFrameExporter -> setFileName(frameStreamFileName);
-    frameStreamData_.addModule(jsonFrameExporter);
+    // prepare containers for binned solvent positions:
+    frameStreamColumnNames.push_back({"binS", 
+                                      "binRho",
+                                      "count"});
+    frameStreamColumnNames.push_back({"binS", 
+                                      "binPhi",
+                                      "count"});
+
+    // data sets excluded by the stream level are not written (and not built
+    // in analyzeFrame()):
+    std::vector<bool> frameStreamDataSetMask(
+            frameStreamDataSetNames.size(), 
+            true);
+    frameStreamDataSetMask.at(4) = outputStreamLevel_ >= eStreamLevelResidues;
+    frameStreamDataSetMask.at(5) = outputStreamLevel_ >= eStreamLevelParticles;
+    frameStreamDataSetMask.at(9) = outputOccupancy_;
+    frameStreamDataSetMask.at(10) = outputOccupancy_;
+
+    // each pathway has its own block of data sets in the frame stream data of
+    // each replicate and its own stream file:
+    for(size_t r = 0; r < numReplicates_; r++)
+    {
+        AnalysisData &streamData = (r == 0) ? 
+                frameStreamData_ : *ensFrameStreamData_.at(r - 1);
+        streamData.setDataSetCount(
+                numFrameStreamDataSets_*pathwaySel_.size());
+
+        for(size_t p = 0; p < pathwaySel_.size(); p++)
+        {
+            // set number of columns in each data set of this block:
+            size_t offset = p*numFrameStreamDataSets_;
+            for(size_t i = 0; i < frameStreamColumnNames.size(); i++)
+            {
+                streamData.setColumnCount(
+                        offset + i, 
+                        frameStreamColumnNames.at(i).size());
+            }
+
+            // add JSON exporter to frame stream data:
+            AnalysisDataJsonFrameExporterPointer jsonFrameExporter(new AnalysisDataJsonFrameExporter);
+            jsonFrameExporter -> setDataSetNames(frameStreamDataSetNames);
+            jsonFrameExporter -> setColumnNames(frameStreamColumnNames);
+            jsonFrameExporter -> setDataSetOffset(offset);
+            jsonFrameExporter -> setDataSetMask(frameStreamDataSetMask);
+            jsonFrameExporter -> setFileName(frameStreamFileName(p, r));
+            jsonFrameExporter -> setResumeLineCount(
+                    streamNumLines_.at(r*pathwaySel_.size() + p));
+            if( !streamNumBytes_.empty() )
+            {
+                jsonFrameExporter -> setResumeByteOffset(
+                        streamNumBytes_.at(r*pathwaySel_.size() + p));
+            }
+            streamData.addModule(jsonFrameExporter);
+            frameStreamExporters_.push_back(jsonFrameExporter);
+        }
+    }
 
 
     // PREPARE SELECTIONS FOR PORE PARTICLE MAPPING
@@ -616,11 +983,6 @@ ChapTrajectoryAnalysis::initAnalysis(
     poreMappingSelCol_.setReferencePosType("res_cog");
     poreMappingSelCol_.setOutputPosType("res_cog");
   
-    // selection of C-alpha atoms:
-    std::string pathwaySelSelText = pathwaySel_.selectionText();
-    std::string poreMappingSelCalString = pfSelString_;
-    std::string poreMappingSelCogString = pathwaySelSelText;
-
     // create index groups from topology:
     gmx_ana_indexgrps_t *poreIdxGroups;
  
@@ -638,9 +1000,18 @@ ChapTrajectoryAnalysis::initAnalysis(
                                NULL); 
     }
 
-    // create selections as defined above:
-    poreMappingSelCal_ = poreMappingSelCol_.parseFromString(poreMappingSelCalString)[0];
-    poreMappingSelCog_ = poreMappingSelCol_.parseFromString(poreMappingSelCogString)[0];
+    // create C-alpha and residue selections for each pathway:
+    for(auto sel : pathwaySel_)
+    {
+        std::string poreMappingSelCalString = pfSelString_;
+        std::string poreMappingSelCogString = sel.selectionText();
+        poreMappingSelCal_.push_back(
+                poreMappingSelCol_.parseFromString(poreMappingSelCalString)[0]);
+        poreMappingSelCog_.push_back(
+                poreMappingSelCol_.parseFromString(poreMappingSelCogString)[0]);
+    }
+
+    // all pathways are evaluated together as one collection:
     poreMappingSelCol_.setTopology(topologyPointer.get(), 0);
     poreMappingSelCol_.setIndexGroups(poreIdxGroups);
     poreMappingSelCol_.compile();
@@ -649,15 +1020,156 @@ ChapTrajectoryAnalysis::initAnalysis(
     gmx_ana_indexgrps_free(poreIdxGroups);
 
     // do we have one C-alpha for each pore-forming residue?
-    if( poreMappingSelCal_.posCount() != poreMappingSelCog_.posCount() )
+    for(size_t p = 0; p < pathwaySel_.size(); p++)
     {
-        findPfResidues_ = false;  
+        findPfResidues_.push_back( 
+                poreMappingSelCal_[p].posCount() == 
+                poreMappingSelCog_[p].posCount() );
     }
-    else
+
+
+
+    // PREPARE SELECTIONS AND TRAJECTORIES FOR REPLICATES
+    //-------------------------------------------------------------------------
+
+    // only do this if replicate trajectories are given:
+    if( numReplicates_ > 1 )
     {
-        findPfResidues_ = true;
-    }
+        // create index groups from topology:
+        gmx_ana_indexgrps_t *ensIdxGroups;
+
+        // has custom index file been provided?
+        if( customNdxFileName_.size() != 0 )
+        {
+            gmx_ana_indexgrps_init(&ensIdxGroups,
+                                   topologyPointer.get(),
+                                   customNdxFileName_.c_str());
+        }
+        else
+        {
+            gmx_ana_indexgrps_init(&ensIdxGroups,
+                                   topologyPointer.get(),
+                                   NULL);
+        }
+
+        // replicate frames are not seen by the runner, so user selections
+        // and mapping selections are duplicated into internal collections,
+        // one set per replicate so that replicates can be evaluated 
+        // concurrently:
+        for(size_t i = 0; i < ensTrajFileNames_.size(); i++)
+        {
+            std::unique_ptr<ReplicateSelections> repSel(
+                    new ReplicateSelections());
+
+            // user selections:
+            for(auto sel : pathwaySel_)
+            {
+                repSel -> pathwaySel.push_back(repSel -> selCol.parseFromString(
+                        sel.selectionText())[0]);
+            }
+            for(auto sel : ippSel_)
+            {
+                repSel -> ippSel.push_back(repSel -> selCol.parseFromString(
+                        sel.selectionText())[0]);
+            }
+            repSel -> selCol.setTopology(topologyPointer.get(), 0);
+            repSel -> selCol.setIndexGroups(ensIdxGroups);
+            repSel -> selCol.compile();
+
+            // pore mapping selections (as for main trajectory):
+            repSel -> poreMappingSelCol.setReferencePosType("res_cog");
+            repSel -> poreMappingSelCol.setOutputPosType("res_cog");
+            for(auto sel : pathwaySel_)
+            {
+                repSel -> poreMappingSelCal.push_back(
+                        repSel -> poreMappingSelCol.parseFromString(
+                            pfSelString_)[0]);
+                repSel -> poreMappingSelCog.push_back(
+                        repSel -> poreMappingSelCol.parseFromString(
+                            sel.selectionText())[0]);
+            }
+            repSel -> poreMappingSelCol.setTopology(topologyPointer.get(), 0);
+            repSel -> poreMappingSelCol.setIndexGroups(ensIdxGroups);
+            repSel -> poreMappingSelCol.compile();
+
+            // solvent mapping selection (as for main trajectory):
+            if( !solventSel_.empty() )
+            {
+                repSel -> solvMappingSelCol.setReferencePosType("res_cog");
+                repSel -> solvMappingSelCol.setOutputPosType("res_cog");
+                repSel -> solvMappingSelCog = 
+                        repSel -> solvMappingSelCol.parseFromString(
+                            solventSel_[0].selectionText())[0];
+                repSel -> solvMappingSelCol.setTopology(
+                        topologyPointer.get(), 0);
+                repSel -> solvMappingSelCol.setIndexGroups(ensIdxGroups);
+                repSel -> solvMappingSelCol.compile();
+            }
+
+            ensSel_.push_back(std::move(repSel));
+        }
 
+        // free memory:
+        gmx_ana_indexgrps_free(ensIdxGroups);
+
+        // replicates use the same periodic boundary type as main trajectory,
+        // but each frame provides its own box:
+        ensHasPbc_ = settings.hasPBC();
+        ensEPBC_ = top.ePBC();
+
+        // start replicate frame streams (this opens the stream files):
+        for(auto &streamData : ensFrameStreamData_)
+        {
+            ensFrameStreamHandles_.push_back(
+                    streamData -> startData(AnalysisDataParallelOptions()));
+        }
+
+        // open replicate trajectories and read their first frame:
+        output_env_init_default(&ensOenv_);
+        ensTrxStatus_.resize(ensTrajFileNames_.size(), nullptr);
+        ensFrames_.resize(ensTrajFileNames_.size());
+        ensNumFrames_.assign(ensTrajFileNames_.size(), 0);
+        for(size_t i = 0; i < ensTrajFileNames_.size(); i++)
+        {
+            bool success = read_first_frame(
+                    ensOenv_,
+                    &ensTrxStatus_[i],
+                    ensTrajFileNames_[i].c_str(),
+                    &ensFrames_[i],
+                    TRX_NEED_X);
+            if( !success )
+            {
+                throw std::runtime_error("Could not read first frame from "
+                                         "replicate trajectory " + 
+                                         ensTrajFileNames_[i] + ".");
+            }
+            ensFrameAvailable_.push_back(true);
+
+            // skip frames analysed before checkpoint (each stream file holds
+            // one line per analysed frame), frames are finished without data:
+            size_t numSkip = streamNumLines_.at((i + 1)*pathwaySel_.size());
+            while( ensFrameAvailable_[i] && 
+                   static_cast<size_t>(ensNumFrames_[i]) < numSkip )
+            {
+                ensFrameStreamHandles_[i].startFrame(
+                        ensNumFrames_[i], 
+                        ensFrames_[i].time);
+                ensFrameStreamHandles_[i].finishFrame();
+                ensFrameAvailable_[i] = read_next_frame(
+                        ensOenv_, 
+                        ensTrxStatus_[i], 
+                        &ensFrames_[i]);
+                ensNumFrames_[i]++;
+            }
+            if( static_cast<size_t>(ensNumFrames_[i]) != numSkip )
+            {
+                throw std::runtime_error("Replicate trajectory " + 
+                                         ensTrajFileNames_[i] + " has fewer "
+                                         "frames than recorded in checkpoint "
+                                         "file " + checkpointFileName_ + ".");
+            }
+        }
+    }
 
 
     // PREPARE SELECTIONS FOR SOLVENT PARTICLE MAPPING
@@ -742,13 +1254,12 @@ ChapTrajectoryAnalysis::initAnalysis(
         }
     }
 
-    // import vdW radii JSON: 
-    JsonDocImporter jdi;
-    rapidjson::Document radiiDoc = jdi(pfVdwRadiusJson_.c_str());
+    // import vdW radii JSON (parsed in place, no intermediate copies): 
+    InsituJsonDocument radiiDoc(pfVdwRadiusJson_);
    
     // create radius provider and build lookup table:
     VdwRadiusProvider vrp;
-    vrp.lookupTableFromJson(radiiDoc);
+    vrp.lookupTableFromJson(radiiDoc.doc());
 
     // set user-defined default radius?
     if( pfDefaultVdwRadiusIsSet_ )
@@ -757,11 +1268,19 @@ ChapTrajectoryAnalysis::initAnalysis(
     }
 
 
-    std::vector<int> mappedIds(
-            pathwaySel_.mappedIds().data(),
-            pathwaySel_.mappedIds().data() + pathwaySel_.mappedIds().size());
-
-    
+    // collect atoms in all pathway-forming groups:
+    std::vector<int> mappedIds;
+    for(auto sel : pathwaySel_)
+    {
+        mappedIds.insert(
+                mappedIds.end(),
+                sel.mappedIds().data(),
+                sel.mappedIds().data() + sel.mappedIds().size());
+    }
+    std::sort(mappedIds.begin(), mappedIds.end());
+    mappedIds.erase(
+            std::unique(mappedIds.begin(), mappedIds.end()), 
+            mappedIds.end());
 
     // build vdw radius lookup map:
     vdwRadii_ = vrp.vdwRadiiForTopology(top, mappedIds);
@@ -769,6 +1288,18 @@ ChapTrajectoryAnalysis::initAnalysis(
     // find maximum van der Waals radius:
     maxVdwRadius_ = std::max_element(vdwRadii_.begin(), vdwRadii_.end()) -> second;
 
+    // dense radius array in atom order of each pathway-forming group:
+    for(auto sel : pathwaySel_)
+    {
+        std::vector<real> selVdwRadii;
+        selVdwRadii.reserve(sel.atomCount());
+        for(auto idx : sel.mappedIds())
+        {
+            selVdwRadii.push_back(vdwRadii_.at(idx));
+        }
+        pathwayVdwRadii_.push_back(selVdwRadii);
+    }
+
 
     // GET RESIDUE CHEMICAL INFORMATION
     //-------------------------------------------------------------------------
@@ -822,10 +1353,10 @@ ChapTrajectoryAnalysis::initAnalysis(
     }
 
     // import hydrophbicity JSON:
-    rapidjson::Document hydrophobicityDoc = jdi(hydrophobicityJson_.c_str());
+    InsituJsonDocument hydrophobicityDoc(hydrophobicityJson_);
    
     // generate hydrophobicity lookup table:
-    resInfo_.hydrophobicityFromJson(hydrophobicityDoc);
+    resInfo_.hydrophobicityFromJson(hydrophobicityDoc.doc());
 
     // set fallback hydrophobicity:
     if( hydrophobicityDefaultIsSet_ )
@@ -860,9 +1391,6 @@ ChapTrajectoryAnalysis::analyzeFrame(
         t_pbc *pbc,
         TrajectoryAnalysisModuleData *pdata)
 {
-    // get thread-local selections:
-    const Selection &refSelection = pdata -> parallelSelection(pathwaySel_);
-
     // get data handles for this frame:
     AnalysisDataHandle dhFrameStream = pdata -> dataHandle(frameStreamData_);
 
@@ -870,9 +1398,243 @@ ChapTrajectoryAnalysis::analyzeFrame(
     dhFrameStream.startFrame(frnr, fr.time);
 
 
+    // SKIP FRAMES ANALYSED BEFORE CHECKPOINT
+    //-------------------------------------------------------------------------
+
+    if( frnr < resumeNumFrames_ )
+    {
+        // make sure we are resuming on the same trajectory:
+        if( frnr == resumeNumFrames_ - 1 && fr.time != resumeLastTime_ )
+        {
+            throw std::runtime_error("Time of frame " + std::to_string(frnr) +
+                                     " does not match time recorded in "
+                                     "checkpoint file " + checkpointFileName_ +
+                                     ".");
+        }
+
+        // replicates have already skipped their frames in initAnalysis()
+
+        // frame is finished without adding any data:
+        dhFrameStream.finishFrame();
+        return;
+    }
+
+
+    // EVALUATE MAPPING SELECTIONS
+    //-------------------------------------------------------------------------
+
+    // evaluate pore mapping selections of all pathways for this frame:
+    t_trxframe frame = fr;
+    poreMappingSelCol_.evaluate(&frame, pbc);
+
+    // solvent selection is evaluated once and shared by all pathways:
+    if( !solventSel_.empty() )
+    {
+        t_trxframe tmpFrame = fr;
+        solvMappingSelCol_.evaluate(&tmpFrame, pbc);
+    }
+
+
+    // ANALYSE EACH PATHWAY IN MAIN AND REPLICATE TRAJECTORIES
+    //-------------------------------------------------------------------------
+
+    // replicates are advanced in lockstep with the main trajectory and 
+    // analysed concurrently with it, frames beyond its end are analysed in 
+    // finishAnalysis():
+    int numReplicates = numReplicates_;
+    std::vector<std::exception_ptr> errors(numReplicates);
+    #pragma omp parallel for schedule(dynamic) if( numReplicates > 1 )
+    for(int r = 0; r < numReplicates; r++)
+    {
+        // exceptions may not propagate out of parallel region:
+        try
+        {
+            if( r == 0 )
+            {
+                for(size_t p = 0; p < pathwaySel_.size(); p++)
+                {
+                    analyzePathway(0, p, frnr, fr, pbc, pdata, dhFrameStream);
+                    streamNumLines_.at(p)++;
+                }
+            }
+            else if( ensFrameAvailable_[r - 1] )
+            {
+                // replicates that have run out of frames are skipped:
+                analyzeReplicateFrame(r);
+            }
+        }
+        catch(...)
+        {
+            errors[r] = std::current_exception();
+        }
+    }
+    for(auto &error : errors)
+    {
+        if( error )
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+
+    // FINISH FRAME
+    //-------------------------------------------------------------------------
+
+    // finish analysis of current frame:
+    dhFrameStream.finishFrame();
+
+    // frame data has now been written to stream files:
+    if( checkpointInterval_ > 0 && (frnr + 1) % checkpointInterval_ == 0 )
+    {
+        writeCheckpoint(frnr + 1, fr.time);
+    }
+}
+
+
+/*!
+ * Concurrently analyses the current frame of each replicate trajectory that
+ * has not yet run out of frames (see analyzeReplicateFrame()). This is used
+ * to analyse the replicate frames beyond the end of the main trajectory.
+ */
+void
+ChapTrajectoryAnalysis::analyzeReplicateFrames()
+{
+    int numEnsTraj = ensFrameAvailable_.size();
+    std::vector<std::exception_ptr> errors(numEnsTraj);
+    #pragma omp parallel for schedule(dynamic) if( numEnsTraj > 1 )
+    for(int i = 0; i < numEnsTraj; i++)
+    {
+        // exceptions may not propagate out of parallel region:
+        try
+        {
+            if( ensFrameAvailable_[i] )
+            {
+                analyzeReplicateFrame(i + 1);
+            }
+        }
+        catch(...)
+        {
+            errors[i] = std::current_exception();
+        }
+    }
+    for(auto &error : errors)
+    {
+        if( error )
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+
+/*!
+ * Analyses the current frame of a replicate trajectory and reads ahead to its
+ * next frame. Replicate frames are not seen by the analysis runner, so
+ * selections are evaluated here with periodic boundary conditions built from
+ * the replicate's own simulation box, and the results are added to the 
+ * replicate's own frame stream data. As each replicate has its own selection
+ * collections, trajectory reader, periodic boundary conditions, path 
+ * finders, and frame stream, different replicates may be analysed 
+ * concurrently.
+ */
+void
+ChapTrajectoryAnalysis::analyzeReplicateFrame(
+        size_t replicateIdx)
+{
+    // current frame and frame number of this replicate:
+    t_trxframe repFrame = ensFrames_.at(replicateIdx - 1);
+    int repFrnr = ensNumFrames_.at(replicateIdx - 1);
+
+    // periodic boundary conditions of this replicate frame:
+    t_pbc repPbc;
+    t_pbc *pbc = nullptr;
+    if( ensHasPbc_ )
+    {
+        set_pbc(&repPbc, ensEPBC_, repFrame.box);
+        pbc = &repPbc;
+    }
+
+    // evaluate all selections of this replicate on its current frame:
+    ReplicateSelections &repSel = *ensSel_.at(replicateIdx - 1);
+    repSel.selCol.evaluate(&repFrame, pbc);
+    repSel.poreMappingSelCol.evaluate(&repFrame, pbc);
+    if( !solventSel_.empty() )
+    {
+        repSel.solvMappingSelCol.evaluate(&repFrame, pbc);
+    }
+
+    // analyse each pathway in this replicate:
+    AnalysisDataHandle &dhFrameStream = 
+            ensFrameStreamHandles_.at(replicateIdx - 1);
+    dhFrameStream.startFrame(repFrnr, repFrame.time);
+    for(size_t p = 0; p < pathwaySel_.size(); p++)
+    {
+        analyzePathway(
+                replicateIdx, 
+                p, 
+                repFrnr, 
+                repFrame, 
+                pbc, 
+                nullptr, 
+                dhFrameStream);
+        streamNumLines_.at(replicateIdx*pathwaySel_.size() + p)++;
+    }
+    dhFrameStream.finishFrame();
+    ensNumFrames_.at(replicateIdx - 1)++;
+
+    // read ahead to next frame of this replicate:
+    ensFrameAvailable_[replicateIdx - 1] = read_next_frame(
+            ensOenv_, 
+            ensTrxStatus_[replicateIdx - 1], 
+            &ensFrames_[replicateIdx - 1]);
+}
+
+
+/*!
+ * Carries out path finding and particle mapping for a single pathway in the 
+ * current frame of the given replicate and adds the results to the 
+ * corresponding block of data sets in the given frame stream. Assumes that 
+ * the mapping selections have already been evaluated for this frame. Replicate
+ * zero refers to the main trajectory handled by the analysis runner and is the
+ * only one for which the thread-local module data is used, all other 
+ * replicates use their own internal selections, so that different replicates
+ * can be analysed concurrently. The frame number 
+ * (counted within the replicate) selects the random number streams used in 
+ * path finding.
+ */
+void
+ChapTrajectoryAnalysis::analyzePathway(
+        size_t replicateIdx,
+        size_t pathwayIdx,
+        int frnr,
+        const t_trxframe &fr,
+        t_pbc *pbc,
+        TrajectoryAnalysisModuleData *pdata,
+        AnalysisDataHandle &dhFrameStream)
+{
+    // get thread-local selections (replicates use internal selections):
+    const Selection &refSelection = (replicateIdx == 0) ? 
+            pdata -> parallelSelection(pathwaySel_[pathwayIdx]) : 
+            ensSel_.at(replicateIdx - 1) -> pathwaySel[pathwayIdx];
+
+    // index of first data set belonging to this pathway (each replicate has
+    // its own frame stream data):
+    int dataSetOffset = pathwayIdx*numFrameStreamDataSets_;
+
+
     // UPDATE INITIAL PROBE POSITION FOR THIS FRAME
     //-------------------------------------------------------------------------
 
+    // initial probe position and channel direction of this pathway:
+    RVec initProbePos(
+            pfInitProbePos_[3*pathwayIdx + XX], 
+            pfInitProbePos_[3*pathwayIdx + YY], 
+            pfInitProbePos_[3*pathwayIdx + ZZ]);
+    RVec chanDirVec(
+            pfChanDirVec_[3*pathwayIdx + XX], 
+            pfChanDirVec_[3*pathwayIdx + YY], 
+            pfChanDirVec_[3*pathwayIdx + ZZ]); 
+
     // recalculate initial probe position based on reference group COG:
     if( pfInitProbePosIsSet_ == false )
     {  
@@ -883,16 +1645,21 @@ ChapTrajectoryAnalysis::analyzeFrame(
         if( ippSelIsSet_ == true )
         {
             // use explicitly given selection:
-            tmpsel = ippSel_;
+            tmpsel = (replicateIdx == 0) ? 
+                    ippSel_[pathwayIdx] : 
+                    ensSel_.at(replicateIdx - 1) -> ippSel[pathwayIdx];
         }
         else 
         {
             // default to overall group of pore forming particles:
-            tmpsel = pathwaySel_;
+            tmpsel = (replicateIdx == 0) ? 
+                    pathwaySel_[pathwayIdx] : 
+                    ensSel_.at(replicateIdx - 1) -> pathwaySel[pathwayIdx];
         }
      
         // load data into initial position selection:
-        const gmx::Selection &initPosSelection = pdata -> parallelSelection(tmpsel);
+        const gmx::Selection &initPosSelection = (replicateIdx == 0) ?
+                pdata -> parallelSelection(tmpsel) : tmpsel;
  
         // initialse total mass and COM vector:
         real totalMass = 0.0;
@@ -919,60 +1686,128 @@ ChapTrajectoryAnalysis::analyzeFrame(
         centreOfMass[ZZ] /= 1.0 * totalMass; 
 
         // set initial probe position:
-        pfInitProbePos_[XX] = centreOfMass[XX];
-        pfInitProbePos_[YY] = centreOfMass[YY];
-        pfInitProbePos_[ZZ] = centreOfMass[ZZ];
+        initProbePos = centreOfMass;
     }
 
 
     // GET VDW RADII FOR SELECTION
     //-------------------------------------------------------------------------
 
-    // create vector of van der Waals radii and allocate memory:
-    std::vector<real> selVdwRadii;
-    selVdwRadii.reserve(refSelection.atomCount());
+    // radii of static selections are looked up once in initAnalysis:
+    const std::vector<real> *selVdwRadii = &pathwayVdwRadii_.at(pathwayIdx);
 
-    // loop over all atoms in system and get vdW-radii:
-    for(int i=0; i<refSelection.atomCount(); i++)
+    // atoms in dynamic selections may change from frame to frame:
+    std::vector<real> dynamicVdwRadii;
+    if( refSelection.isDynamic() )
     {
-        // get global index of i-th atom in selection:
-        gmx::SelectionPosition atom = refSelection.position(i);
-        int idx = atom.mappedId();
+        dynamicVdwRadii.reserve(refSelection.atomCount());
+        for(int i = 0; i < refSelection.atomCount(); i++)
+        {
+            // get global index of i-th atom in selection:
+            int idx = refSelection.position(i).mappedId();
 
-        // add radius to vector of radii:
-        selVdwRadii.push_back(vdwRadii_.at(idx));
-				}
+            // add radius to vector of radii:
+            dynamicVdwRadii.push_back(vdwRadii_.at(idx));
+        }
+        selVdwRadii = &dynamicVdwRadii;
+    }
 
 
 				// PORE FINDING AND RADIUS CALCULATION
 				// ------------------------------------------------------------------------
 
-    // vectors as RVec:
-    RVec initProbePos(pfInitProbePos_[0], pfInitProbePos_[1], pfInitProbePos_[2]);
-    RVec chanDirVec(pfChanDirVec_[0], pfChanDirVec_[1], pfChanDirVec_[2]); 
-
-    // create path finding module:
-    std::unique_ptr<AbstractPathFinder> pfm;
-    if( pfMethod_ == ePathFindingMethodInplaneOptimised )
+    // random number streams are unique to frame, replicate, and pathway:
+    PathFindingParameters frameParams = pfParams_;
+    frameParams.setFrameIndex(
+            (static_cast<uint64_t>(frnr)*numReplicates_ + replicateIdx)*
+            pathwaySel_.size() + pathwayIdx);
+
+    // creates path finding module for given pore-forming particles:
+    auto makePathFinder = [&](
+            gmx::AnalysisNeighborhoodPositions porePos,
+            const std::vector<real> &poreVdwRadii) 
+            -> std::unique_ptr<AbstractPathFinder>
     {
-        // create inplane-optimised path finder:
-        pfm.reset(new InplaneOptimisedProbePathFinder(pfPar_,
+        std::unique_ptr<AbstractPathFinder> pfm;
+        if( pfMethod_ == ePathFindingMethodInplaneOptimised )
+        {
+            // create inplane-optimised path finder:
+            pfm.reset(new InplaneOptimisedProbePathFinder(pfPar_,
+                                                          initProbePos,
+                                                          chanDirVec,
+                                                          pbc,
+                                                          porePos,
+                                                          poreVdwRadii));        
+        }
+        else if( pfMethod_ == ePathFindingMethodOptimisedDirection )
+        {
+            // create direction-optimised path finder:
+            pfm.reset(new OptimisedDirectionProbePathFinder(pfPar_,
+                                                            initProbePos,
+                                                            chanDirVec,
+                                                            pbc,
+                                                            porePos,
+                                                            poreVdwRadii));
+        }
+        else if( pfMethod_ == ePathFindingMethodPowerDiagram )
+        {
+            // create power diagram path finder:
+            pfm.reset(new PowerDiagramProbePathFinder(pfPar_,
                                                       initProbePos,
                                                       chanDirVec,
                                                       pbc,
-                                                      refSelection,
-                                                      selVdwRadii));        
-    }
-    else if( pfMethod_ == ePathFindingMethodNaiveCylindrical )
-    {        
-        // create the naive cylindrical path finder:
-        pfm.reset(new NaiveCylindricalPathFinder(pfPar_,
-                                                 initProbePos,
-                                                 chanDirVec));
+                                                      porePos,
+                                                      poreVdwRadii));
+        }
+        else if( pfMethod_ == ePathFindingMethodDistanceTransform )
+        {
+            // create distance transform path finder:
+            pfm.reset(new DistanceTransformPathFinder(pfPar_,
+                                                      initProbePos,
+                                                      chanDirVec,
+                                                      pbc,
+                                                      porePos,
+                                                      poreVdwRadii));
+        }
+        else if( pfMethod_ == ePathFindingMethodNaiveCylindrical )
+        {        
+            // create the naive cylindrical path finder:
+            pfm.reset(new NaiveCylindricalPathFinder(pfPar_,
+                                                     initProbePos,
+                                                     chanDirVec));
+        }
+
+        // set parameters:
+        pfm -> setParameters(frameParams);
+        return pfm;
+    };
+
+
+    // PORE REGION CULLING
+    //-------------------------------------------------------------------------
+
+    // distance up to which neighbourhood searches reach from probe:
+    real searchReach = cutoffIsSet_ ? cutoff_ : 
+            pfMaxProbeRadius_ + maxVdwRadius_ + 
+            std::sqrt(std::numeric_limits<real>::epsilon());
+    if( pfMethod_ == ePathFindingMethodPowerDiagram )
+    {
+        searchReach += std::sqrt(2.0)*pfMaxProbeRadius_;
     }
 
-    // set parameters:
-    pfm -> setParameters(pfParams_);
+    // culling applies to probe-based methods with finite search cutoff:
+    bool cullPoreRegion = pfCullMargin_ >= 0.0 && searchReach > 0.0 && 
+            ( pfMethod_ == ePathFindingMethodInplaneOptimised ||
+              pfMethod_ == ePathFindingMethodOptimisedDirection ||
+              pfMethod_ == ePathFindingMethodPowerDiagram );
+
+    // path of this pathway in previous frame:
+    std::vector<gmx::RVec> &prevPath = prevPathPoints_.at(
+            replicateIdx*pathwaySel_.size() + pathwayIdx);
+
+    // retained particles need to outlive path finder:
+    std::vector<gmx::RVec> culledPos;
+    std::vector<real> culledVdwRadii;
 
 
     // PATH FINDING
@@ -981,7 +1816,77 @@ ChapTrajectoryAnalysis::analyzeFrame(
     // run path finding algorithm on current frame:
     std::cout.flush();
     clock_t tPathFinding = std::clock();
-    pfm -> findPath();
+    std::unique_ptr<AbstractPathFinder> pfm;
+    if( cullPoreRegion )
+    {
+        // positions of all pore-forming particles:
+        std::vector<gmx::RVec> selPos;
+        selPos.reserve(refSelection.atomCount());
+        for(int i = 0; i < refSelection.atomCount(); i++)
+        {
+            selPos.push_back(refSelection.position(i).x());
+        }
+
+        // widen tube until path lies well inside of it:
+        real tubeRadius = searchReach + pfCullMargin_;
+        while( true )
+        {
+            // tube around previous path or around channel axis:
+            std::unique_ptr<PoreRegionFilter> filter;
+            if( prevPath.empty() )
+            {
+                filter.reset(new PoreRegionFilter(
+                        initProbePos, chanDirVec, tubeRadius, pbc));
+            }
+            else
+            {
+                filter.reset(new PoreRegionFilter(
+                        prevPath, tubeRadius, 0.1*tubeRadius, pbc));
+            }
+
+            // no point in culling if all particles are retained:
+            std::vector<int> inside = filter -> filter(selPos);
+            if( inside.size() == selPos.size() )
+            {
+                pfm = makePathFinder(refSelection, *selVdwRadii);
+                pfm -> findPath();
+                break;
+            }
+
+            // probe must start well inside tube:
+            std::vector<gmx::RVec> ipp(1, initProbePos);
+            if( !inside.empty() && filter -> contains(ipp, searchReach) )
+            {
+                // run path finding on retained particles only:
+                pfm.reset();
+                culledPos.clear();
+                culledVdwRadii.clear();
+                for(auto idx : inside)
+                {
+                    culledPos.push_back(selPos[idx]);
+                    culledVdwRadii.push_back(selVdwRadii -> at(idx));
+                }
+                pfm = makePathFinder(culledPos, culledVdwRadii);
+                pfm -> findPath();
+
+                // accept path if no path point sees beyond tube surface:
+                if( filter -> contains(pfm -> pathPoints(), searchReach) )
+                {
+                    break;
+                }
+            }
+
+            tubeRadius *= 2.0;
+        }
+
+        // path serves as centre line of tube in next frame:
+        prevPath = pfm -> pathPoints();
+    }
+    else
+    {
+        pfm = makePathFinder(refSelection, *selVdwRadii);
+        pfm -> findPath();
+    }
     tPathFinding = (std::clock() - tPathFinding)/CLOCKS_PER_SEC;
 
     // retrieve molecular path object:
@@ -1010,19 +1915,25 @@ ChapTrajectoryAnalysis::analyzeFrame(
     std::vector<gmx::RVec> pathPoints = molPath.pathPoints();
     std::vector<real> pathRadii = molPath.pathRadii();
 
+    // optimiser iterations spent on each path point:
+    std::vector<int> pathSaIter = pfm -> pathSaIterations();
+    std::vector<int> pathNmIter = pfm -> pathNmIterations();
+
     // add original path points to frame stream dataset:
-    dhFrameStream.selectDataSet(1);
+    dhFrameStream.selectDataSet(dataSetOffset + 1);
     for(size_t i = 0; i < pathPoints.size(); i++)
     {
         dhFrameStream.setPoint(0, pathPoints.at(i)[XX]);
         dhFrameStream.setPoint(1, pathPoints.at(i)[YY]);
         dhFrameStream.setPoint(2, pathPoints.at(i)[ZZ]);
         dhFrameStream.setPoint(3, pathRadii.at(i));
+        dhFrameStream.setPoint(4, pathSaIter.at(i));
+        dhFrameStream.setPoint(5, pathNmIter.at(i));
         dhFrameStream.finishPointSet();
     }
 
     // add radius spline knots and control points to frame stream dataset:
-    dhFrameStream.selectDataSet(2);
+    dhFrameStream.selectDataSet(dataSetOffset + 2);
     std::vector<real> radiusKnots = molPath.poreRadiusUniqueKnots();    
     std::vector<real> radiusCtrlPoints = molPath.poreRadiusCtrlPoints();
     for(size_t i = 0; i < radiusKnots.size(); i++)
@@ -1033,7 +1944,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
     }
     
     // add centre line spline knots and control points to frame stream dataset:
-    dhFrameStream.selectDataSet(3);
+    dhFrameStream.selectDataSet(dataSetOffset + 3);
     std::vector<real> centreLineKnots = molPath.centreLineUniqueKnots();    
     std::vector<gmx::RVec> centreLineCtrlPoints = molPath.centreLineCtrlPoints();
     for(size_t i = 0; i < centreLineKnots.size(); i++)
@@ -1049,17 +1960,20 @@ ChapTrajectoryAnalysis::analyzeFrame(
     // MAP PORE PARTICLES ONTO PATHWAY
     //-------------------------------------------------------------------------
  
-    // evaluate pore mapping selection for this frame:
-    t_trxframe frame = fr;
-    poreMappingSelCol_.evaluate(&frame, pbc);
-    const gmx::Selection poreMappingSelCal = pdata -> parallelSelection(poreMappingSelCal_);    
-    const gmx::Selection poreMappingSelCog = pdata -> parallelSelection(poreMappingSelCog_);    
+    // get pore mapping selections of this pathway:
+    const gmx::Selection poreMappingSelCal = (replicateIdx == 0) ? 
+            pdata -> parallelSelection(poreMappingSelCal_[pathwayIdx]) :
+            ensSel_.at(replicateIdx - 1) -> poreMappingSelCal[pathwayIdx];
+    const gmx::Selection poreMappingSelCog = (replicateIdx == 0) ? 
+            pdata -> parallelSelection(poreMappingSelCog_[pathwayIdx]) :
+            ensSel_.at(replicateIdx - 1) -> poreMappingSelCog[pathwayIdx];
 
 
     // map pore residue COG onto pathway:
     clock_t tMapResCog = std::clock();
     std::map<int, gmx::RVec> poreCogMappedCoords = molPath.mapSelection(
-            poreMappingSelCog);
+            poreMappingSelCog,
+            true);
     tMapResCog = (std::clock() - tMapResCog)/CLOCKS_PER_SEC;
 
     // map pore residue C-alpha onto pathway:
@@ -1095,7 +2009,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
         // is residue pore lining and has COG closer to centreline than CA?
         if( it -> second[RR] < poreCalMappedCoords[it->first][RR] &&
             poreLining[it -> first] == true &&
-            findPfResidues_ == true )
+            findPfResidues_[pathwayIdx] == true )
         {
             poreFacing[it->first] = true;
             nPoreFacing++;
@@ -1165,7 +2079,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
             plResidueHydrophobicity);
 
     // add spline curve parameters to data handle:   
-    dhFrameStream.selectDataSet(7);
+    dhFrameStream.selectDataSet(dataSetOffset + 7);
     for(size_t i = 0; i < plHydrophobicity.ctrlPoints().size(); i++)
     {
         dhFrameStream.setPoint(
@@ -1183,7 +2097,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
             pfResidueHydrophobicity);
 
     // add spline curve parameters to data handle:   
-    dhFrameStream.selectDataSet(8);
+    dhFrameStream.selectDataSet(dataSetOffset + 8);
     for(size_t i = 0; i < pfHydrophobicity.ctrlPoints().size(); i++)
     {
         dhFrameStream.setPoint(
@@ -1209,19 +2123,19 @@ ChapTrajectoryAnalysis::analyzeFrame(
     // only do this if solvent selection is valid:
     if( !solventSel_.empty() )
     {
-        // evaluate solvent mapping selections for this frame:
-        t_trxframe tmpFrame = fr;
-        solvMappingSelCol_.evaluate(&tmpFrame, pbc);
-
         // TODO: make this a parameter:
         real solvMappingMargin_ = 0.0;
             
         // get thread-local selection data:
-        const Selection solvMapSel = pdata -> parallelSelection(solvMappingSelCog_);
+        const Selection solvMapSel = (replicateIdx == 0) ? 
+                pdata -> parallelSelection(solvMappingSelCog_) : 
+                ensSel_.at(replicateIdx - 1) -> solvMappingSelCog;
 
-        // map particles onto pathway:
+        // map particles onto pathway (angle only needed for occupancy maps):
         clock_t tMapSol = std::clock();
-        solventMappedCoords = molPath.mapSelection(solvMapSel);
+        solventMappedCoords = molPath.mapSelection(
+                solvMapSel, 
+                outputOccupancy_);
         tMapSol = (std::clock() - tMapSol)/CLOCKS_PER_SEC;
 
         // find particles inside path (i.e. pore plus bulk sampling regime):
@@ -1254,24 +2168,71 @@ ChapTrajectoryAnalysis::analyzeFrame(
         }
         tSolInsidePore = (std::clock() - tSolInsidePore)/CLOCKS_PER_SEC;
 
-        // now add mapped residue coordinates to data handle:
-        dhFrameStream.selectDataSet(5);
-        
-        // add mapped residues to data container:
-        for(auto it = solventMappedCoords.begin(); 
-            it != solventMappedCoords.end(); 
-            it++)
+        // particle positions are only streamed on request:
+        if( outputStreamLevel_ >= eStreamLevelParticles )
+        {
+            // now add mapped residue coordinates to data handle:
+            dhFrameStream.selectDataSet(dataSetOffset + 5);
+            
+            // add mapped residues to data container:
+            for(auto it = solventMappedCoords.begin(); 
+                it != solventMappedCoords.end(); 
+                it++)
+            {
+                 // skip bulk particles outside sampling region:
+                 if( outputStreamSampleOnly_ && !solvInsideSample[it -> first] )
+                 {
+                     continue;
+                 }
+
+                 dhFrameStream.setPoint(0, solvMapSel.position(it -> first).mappedId()); // res.id
+                 dhFrameStream.setPoint(1, it -> second[0]);     // s
+                 dhFrameStream.setPoint(2, std::sqrt(it -> second[RR])); // rho
+                 dhFrameStream.setPoint(3, it -> second[PP]);    // phi 
+                 dhFrameStream.setPoint(4, solvInsidePore[it -> first]);        // inside pore
+                 dhFrameStream.setPoint(5, solvInsideSample[it -> first]);      // inside sample
+                 dhFrameStream.setPoint(6, solvMapSel.position(it -> first).x()[XX]);  // x
+                 dhFrameStream.setPoint(7, solvMapSel.position(it -> first).x()[YY]);  // y
+                 dhFrameStream.setPoint(8, solvMapSel.position(it -> first).x()[ZZ]);  // z
+                 dhFrameStream.finishPointSet();
+            }
+        }
+
+        // bin particles in sampling region into occupancy maps:
+        if( outputOccupancy_ )
         {
-             dhFrameStream.setPoint(0, solvMapSel.position(it -> first).mappedId()); // res.id
-             dhFrameStream.setPoint(1, it -> second[0]);     // s
-             dhFrameStream.setPoint(2, it -> second[1]);     // rho
-             dhFrameStream.setPoint(3, 0.0);                 // phi 
-             dhFrameStream.setPoint(4, solvInsidePore[it -> first]);        // inside pore
-             dhFrameStream.setPoint(5, solvInsideSample[it -> first]);      // inside sample
-             dhFrameStream.setPoint(6, solvMapSel.position(it -> first).x()[XX]);  // x
-             dhFrameStream.setPoint(7, solvMapSel.position(it -> first).x()[YY]);  // y
-             dhFrameStream.setPoint(8, solvMapSel.position(it -> first).x()[ZZ]);  // z
-             dhFrameStream.finishPointSet();
+            OccupancyMap sRhoMap(
+                    outputOccupancyBinWidthS_, 
+                    outputOccupancyBinWidthRho_);
+            OccupancyMap sPhiMap(
+                    outputOccupancyBinWidthS_, 
+                    2.0*M_PI/outputOccupancyNumBinsPhi_);
+            for(auto &coords : solventMappedCoords)
+            {
+                if( solvInsideSample[coords.first] )
+                {
+                    sRhoMap.add(coords.second[SS], std::sqrt(coords.second[RR]));
+                    sPhiMap.add(coords.second[SS], coords.second[PP]);
+                }
+            }
+
+            // only visited bins are added to frame stream:
+            dhFrameStream.selectDataSet(dataSetOffset + 9);
+            for(auto &bin : sRhoMap.counts())
+            {
+                dhFrameStream.setPoint(0, bin.first.first);
+                dhFrameStream.setPoint(1, bin.first.second);
+                dhFrameStream.setPoint(2, bin.second);
+                dhFrameStream.finishPointSet();
+            }
+            dhFrameStream.selectDataSet(dataSetOffset + 10);
+            for(auto &bin : sPhiMap.counts())
+            {
+                dhFrameStream.setPoint(0, bin.first.first);
+                dhFrameStream.setPoint(1, bin.first.second);
+                dhFrameStream.setPoint(2, bin.second);
+                dhFrameStream.finishPointSet();
+            }
         }
     }
 
@@ -1332,7 +2293,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
             solventSampleCoordS);
 
     // add spline curve parameters to data handle:   
-    dhFrameStream.selectDataSet(6);
+    dhFrameStream.selectDataSet(dataSetOffset + 6);
     for(size_t i = 0; i < solventDensityCoordS.ctrlPoints().size(); i++)
     {
         dhFrameStream.setPoint(
@@ -1365,7 +2326,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
     //-------------------------------------------------------------------------   
 
     // add aggegate path data:
-    dhFrameStream.selectDataSet(0);
+    dhFrameStream.selectDataSet(dataSetOffset + 0);
 
     // only one point per frame:
     dhFrameStream.setPoint(0, fr.time);
@@ -1382,12 +2343,24 @@ ChapTrajectoryAnalysis::analyzeFrame(
     dhFrameStream.setPoint(11, molPath.sLo()); 
     dhFrameStream.setPoint(12, molPath.sHi());
     dhFrameStream.setPoint(13, deParams_.bandWidth()*deParams_.bandWidthScale());
+    if( outputOccupancy_ )
+    {
+        dhFrameStream.setPoint(14, outputOccupancyBinWidthS_);
+        dhFrameStream.setPoint(15, outputOccupancyBinWidthRho_);
+        dhFrameStream.setPoint(16, 2.0*M_PI/outputOccupancyNumBinsPhi_);
+    }
     dhFrameStream.finishPointSet();
 
 
     // ADD RESIDUE DATA TO CONTAINER
     //-------------------------------------------------------------------------
 
+    // residue positions are not streamed at lowest output level:
+    if( outputStreamLevel_ < eStreamLevelResidues )
+    {
+        return;
+    }
+
     // get pore radius and solvent density at each residue's position:
     std::map<int, real> poreRadiusAtResidue;
     std::map<int, real> solventDensityAtResidue;
@@ -1403,7 +2376,7 @@ ChapTrajectoryAnalysis::analyzeFrame(
     }
 
     // add mapped residues to data container:
-    dhFrameStream.selectDataSet(4);
+    dhFrameStream.selectDataSet(dataSetOffset + 4);
     for(auto it = poreCogMappedCoords.begin(); it != poreCogMappedCoords.end(); it++)
     {
         dhFrameStream.setPoint( 0, poreMappingSelCog.position(it -> first).mappedId());
@@ -1419,13 +2392,6 @@ ChapTrajectoryAnalysis::analyzeFrame(
         dhFrameStream.setPoint(10, poreMappingSelCog.position(it -> first).x()[ZZ]);
         dhFrameStream.finishPointSet();
     }
-
-
-    // FINISH FRAME
-    //-------------------------------------------------------------------------
-
-    // finish analysis of current frame:
-    dhFrameStream.finishFrame();
 }
 
 
@@ -1436,505 +2402,342 @@ ChapTrajectoryAnalysis::analyzeFrame(
 void
 ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
 {
-    // free line for neater output:
-    std::cout<<std::endl;
+    // replicates longer than the main trajectory are read to their end:
+    while( std::any_of(ensFrameAvailable_.begin(), 
+                       ensFrameAvailable_.end(), 
+                       [](char available){return available != 0;}) )
+    {
+        analyzeReplicateFrames();
+    }
 
-    // transfer file names from user input:
-    std::string inFileName = std::string("stream_") + outputJsonFileName_;
-    std::string outFileName = outputJsonFileName_;
-    std::fstream inFile;
-    std::fstream outFile;
+    // finish replicate frame streams and close replicate trajectories:
+    for(size_t i = 0; i < ensTrxStatus_.size(); i++)
+    {
+        ensFrameStreamHandles_[i].finishData();
+        close_trx(ensTrxStatus_[i]);
+        done_frame(&ensFrames_[i]);
+    }
+    if( numReplicates_ > 1 )
+    {
+        output_env_done(ensOenv_);
+    }
 
-    // READ PER-FRAME DATA AND AGGREGATE ALL NON-PROFILE DATA
-    // ------------------------------------------------------------------------
+    // aggregate data for each pathway separately:
+    for(size_t p = 0; p < pathwaySel_.size(); p++)
+    {
+        finishPathway(p, numFrames);
+    }
 
-    // openen per-frame data set for reading:
-    inFile.open(inFileName, std::fstream::in);
-
-    // prepare summary statistics for aggregate properties:
-    SummaryStatistics argMinRadiusSummary;
-    SummaryStatistics minRadiusSummary;
-    SummaryStatistics lengthSummary;
-    SummaryStatistics volumeSummary;
-    SummaryStatistics numPathSummary;
-    SummaryStatistics numSampleSummary;
-    SummaryStatistics solventRangeLoSummary;
-    SummaryStatistics solventRangeHiSummary;
-    SummaryStatistics argMinSolventDensitySummary;
-    SummaryStatistics minSolventDensitySummary;
-    SummaryStatistics arcLengthLoSummary;
-    SummaryStatistics arcLengthHiSummary;
-    SummaryStatistics bandWidthSummary;
-
-    // containers for scalar time series:
-    std::vector<real> argMinRadiusTimeSeries;
-    std::vector<real> minRadiusTimeSeries;
-    std::vector<real> lengthTimeSeries;
-    std::vector<real> volumeTimeSeries;
-    std::vector<real> numPathwayTimeSeries;
-    std::vector<real> numSampleTimeSeries;
-    std::vector<real> argMinSolventDensityTimeSeries;
-    std::vector<real> minSolventDensityTimeSeries;
-    std::vector<real> bandWidthTimeSeries;
-
-    // number of residues in pore forming group:
-    size_t numPoreRes = 0;
-    std::vector<int> poreResIds;
-
-    // container for time stamps:
-    std::vector<real> timeStamps;
-
-    // read file line by line and calculate summary statistics:
-    int linesRead = 0;
-    std::string line;
-    while( std::getline(inFile, line) )
-    {
-        // read line into JSON document:
-        rapidjson::StringStream lineStream(line.c_str());
-        rapidjson::Document lineDoc;
-        lineDoc.ParseStream(lineStream);
-
-        // sanity checks:
-        if( !lineDoc.IsObject() )
-        {
-            // FIXME this is where the JSON error occurs
-            std::string error = "Line " + std::to_string(linesRead) + 
-            " read from" + inFileName + " is not valid JSON object.";
-            throw std::runtime_error(error);
-        }
-    
-        // calculate summary statistics of aggregate variables:
-        argMinRadiusSummary.update(
-                lineDoc["pathSummary"]["argMinRadius"][0].GetDouble());
-        minRadiusSummary.update(
-                lineDoc["pathSummary"]["minRadius"][0].GetDouble());
-        lengthSummary.update(
-                lineDoc["pathSummary"]["length"][0].GetDouble());
-        volumeSummary.update(
-                lineDoc["pathSummary"]["volume"][0].GetDouble());
-        numPathSummary.update(
-                lineDoc["pathSummary"]["numPath"][0].GetDouble());
-        numSampleSummary.update(
-                lineDoc["pathSummary"]["numSample"][0].GetDouble());
-        solventRangeLoSummary.update(
-                lineDoc["pathSummary"]["solventRangeLo"][0].GetDouble());
-        solventRangeHiSummary.update(
-                lineDoc["pathSummary"]["solventRangeHi"][0].GetDouble());
-        argMinSolventDensitySummary.update(
-                lineDoc["pathSummary"]["argMinSolventDensity"][0].GetDouble());
-        minSolventDensitySummary.update(
-                lineDoc["pathSummary"]["minSolventDensity"][0].GetDouble());
-        arcLengthLoSummary.update(
-                lineDoc["pathSummary"]["arcLengthLo"][0].GetDouble());
-        arcLengthHiSummary.update(
-                lineDoc["pathSummary"]["arcLengthHi"][0].GetDouble());
-        bandWidthSummary.update(
-                lineDoc["pathSummary"]["bandWidth"][0].GetDouble());
-        
-        // get time stamp of current frame:
-        real timeStamp = lineDoc["pathSummary"]["timeStamp"][0].GetDouble();
-        timeStamps.push_back(timeStamp);
-
-        // get scalar time series data:
-        argMinRadiusTimeSeries.push_back(lineDoc["pathSummary"]["argMinRadius"][0].GetDouble());
-        minRadiusTimeSeries.push_back(lineDoc["pathSummary"]["minRadius"][0].GetDouble());
-        lengthTimeSeries.push_back(lineDoc["pathSummary"]["length"][0].GetDouble());
-        volumeTimeSeries.push_back(lineDoc["pathSummary"]["volume"][0].GetDouble());
-        numPathwayTimeSeries.push_back(lineDoc["pathSummary"]["numPath"][0].GetDouble());
-        numSampleTimeSeries.push_back(lineDoc["pathSummary"]["numSample"][0].GetDouble());
-        argMinSolventDensityTimeSeries.push_back(lineDoc["pathSummary"]["argMinSolventDensity"][0].GetDouble());
-        minSolventDensityTimeSeries.push_back(lineDoc["pathSummary"]["minSolventDensity"][0].GetDouble());
-        bandWidthTimeSeries.push_back(lineDoc["pathSummary"]["bandWidth"][0].GetDouble());
-
-        // in first line, also read number of residues in pore forming group:
-        if( linesRead == 0 )
-        {
-            numPoreRes = lineDoc["residuePositions"]["resId"].Size();
+    // checkpoint is obsolete once the run has completed:
+    std::remove(checkpointFileName_.c_str());
+}
 
-            for(size_t i = 0; i < numPoreRes; i++)
-            {
-                poreResIds.push_back(
-                        lineDoc["residuePositions"]["resId"][i].GetDouble());
-            }
-        }
 
-        // increment line counter:
-        linesRead++;
-    }
+/*!
+ * Aggregates the per-frame data of a single pathway from its stream files and
+ * writes the pathway's JSON, PDB, and OBJ output files. If replicate 
+ * trajectories have been analysed, the data of each replicate is aggregated
+ * separately and the results are pooled by merging the summary statistics.
+ * The aggregation itself is carried out by a FrameStreamAggregator, so that 
+ * it can be repeated on the retained stream files using chap-aggregate.
+ */
+void
+ChapTrajectoryAnalysis::finishPathway(
+        size_t pathwayIdx,
+        int numFrames)
+{
+    // free line for neater output:
+    std::cout<<std::endl;
 
-    // close per frame data set:
-    inFile.close();
-    
-    // sanity check:
-    if( linesRead != numFrames )
+    // collect stream files of all replicates:
+    std::vector<std::string> streamFileNames;
+    for(size_t r = 0; r < numReplicates_; r++)
     {
-        throw std::runtime_error("Number of frames read does not equal number"
-        "of frames analyised.");
+        streamFileNames.push_back(frameStreamFileName(pathwayIdx, r));
     }
 
 
-    // READ PER-FRAME DATA AND AGGREGATE TIME-AVERAGED PORE PROFILE
+    // AGGREGATE PER-FRAME DATA
     // ------------------------------------------------------------------------
 
-    // define set of support points for profile evaluation:
-    std::vector<real> supportPoints;
-    size_t numSupportPoints = outputNumPoints_;
-    real supportPointsLo = arcLengthLoSummary.min() - outputExtrapDist_;
-    real supportPointsHi = arcLengthHiSummary.max() + outputExtrapDist_;
-
-    // build support points:
-    real supportPointsStep = (supportPointsHi - supportPointsLo) / (numSupportPoints - 1);
-    for(size_t i = 0; i < numSupportPoints; i++)
+    // set output parameters:
+    FrameStreamAggregator aggregator(streamFileNames);
+    aggregator.setNumPoints(outputNumPoints_);
+    aggregator.setExtrapDist(outputExtrapDist_);
+    if( outputSupportRangeIsSet_ )
     {
-        supportPoints.push_back(supportPointsLo + i*supportPointsStep);
+        aggregator.setSupportRange(
+                outputSupportRange_.at(0), 
+                outputSupportRange_.at(1));
     }
-
-    // define anchor points at which energy is set to zero:
-    real anchorPointLo = arcLengthLoSummary.min();
-    real anchorPointHi = arcLengthHiSummary.max();
-    SummaryStatistics anchorEnergyLo;
-    SummaryStatistics anchorEnergyHi;
-
-    // open JSON data file in read mode:
-    inFile.open(inFileName.c_str(), std::fstream::in);
-    
-    // prepare containers for profile summaries:
-    std::vector<SummaryStatistics> radiusSummary(supportPoints.size());
-    std::vector<SummaryStatistics> solventDensitySummary(supportPoints.size());
-    std::vector<SummaryStatistics> energySummary(supportPoints.size());
-    std::vector<SummaryStatistics> plHydrophobicitySummary(supportPoints.size());
-    std::vector<SummaryStatistics> pfHydrophobicitySummary(supportPoints.size());
-
-    // prepare summary statistics for residue properties:
-    std::vector<SummaryStatistics> residueArcSummary(numPoreRes);
-    std::vector<SummaryStatistics> residueRhoSummary(numPoreRes);
-    std::vector<SummaryStatistics> residuePhiSummary(numPoreRes);
-    std::vector<SummaryStatistics> residuePlSummary(numPoreRes);
-    std::vector<SummaryStatistics> residuePfSummary(numPoreRes);
-    std::vector<SummaryStatistics> residuePoreRadiusSummary(numPoreRes);
-    std::vector<SummaryStatistics> residueSolventDensitySummary(numPoreRes);
-    std::vector<SummaryStatistics> residueXSummary(numPoreRes);
-    std::vector<SummaryStatistics> residueYSummary(numPoreRes);
-    std::vector<SummaryStatistics> residueZSummary(numPoreRes);
-
-    // containers for profile valued time series: 
-    std::vector<std::vector<real>> radiusProfileTimeSeries;
-    std::vector<std::vector<real>> solventDensityTimeSeries;
-    std::vector<std::vector<real>> plHydrophobicityTimeSeries;
-    std::vector<std::vector<real>> pfHydrophobicityTimeSeries;
-
-    // read file line by line:
-    int linesProcessed = 0;
-    while( std::getline(inFile, line) )
-    {
-        std::cout.precision(3);
-        std::cout<<"\rForming time averages, "
-                 <<(double)linesProcessed/numFrames*100
-                 <<"\% complete"
-                 <<std::flush;
-
-        // read line into JSON document:
-        rapidjson::StringStream lineStream(line.c_str());
-        rapidjson::Document lineDoc;
-        lineDoc.ParseStream(lineStream);
-
-        // sanity checks:
-        if( !lineDoc.IsObject() )
+    aggregator.setEnergyAnchor(outputEnergyAnchor_);
+    aggregator.setGridSampleDist(outputGridSampleDist_);
+    aggregator.setCorrectionThreshold(outputCorrectionThreshold_);
+    aggregator.setAdaptiveResolution(
+            outputMeshTolerance_, 
+            std::max(outputMeshMaxVertices_, 0));
+    aggregator.setMeshFormat(outputMeshFormat_);
+    aggregator.setAnimation(
+            outputPathwayBaseFileNames_.at(pathwayIdx) + "_animation.msq",
+            std::max(outputAnimStride_, 0),
+            outputAnimQuantStep_);
+
+    // read stream files and form time averages:
+    aggregator.aggregate();
+
+    // sanity check (replicates may differ in length from main trajectory):
+    for(size_t r = 0; r < numReplicates_; r++)
+    {
+        int numAnalysed = (r == 0) ? numFrames : ensNumFrames_.at(r - 1);
+        if( aggregator.replicate(r).numScalarFrames() != numAnalysed )
         {
-            std::string error = "Line " + std::to_string(linesProcessed) + 
-            " read from" + inFileName + " is not valid JSON object.";
-            throw std::runtime_error(error);
+            throw std::runtime_error("Number of frames read does not equal "
+                                     "number of frames analyised.");
         }
+    }
 
-        // copy first frame from here for OBJ output:
-        if( linesProcessed == 0 )
-        {
-            molPathAvg_.reset(new MolecularPath(lineDoc));
-        }
 
+    // WRITE OUTPUT FILES
+    // ------------------------------------------------------------------------
 
-        // create molecular path:
-        MolecularPath molPath(lineDoc);
+    // structure annotated with pore-lining and pore-facing residues:
+    aggregator.writePdb(outputPdbFileNames_.at(pathwayIdx), outputStructure_);
 
-        // sample radius at support points and add to summary statistics:
-        std::vector<real> radiusSample = molPath.sampleRadii(supportPoints); 
-        for(size_t i = 0; i < radiusSample.size(); i++)
-        {
-            radiusSummary.at(i).update(radiusSample.at(i));
-        }
+    // results including per-replicate data:
+    aggregator.writeJson(outputJsonFileNames_.at(pathwayIdx), resInfo_);
+
+    // aggregation state for merging with other runs:
+    if( outputState_ )
+    {
+        aggregator.writeState(
+                outputPathwayBaseFileNames_.at(pathwayIdx) + "_state.json",
+                resInfo_);
+    }
 
-        // add to time series:
-        radiusProfileTimeSeries.push_back(radiusSample);
+    // load colour palettes from JSON file:
+    std::map<std::string, ColourPalette> palettes;
+    if( outputMeshFormat_ == eMeshFormatObj )
+    {
+        std::string paletteFilePath = chapInstallBase() + 
+                std::string("/chap/share/data/palettes/");
+        std::string paletteFileName = paletteFilePath + "default.json";
+        palettes = ColourPaletteProvider::fromJsonFile(paletteFileName);
+    }
 
-        
-        // sample points from hydrophobicity splines:
-        SplineCurve1D pfHydrophobicitySpline = SplineCurve1DJsonConverter::fromJson(
-                lineDoc["pfHydrophobicitySpline"], 1);
-        std::vector<real> pfHydrophobicitySample = 
-                pfHydrophobicitySpline.evaluateMultiple(supportPoints, 0);
-        SummaryStatistics::updateMultiple(
-                pfHydrophobicitySummary,
-                pfHydrophobicitySample);
-        pfHydrophobicityTimeSeries.push_back(pfHydrophobicitySample);
-
-        SplineCurve1D plHydrophobicitySpline = SplineCurve1DJsonConverter::fromJson(
-                lineDoc["plHydrophobicitySpline"], 1);
-        std::vector<real> plHydrophobicitySample = 
-                plHydrophobicitySpline.evaluateMultiple(supportPoints, 0);
-        SummaryStatistics::updateMultiple(
-                plHydrophobicitySummary,
-                plHydrophobicitySample);
-        plHydrophobicityTimeSeries.push_back(plHydrophobicitySample);
-
-
-        // sample points from solvent density spline:
-        SplineCurve1D solventDensitySpline = SplineCurve1DJsonConverter::fromJson(
-                lineDoc["solventDensitySpline"], 1);
-        std::vector<real> solventDensitySample = 
-                solventDensitySpline.evaluateMultiple(supportPoints, 0);
-
-        // get total number of particles in sample for this time step:
-        int totalNumber = lineDoc["pathSummary"]["numSample"][0].GetDouble();
-
-        // convert to number density and add to summary statistic:
-        // TODO this should be done in per-frame analysis:
-        NumberDensityCalculator ndc;
-        solventDensitySample = ndc(
-                solventDensitySample, 
-                radiusSample, 
-                totalNumber);
-        SummaryStatistics::updateMultiple(
-                solventDensitySummary,
-                solventDensitySample);
-        solventDensityTimeSeries.push_back(solventDensitySample);
- 
-        // convert to energy and add to summary statistic:
-        BoltzmannEnergyCalculator bec;
-        std::vector<real> energySample = bec.calculate(solventDensitySample);
-        SummaryStatistics::updateMultiple(
-                energySummary,
-                energySample);
-
-        // also evaluate density and radius at anchor points:
-        real solventDensityAnchorLo = solventDensitySpline.evaluate(
-                anchorPointLo, 0);
-        real solventDensityAnchorHi = solventDensitySpline.evaluate(
-                anchorPointHi, 0);
-        real poreRadiusAnchorLo = molPath.radius(anchorPointLo);
-        real poreRadiusAnchorHi = molPath.radius(anchorPointHi);
-
-        // calculate energy at anchor points by linear interpolation:
-        LinearSplineInterp1D interp;
-        auto energySpline = interp(supportPoints, energySample);
-        anchorEnergyLo.update( energySpline.evaluate(anchorPointLo, 0) );
-        anchorEnergyHi.update( energySpline.evaluate(anchorPointHi, 0) );
-
-
-        // loop over all pore forming residues:
-        for(size_t i = 0; i < numPoreRes; i++)
+    // time-averaged pathway surface:
+    aggregator.writeSurface(
+            outputPathwayBaseFileNames_.at(pathwayIdx), 
+            palettes);
+
+
+    // DELETE PER FRAME DATA
+    // ------------------------------------------------------------------------
+   
+    // detailed output requested?
+    if( !outputDetailed_ )
+    {
+        // remove streaming JSON files:
+        for(auto &fileName : streamFileNames)
         {
-            residueArcSummary.at(i).update(
-                    lineDoc["residuePositions"]["s"][i].GetDouble());
-            residueRhoSummary.at(i).update(
-                    lineDoc["residuePositions"]["rho"][i].GetDouble());
-            residuePhiSummary.at(i).update(
-                    lineDoc["residuePositions"]["phi"][i].GetDouble());
-            residuePlSummary.at(i).update(
-                    lineDoc["residuePositions"]["poreLining"][i].GetDouble());
-            residuePfSummary.at(i).update(
-                    lineDoc["residuePositions"]["poreFacing"][i].GetDouble());
-            residueXSummary.at(i).update(
-                    lineDoc["residuePositions"]["x"][i].GetDouble());
-            residueYSummary.at(i).update(
-                    lineDoc["residuePositions"]["y"][i].GetDouble());
-            residueZSummary.at(i).update(
-                    lineDoc["residuePositions"]["z"][i].GetDouble());
-
-            // residue-local number density requires additional post-processing:
-            real rad = lineDoc["residuePositions"]["poreRadius"][i].GetDouble();
-            real den = lineDoc["residuePositions"]["solventDensity"][i].GetDouble();
-            residuePoreRadiusSummary.at(i).update(rad);
-            residueSolventDensitySummary.at(i).update(den*totalNumber/(M_PI*rad*rad));
+            std::remove(fileName.c_str());
         }
-
-        // increment line counter:
-        linesProcessed++;
     }
-  
-    // shift of energy profile so that energy at anchor points is zero:
-    real shift = -0.5*(anchorEnergyLo.mean() + anchorEnergyHi.mean());
-    std::for_each(
-            energySummary.begin(), 
-            energySummary.end(), 
-            [this, shift](SummaryStatistics &s){s.shift(shift);});
+}
 
-    // inform user about progress:
-    std::cout.precision(3);
-    std::cout<<"\rForming time averages, "
-             <<(double)linesProcessed/numFrames*100
-             <<"\% complete"
-             <<std::endl;
 
-    // sanity check:
-    if( linesProcessed != numFrames )
+/*!
+ * Returns the name of the frame stream file for the given pathway and 
+ * replicate. The replicate index is only added to the file name if several
+ * replicates are analysed.
+ */
+std::string
+ChapTrajectoryAnalysis::frameStreamFileName(
+        size_t pathwayIdx,
+        size_t replicateIdx) const
+{
+    if( numReplicates_ > 1 )
     {
-        std::string error = "Number of lines read from JSON file does not"
-        "equal number of frames processed!"; 
-        throw std::runtime_error(error);
+        return std::string("stream_") + 
+               outputPathwayBaseFileNames_.at(pathwayIdx) + "_replicate" + 
+               std::to_string(replicateIdx + 1) + ".json";
     }
+    else
+    {
+        return std::string("stream_") + outputJsonFileNames_.at(pathwayIdx);
+    }
+}
 
-    // close filestream object:
-    inFile.close();
-
-    
-    // CREATE PDB OUTPUT
-    // ------------------------------------------------------------------------
 
-    // assign residue pore facing and pore lining to occupency and bfac:
-    outputStructure_.setPoreFacing(residuePlSummary, residuePfSummary);
+/*!
+ * Writes a checkpoint file recording the number of frames analysed so far, 
+ * the time of the last analysed frame, the random seed used in path finding,
+ * and the number of frames and bytes written to each stream file together 
+ * with the last path points of the corresponding pathway, around which 
+ * pore-forming particles are culled in the next frame. As all aggregation is
+ * carried out on the stream files in finishAnalysis(), this is sufficient to
+ * resume an interrupted run with identical results. The 
+ * checkpoint is first written to a temporary file, which is then renamed, so 
+ * that a valid checkpoint exists even if the run is killed while writing.
+ */
+void
+ChapTrajectoryAnalysis::writeCheckpoint(
+        int numFrames,
+        real lastTime)
+{
+    // create JSON document:
+    rapidjson::Document doc;
+    doc.SetObject();
+    rapidjson::Document::AllocatorType &alloc = doc.GetAllocator();
+
+    // progress of main trajectory and random number generator state:
+    doc.AddMember("numFrames", numFrames, alloc);
+    doc.AddMember("lastTime", lastTime, alloc);
+    doc.AddMember("saRandomSeed", static_cast<int64_t>(saRandomSeed_), alloc);
+
+    // number of frames written to each stream file:
+    rapidjson::Value streamFiles(rapidjson::kArrayType);
+    for(size_t r = 0; r < numReplicates_; r++)
+    {
+        for(size_t p = 0; p < pathwaySel_.size(); p++)
+        {
+            rapidjson::Value streamFile(rapidjson::kObjectType);
+            streamFile.AddMember(
+                    "fileName", 
+                    rapidjson::Value(frameStreamFileName(p, r), alloc),
+                    alloc);
+            streamFile.AddMember(
+                    "numLines", 
+                    static_cast<uint64_t>(
+                        streamNumLines_.at(r*pathwaySel_.size() + p)),
+                    alloc);
+            streamFile.AddMember(
+                    "numBytes", 
+                    frameStreamExporters_.at(
+                        r*pathwaySel_.size() + p) -> fileSize(),
+                    alloc);
+
+            // centre line of culling tube in next frame:
+            rapidjson::Value prevPath(rapidjson::kArrayType);
+            for(auto &point : prevPathPoints_.at(r*pathwaySel_.size() + p))
+            {
+                rapidjson::Value xyz(rapidjson::kArrayType);
+                xyz.PushBack(point[XX], alloc);
+                xyz.PushBack(point[YY], alloc);
+                xyz.PushBack(point[ZZ], alloc);
+                prevPath.PushBack(xyz, alloc);
+            }
+            streamFile.AddMember("prevPathPoints", prevPath, alloc);
+            streamFiles.PushBack(streamFile, alloc);
+        }
+    }
+    doc.AddMember("streamFiles", streamFiles, alloc);
+
+    // stringify document:
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    doc.Accept(writer);
+
+    // write to temporary file and replace previous checkpoint:
+    std::string tmpFileName = checkpointFileName_ + ".tmp";
+    std::fstream file;
+    file.open(tmpFileName.c_str(), std::fstream::out);
+    file<<buffer.GetString()<<std::endl;
+    file.close();
+    if( file.fail() || 
+        std::rename(tmpFileName.c_str(), checkpointFileName_.c_str()) != 0 )
+    {
+        throw std::runtime_error("Could not write checkpoint file " +
+                                 checkpointFileName_ + ".");
+    }
+}
 
-    // write structure to PDB file:
-    PdbIo::write(outputPdbFileName_, outputStructure_);
 
+/*!
+ * Reads the checkpoint file written by writeCheckpoint() and restores the 
+ * state needed to resume an interrupted run. The stream files listed in the
+ * checkpoint must match those of the current run, i.e. the same number of 
+ * pathways and replicates must be analysed with the same output file name.
+ */
+void
+ChapTrajectoryAnalysis::readCheckpoint()
+{
+    // load checkpoint file:
+    std::ifstream file(checkpointFileName_.c_str());
+    if( !file.good() )
+    {
+        throw std::runtime_error("Can not resume, checkpoint file " +
+                                 checkpointFileName_ + " not found.");
+    }
+    file.close();
+    JsonDocImporter jdi;
+    rapidjson::Document doc = jdi(checkpointFileName_);
 
-    // CREATE OUTPUT JSON
-    // ------------------------------------------------------------------------
+    // sanity checks:
+    if( !doc.IsObject() ||
+        !doc.HasMember("numFrames") ||
+        !doc.HasMember("lastTime") ||
+        !doc.HasMember("saRandomSeed") ||
+        !doc.HasMember("streamFiles") ||
+        !doc["streamFiles"].IsArray() )
+    {
+        throw std::runtime_error("Checkpoint file " + checkpointFileName_ +
+                                 " is not valid.");
+    }
+    if( doc["streamFiles"].Size() != streamNumLines_.size() )
+    {
+        throw std::runtime_error("Number of pathways and replicates does not "
+                                 "match checkpoint file " + 
+                                 checkpointFileName_ + ".");
+    }
 
-    // initialise a JSON results container:
-    ResultsJsonExporter results;
-
-    // add summary statistics for scalr variables describing the pathway:
-    results.addPathwaySummary("argMinRadius", argMinRadiusSummary);
-    results.addPathwaySummary("minRadius", minRadiusSummary);
-    results.addPathwaySummary("length", lengthSummary);
-    results.addPathwaySummary("volume", volumeSummary);
-    results.addPathwaySummary("numPathway", numPathSummary);
-    results.addPathwaySummary("numSample", numSampleSummary);
-    results.addPathwaySummary("argMinSolventDensity", argMinSolventDensitySummary);
-    results.addPathwaySummary("minSolventDensity", minSolventDensitySummary);
-    results.addPathwaySummary("bandWidth", bandWidthSummary);
-
-    // add time-averaged pathway profiles:
-    results.addSupportPoints(supportPoints);
-    results.addPathwayProfile("radius", radiusSummary);
-    results.addPathwayProfile("plHydrophobicity", plHydrophobicitySummary);
-    results.addPathwayProfile("pfHydrophobicity", pfHydrophobicitySummary);
-    results.addPathwayProfile("density", solventDensitySummary);
-    results.addPathwayProfile("energy", energySummary);
-    
-    // add scalar time series data to output:
-    results.addTimeStamps(timeStamps);
-    results.addPathwayScalarTimeSeries("argMinRadius", argMinRadiusTimeSeries);
-    results.addPathwayScalarTimeSeries("minRadius", minRadiusTimeSeries);
-    results.addPathwayScalarTimeSeries("length", lengthTimeSeries);
-    results.addPathwayScalarTimeSeries("volume", volumeTimeSeries);
-    results.addPathwayScalarTimeSeries("numPathway", numPathwayTimeSeries);
-    results.addPathwayScalarTimeSeries("numSample", numSampleTimeSeries);
-    results.addPathwayScalarTimeSeries("argMinSolventDensity", argMinSolventDensityTimeSeries);
-    results.addPathwayScalarTimeSeries("minSolventDensity", minSolventDensityTimeSeries);
-    results.addPathwayScalarTimeSeries("bandWidth", bandWidthTimeSeries);
-
-    // add vector-valued time series data to output:
-    results.addPathwayGridPoints(timeStamps, supportPoints);
-    results.addPathwayProfileTimeSeries("radius", radiusProfileTimeSeries);
-    results.addPathwayProfileTimeSeries("density", solventDensityTimeSeries);
-    results.addPathwayProfileTimeSeries("plHydrophobicity", plHydrophobicityTimeSeries);
-    results.addPathwayProfileTimeSeries("pfHydrophobicity", pfHydrophobicityTimeSeries);
-
-    // add per-residue data to output document:
-    results.addResidueInformation(poreResIds, resInfo_);
-    results.addResidueSummary("s", residueArcSummary);
-    results.addResidueSummary("rho", residueRhoSummary);
-    results.addResidueSummary("phi", residuePhiSummary);
-    results.addResidueSummary("poreLining", residuePlSummary);
-    results.addResidueSummary("poreFacing", residuePfSummary);
-    results.addResidueSummary("poreRadius", residuePoreRadiusSummary);
-    results.addResidueSummary("solventDensity", residueSolventDensitySummary);
-    results.addResidueSummary("x", residueXSummary);
-    results.addResidueSummary("y", residueYSummary);
-    results.addResidueSummary("z", residueZSummary);
-
-
-    // write results to JSON file:
-    results.write(outFileName);
+    // restore number of frames written to each stream file:
+    for(size_t r = 0; r < numReplicates_; r++)
+    {
+        for(size_t p = 0; p < pathwaySel_.size(); p++)
+        {
+            size_t idx = r*pathwaySel_.size() + p;
+            const rapidjson::Value &streamFile = doc["streamFiles"][idx];
+            if( streamFile["fileName"].GetString() != 
+                frameStreamFileName(p, r) )
+            {
+                throw std::runtime_error("Stream file names do not match "
+                                         "checkpoint file " + 
+                                         checkpointFileName_ + ".");
+            }
+            streamNumLines_.at(idx) = streamFile["numLines"].GetUint64();
 
+            // size of retained part of stream file (if recorded):
+            if( streamFile.HasMember("numBytes") )
+            {
+                streamNumBytes_.resize(streamNumLines_.size(), 0);
+                streamNumBytes_.at(idx) = streamFile["numBytes"].GetUint64();
+            }
 
-    // DELETE PER FRAME DATA
-    // ------------------------------------------------------------------------
-   
-    // detailed output requested?
-    if( !outputDetailed_ )
-    {
-        // remove streaming JSON file:
-        std::remove(inFileName.c_str());
+            // path around which particles are culled (if recorded):
+            if( streamFile.HasMember("prevPathPoints") )
+            {
+                const rapidjson::Value &prevPath = 
+                        streamFile["prevPathPoints"];
+                for(rapidjson::SizeType i = 0; i < prevPath.Size(); i++)
+                {
+                    prevPathPoints_.at(idx).push_back(gmx::RVec(
+                            prevPath[i][0].GetDouble(), 
+                            prevPath[i][1].GetDouble(), 
+                            prevPath[i][2].GetDouble()));
+                }
+            }
+        }
     }
 
-    // EXPORT PATHWAY TO OBJ FILE
-    // ------------------------------------------------------------------------
 
-    // retrieve averaged properties:
-    std::vector<real> avgRadius;
-    std::vector<real> avgSolventDensity;
-    std::vector<real> avgEnergy;
-    std::vector<real> avgPlHydrophobicity;
-    std::vector<real> avgPfHydrophobicity;
-    for(size_t i = 0; i < supportPoints.size(); i++)
-    {
-        avgRadius.push_back(radiusSummary.at(i).mean());
-        avgSolventDensity.push_back(solventDensitySummary.at(i).mean());
-        avgEnergy.push_back(energySummary.at(i).mean());
-        avgPlHydrophobicity.push_back(plHydrophobicitySummary.at(i).mean());
-        avgPfHydrophobicity.push_back(pfHydrophobicitySummary.at(i).mean());
-    }
-
-    // averaged properties as spline curves:
-    CubicSplineInterp1D interp;
-    auto avgRadiusSpl = interp(
-            supportPoints, 
-            avgRadius, 
-            eSplineInterpBoundaryHermite);
-    auto avgSolventDensitySpl = interp(
-            supportPoints, 
-            avgSolventDensity, 
-            eSplineInterpBoundaryHermite);
-    auto avgEnergySpl = interp(
-            supportPoints, 
-            avgEnergy, 
-            eSplineInterpBoundaryHermite);
-    auto avgPlHydrophobicitySpl = interp(
-            supportPoints, 
-            avgPlHydrophobicity, 
-            eSplineInterpBoundaryHermite);
-    auto avgPfHydrophobicitySpl = interp(
-            supportPoints, 
-            avgPfHydrophobicity, 
-            eSplineInterpBoundaryHermite);
-
-
-    // associate properties with pathway:
-    molPathAvg_ -> addScalarProperty("avg_radius", avgRadiusSpl, false);
-    molPathAvg_ -> addScalarProperty("avg_density", avgSolventDensitySpl, false);
-    // FIXME: NaN energy values can not be exported to OBJ!
-    molPathAvg_ -> addScalarProperty("avg_energy", avgEnergySpl, false);
-    molPathAvg_ -> addScalarProperty("avg_pl_hydrophobicity", avgPlHydrophobicitySpl, true);
-    molPathAvg_ -> addScalarProperty("avg_pf_hydrophobicity", avgPfHydrophobicitySpl, true);
+    // restore progress and random seed so that results are reproduced:
+    resumeNumFrames_ = doc["numFrames"].GetInt();
+    resumeLastTime_ = doc["lastTime"].GetDouble();
+    saRandomSeed_ = doc["saRandomSeed"].GetInt64();
+    pfParams_.setRandomSeed(saRandomSeed_);
 
-    // load colour palettes from JSON file:
-    std::string paletteFilePath = chapInstallBase() + 
-            std::string("/chap/share/data/palettes/");
-    std::string paletteFileName = paletteFilePath + "default.json";
-    auto palettes = ColourPaletteProvider::fromJsonFile(paletteFileName);
-
-    // export pathway to file:
-    MolecularPathObjExporter mpexp;
-    mpexp.setExtrapDist(outputExtrapDist_);
-    mpexp.setGridSampleDist(outputGridSampleDist_);
-    mpexp.setCorrectionThreshold(outputCorrectionThreshold_);
-    mpexp(
-        outputBaseFileName_, 
-        "time_averaged_molecular_path", 
-        *molPathAvg_,
-        palettes);
+    std::cout<<"Resuming from checkpoint file "<<checkpointFileName_
+             <<" after "<<resumeNumFrames_<<" frames."<<std::endl;
 }
 
 
@@ -1985,13 +2788,32 @@ ChapTrajectoryAnalysis::obtainNdxFilePathInfo()
 void
 ChapTrajectoryAnalysis::checkParameters()
 {
+    // ENSEMBLE PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // main trajectory counts as first replicate:
+    numReplicates_ = ensTrajFileNames_.size() + 1;
+
+
     // OUTPUT PARAMETERS
     //-------------------------------------------------------------------------
 
-    // add proper extensions to file names:
-    // TODO: better in exporter code?
-    outputJsonFileName_ = outputBaseFileName_ + ".json";
-    outputPdbFileName_ = outputBaseFileName_ + ".pdb";
+    // each pathway gets its own set of output files:
+    for(size_t p = 0; p < pathwaySel_.size(); p++)
+    {
+        // pathway index is only appended if several pathways are analysed:
+        std::string baseFileName = outputBaseFileName_;
+        if( pathwaySel_.size() > 1 )
+        {
+            baseFileName += "_pathway" + std::to_string(p + 1);
+        }
+        outputPathwayBaseFileNames_.push_back(baseFileName);
+
+        // add proper extensions to file names:
+        // TODO: better in exporter code?
+        outputJsonFileNames_.push_back(baseFileName + ".json");
+        outputPdbFileNames_.push_back(baseFileName + ".pdb");
+    }
 
     // sanity checks:
     if( outputExtrapDist_ < 0.0 )
@@ -2010,11 +2832,84 @@ ChapTrajectoryAnalysis::checkParameters()
         throw std::runtime_error("Parameter -out-vis-teak must be in interval "
                                  "(-1, 1).");
     }
+    if( outputSupportRangeIsSet_ && 
+        outputSupportRange_.at(1) <= outputSupportRange_.at(0) )
+    {
+        throw std::runtime_error("Upper end of -out-support-range must be "
+                                 "larger than lower end.");
+    }
+    if( outputOccupancyBinWidthS_ <= 0.0 || 
+        outputOccupancyBinWidthRho_ <= 0.0 )
+    {
+        throw std::runtime_error("Parameters -out-occupancy-ds and "
+                                 "-out-occupancy-drho must be strictly "
+                                 "positive.");
+    }
+    if( outputOccupancyNumBinsPhi_ <= 0 || outputOccupancyNumBinsPhi_ % 2 != 0 )
+    {
+        throw std::runtime_error("Parameter -out-occupancy-nphi must be a "
+                                 "positive even number.");
+    }
+    if( outputState_ && 
+        (!outputSupportRangeIsSet_ || 
+         outputEnergyAnchor_ != eEnergyAnchorSupportRange) )
+    {
+        std::cout<<"WARNING: Aggregation states can only be merged if "
+                 <<"-out-support-range is set and -out-energy-anchor is "
+                 <<"support_range."<<std::endl;
+    }
 
 
     // PATH FINDING PARAMETERS
     //-------------------------------------------------------------------------
 
+    // need one initial probe position group per pathway:
+    size_t numPathways = pathwaySel_.size();
+    if( ippSelIsSet_ && ippSel_.size() != numPathways )
+    {
+        throw std::runtime_error("Number of groups given with -pf-sel-ipp "
+                                 "must equal number of groups given with "
+                                 "-sel-pathway.");
+    }
+
+    // need one explicit initial probe position per pathway:
+    if( pfInitProbePosIsSet_ && pfInitProbePos_.size() != 3*numPathways )
+    {
+        throw std::runtime_error("Parameter -pf-init-probe-pos requires "
+                                 "three values per group given with "
+                                 "-sel-pathway.");
+    }
+    if( !pfInitProbePosIsSet_ )
+    {
+        pfInitProbePos_.resize(3*numPathways, std::nan(""));
+    }
+
+    // a single channel direction vector is used for all pathways:
+    if( pfChanDirVec_.size() == 3 )
+    {
+        std::vector<real> chanDirVec = pfChanDirVec_;
+        for(size_t p = 1; p < numPathways; p++)
+        {
+            pfChanDirVec_.insert(
+                    pfChanDirVec_.end(), 
+                    chanDirVec.begin(), 
+                    chanDirVec.end());
+        }
+    }
+    if( pfChanDirVec_.size() != 3*numPathways )
+    {
+        throw std::runtime_error("Parameter -pf-chan-dir-vec requires either "
+                                 "three values or three values per group "
+                                 "given with -sel-pathway.");
+    }
+
+    // each probe step has its own annealing stream (see annealingStream()):
+    if( pfMaxProbeSteps_ < 0 || pfMaxProbeSteps_ >= (1 << 16) )
+    {
+        throw std::runtime_error("Parameter -pf-max-probe-steps must be "
+                                 "non-negative and less than 65536.");
+    }
+
     // create random seed unless user has set seed explicitly:
     if( !saRandomSeedIsSet_ )
     {
@@ -2030,7 +2925,8 @@ ChapTrajectoryAnalysis::checkParameters()
     pfPar_["pfCylStepLength"] = pfProbeStepLength_;
 
     pfPar_["saMaxCoolingIter"] = saMaxCoolingIter_;
-    pfPar_["saRandomSeed"] = saRandomSeed_;
+    pfPar_["saConvIter"] = saConvIter_;
+    pfPar_["saNumStarts"] = saNumStarts_;
     pfPar_["saNumCostSamples"] = saNumCostSamples_;
 
     pfPar_["nmMaxIter"] = nmMaxIter_;
@@ -2039,6 +2935,8 @@ ChapTrajectoryAnalysis::checkParameters()
     pfParams_.setProbeStepLength(pfProbeStepLength_);
     pfParams_.setMaxProbeRadius(pfMaxProbeRadius_);
     pfParams_.setMaxProbeSteps(pfMaxProbeSteps_);
+    // random seed is not representable as real and only passed via struct:
+    pfParams_.setRandomSeed(saRandomSeed_);
     
     if( cutoffIsSet_ )
     {
@@ -2075,5 +2973,26 @@ ChapTrajectoryAnalysis::checkParameters()
     hydrophobKernelParams_.setBandWidth(hpBandWidth_);
     hydrophobKernelParams_.setEvalRangeCutoff(hpEvalRangeCutoff_);
     hydrophobKernelParams_.setMaxEvalPointDist(hpResolution_);
+
+
+    // CHECKPOINT PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // sanity checks:
+    if( checkpointInterval_ < 0 )
+    {
+        throw std::runtime_error("Parameter -checkpoint-interval may not be "
+                                 "negative.");
+    }
+
+    // no frames written to stream files unless resuming:
+    checkpointFileName_ = outputBaseFileName_ + "_checkpoint.json";
+    streamNumLines_.assign(pathwaySel_.size()*numReplicates_, 0);
+    prevPathPoints_.assign(pathwaySel_.size()*numReplicates_, 
+                           std::vector<gmx::RVec>());
+    if( resume_ )
+    {
+        readCheckpoint();
+    }
 }
 
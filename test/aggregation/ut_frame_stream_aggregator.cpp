@@ -0,0 +1,362 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "external/rapidjson/stringbuffer.h"
+#include "external/rapidjson/writer.h"
+
+#include "aggregation/frame_stream_aggregator.hpp"
+
+
+/*!
+ * \brief Test fixture for FrameStreamAggregator.
+ *
+ * Writes two frame stream files containing frames of a cylindrical pathway
+ * whose properties vary with the frame index. 
+ */
+class FrameStreamAggregatorTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Constructor writes frames 0 to 3 to the first and frames 4 to 8 to
+         * the second stream file.
+         */
+        FrameStreamAggregatorTest()
+            : streamFileNames_({"test_stream_replicate1.json",
+                                "test_stream_replicate2.json"})
+        {
+            writeStream(streamFileNames_[0], 0, 3);
+            writeStream(streamFileNames_[1], 4, 8);
+        }
+
+        /*!
+         * Removes temporary stream files.
+         */
+        ~FrameStreamAggregatorTest()
+        {
+            for(auto &fileName : streamFileNames_)
+            {
+                std::remove(fileName.c_str());
+            }
+        }
+
+        /*!
+         * Auxiliary function that creates the JSON document for a single
+         * frame in the format written to the frame stream file.
+         */
+        rapidjson::Document makeFrameDoc(int frame)
+        {
+            std::string r = std::to_string(0.5 + 0.1*frame);
+            std::string d = std::to_string(0.2 + 0.05*frame);
+            std::string s = std::to_string(-0.5 + 0.2*frame);
+            std::string h = std::to_string(-1.0 + 0.3*frame);
+
+            std::string json =
+                "{\"pathSummary\":{"
+                "\"timeStamp\":[" + std::to_string(frame) + "],"
+                "\"argMinRadius\":[" + s + "],"
+                "\"minRadius\":[" + r + "],"
+                "\"length\":[4.0],"
+                "\"volume\":[" + std::to_string(3.0 + frame) + "],"
+                "\"numPath\":[" + std::to_string(10 + frame) + "],"
+                "\"numSample\":[" + std::to_string(20 + 2*frame) + "],"
+                "\"solventRangeLo\":[-2.0],"
+                "\"solventRangeHi\":[2.0],"
+                "\"argMinSolventDensity\":[" + s + "],"
+                "\"minSolventDensity\":[" + d + "],"
+                "\"arcLengthLo\":[" + std::to_string(-2.0 - 0.1*frame) + "],"
+                "\"arcLengthHi\":[" + std::to_string(2.0 + 0.1*frame) + "],"
+                "\"bandWidth\":[0.1]},"
+                "\"molPathOrigPoints\":{"
+                "\"x\":[0.0,0.0],\"y\":[0.0,0.0],\"z\":[-2.0,2.0],"
+                "\"r\":[" + r + "," + r + "]},"
+                "\"molPathRadiusSpline\":{"
+                "\"knots\":[-2.0,-2.0,-1.0,0.0,1.0,2.0,2.0],"
+                "\"ctrl\":[" + r + "," + r + "," + r + "," + r + "," + r + ","
+                + r + "," + r + "]},"
+                "\"molPathCentreLineSpline\":{"
+                "\"knots\":[-2.0,-2.0,-1.0,0.0,1.0,2.0,2.0],"
+                "\"ctrlX\":[0.0,0.0,0.0,0.0,0.0,0.0,0.0],"
+                "\"ctrlY\":[0.0,0.0,0.0,0.0,0.0,0.0,0.0],"
+                "\"ctrlZ\":[-2.0,-1.6667,-1.0,0.0,1.0,1.6667,2.0]},"
+                "\"residuePositions\":{"
+                "\"resId\":[1,2],\"s\":[" + s + ",1.0],\"rho\":[1.0,1.2],"
+                "\"phi\":[0.0,3.0],\"poreLining\":[1,0],\"poreFacing\":[1,0],"
+                "\"poreRadius\":[" + r + "," + r + "],"
+                "\"solventDensity\":[" + d + "," + d + "],"
+                "\"x\":[1.0,0.0],\"y\":[0.0,1.2],\"z\":[" + s + ",1.0]},"
+                "\"solventDensitySpline\":{"
+                "\"knots\":[-3.0,-1.0,0.0,1.0,3.0],"
+                "\"ctrl\":[0.0," + d + ",0.1," + d + ",0.0]},"
+                "\"plHydrophobicitySpline\":{"
+                "\"knots\":[-3.0,0.0,3.0],\"ctrl\":[0.0," + h + ",0.0]},"
+                "\"pfHydrophobicitySpline\":{"
+                "\"knots\":[-3.0,0.0,3.0],\"ctrl\":[0.0," + h + ",0.0]}}";
+
+            rapidjson::Document doc;
+            doc.Parse(json.c_str());
+            return doc;
+        }
+
+        /*!
+         * Auxiliary function that writes the given range of frames to a 
+         * newline delimited stream file.
+         */
+        void writeStream(
+                const std::string &fileName,
+                int firstFrame,
+                int lastFrame)
+        {
+            std::ofstream file(fileName);
+            for(int i = firstFrame; i <= lastFrame; i++)
+            {
+                rapidjson::Document doc = makeFrameDoc(i);
+                rapidjson::StringBuffer buffer;
+                rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+                doc.Accept(writer);
+                file<<buffer.GetString()<<std::endl;
+            }
+        }
+
+    protected:
+
+        std::vector<std::string> streamFileNames_;
+};
+
+
+/*!
+ * Checks that aggregating the stream files yields the same results as 
+ * aggregating all frames directly with a single PathwayAggregator.
+ */
+TEST_F(FrameStreamAggregatorTest, FrameStreamAggregatorPoolingTest)
+{
+    // floating point tolerance:
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // aggregate stream files:
+    FrameStreamAggregator aggregator(streamFileNames_);
+    aggregator.setNumPoints(50);
+    aggregator.setExtrapDist(0.5);
+    aggregator.setVerbose(false);
+    aggregator.aggregate();
+
+    // reference aggregation of all frames at once:
+    PathwayAggregator reference;
+    for(int i = 0; i <= 8; i++)
+    {
+        rapidjson::Document doc = makeFrameDoc(i);
+        reference.addScalarFrame(doc);
+    }
+    reference.supportPointsFromScalars(50, 0.5);
+    for(int i = 0; i <= 8; i++)
+    {
+        rapidjson::Document doc = makeFrameDoc(i);
+        reference.addProfileFrame(doc);
+    }
+
+    // check number of frames per replicate:
+    ASSERT_EQ(2, aggregator.numReplicates());
+    ASSERT_EQ(4, aggregator.replicate(0).numScalarFrames());
+    ASSERT_EQ(5, aggregator.replicate(1).numScalarFrames());
+    ASSERT_EQ(9, aggregator.pooled().numProfileFrames());
+
+    // check support points and profiles:
+    const PathwayAggregator &pooled = aggregator.pooled();
+    ASSERT_EQ(reference.supportPoints().size(), pooled.supportPoints().size());
+    for(size_t i = 0; i < pooled.supportPoints().size(); i++)
+    {
+        ASSERT_NEAR(
+                reference.supportPoints()[i], 
+                pooled.supportPoints()[i], 
+                eps);
+    }
+    for(auto name : {"radius", "density", "energy", "pfHydrophobicity"})
+    {
+        std::vector<real> expected = reference.meanProfile(name);
+        std::vector<real> actual = pooled.meanProfile(name);
+        ASSERT_EQ(expected.size(), actual.size());
+        for(size_t i = 0; i < actual.size(); i++)
+        {
+            ASSERT_NEAR(expected[i], actual[i], eps);
+        }
+    }
+
+    // check scalar and residue summaries:
+    ASSERT_NEAR(
+            reference.scalarSummary("volume").mean(),
+            pooled.scalarSummary("volume").mean(),
+            eps);
+    ASSERT_NEAR(
+            reference.residueSummary("s").at(0).mean(),
+            pooled.residueSummary("s").at(0).mean(),
+            eps);
+}
+
+
+/*!
+ * Checks that the choice of energy anchor points only shifts the energy 
+ * profile and that missing stream files are reported.
+ */
+TEST_F(FrameStreamAggregatorTest, FrameStreamAggregatorEnergyAnchorTest)
+{
+    // floating point tolerance:
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // aggregate with different anchors:
+    FrameStreamAggregator endpoints(streamFileNames_);
+    endpoints.setNumPoints(20);
+    endpoints.setVerbose(false);
+    endpoints.aggregate();
+    FrameStreamAggregator meanEndpoints(streamFileNames_);
+    meanEndpoints.setNumPoints(20);
+    meanEndpoints.setEnergyAnchor(eEnergyAnchorMeanEndpoints);
+    meanEndpoints.setVerbose(false);
+    meanEndpoints.aggregate();
+
+    // energy profiles differ by a constant shift:
+    std::vector<real> energyA = endpoints.pooled().meanProfile("energy");
+    std::vector<real> energyB = meanEndpoints.pooled().meanProfile("energy");
+    ASSERT_EQ(energyA.size(), energyB.size());
+    real shift = energyB.front() - energyA.front();
+    for(size_t i = 0; i < energyA.size(); i++)
+    {
+        ASSERT_NEAR(shift, energyB[i] - energyA[i], eps);
+    }
+
+    // other profiles are unaffected:
+    std::vector<real> radiusA = endpoints.pooled().meanProfile("radius");
+    std::vector<real> radiusB = meanEndpoints.pooled().meanProfile("radius");
+    for(size_t i = 0; i < radiusA.size(); i++)
+    {
+        ASSERT_NEAR(radiusA[i], radiusB[i], eps);
+    }
+
+    // nonexistent stream file:
+    FrameStreamAggregator missing({"nonexistent_stream.json"});
+    missing.setVerbose(false);
+    ASSERT_THROW(missing.aggregate(), std::runtime_error);
+}
+
+
+
+/*!
+ * Checks that merging the aggregation states of two shards covering 
+ * different time windows of the same trajectory yields the same results as 
+ * aggregating all frames in a single run (up to floating point rounding).
+ */
+TEST_F(FrameStreamAggregatorTest, FrameStreamAggregatorMergeStatesTest)
+{
+    // floating point tolerance:
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // residue information for both pore residues:
+    rapidjson::Document residueSummary;
+    residueSummary.Parse(
+            "{\"id\":[1,2],\"name\":[\"ALA\",\"LEU\"],\"chain\":[\"A\",\"A\"],"
+            "\"hydrophobicity\":[1.8,3.8]}");
+    ResidueInformationProvider resInfo;
+    resInfo.fromResidueSummary(residueSummary);
+
+    // single run over all frames:
+    writeStream("test_stream_full.json", 0, 8);
+    FrameStreamAggregator full({"test_stream_full.json"});
+    full.setNumPoints(30);
+    full.setSupportRange(-3.0, 3.0);
+    full.setEnergyAnchor(eEnergyAnchorSupportRange);
+    full.setVerbose(false);
+    full.aggregate();
+    std::remove("test_stream_full.json");
+
+    // one run per shard, states are given in reverse temporal order:
+    std::vector<std::string> stateFileNames = {"test_state_shard2.json",
+                                               "test_state_shard1.json"};
+    for(size_t i = 0; i < streamFileNames_.size(); i++)
+    {
+        FrameStreamAggregator shard({streamFileNames_[i]});
+        shard.setNumPoints(30);
+        shard.setSupportRange(-3.0, 3.0);
+        shard.setEnergyAnchor(eEnergyAnchorSupportRange);
+        shard.setVerbose(false);
+        shard.aggregate();
+        shard.writeState(stateFileNames[1 - i], resInfo);
+    }
+
+    // merge shard states:
+    FrameStreamAggregator merged({});
+    merged.setVerbose(false);
+    ResidueInformationProvider mergedResInfo;
+    merged.mergeStates(stateFileNames, mergedResInfo);
+    for(auto &fileName : stateFileNames)
+    {
+        std::remove(fileName.c_str());
+    }
+
+    // residue information is restored from state:
+    ASSERT_EQ("LEU", mergedResInfo.name(2));
+    ASSERT_EQ("A", mergedResInfo.chain(1));
+
+    // merged results agree with single run up to rounding:
+    const PathwayAggregator &expected = full.pooled();
+    const PathwayAggregator &actual = merged.pooled();
+    ASSERT_EQ(expected.numScalarFrames(), actual.numScalarFrames());
+    ASSERT_EQ(expected.numProfileFrames(), actual.numProfileFrames());
+    for(auto name : {"minRadius", "volume", "numPath"})
+    {
+        ASSERT_NEAR(expected.scalarSummary(name).mean(),
+                    actual.scalarSummary(name).mean(), eps);
+        ASSERT_NEAR(expected.scalarSummary(name).var(),
+                    actual.scalarSummary(name).var(), eps);
+    }
+    for(auto name : {"radius", "density", "energy", "pfHydrophobicity"})
+    {
+        std::vector<SummaryStatistics> a = expected.profileSummary(name);
+        std::vector<SummaryStatistics> b = actual.profileSummary(name);
+        ASSERT_EQ(a.size(), b.size());
+        for(size_t i = 0; i < a.size(); i++)
+        {
+            ASSERT_NEAR(a[i].mean(), b[i].mean(), eps);
+            ASSERT_NEAR(a[i].sd(), b[i].sd(), eps);
+        }
+    }
+
+    // time series are in temporal order:
+    rapidjson::Document stateDoc;
+    stateDoc.SetObject();
+    rapidjson::Value state = actual.stateToJson(stateDoc.GetAllocator());
+    const rapidjson::Value &timeStamps = state["timeStamps"];
+    ASSERT_EQ(9, timeStamps.Size());
+    for(rapidjson::SizeType i = 1; i < timeStamps.Size(); i++)
+    {
+        ASSERT_LT(timeStamps[i - 1].GetDouble(), timeStamps[i].GetDouble());
+    }
+}
@@ -0,0 +1,158 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "aggregation/occupancy_map.hpp"
+#include "io/occupancy_map_json_converter.hpp"
+
+
+/*!
+ * \brief Test fixture for OccupancyMap.
+ */
+class OccupancyMapTest : public ::testing::Test
+{
+
+};
+
+
+/*!
+ * Checks that points are assigned to the correct bins, including points with
+ * negative coordinates and points on bin edges.
+ */
+TEST_F(OccupancyMapTest, OccupancyMapBinningTest)
+{
+    OccupancyMap map(0.5, 0.25);
+    ASSERT_TRUE(map.empty());
+
+    map.add(0.1, 0.1);
+    map.add(0.4, 0.2);
+    map.add(-0.1, 0.3);
+    map.add(0.5, -0.25);
+    map.add(-1.2, 0.0);
+
+    ASSERT_FALSE(map.empty());
+    ASSERT_EQ(4, map.counts().size());
+    ASSERT_EQ(2, map.count(0, 0));
+    ASSERT_EQ(1, map.count(-1, 1));
+    ASSERT_EQ(1, map.count(1, -1));
+    ASSERT_EQ(1, map.count(-3, 0));
+    ASSERT_EQ(0, map.count(5, 5));
+
+    // default constructed map has no bin widths:
+    OccupancyMap undefined;
+    ASSERT_THROW(undefined.add(0.0, 0.0), std::logic_error);
+    ASSERT_THROW(OccupancyMap(0.0, 1.0), std::logic_error);
+}
+
+
+/*!
+ * Checks that merging maps adds up counts and frame numbers and that maps 
+ * with different bin widths can not be merged.
+ */
+TEST_F(OccupancyMapTest, OccupancyMapMergeTest)
+{
+    OccupancyMap first(0.1, 0.1);
+    first.add(0.05, 0.05);
+    first.add(0.15, 0.05);
+    first.addFrames(1);
+    OccupancyMap second(0.1, 0.1);
+    second.add(0.05, 0.05);
+    second.add(-0.05, 0.05);
+    second.addFrames(2);
+
+    // merge into default constructed map:
+    OccupancyMap pooled;
+    pooled.merge(first);
+    pooled.merge(second);
+    ASSERT_EQ(3, pooled.numFrames());
+    ASSERT_EQ(2, pooled.count(0, 0));
+    ASSERT_EQ(1, pooled.count(1, 0));
+    ASSERT_EQ(1, pooled.count(-1, 0));
+    ASSERT_NEAR(0.1, pooled.binWidthX(), 1e-7);
+
+    // merging an empty default map only adds frames:
+    OccupancyMap noBins;
+    noBins.addFrames(4);
+    pooled.merge(noBins);
+    ASSERT_EQ(7, pooled.numFrames());
+
+    // incompatible bin widths:
+    OccupancyMap other(0.2, 0.1);
+    ASSERT_THROW(pooled.merge(other), std::logic_error);
+}
+
+
+/*!
+ * Checks that conversion to the dense JSON representation is lossless.
+ */
+TEST_F(OccupancyMapTest, OccupancyMapJsonConverterTest)
+{
+    // map spanning negative and positive bin indices:
+    OccupancyMap map(0.1, 0.2);
+    map.addCount(-2, 1, 3);
+    map.addCount(0, -1, 1);
+    map.addCount(1, 1, 5);
+    map.addFrames(10);
+
+    // convert to JSON:
+    rapidjson::Document doc;
+    doc.SetObject();
+    rapidjson::Value obj = OccupancyMapJsonConverter::convert(
+            map, 
+            doc.GetAllocator());
+    ASSERT_EQ(10, obj["numFrames"].GetUint64());
+    ASSERT_EQ(-2, obj["binLo"][0].GetInt());
+    ASSERT_EQ(-1, obj["binLo"][1].GetInt());
+    ASSERT_EQ(4, obj["shape"][0].GetInt());
+    ASSERT_EQ(3, obj["shape"][1].GetInt());
+    ASSERT_EQ(12, obj["counts"].Size());
+    ASSERT_EQ(3, obj["counts"][0*3 + 2].GetUint64());
+    ASSERT_EQ(1, obj["counts"][2*3 + 0].GetUint64());
+    ASSERT_EQ(5, obj["counts"][3*3 + 2].GetUint64());
+
+    // convert back:
+    OccupancyMap restored = OccupancyMapJsonConverter::fromJson(obj);
+    ASSERT_EQ(map.numFrames(), restored.numFrames());
+    ASSERT_EQ(map.counts(), restored.counts());
+    ASSERT_NEAR(map.binWidthY(), restored.binWidthY(), 1e-7);
+
+    // empty map:
+    OccupancyMap empty(0.1, 0.1);
+    rapidjson::Value emptyObj = OccupancyMapJsonConverter::convert(
+            empty, 
+            doc.GetAllocator());
+    ASSERT_EQ(0, emptyObj["counts"].Size());
+    ASSERT_TRUE(OccupancyMapJsonConverter::fromJson(emptyObj).empty());
+
+    // malformed object:
+    rapidjson::Value malformed(rapidjson::kObjectType);
+    ASSERT_THROW(
+            OccupancyMapJsonConverter::fromJson(malformed), 
+            std::runtime_error);
+}
+
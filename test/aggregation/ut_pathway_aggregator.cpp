@@ -0,0 +1,446 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "aggregation/pathway_aggregator.hpp"
+
+
+/*!
+ * \brief Test fixture for PathwayAggregator.
+ *
+ * Provides a function that creates frame documents in the format written to
+ * the frame stream file, where all properties vary with the frame index.
+ */
+class PathwayAggregatorTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Auxiliary function that creates the JSON document for a single
+         * frame of a straight cylindrical pathway along the z-axis, whose
+         * radius, solvent density, and residue positions depend on the
+         * frame index.
+         */
+        rapidjson::Document makeFrameDoc(int frame)
+        {
+            std::string r = std::to_string(0.5 + 0.1*frame);
+            std::string d = std::to_string(0.2 + 0.05*frame);
+            std::string s = std::to_string(-0.5 + 0.2*frame);
+            std::string h = std::to_string(-1.0 + 0.3*frame);
+
+            std::string json =
+                "{\"pathSummary\":{"
+                "\"timeStamp\":[" + std::to_string(frame) + "],"
+                "\"argMinRadius\":[" + s + "],"
+                "\"minRadius\":[" + r + "],"
+                "\"length\":[4.0],"
+                "\"volume\":[" + std::to_string(3.0 + frame) + "],"
+                "\"numPath\":[" + std::to_string(10 + frame) + "],"
+                "\"numSample\":[" + std::to_string(20 + 2*frame) + "],"
+                "\"solventRangeLo\":[-2.0],"
+                "\"solventRangeHi\":[2.0],"
+                "\"argMinSolventDensity\":[" + s + "],"
+                "\"minSolventDensity\":[" + d + "],"
+                "\"arcLengthLo\":[" + std::to_string(-2.0 - 0.1*frame) + "],"
+                "\"arcLengthHi\":[" + std::to_string(2.0 + 0.1*frame) + "],"
+                "\"bandWidth\":[0.1]},"
+                "\"molPathOrigPoints\":{"
+                "\"x\":[0.0,0.0],\"y\":[0.0,0.0],\"z\":[-2.0,2.0],"
+                "\"r\":[" + r + "," + r + "]},"
+                "\"molPathRadiusSpline\":{"
+                "\"knots\":[-2.0,-2.0,-1.0,0.0,1.0,2.0,2.0],"
+                "\"ctrl\":[" + r + "," + r + "," + r + "," + r + "," + r + ","
+                + r + "," + r + "]},"
+                "\"molPathCentreLineSpline\":{"
+                "\"knots\":[-2.0,-2.0,-1.0,0.0,1.0,2.0,2.0],"
+                "\"ctrlX\":[0.0,0.0,0.0,0.0,0.0,0.0,0.0],"
+                "\"ctrlY\":[0.0,0.0,0.0,0.0,0.0,0.0,0.0],"
+                "\"ctrlZ\":[-2.0,-1.6667,-1.0,0.0,1.0,1.6667,2.0]},"
+                "\"residuePositions\":{"
+                "\"resId\":[1,2],\"s\":[" + s + ",1.0],\"rho\":[1.0,1.2],"
+                "\"phi\":[0.0,3.0],\"poreLining\":[1,0],\"poreFacing\":[1,0],"
+                "\"poreRadius\":[" + r + "," + r + "],"
+                "\"solventDensity\":[" + d + "," + d + "],"
+                "\"x\":[1.0,0.0],\"y\":[0.0,1.2],\"z\":[" + s + ",1.0]},"
+                "\"solventDensitySpline\":{"
+                "\"knots\":[-3.0,-1.0,0.0,1.0,3.0],"
+                "\"ctrl\":[0.0," + d + ",0.1," + d + ",0.0]},"
+                "\"plHydrophobicitySpline\":{"
+                "\"knots\":[-3.0,0.0,3.0],\"ctrl\":[0.0," + h + ",0.0]},"
+                "\"pfHydrophobicitySpline\":{"
+                "\"knots\":[-3.0,0.0,3.0],\"ctrl\":[0.0," + h + ",0.0]}}";
+
+            rapidjson::Document doc;
+            doc.Parse(json.c_str());
+            return doc;
+        }
+
+        /*!
+         * Auxiliary function that runs both aggregation passes over the
+         * given range of frames using the given support points.
+         */
+        void aggregate(
+                PathwayAggregator &agg,
+                int firstFrame,
+                int lastFrame,
+                const std::vector<real> &supportPoints,
+                real anchorPointLo,
+                real anchorPointHi)
+        {
+            for(int i = firstFrame; i <= lastFrame; i++)
+            {
+                rapidjson::Document doc = makeFrameDoc(i);
+                agg.addScalarFrame(doc);
+            }
+            agg.setSupportPoints(supportPoints, anchorPointLo, anchorPointHi);
+            for(int i = firstFrame; i <= lastFrame; i++)
+            {
+                rapidjson::Document doc = makeFrameDoc(i);
+                agg.addProfileFrame(doc);
+            }
+        }
+};
+
+
+/*!
+ * Checks that merging the aggregates of two disjoint sets of frames yields
+ * the same summary statistics as aggregating all frames at once (up to 
+ * floating point rounding). This includes the energy profile, whose shift 
+ * depends on the pooled anchor point energies.
+ */
+TEST_F(PathwayAggregatorTest, PathwayAggregatorMergeTest)
+{
+    // floating point tolerance:
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // aggregate all frames in first pass to obtain support points:
+    PathwayAggregator full;
+    for(int i = 0; i < 6; i++)
+    {
+        rapidjson::Document doc = makeFrameDoc(i);
+        full.addScalarFrame(doc);
+    }
+    full.supportPointsFromScalars(51, 0.5);
+    std::vector<real> supportPoints = full.supportPoints();
+    real anchorPointLo = full.scalarSummary("arcLengthLo").min();
+    real anchorPointHi = full.scalarSummary("arcLengthHi").max();
+    ASSERT_EQ(51, supportPoints.size());
+    ASSERT_NEAR(anchorPointLo - 0.5, supportPoints.front(), eps);
+    ASSERT_NEAR(anchorPointHi + 0.5, supportPoints.back(), eps);
+
+    // second pass over all frames:
+    for(int i = 0; i < 6; i++)
+    {
+        rapidjson::Document doc = makeFrameDoc(i);
+        full.addProfileFrame(doc);
+    }
+
+    // aggregate two disjoint subsets and merge them:
+    PathwayAggregator first;
+    PathwayAggregator second;
+    aggregate(first, 0, 1, supportPoints, anchorPointLo, anchorPointHi);
+    aggregate(second, 2, 5, supportPoints, anchorPointLo, anchorPointHi);
+    PathwayAggregator pooled;
+    pooled.merge(first);
+    pooled.merge(second);
+
+    // number of frames should agree:
+    ASSERT_EQ(full.numScalarFrames(), pooled.numScalarFrames());
+    ASSERT_EQ(full.numProfileFrames(), pooled.numProfileFrames());
+
+    // scalar summaries should agree:
+    for(auto name : {"minRadius", "volume", "numPath", "minSolventDensity"})
+    {
+        ASSERT_EQ(full.scalarSummary(name).num(),
+                  pooled.scalarSummary(name).num());
+        ASSERT_NEAR(full.scalarSummary(name).min(),
+                    pooled.scalarSummary(name).min(), eps);
+        ASSERT_NEAR(full.scalarSummary(name).max(),
+                    pooled.scalarSummary(name).max(), eps);
+        ASSERT_NEAR(full.scalarSummary(name).mean(),
+                    pooled.scalarSummary(name).mean(), eps);
+        ASSERT_NEAR(full.scalarSummary(name).var(),
+                    pooled.scalarSummary(name).var(), eps);
+    }
+
+    // profile summaries should agree:
+    for(auto name : {"radius", "density", "energy", "plHydrophobicity"})
+    {
+        std::vector<SummaryStatistics> fullProfile = full.profileSummary(name);
+        std::vector<SummaryStatistics> pooledProfile = pooled.profileSummary(name);
+        ASSERT_EQ(fullProfile.size(), pooledProfile.size());
+        for(size_t i = 0; i < fullProfile.size(); i++)
+        {
+            ASSERT_NEAR(fullProfile[i].mean(), pooledProfile[i].mean(), eps);
+            ASSERT_NEAR(fullProfile[i].sd(), pooledProfile[i].sd(), eps);
+        }
+    }
+
+    // residue summaries should agree:
+    for(auto name : {"s", "poreRadius", "solventDensity"})
+    {
+        const std::vector<SummaryStatistics> &fullRes = full.residueSummary(name);
+        const std::vector<SummaryStatistics> &pooledRes = pooled.residueSummary(name);
+        ASSERT_EQ(2, pooledRes.size());
+        for(size_t i = 0; i < fullRes.size(); i++)
+        {
+            ASSERT_NEAR(fullRes[i].mean(), pooledRes[i].mean(), eps);
+            ASSERT_NEAR(fullRes[i].var(), pooledRes[i].var(), eps);
+        }
+    }
+}
+
+
+/*!
+ * Checks that aggregates with different support points or different energy
+ * anchor points (as obtained from the pathway endpoints of each set of 
+ * frames) can not be merged.
+ */
+TEST_F(PathwayAggregatorTest, PathwayAggregatorMergeMismatchTest)
+{
+    PathwayAggregator first;
+    PathwayAggregator second;
+    aggregate(first, 0, 1, {-1.0, 0.0, 1.0}, -1.0, 1.0);
+    aggregate(second, 2, 3, {-2.0, 0.0, 2.0}, -2.0, 2.0);
+
+    ASSERT_THROW(first.merge(second), std::logic_error);
+
+    // same support points, but endpoint anchors differ between subsets:
+    std::vector<real> supportPoints = {-2.5, -1.0, 0.0, 1.0, 2.5};
+    PathwayAggregator third;
+    PathwayAggregator fourth;
+    aggregate(third, 0, 1, supportPoints, -1.5, 1.5);
+    aggregate(fourth, 2, 3, supportPoints, -2.0, 2.0);
+
+    ASSERT_THROW(third.merge(fourth), std::logic_error);
+}
+
+
+
+/*!
+ * Checks that an aggregator restored from its JSON state yields the same 
+ * summaries as the original one and can be merged with further aggregates.
+ */
+TEST_F(PathwayAggregatorTest, PathwayAggregatorStateTest)
+{
+    // floating point tolerance:
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // aggregate two disjoint subsets of frames:
+    std::vector<real> supportPoints = {-2.5, -1.0, 0.0, 1.0, 2.5};
+    PathwayAggregator first;
+    PathwayAggregator second;
+    aggregate(first, 0, 2, supportPoints, -2.0, 2.0);
+    aggregate(second, 3, 5, supportPoints, -2.0, 2.0);
+
+    // round trip through JSON state:
+    rapidjson::Document doc;
+    doc.SetObject();
+    rapidjson::Value state = first.stateToJson(doc.GetAllocator());
+    PathwayAggregator restored;
+    restored.stateFromJson(state);
+
+    // restored aggregate agrees with original:
+    ASSERT_EQ(first.numScalarFrames(), restored.numScalarFrames());
+    ASSERT_EQ(first.numProfileFrames(), restored.numProfileFrames());
+    ASSERT_EQ(first.poreResIds(), restored.poreResIds());
+    ASSERT_EQ(first.supportPoints().size(), restored.supportPoints().size());
+    for(auto name : {"minRadius", "volume", "minSolventDensity"})
+    {
+        ASSERT_NEAR(first.scalarSummary(name).mean(),
+                    restored.scalarSummary(name).mean(), eps);
+        ASSERT_NEAR(first.scalarSummary(name).var(),
+                    restored.scalarSummary(name).var(), eps);
+    }
+    for(auto name : {"radius", "density", "energy"})
+    {
+        std::vector<SummaryStatistics> a = first.profileSummary(name);
+        std::vector<SummaryStatistics> b = restored.profileSummary(name);
+        ASSERT_EQ(a.size(), b.size());
+        for(size_t i = 0; i < a.size(); i++)
+        {
+            ASSERT_NEAR(a[i].mean(), b[i].mean(), eps);
+            ASSERT_NEAR(a[i].sd(), b[i].sd(), eps);
+        }
+    }
+
+    // restored aggregate merges like the original:
+    PathwayAggregator pooledA;
+    pooledA.merge(first);
+    pooledA.merge(second);
+    PathwayAggregator pooledB;
+    pooledB.merge(restored);
+    pooledB.merge(second);
+    ASSERT_NEAR(pooledA.scalarSummary("volume").var(),
+                pooledB.scalarSummary("volume").var(), eps);
+    ASSERT_NEAR(pooledA.residueSummary("s").at(0).mean(),
+                pooledB.residueSummary("s").at(0).mean(), eps);
+
+    // malformed state:
+    rapidjson::Value empty(rapidjson::kObjectType);
+    PathwayAggregator broken;
+    ASSERT_THROW(broken.stateFromJson(empty), std::runtime_error);
+}
+
+
+/*!
+ * Checks that frames written without residue positions (i.e. at the lowest
+ * stream output level) still yield scalar and profile summaries, but no 
+ * residue summaries.
+ */
+TEST_F(PathwayAggregatorTest, PathwayAggregatorNoResiduesTest)
+{
+    // floating point tolerance:
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // aggregate frames with and without residue data:
+    std::vector<real> supportPoints = {-2.5, -1.0, 0.0, 1.0, 2.5};
+    PathwayAggregator withResidues;
+    aggregate(withResidues, 0, 3, supportPoints, -2.0, 2.0);
+    PathwayAggregator withoutResidues;
+    for(int i = 0; i <= 3; i++)
+    {
+        rapidjson::Document doc = makeFrameDoc(i);
+        doc.RemoveMember("residuePositions");
+        withoutResidues.addScalarFrame(doc);
+    }
+    withoutResidues.setSupportPoints(supportPoints, -2.0, 2.0);
+    for(int i = 0; i <= 3; i++)
+    {
+        rapidjson::Document doc = makeFrameDoc(i);
+        doc.RemoveMember("residuePositions");
+        withoutResidues.addProfileFrame(doc);
+    }
+
+    // no residues, but all frames were processed:
+    ASSERT_TRUE(withoutResidues.poreResIds().empty());
+    ASSERT_TRUE(withoutResidues.residueSummary("s").empty());
+    ASSERT_EQ(4, withoutResidues.numProfileFrames());
+
+    // profiles are unaffected by missing residue data:
+    for(auto name : {"radius", "density", "energy", "pfHydrophobicity"})
+    {
+        std::vector<real> expected = withResidues.meanProfile(name);
+        std::vector<real> actual = withoutResidues.meanProfile(name);
+        ASSERT_EQ(expected.size(), actual.size());
+        for(size_t i = 0; i < actual.size(); i++)
+        {
+            ASSERT_NEAR(expected[i], actual[i], eps);
+        }
+    }
+}
+
+
+/*!
+ * Checks that binned solvent positions in the frame stream are accumulated
+ * into occupancy maps, which are merged and saved with the aggregation state.
+ */
+TEST_F(PathwayAggregatorTest, PathwayAggregatorOccupancyTest)
+{
+    // add binned solvent positions to frame documents:
+    auto makeOccupancyDoc = [this](int frame)
+    {
+        rapidjson::Document doc = makeFrameDoc(frame);
+        rapidjson::Document::AllocatorType &alloc = doc.GetAllocator();
+        rapidjson::Value &pathSummary = doc["pathSummary"];
+        for(auto name : {"occupancyBinWidthS", "occupancyBinWidthRho", 
+                         "occupancyBinWidthPhi"})
+        {
+            rapidjson::Value width(rapidjson::kArrayType);
+            width.PushBack(0.5, alloc);
+            pathSummary.AddMember(rapidjson::StringRef(name), width, alloc);
+        }
+        for(auto name : {"sRhoOccupancy", "sPhiOccupancy"})
+        {
+            std::string col = std::string(name) == "sRhoOccupancy" ? 
+                    "binRho" : "binPhi";
+            rapidjson::Value binS(rapidjson::kArrayType);
+            rapidjson::Value binY(rapidjson::kArrayType);
+            rapidjson::Value count(rapidjson::kArrayType);
+            binS.PushBack(-1.0, alloc).PushBack(frame, alloc);
+            binY.PushBack(0.0, alloc).PushBack(1.0, alloc);
+            count.PushBack(2.0, alloc).PushBack(1.0, alloc);
+            rapidjson::Value dataSet(rapidjson::kObjectType);
+            dataSet.AddMember("binS", binS, alloc);
+            dataSet.AddMember(rapidjson::Value(col, alloc), binY, alloc);
+            dataSet.AddMember("count", count, alloc);
+            doc.AddMember(rapidjson::StringRef(name), dataSet, alloc);
+        }
+        return doc;
+    };
+
+    // aggregate two subsets of frames and merge them:
+    std::vector<real> supportPoints = {-2.5, -1.0, 0.0, 1.0, 2.5};
+    PathwayAggregator first;
+    PathwayAggregator second;
+    for(int i = 0; i <= 3; i++)
+    {
+        PathwayAggregator &agg = i < 2 ? first : second;
+        rapidjson::Document doc = makeOccupancyDoc(i);
+        agg.addScalarFrame(doc);
+    }
+    first.setSupportPoints(supportPoints, -2.0, 2.0);
+    second.setSupportPoints(supportPoints, -2.0, 2.0);
+    for(int i = 0; i <= 3; i++)
+    {
+        PathwayAggregator &agg = i < 2 ? first : second;
+        rapidjson::Document doc = makeOccupancyDoc(i);
+        agg.addProfileFrame(doc);
+    }
+    PathwayAggregator pooled;
+    pooled.merge(first);
+    pooled.merge(second);
+
+    // check accumulated counts:
+    for(auto name : {"sRho", "sPhi"})
+    {
+        const OccupancyMap &map = pooled.occupancyMap(name);
+        ASSERT_EQ(4, map.numFrames());
+        ASSERT_EQ(8, map.count(-1, 0));
+        ASSERT_EQ(1, map.count(0, 1));
+        ASSERT_EQ(1, map.count(3, 1));
+    }
+
+    // occupancy maps are part of aggregation state:
+    rapidjson::Document doc;
+    doc.SetObject();
+    rapidjson::Value state = pooled.stateToJson(doc.GetAllocator());
+    PathwayAggregator restored;
+    restored.stateFromJson(state);
+    ASSERT_EQ(
+            pooled.occupancyMap("sPhi").counts(),
+            restored.occupancyMap("sPhi").counts());
+
+    // frames without binned solvent positions yield no maps:
+    PathwayAggregator noMaps;
+    aggregate(noMaps, 0, 1, supportPoints, -2.0, 2.0);
+    ASSERT_THROW(noMaps.occupancyMap("sRho"), std::out_of_range);
+}
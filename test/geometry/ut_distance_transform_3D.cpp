@@ -0,0 +1,152 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "geometry/distance_transform_3D.hpp"
+
+
+/*!
+ * \brief Test fixture for DistanceTransform3D.
+ */
+class DistanceTransform3DTest : public ::testing::Test
+{
+    protected:
+
+        // brute force squared distance transform for comparison:
+        std::vector<real> bruteForce(
+                const std::vector<char> &isFeature,
+                int numX,
+                int numY,
+                int numZ)
+        {
+            std::vector<real> dist(isFeature.size(), 
+                                   std::numeric_limits<real>::infinity());
+            for(int k = 0; k < numZ; k++)
+            {
+                for(int j = 0; j < numY; j++)
+                {
+                    for(int i = 0; i < numX; i++)
+                    {
+                        int idx = i + numX*(j + numY*k);
+                        for(size_t f = 0; f < isFeature.size(); f++)
+                        {
+                            if( !isFeature[f] )
+                            {
+                                continue;
+                            }
+                            int fi = f % numX;
+                            int fj = (f/numX) % numY;
+                            int fk = f/(numX*numY);
+                            real d2 = (i - fi)*(i - fi) + (j - fj)*(j - fj)
+                                    + (k - fk)*(k - fk);
+                            dist[idx] = std::min(dist[idx], d2);
+                        }
+                    }
+                }
+            }
+            return dist;
+        }
+};
+
+
+/*!
+ * A single feature voxel must yield the squared distance to this voxel
+ * everywhere and a grid without feature voxels must yield infinite 
+ * distances.
+ */
+TEST_F(DistanceTransform3DTest, DistanceTransform3DSingleFeatureTest)
+{
+    int numX = 5;
+    int numY = 4;
+    int numZ = 6;
+    DistanceTransform3D edt(numX, numY, numZ);
+    ASSERT_EQ(numX*numY*numZ, edt.numVoxels());
+
+    // grid without features:
+    std::vector<char> isFeature(edt.numVoxels(), 0);
+    std::vector<real> dist = edt.squaredDistances(isFeature);
+    for(size_t i = 0; i < dist.size(); i++)
+    {
+        ASSERT_TRUE(std::isinf(dist[i]));
+    }
+
+    // single feature voxel:
+    int fi = 1, fj = 3, fk = 4;
+    isFeature[fi + numX*(fj + numY*fk)] = 1;
+    dist = edt.squaredDistances(isFeature);
+    for(int k = 0; k < numZ; k++)
+    {
+        for(int j = 0; j < numY; j++)
+        {
+            for(int i = 0; i < numX; i++)
+            {
+                real d2 = (i - fi)*(i - fi) + (j - fj)*(j - fj) 
+                        + (k - fk)*(k - fk);
+                ASSERT_FLOAT_EQ(d2, dist[i + numX*(j + numY*k)]);
+            }
+        }
+    }
+
+    // mask of wrong size is rejected:
+    std::vector<char> wrongSize(edt.numVoxels() + 1, 0);
+    ASSERT_THROW(edt.squaredDistances(wrongSize), std::logic_error);
+}
+
+
+/*!
+ * For random feature masks of varying density the transform must agree 
+ * exactly with a brute force computation.
+ */
+TEST_F(DistanceTransform3DTest, DistanceTransform3DRandomTest)
+{
+    int numX = 9;
+    int numY = 7;
+    int numZ = 8;
+    DistanceTransform3D edt(numX, numY, numZ);
+
+    std::mt19937 rng(1234);
+    std::vector<real> densities = {0.01, 0.1, 0.5};
+    for(auto density : densities)
+    {
+        std::bernoulli_distribution isFeatureDist(density);
+        std::vector<char> isFeature(edt.numVoxels());
+        for(size_t i = 0; i < isFeature.size(); i++)
+        {
+            isFeature[i] = isFeatureDist(rng);
+        }
+
+        std::vector<real> dist = edt.squaredDistances(isFeature);
+        std::vector<real> ref = bruteForce(isFeature, numX, numY, numZ);
+        for(size_t i = 0; i < dist.size(); i++)
+        {
+            ASSERT_EQ(ref[i], dist[i]);
+        }
+    }
+}
@@ -0,0 +1,184 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "geometry/power_diagram_2D.hpp"
+
+
+/*!
+ * \brief Test fixture for PowerDiagram2D.
+ */
+class PowerDiagram2DTest : public ::testing::Test
+{
+    protected:
+
+        typedef PowerDiagram2D::Point Point;
+
+        // area of a cell polygon:
+        real cellArea(const std::vector<PowerDiagram2D::CellVertex> &cell)
+        {
+            real area = 0.0;
+            for(size_t k = 0; k < cell.size(); k++)
+            {
+                const Point &a = cell[k].pos;
+                const Point &b = cell[(k + 1) % cell.size()].pos;
+                area += a[0]*b[1] - b[0]*a[1];
+            }
+            return 0.5*area;
+        }
+
+        // check if point is inside convex counterclockwise polygon:
+        bool inCell(
+                const std::vector<PowerDiagram2D::CellVertex> &cell,
+                const Point &x,
+                real tol)
+        {
+            for(size_t k = 0; k < cell.size(); k++)
+            {
+                const Point &a = cell[k].pos;
+                const Point &b = cell[(k + 1) % cell.size()].pos;
+                real cross = (b[0] - a[0])*(x[1] - a[1]) 
+                           - (b[1] - a[1])*(x[0] - a[0]);
+                if( cross < -tol )
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+};
+
+
+/*!
+ * Four sites of equal weight placed symmetrically about the origin must 
+ * divide a square into four quadrants that meet at the origin. The vertex at
+ * the origin must be generated by the two neighbouring sites.
+ */
+TEST_F(PowerDiagram2DTest, PowerDiagram2DQuadrantTest)
+{
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    std::vector<Point> sites = {{{1.0, 1.0}}, {{-1.0, 1.0}}, 
+                                {{-1.0, -1.0}}, {{1.0, -1.0}}};
+    std::vector<real> weights(sites.size(), 0.3);
+    PowerDiagram2D pd(sites, weights, {{-2.0, -2.0}}, {{2.0, 2.0}});
+
+    ASSERT_EQ(sites.size(), pd.numSites());
+    for(size_t i = 0; i < sites.size(); i++)
+    {
+        ASSERT_EQ(4, pd.cell(i).size());
+        ASSERT_NEAR(4.0, cellArea(pd.cell(i)), eps);
+        ASSERT_TRUE(inCell(pd.cell(i), sites[i], eps));
+
+        // find vertex at origin:
+        int numOrigin = 0;
+        for(auto &v : pd.cell(i))
+        {
+            if( std::abs(v.pos[0]) < eps && std::abs(v.pos[1]) < eps )
+            {
+                numOrigin++;
+                ASSERT_LE(0, v.prevGenerator);
+                ASSERT_LE(0, v.nextGenerator);
+                ASSERT_NE(static_cast<int>(i), v.prevGenerator);
+                ASSERT_NE(static_cast<int>(i), v.nextGenerator);
+            }
+        }
+        ASSERT_EQ(1, numOrigin);
+    }
+}
+
+
+/*!
+ * Weights shift the bisector between two sites: for sites at -1 and 1 on the
+ * x-axis with weights w0 and w1, the cell boundary lies at 
+ * x = (w0 - w1)/4.
+ */
+TEST_F(PowerDiagram2DTest, PowerDiagram2DWeightedBisectorTest)
+{
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    std::vector<Point> sites = {{{-1.0, 0.0}}, {{1.0, 0.0}}};
+    std::vector<real> weights = {0.8, 0.0};
+    PowerDiagram2D pd(sites, weights, {{-2.0, -1.0}}, {{2.0, 1.0}});
+
+    real boundary = (weights[0] - weights[1])/4.0;
+    ASSERT_NEAR(2.0*(boundary + 2.0), cellArea(pd.cell(0)), eps);
+    ASSERT_NEAR(2.0*(2.0 - boundary), cellArea(pd.cell(1)), eps);
+
+    // site with much larger weight hides the other one:
+    weights = {0.0, 20.0};
+    PowerDiagram2D pdHidden(sites, weights, {{-2.0, -1.0}}, {{2.0, 1.0}});
+    ASSERT_TRUE(pdHidden.cell(0).empty());
+    ASSERT_NEAR(8.0, cellArea(pdHidden.cell(1)), eps);
+}
+
+
+/*!
+ * For a random set of weighted sites, including sites outside the bounding 
+ * rectangle, the cells must tile the rectangle and each sample point must 
+ * lie in the cell of the site with respect to which it has minimal power.
+ */
+TEST_F(PowerDiagram2DTest, PowerDiagram2DRandomTest)
+{
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    std::mt19937 rng(15011992);
+    std::uniform_real_distribution<real> pos(-3.0, 3.0);
+    std::uniform_real_distribution<real> wgt(-0.5, 0.1);
+
+    std::vector<Point> sites;
+    std::vector<real> weights;
+    for(int i = 0; i < 500; i++)
+    {
+        sites.push_back({{pos(rng), pos(rng)}});
+        weights.push_back(wgt(rng));
+    }
+    Point lo = {{-2.0, -1.5}};
+    Point hi = {{1.5, 2.0}};
+    PowerDiagram2D pd(sites, weights, lo, hi);
+
+    // cells tile bounding rectangle:
+    real totalArea = 0.0;
+    for(size_t i = 0; i < pd.numSites(); i++)
+    {
+        totalArea += cellArea(pd.cell(i));
+    }
+    ASSERT_NEAR((hi[0] - lo[0])*(hi[1] - lo[1]), totalArea, 10*eps);
+
+    // sample points lie in cell of minimal power site:
+    std::uniform_real_distribution<real> sx(lo[0], hi[0]);
+    std::uniform_real_distribution<real> sy(lo[1], hi[1]);
+    for(int k = 0; k < 1000; k++)
+    {
+        Point x = {{sx(rng), sy(rng)}};
+        size_t idx = pd.locate(x);
+        ASSERT_TRUE(inCell(pd.cell(idx), x, eps));
+    }
+}
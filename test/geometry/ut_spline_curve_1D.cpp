@@ -22,9 +22,12 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <limits>
+#include <stdexcept>
+#include <utility>
 
 #include <gtest/gtest.h>
 
@@ -247,3 +250,218 @@ TEST_F(SplineCurve1DTest, SplineCurve1DExtrapolationTest)
                 eps); 
 }
 
+
+
+/*!
+ * Tests the analytic minimum and maximum of a cubic spline with non-uniformly
+ * spaced knots against a dense sample of spline values. Also checks that the
+ * extrema over an interval extending beyond the knot range are found inside
+ * the knot range.
+ */
+TEST_F(SplineCurve1DTest, SplineCurve1DExtremumTest)
+{
+    // cubic spline with non-uniform knots:
+    int degree = 3;
+    std::vector<real> uniqueKnots = {-1.0, -0.7, -0.1, 0.2, 0.9, 1.0, 2.5};
+    std::vector<real> knots = prepareKnotVector(uniqueKnots, degree);
+    std::vector<real> ctrlPoints = {1.0, -0.5, 2.0, 0.3, 1.7, -1.2, 0.4, 3.0,
+                                    0.8};
+    SplineCurve1D SplC(degree, knots, ctrlPoints);
+
+    // search intervals:
+    std::vector<std::pair<real, real>> limits = {
+            {-1.0, 2.5}, {-0.5, 0.5}, {0.0, 2.0}, {-3.0, 4.0}};
+
+    for(auto lim : limits)
+    {
+        // dense sample of spline values:
+        real lo = std::max(lim.first, uniqueKnots.front());
+        real hi = std::min(lim.second, uniqueKnots.back());
+        int numSamples = 20001;
+        real sampleMin = std::numeric_limits<real>::max();
+        real sampleMax = -std::numeric_limits<real>::max();
+        for(int i = 0; i < numSamples; i++)
+        {
+            real s = lo + i*(hi - lo)/(numSamples - 1);
+            real value = SplC.evaluate(s, 0);
+            sampleMin = std::min(sampleMin, value);
+            sampleMax = std::max(sampleMax, value);
+        }
+
+        // analytic extrema can not be worse than sampled extrema:
+        std::pair<real, real> min = SplC.minimum(lim);
+        std::pair<real, real> max = SplC.maximum(lim);
+        ASSERT_LE(min.second, sampleMin + 10*std::numeric_limits<real>::epsilon());
+        ASSERT_GE(max.second, sampleMax - 10*std::numeric_limits<real>::epsilon());
+        ASSERT_NEAR(sampleMin, min.second, 1e-5);
+        ASSERT_NEAR(sampleMax, max.second, 1e-5);
+
+        // location of extrema is consistent with values:
+        ASSERT_GE(min.first, lo);
+        ASSERT_LE(min.first, hi);
+        ASSERT_NEAR(min.second, SplC.evaluate(min.first, 0), 1e-5);
+        ASSERT_NEAR(max.second, SplC.evaluate(max.first, 0), 1e-5);
+    }
+
+    // interval entirely in the extrapolation region:
+    std::pair<real, real> min = SplC.minimum(std::make_pair(3.0, 4.0));
+    ASSERT_NEAR(ctrlPoints.back(), min.second, 1e-5);
+}
+
+
+/*!
+ * Tests the exact integration of the squared spline on simple Bezier curves
+ * for which the integral is known analytically and on a non-uniform spline
+ * against a fine Simpson's rule quadrature.
+ */
+TEST_F(SplineCurve1DTest, SplineCurve1DIntegrateSquaredTest)
+{
+    real eps = std::numeric_limits<real>::epsilon();
+
+    // single cubic Bezier segment on unit interval:
+    int degree = 3;
+    std::vector<real> knots = prepareKnotVector({0.0, 1.0}, degree);
+
+    // constant function, including constant extrapolation:
+    SplineCurve1D constSpl(degree, knots, {2.0, 2.0, 2.0, 2.0});
+    ASSERT_NEAR(4.0, constSpl.integrateSquared(std::make_pair(0.0, 1.0)),
+                10*eps);
+    ASSERT_NEAR(12.0, constSpl.integrateSquared(std::make_pair(-1.0, 2.0)),
+                10*eps);
+
+    // identity function:
+    SplineCurve1D linSpl(degree, knots, {0.0, 1.0/3.0, 2.0/3.0, 1.0});
+    ASSERT_NEAR(1.0/3.0, linSpl.integrateSquared(std::make_pair(0.0, 1.0)),
+                10*eps);
+    ASSERT_NEAR(0.5*0.5*0.5/3.0, 
+                linSpl.integrateSquared(std::make_pair(0.0, 0.5)),
+                10*eps);
+
+    // non-uniform cubic spline:
+    std::vector<real> uniqueKnots = {-1.0, -0.7, -0.1, 0.2, 0.9, 1.0, 2.5};
+    SplineCurve1D SplC(
+            degree, 
+            prepareKnotVector(uniqueKnots, degree),
+            {1.0, -0.5, 2.0, 0.3, 1.7, -1.2, 0.4, 3.0, 0.8});
+
+    // Simpson's rule reference:
+    std::pair<real, real> lim(-0.8, 2.0);
+    int numIntervals = 20000;
+    real h = (lim.second - lim.first)/numIntervals;
+    real reference = 0.0;
+    for(int i = 0; i <= numIntervals; i++)
+    {
+        real value = SplC.evaluate(lim.first + i*h, 0);
+        real weight = (i == 0 || i == numIntervals) ? 1.0 : (i % 2 ? 4.0 : 2.0);
+        reference += weight*value*value;
+    }
+    reference *= h/3.0;
+    ASSERT_NEAR(reference, SplC.integrateSquared(lim), 1e-5);
+}
+
+
+/*!
+ * Tests that all level crossings of a non-uniform cubic spline are found by
+ * comparing their number to the number of sign changes in a dense sample.
+ */
+TEST_F(SplineCurve1DTest, SplineCurve1DRootsTest)
+{
+    int degree = 3;
+    std::vector<real> uniqueKnots = {-1.0, -0.7, -0.1, 0.2, 0.9, 1.0, 2.5};
+    SplineCurve1D SplC(
+            degree, 
+            prepareKnotVector(uniqueKnots, degree),
+            {1.0, -0.5, 2.0, 0.3, 1.7, -1.2, 0.4, 3.0, 0.8});
+
+    std::pair<real, real> lim(-2.0, 3.0);
+    std::vector<real> levels = {0.0, 0.5, 1.5};
+    for(auto level : levels)
+    {
+        std::vector<real> roots = SplC.roots(lim, level);
+
+        // count sign changes in dense sample:
+        int numSamples = 20001;
+        int numSignChanges = 0;
+        real prev = SplC.evaluate(uniqueKnots.front(), 0) - level;
+        for(int i = 1; i < numSamples; i++)
+        {
+            real s = uniqueKnots.front() 
+                   + i*(uniqueKnots.back() - uniqueKnots.front())/(numSamples - 1);
+            real value = SplC.evaluate(s, 0) - level;
+            if( value*prev < 0.0 )
+            {
+                numSignChanges++;
+            }
+            prev = value;
+        }
+        ASSERT_EQ(numSignChanges, roots.size());
+
+        // roots are ascending and spline takes on level there:
+        for(size_t i = 0; i < roots.size(); i++)
+        {
+            ASSERT_NEAR(level, SplC.evaluate(roots[i], 0), 1e-5);
+            if( i > 0 )
+            {
+                ASSERT_LT(roots[i - 1], roots[i]);
+            }
+        }
+    }
+}
+
+
+/*!
+ * Checks that sorted batch evaluation agrees with pointwise evaluation for a
+ * non-uniform cubic spline, including points on the knots and in the 
+ * extrapolation range on either side, and that evaluateMultiple() returns the
+ * same result for sorted and unsorted evaluation points.
+ */
+TEST_F(SplineCurve1DTest, SplineCurve1DSortedEvaluationTest)
+{
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    int degree = 3;
+    std::vector<real> uniqueKnots = {-1.0, -0.7, -0.1, 0.2, 0.9, 1.0, 2.5};
+    SplineCurve1D SplC(
+            degree, 
+            prepareKnotVector(uniqueKnots, degree),
+            {1.0, -0.5, 2.0, 0.3, 1.7, -1.2, 0.4, 3.0, 0.8});
+
+    // sorted evaluation points including knots and extrapolation range:
+    std::vector<real> eval = {-2.0, -1.0, -1.0};
+    for(int i = 1; i < 100; i++)
+    {
+        eval.push_back(-1.0 + i*3.5/100);
+    }
+    eval.insert(eval.end(), uniqueKnots.begin(), uniqueKnots.end());
+    eval.push_back(3.0);
+    std::sort(eval.begin(), eval.end());
+
+    // compare to pointwise evaluation:
+    unsigned int maxDeriv = 4;
+    std::vector<std::vector<real>> values;
+    SplC.evaluateSorted(eval, maxDeriv, values);
+    ASSERT_EQ(maxDeriv + 1, values.size());
+    for(unsigned int k = 0; k <= maxDeriv; k++)
+    {
+        ASSERT_EQ(eval.size(), values[k].size());
+        for(size_t i = 0; i < eval.size(); i++)
+        {
+            real ref = SplC.evaluate(eval[i], k);
+            ASSERT_NEAR(ref, values[k][i], eps*std::max<real>(1.0, std::abs(ref)));
+        }
+    }
+
+    // unsorted points use pointwise evaluation:
+    std::vector<real> reversed(eval.rbegin(), eval.rend());
+    std::vector<real> sortedValues = SplC.evaluateMultiple(eval, 1);
+    std::vector<real> reversedValues = SplC.evaluateMultiple(reversed, 1);
+    for(size_t i = 0; i < eval.size(); i++)
+    {
+        ASSERT_NEAR(sortedValues[i], 
+                    reversedValues[eval.size() - 1 - i], 
+                    eps*std::max<real>(1.0, std::abs(sortedValues[i])));
+    }
+
+    // batch evaluation rejects unsorted points:
+    ASSERT_THROW(SplC.evaluateSorted(reversed, 0, values), std::logic_error);
+}
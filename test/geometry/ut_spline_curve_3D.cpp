@@ -22,6 +22,7 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <limits>
@@ -719,3 +720,115 @@ TEST_F(SplineCurve3DTest, CartesianToCurvilinearExternalTest)
     }   
 }
 
+
+
+/*!
+ * Test for the angular coordinate returned by cartesianToCurvilinear(). For a
+ * straight curve along the z-axis, the angle is measured from the x-axis in 
+ * counterclockwise direction. This also holds in the extrapolation range. If
+ * the angle is not requested, it is zero.
+ */
+TEST_F(SplineCurve3DTest, CartesianToCurvilinearAngularTest)
+{
+    // floating point comparison threshold:
+    real eps = 1.1*std::sqrt(std::numeric_limits<real>::epsilon());
+    const real PI = std::acos(-1.0);
+
+    // linear spline along z-axis:
+    int degree = 1;
+    std::vector<real> knots = {-2.0, -2.0, -1.0, 0.0, 1.0, 2.0, 2.0};
+    std::vector<gmx::RVec> ctrlPoints = {gmx::RVec(0.0, 0.0, -2.0),
+                                         gmx::RVec(0.0, 0.0, -1.0),
+                                         gmx::RVec(0.0, 0.0,  0.0),
+                                         gmx::RVec(0.0, 0.0,  1.0),
+                                         gmx::RVec(0.0, 0.0,  2.0)};
+    SplineCurve3D spl(degree, knots, ctrlPoints);
+
+    // test points around curve and expected angles:
+    std::vector<gmx::RVec> pts = {gmx::RVec( 1.0,  0.0,  0.5),
+                                  gmx::RVec( 0.0,  2.0, -1.5),
+                                  gmx::RVec(-1.0, -1.0,  0.0),
+                                  gmx::RVec( 0.0, -1.0,  5.0),
+                                  gmx::RVec(-1.0,  0.0,  1.0),
+                                  gmx::RVec( 0.0,  0.0,  1.0)};
+    std::vector<real> phiTrue = {0.0, 
+                                 0.5*PI,
+                                 -0.75*PI,
+                                 -0.5*PI,
+                                 -PI,
+                                 0.0};
+
+    // check angular coordinates:
+    for(size_t i = 0; i < pts.size(); i++)
+    {
+        gmx::RVec curvi = spl.cartesianToCurvilinear(pts.at(i), true);
+        ASSERT_NEAR(phiTrue.at(i), curvi[PP], eps);
+        ASSERT_LE(-PI, curvi[PP]);
+        ASSERT_GT(PI, curvi[PP]);
+
+        gmx::RVec curviNoAngle = spl.cartesianToCurvilinear(pts.at(i));
+        ASSERT_NEAR(curvi[SS], curviNoAngle[SS], eps);
+        ASSERT_NEAR(curvi[RR], curviNoAngle[RR], eps);
+        ASSERT_EQ(0.0, curviNoAngle[PP]);
+    }
+}
+
+
+/*!
+ * Checks that sorted batch evaluation agrees with pointwise evaluation for a
+ * cubic curve with non-uniform knots, including points on the knots and in
+ * the linear extrapolation range on either side.
+ */
+TEST_F(SplineCurve3DTest, SplineCurve3DSortedEvaluationTest)
+{
+    real eps = std::sqrt(std::numeric_limits<real>::epsilon());
+
+    // cubic spline with clamped, non-uniform knots:
+    int degree = 3;
+    std::vector<real> knots = {0.0, 0.0, 0.0, 0.0, 0.3, 1.1, 1.5, 2.0, 2.0, 
+                               2.0, 2.0};
+    std::vector<gmx::RVec> ctrlPoints = {gmx::RVec( 0.0,  0.0, 0.0),
+                                         gmx::RVec( 1.0,  0.5, 0.2),
+                                         gmx::RVec( 0.5,  2.0, 0.7),
+                                         gmx::RVec(-1.0,  1.0, 1.3),
+                                         gmx::RVec(-0.5, -1.0, 1.9),
+                                         gmx::RVec( 0.3, -0.2, 2.4),
+                                         gmx::RVec( 1.2,  0.4, 3.0)};
+    SplineCurve3D spl(degree, knots, ctrlPoints);
+
+    // sorted evaluation points:
+    std::vector<real> eval = {-1.0, 0.0, 0.3, 1.1, 1.5, 2.0, 2.5};
+    for(int i = 0; i < 50; i++)
+    {
+        eval.push_back(i*2.0/50);
+    }
+    std::sort(eval.begin(), eval.end());
+
+    // compare to pointwise evaluation:
+    unsigned int maxDeriv = 3;
+    std::vector<std::vector<gmx::RVec>> values;
+    spl.evaluateSorted(eval, maxDeriv, values);
+    for(unsigned int k = 0; k <= maxDeriv; k++)
+    {
+        for(size_t i = 0; i < eval.size(); i++)
+        {
+            gmx::RVec ref = spl.evaluate(eval[i], k);
+            for(int d = 0; d < DIM; d++)
+            {
+                ASSERT_NEAR(ref[d], 
+                            values[k][i][d], 
+                            eps*std::max<real>(1.0, std::abs(ref[d])));
+            }
+        }
+    }
+
+    // evaluateMultiple delegates to batch evaluation:
+    std::vector<gmx::RVec> tangents = spl.evaluateMultiple(eval, 1);
+    for(size_t i = 0; i < eval.size(); i++)
+    {
+        for(int d = 0; d < DIM; d++)
+        {
+            ASSERT_NEAR(values[1][i][d], tangents[i][d], eps);
+        }
+    }
+}
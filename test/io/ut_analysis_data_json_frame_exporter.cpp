@@ -0,0 +1,210 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gromacs/analysisdata/analysisdata.h>
+#include <gromacs/analysisdata/paralleloptions.h>
+
+#include "io/analysis_data_json_frame_exporter.hpp"
+
+
+/*!
+ * \brief Test fixture for the AnalysisDataJsonFrameExporter.
+ */
+class AnalysisDataJsonFrameExporterTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Auxiliary function that passes the given number of frames through
+         * the given exporter. Frames before the first frame are finished 
+         * without data (as is done for frames skipped when resuming) and 
+         * are hence not written.
+         */
+        void exportFrames(
+                AnalysisDataJsonFrameExporterPointer exporter,
+                int firstFrame,
+                int numFrames)
+        {
+            gmx::AnalysisData data;
+            data.setDataSetCount(1);
+            data.setColumnCount(0, 2);
+            data.setMultipoint(true);
+
+            exporter -> setDataSetNames({"values"});
+            exporter -> setColumnNames({{"x", "y"}});
+            exporter -> setFileName(fileName_);
+            data.addModule(exporter);
+
+            gmx::AnalysisDataHandle dh = data.startData(
+                    gmx::AnalysisDataParallelOptions());
+            for(int i = 0; i < firstFrame + numFrames; i++)
+            {
+                dh.startFrame(i, 0.5*i);
+                if( i >= firstFrame )
+                {
+                    dh.selectDataSet(0);
+                    dh.setPoint(0, i);
+                    dh.setPoint(1, 2.0*i);
+                    dh.finishPointSet();
+                }
+                dh.finishFrame();
+            }
+            dh.finishData();
+        }
+
+        /*!
+         * Auxiliary function that returns the entire content of the output
+         * file.
+         */
+        std::string readFile()
+        {
+            std::ifstream file(fileName_.c_str(), std::ifstream::binary);
+            return std::string(std::istreambuf_iterator<char>(file),
+                               std::istreambuf_iterator<char>());
+        }
+
+        /*!
+         * Auxiliary function that appends raw text to the output file.
+         */
+        void appendToFile(const std::string &text)
+        {
+            std::ofstream file(fileName_.c_str(), std::ofstream::app);
+            file<<text;
+        }
+
+        /*!
+         * Removes output file after each test.
+         */
+        virtual void TearDown()
+        {
+            std::remove(fileName_.c_str());
+        }
+
+        std::string fileName_ = "test_analysis_data_json_frame_exporter.json";
+};
+
+
+/*!
+ * Checks that frames written after resuming with a line count follow the 
+ * retained frames, so that the file is identical to that of an uninterrupted
+ * run, and that lines beyond the line count are discarded.
+ */
+TEST_F(AnalysisDataJsonFrameExporterTest, 
+       AnalysisDataJsonFrameExporterResumeLineCountTest)
+{
+    // reference file from uninterrupted run:
+    exportFrames(std::make_shared<AnalysisDataJsonFrameExporter>(), 0, 5);
+    std::string reference = readFile();
+
+    // interrupted run with partially written frame after checkpoint:
+    exportFrames(std::make_shared<AnalysisDataJsonFrameExporter>(), 0, 3);
+    appendToFile("{\"i\":3,\"t\":1.5,\"val");
+
+    // resume after two frames:
+    auto exporter = std::make_shared<AnalysisDataJsonFrameExporter>();
+    exporter -> setResumeLineCount(2);
+    exportFrames(exporter, 2, 3);
+    ASSERT_EQ(reference, readFile());
+    ASSERT_EQ(reference.size(), exporter -> fileSize());
+}
+
+
+/*!
+ * Checks that resuming is refused if the file is shorter than recorded, 
+ * including the case where the last retained line is incomplete.
+ */
+TEST_F(AnalysisDataJsonFrameExporterTest, 
+       AnalysisDataJsonFrameExporterShortFileTest)
+{
+    // file with two complete frames:
+    exportFrames(std::make_shared<AnalysisDataJsonFrameExporter>(), 0, 2);
+    uint64_t fileSize = readFile().size();
+
+    // too few lines:
+    auto exporter = std::make_shared<AnalysisDataJsonFrameExporter>();
+    exporter -> setResumeLineCount(3);
+    ASSERT_THROW(exportFrames(exporter, 3, 1), std::runtime_error);
+
+    // too few bytes:
+    exporter = std::make_shared<AnalysisDataJsonFrameExporter>();
+    exporter -> setResumeLineCount(3);
+    exporter -> setResumeByteOffset(fileSize + 10);
+    ASSERT_THROW(exportFrames(exporter, 3, 1), std::runtime_error);
+
+    // byte offset not at the end of a line:
+    exporter = std::make_shared<AnalysisDataJsonFrameExporter>();
+    exporter -> setResumeLineCount(2);
+    exporter -> setResumeByteOffset(fileSize - 1);
+    ASSERT_THROW(exportFrames(exporter, 2, 1), std::runtime_error);
+
+    // third line is incomplete:
+    appendToFile("{\"i\":2");
+    exporter = std::make_shared<AnalysisDataJsonFrameExporter>();
+    exporter -> setResumeLineCount(3);
+    ASSERT_THROW(exportFrames(exporter, 3, 1), std::runtime_error);
+
+    // file has not been modified by failed attempts:
+    ASSERT_EQ(fileSize + 6, readFile().size());
+}
+
+
+/*!
+ * Checks that the file size reported at a checkpoint can be used as byte 
+ * offset to resume, and that the result is identical to an uninterrupted run.
+ */
+TEST_F(AnalysisDataJsonFrameExporterTest, 
+       AnalysisDataJsonFrameExporterCheckpointRoundTripTest)
+{
+    // reference file from uninterrupted run:
+    exportFrames(std::make_shared<AnalysisDataJsonFrameExporter>(), 0, 6);
+    std::string reference = readFile();
+
+    // run up to checkpoint and record file size:
+    auto exporter = std::make_shared<AnalysisDataJsonFrameExporter>();
+    exportFrames(exporter, 0, 4);
+    uint64_t numBytes = exporter -> fileSize();
+    ASSERT_EQ(readFile().size(), numBytes);
+
+    // frames written after checkpoint are lost:
+    appendToFile("{\"i\":4}\n{\"i\":5,");
+
+    // resume from checkpoint:
+    exporter = std::make_shared<AnalysisDataJsonFrameExporter>();
+    exporter -> setResumeLineCount(4);
+    exporter -> setResumeByteOffset(numBytes);
+    exportFrames(exporter, 4, 2);
+    ASSERT_EQ(reference, readFile());
+    ASSERT_EQ(reference.size(), exporter -> fileSize());
+}
+
@@ -0,0 +1,140 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "io/buffered_text_writer.hpp"
+
+
+/*!
+ * \brief Test fixture for the BufferedTextWriter.
+ */
+class BufferedTextWriterTest : public ::testing::Test
+{
+    public:
+
+};
+
+
+/*!
+ * Checks that floating point formatting agrees with the %g conversion of 
+ * printf for a range of magnitudes, rounding edge cases and precisions.
+ */
+TEST_F(BufferedTextWriterTest, BufferedTextWriterFormatFloatTest)
+{
+    std::vector<double> values = {0.0, -0.0, 1.0, -1.0, 10.0, 0.1, 0.5, 
+                                  123456.0, 1234567.0, 999999.5, 9999995.0, 
+                                  0.0001, 0.00009999995, 1e-5, 2.5e-7, 
+                                  326091.625, 663522.5, -3.75, 1e100, 
+                                  -1.234e-100, 1e300, 1e-300, 0.3f, 1.1f};
+
+    for(int precision : {3, 6, 8})
+    {
+        for(auto value : values)
+        {
+            char buf[64];
+            std::snprintf(buf, sizeof(buf), "%.*g", precision, value);
+            std::string str;
+            BufferedTextWriter::formatFloat(value, precision, str);
+            ASSERT_EQ(std::string(buf), str);
+        }
+    }
+}
+
+
+/*!
+ * Checks that values close to a rounding tie are rounded like printf, i.e. 
+ * according to their exact binary value rather than the rounded result of 
+ * scaling them by a power of ten (e.g. 0.15 is slightly less than 0.15 and 
+ * must be rounded down to one significant digit, whereas 2.5e-5 is slightly 
+ * more and must be rounded up).
+ */
+TEST_F(BufferedTextWriterTest, BufferedTextWriterFormatFloatTieTest)
+{
+    // explicit cases:
+    std::vector<std::pair<double, std::string>> cases = {
+            {0.15, "0.1"}, {0.35, "0.3"}, {2.5e-5, "3e-05"}, {0.25, "0.2"},
+            {0.5, "0.5"}, {2.5, "2"}, {3.5, "4"}, {-0.15, "-0.1"}};
+    for(auto c : cases)
+    {
+        std::string str;
+        BufferedTextWriter::formatFloat(c.first, 1, str);
+        ASSERT_EQ(c.second, str);
+    }
+
+    // decimal ties at all precisions and a range of magnitudes:
+    for(int precision = 1; precision <= 15; precision++)
+    {
+        for(int exponent = -12; exponent <= 12; exponent++)
+        {
+            for(int i = 1; i < 100; i++)
+            {
+                double value = (i + 0.5)*std::pow(10.0, exponent);
+                for(double v : {value, static_cast<double>(
+                                       static_cast<float>(value))})
+                {
+                    char buf[64];
+                    std::snprintf(buf, sizeof(buf), "%.*g", precision, v);
+                    std::string str;
+                    BufferedTextWriter::formatFloat(v, precision, str);
+                    ASSERT_EQ(std::string(buf), str);
+                }
+            }
+        }
+    }
+}
+
+
+/*!
+ * Writes mixed output with a buffer smaller than the output and checks that
+ * the file contains everything in the right order.
+ */
+TEST_F(BufferedTextWriterTest, BufferedTextWriterFileTest)
+{
+    // write to file with tiny buffer:
+    std::string fileName = "test_buffered_text_writer.txt";
+    BufferedTextWriter writer(8);
+    writer.open(fileName);
+    writer<<"v "<<1.5f<<" "<<-2<<" "<<static_cast<size_t>(42)<<'\n';
+    writer<<std::string("f ")<<1<<"//"<<3<<" "<<0.000125<<'\n';
+    writer.close();
+
+    // read back file contents:
+    std::ifstream file(fileName.c_str());
+    std::stringstream contents;
+    contents<<file.rdbuf();
+    ASSERT_EQ("v 1.5 -2 42\nf 1//3 0.000125\n", contents.str());
+
+    // clean up:
+    file.close();
+    std::remove(fileName.c_str());
+}
+
@@ -0,0 +1,140 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "io/json_doc_importer.hpp"
+
+
+/*!
+ * \brief Test fixture for the JSON document importers.
+ */
+class JsonDocImporterTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Writes a small nested JSON document to a temporary file.
+         */
+        JsonDocImporterTest()
+            : fileName_("test_json_doc_importer.json")
+        {
+            std::ofstream file(fileName_);
+            file<<"{\"pathwaySummary\": {\"length\": [1.5, 2.5],"
+                <<" \"name\": \"pore\"},"
+                <<" \"pathwayProfile\": {\"s\": [0.0, 0.1, 0.2],"
+                <<" \"radius\": {\"mean\": [0.3, 0.4, 0.5]}},"
+                <<" \"empty\": null,"
+                <<" \"reproducibility\": {\"version\": 42}}";
+        }
+
+        /*!
+         * Removes temporary file.
+         */
+        ~JsonDocImporterTest()
+        {
+            std::remove(fileName_.c_str());
+        }
+
+    protected:
+
+        std::string fileName_;
+};
+
+
+/*!
+ * Checks that the conventional importer parses the entire document.
+ */
+TEST_F(JsonDocImporterTest, JsonDocImporterFullDocumentTest)
+{
+    JsonDocImporter jdi;
+    rapidjson::Document doc = jdi(fileName_);
+
+    ASSERT_TRUE(doc.IsObject());
+    ASSERT_TRUE(doc.HasMember("pathwayProfile"));
+    ASSERT_EQ(3, doc["pathwayProfile"]["s"].Size());
+    ASSERT_STREQ("pore", doc["pathwaySummary"]["name"].GetString());
+    ASSERT_EQ(42, doc["reproducibility"]["version"].GetInt());
+}
+
+
+/*!
+ * Checks that the in-situ parsed document matches the conventional one and
+ * that nonexistent files are reported.
+ */
+TEST_F(JsonDocImporterTest, InsituJsonDocumentTest)
+{
+    InsituJsonDocument insitu(fileName_);
+    rapidjson::Document &doc = insitu.doc();
+
+    ASSERT_TRUE(doc.IsObject());
+    ASSERT_STREQ("pore", doc["pathwaySummary"]["name"].GetString());
+    ASSERT_DOUBLE_EQ(2.5, doc["pathwaySummary"]["length"][1].GetDouble());
+    ASSERT_DOUBLE_EQ(
+            0.4, doc["pathwayProfile"]["radius"]["mean"][1].GetDouble());
+    ASSERT_TRUE(doc["empty"].IsNull());
+
+    ASSERT_THROW(InsituJsonDocument("nonexistent_file.json"),
+                 std::runtime_error);
+}
+
+
+/*!
+ * Checks that individual members can be extracted lazily by their path.
+ */
+TEST_F(JsonDocImporterTest, JsonDocImporterMemberTest)
+{
+    JsonDocImporter jdi;
+
+    // nested array:
+    rapidjson::Document radius = jdi.member(
+            fileName_, "pathwayProfile/radius/mean");
+    ASSERT_TRUE(radius.IsArray());
+    ASSERT_EQ(3, radius.Size());
+    ASSERT_DOUBLE_EQ(0.5, radius[2].GetDouble());
+
+    // nested object:
+    rapidjson::Document summary = jdi.member(fileName_, "pathwaySummary");
+    ASSERT_TRUE(summary.IsObject());
+    ASSERT_STREQ("pore", summary["name"].GetString());
+    ASSERT_EQ(2, summary["length"].Size());
+
+    // scalars, including null:
+    ASSERT_EQ(42, jdi.member(fileName_, "reproducibility/version").GetInt());
+    ASSERT_TRUE(jdi.member(fileName_, "empty").IsNull());
+
+    // the empty path yields the entire document:
+    ASSERT_TRUE(jdi.member(fileName_, "").HasMember("pathwayProfile"));
+
+    // nonexistent members are reported:
+    ASSERT_THROW(jdi.member(fileName_, "pathwayProfile/density"),
+                 std::runtime_error);
+    ASSERT_THROW(jdi.member(fileName_, "pathwaySummary/name/mean"),
+                 std::runtime_error);
+}
+
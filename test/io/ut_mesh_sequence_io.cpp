@@ -0,0 +1,209 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "io/mesh_sequence_io.hpp"
+
+
+/*!
+ * \brief Test fixture for the MeshSequenceExporter.
+ */
+class MeshSequenceIoTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Auxiliary function that creates a mesh of two rings of three 
+         * vertices each, displaced by the given offset along the z-axis, 
+         * with one scalar property that is constant on each ring.
+         */
+        PlyMesh makeTube(real offset)
+        {
+            PlyMesh mesh;
+            mesh.addVertices({gmx::RVec(1.0, 0.0, offset),
+                              gmx::RVec(0.0, 1.0, offset),
+                              gmx::RVec(-1.0, 0.0, offset),
+                              gmx::RVec(1.0, 0.0, offset + 1.0),
+                              gmx::RVec(0.0, 1.0, offset + 1.0),
+                              gmx::RVec(-1.0, 0.0, offset + 1.0)});
+            mesh.addVertexProperty("radius", 
+                                   {0.5, 0.5, 0.5, 
+                                    offset, offset, offset});
+            mesh.addFace({0, 4, 3});
+            mesh.addFace({0, 1, 4});
+            return mesh;
+        }
+
+        /*!
+         * Auxiliary function for reading a value of given type from a binary
+         * file (assumes a little endian host).
+         */
+        template<typename T>
+        T read(std::ifstream &file)
+        {
+            T value;
+            file.read(reinterpret_cast<char*>(&value), sizeof(T));
+            return value;
+        }
+};
+
+
+/*!
+ * Writes a sequence of quantised frames and checks that the header is 
+ * written only once, that frames are delta encoded where possible, and that
+ * the coordinates can be reconstructed up to the quantisation step.
+ */
+TEST_F(MeshSequenceIoTest, MeshSequenceExporterQuantisedTest)
+{
+    // write three frames, the last with a displacement too large for delta:
+    std::string fileName = "test_mesh_sequence_io.bin";
+    real step = 0.01;
+    MeshSequenceExporter exporter(3, step);
+    exporter.open(fileName);
+    exporter.addFrame(0.0, makeTube(0.0));
+    exporter.addFrame(1.0, makeTube(0.123));
+    exporter.addFrame(2.0, makeTube(1000.0));
+    exporter.close();
+    ASSERT_EQ(3, exporter.numFrames());
+
+    // read and check header:
+    std::ifstream file(fileName.c_str(), std::ifstream::binary);
+    char magic[8];
+    file.read(magic, 8);
+    ASSERT_EQ("CHAPMSEQ", std::string(magic, 8));
+    ASSERT_EQ(1, read<uint32_t>(file));
+    ASSERT_EQ(3, read<uint32_t>(file));
+    ASSERT_EQ(6, read<uint32_t>(file));
+    ASSERT_EQ(3, read<uint32_t>(file));
+    ASSERT_FLOAT_EQ(step, read<float>(file));
+    ASSERT_EQ(1, read<uint32_t>(file));
+    uint32_t nameLength = read<uint32_t>(file);
+    std::string name(nameLength, ' ');
+    file.read(&name[0], nameLength);
+    ASSERT_EQ("radius", name);
+    ASSERT_EQ(2, read<uint32_t>(file));
+    for(int i = 0; i < 6; i++)
+    {
+        read<int32_t>(file);
+    }
+
+    // first frame is key frame:
+    ASSERT_EQ(eMeshFrameKey, read<uint8_t>(file));
+    ASSERT_FLOAT_EQ(0.0, read<float>(file));
+    std::vector<int32_t> quant(18);
+    for(auto &q : quant)
+    {
+        q = read<int32_t>(file);
+    }
+    ASSERT_EQ(100, quant[0]);
+    ASSERT_EQ(100, quant[17]);
+    ASSERT_FLOAT_EQ(0.5, read<float>(file));
+    ASSERT_FLOAT_EQ(0.0, read<float>(file));
+
+    // second frame is delta frame:
+    ASSERT_EQ(eMeshFrameDelta, read<uint8_t>(file));
+    ASSERT_FLOAT_EQ(1.0, read<float>(file));
+    for(auto &q : quant)
+    {
+        q += read<int16_t>(file);
+    }
+    ASSERT_NEAR(1.123, quant[17]*step, step/2.0);
+    ASSERT_NEAR(0.123, quant[2]*step, step/2.0);
+    ASSERT_FLOAT_EQ(0.5, read<float>(file));
+    ASSERT_FLOAT_EQ(0.123, read<float>(file));
+
+    // third frame falls back to key frame:
+    ASSERT_EQ(eMeshFrameKey, read<uint8_t>(file));
+    ASSERT_FLOAT_EQ(2.0, read<float>(file));
+    for(auto &q : quant)
+    {
+        q = read<int32_t>(file);
+    }
+    ASSERT_NEAR(1001.0, quant[17]*step, step/2.0);
+    read<float>(file);
+    read<float>(file);
+
+    // no trailing data:
+    ASSERT_TRUE(file.good());
+    file.peek();
+    ASSERT_TRUE(file.eof());
+
+    // clean up:
+    file.close();
+    std::remove(fileName.c_str());
+}
+
+
+/*!
+ * Checks that frames are stored as floats if quantisation is disabled and 
+ * that meshes with a topology differing from the first frame are rejected.
+ */
+TEST_F(MeshSequenceIoTest, MeshSequenceExporterFloatTest)
+{
+    // write one frame without quantisation:
+    std::string fileName = "test_mesh_sequence_io_float.bin";
+    MeshSequenceExporter exporter(3, 0.0);
+    exporter.open(fileName);
+    exporter.addFrame(0.5, makeTube(0.25));
+
+    // mesh with different number of vertices:
+    PlyMesh badMesh = makeTube(0.0);
+    badMesh.vertices_.pop_back();
+    badMesh.properties_.clear();
+    ASSERT_THROW(exporter.addFrame(1.0, badMesh), std::logic_error);
+
+    // mesh with different property:
+    PlyMesh badProp = makeTube(0.0);
+    badProp.properties_.front().first = "density";
+    ASSERT_THROW(exporter.addFrame(1.0, badProp), std::logic_error);
+    exporter.close();
+    ASSERT_EQ(1, exporter.numFrames());
+
+    // skip header (magic, five fields, one property name, two faces):
+    std::ifstream file(fileName.c_str(), std::ifstream::binary);
+    file.seekg(8 + 5*4 + 4 + 4 + 6 + 4 + 6*4);
+
+    // check vertex data:
+    ASSERT_EQ(eMeshFrameFloat, read<uint8_t>(file));
+    ASSERT_FLOAT_EQ(0.5, read<float>(file));
+    std::vector<float> coords(18);
+    for(auto &c : coords)
+    {
+        c = read<float>(file);
+    }
+    ASSERT_FLOAT_EQ(1.25, coords[17]);
+    ASSERT_FLOAT_EQ(0.5, read<float>(file));
+    ASSERT_FLOAT_EQ(0.25, read<float>(file));
+
+    // clean up:
+    file.close();
+    std::remove(fileName.c_str());
+}
+
@@ -22,12 +22,15 @@
 // THE SOFTWARE.
 
 
-#include <vector>
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "geometry/cubic_spline_interp_1D.hpp"
+#include "geometry/cubic_spline_interp_3D.hpp"
 #include "io/molecular_path_obj_exporter.hpp"
 
 
@@ -139,3 +142,65 @@ TEST_F(MolecularPathObjExporterTest, MolecularPathObjExporterAxisRotationTest)
     ASSERT_NEAR( vec[ZZ], rotZ[ZZ], 10*eps);
 }
 
+
+/*!
+ * Tests adaptive placement of vertex rings along a straight pathway with a 
+ * narrow constriction in its centre. Rings should be concentrated at the 
+ * constriction and the vertex budget should never be exceeded.
+ */
+TEST_F(MolecularPathObjExporterTest, MolecularPathObjExporterAdaptiveRingTest)
+{
+    // straight centre line and radius with constriction at s = 0:
+    std::vector<real> s;
+    std::vector<gmx::RVec> centres;
+    std::vector<real> radii;
+    for(int i = -50; i <= 50; i++)
+    {
+        s.push_back(0.1*i);
+        centres.push_back(gmx::RVec(0.0, 0.0, 0.1*i));
+        radii.push_back(0.8 - 0.6*std::exp(-0.1*i*0.1*i/0.1));
+    }
+    CubicSplineInterp3D interp3D;
+    SplineCurve3D centreLine = interp3D(s, centres, eSplineInterpBoundaryHermite);
+    CubicSplineInterp1D interp1D;
+    SplineCurve1D radius = interp1D(s, radii, eSplineInterpBoundaryHermite);
+    std::map<std::string, std::pair<SplineCurve1D, bool>> properties;
+    properties["radius"] = std::make_pair(radius, false);
+    std::pair<real, real> range(-5.0, 5.0);
+
+    // adaptive ring placement with generous vertex budget:
+    MolecularPathObjExporter molPathExp;
+    molPathExp.setAdaptiveResolution(0.001, 100000);
+    std::vector<real> rings = molPathExp.adaptiveRingPositions(
+            centreLine, 
+            radius, 
+            properties, 
+            range);
+
+    // rings span full range in ascending order:
+    ASSERT_NEAR(range.first, rings.front(), 1e-5);
+    ASSERT_NEAR(range.second, rings.back(), 1e-5);
+    ASSERT_TRUE(std::is_sorted(rings.begin(), rings.end()));
+
+    // rings are denser at constriction than at pathway ends:
+    int numCentral = std::count_if(
+            rings.begin(), rings.end(), 
+            [](real r){ return std::fabs(r) < 1.0; });
+    int numOuter = std::count_if(
+            rings.begin(), rings.end(), 
+            [](real r){ return r > 3.0; });
+    ASSERT_GT(numCentral, 2*numOuter);
+
+    // fewer rings than evenly spaced grid:
+    ASSERT_LT(rings.size(), molPathExp.resolution().first);
+
+    // vertex budget is respected for very small tolerance:
+    size_t maxNumVertices = 60*molPathExp.resolution().second;
+    molPathExp.setAdaptiveResolution(1e-6, maxNumVertices);
+    rings = molPathExp.adaptiveRingPositions(
+            centreLine, 
+            radius, 
+            properties, 
+            range);
+    ASSERT_LE(rings.size()*molPathExp.resolution().second, maxNumVertices);
+}
@@ -0,0 +1,134 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "io/ply_io.hpp"
+
+
+/*!
+ * \brief Test fixture for the PlyMesh and PlyExporter.
+ */
+class PlyIoTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Auxiliary function that creates a mesh consisting of a single 
+         * triangle with normals and one scalar property.
+         */
+        PlyMesh makeTriangle()
+        {
+            PlyMesh mesh;
+            mesh.addVertices({gmx::RVec(0.0, 0.0, 0.0),
+                              gmx::RVec(1.0, 0.0, 0.0),
+                              gmx::RVec(0.0, 1.0, 0.0)});
+            mesh.addVertexNormals({gmx::RVec(0.0, 0.0, 1.0),
+                                   gmx::RVec(0.0, 0.0, 1.0),
+                                   gmx::RVec(0.0, 0.0, 1.0)});
+            mesh.addVertexProperty("radius", {0.1, 0.2, 0.3});
+            mesh.addFace({0, 1, 2});
+            return mesh;
+        }
+};
+
+
+/*!
+ * Checks that invalid meshes are detected.
+ */
+TEST_F(PlyIoTest, PlyMeshValidityTest)
+{
+    // valid mesh:
+    PlyMesh mesh = makeTriangle();
+    ASSERT_TRUE(mesh.valid());
+
+    // face referencing non-existent vertex:
+    PlyMesh badFace = makeTriangle();
+    badFace.addFace({0, 1, 3});
+    ASSERT_FALSE(badFace.valid());
+
+    // property with wrong number of values:
+    PlyMesh badProp = makeTriangle();
+    badProp.addVertexProperty("density", {1.0, 2.0});
+    ASSERT_FALSE(badProp.valid());
+}
+
+
+/*!
+ * Writes a single triangle to a binary PLY file and checks the header and 
+ * the binary vertex and face data read back from the file.
+ */
+TEST_F(PlyIoTest, PlyExporterBinaryTest)
+{
+    // write mesh to file:
+    std::string fileName = "test_ply_io.ply";
+    PlyExporter exporter;
+    exporter.write(fileName, makeTriangle());
+
+    // read header:
+    std::ifstream file(fileName.c_str(), std::ifstream::binary);
+    std::string line;
+    std::vector<std::string> header;
+    while( std::getline(file, line) && line != "end_header" )
+    {
+        header.push_back(line);
+    }
+    ASSERT_EQ("ply", header.at(0));
+    ASSERT_EQ("format binary_little_endian 1.0", header.at(1));
+    ASSERT_EQ("element vertex 3", header.at(3));
+    ASSERT_EQ("property float nx", header.at(7));
+    ASSERT_EQ("property float radius", header.at(10));
+    ASSERT_EQ("element face 1", header.at(11));
+
+    // read vertex data (x, y, z, nx, ny, nz, radius per vertex):
+    std::vector<float> vertexData(3*7);
+    file.read(reinterpret_cast<char*>(vertexData.data()), 
+              vertexData.size()*sizeof(float));
+    ASSERT_FLOAT_EQ(1.0, vertexData[7]);
+    ASSERT_FLOAT_EQ(1.0, vertexData[5]);
+    ASSERT_FLOAT_EQ(0.3, vertexData[20]);
+
+    // read face data:
+    unsigned char numIdx;
+    file.read(reinterpret_cast<char*>(&numIdx), 1);
+    std::vector<int> faceData(3);
+    file.read(reinterpret_cast<char*>(faceData.data()), 3*sizeof(int));
+    ASSERT_EQ(3, numIdx);
+    ASSERT_EQ(2, faceData[2]);
+
+    // no trailing data:
+    ASSERT_TRUE(file.good());
+    file.peek();
+    ASSERT_TRUE(file.eof());
+
+    // clean up:
+    file.close();
+    std::remove(fileName.c_str());
+}
+
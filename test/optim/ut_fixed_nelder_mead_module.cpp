@@ -0,0 +1,102 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <array>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "optim/fixed_nelder_mead_module.hpp"
+#include "optim/nelder_mead_module.hpp"
+
+
+/*!
+ * \brief Test fixture for the fixed-dimension Nelder-Mead optimisation 
+ * module.
+ */
+class FixedNelderMeadModuleTest : public ::testing::Test
+{
+    public:
+
+        // Rosenbrock function as objective function:
+        static real rosenbrock(const std::array<real, 2> &arg)
+        {
+            real a = 1.0;
+            real b = 100.0;
+            real x = arg[0];
+            real y = arg[1];
+            return -(a - x)*(a - x) - b*(y - x*x)*(y - x*x);
+        };
+};
+
+
+/*!
+ * Tests the fixed-dimension Nelder-Mead module on the two-dimensional 
+ * Rosenbrock function. The result is required to be identical to that of the
+ * dynamically sized NelderMeadModule, which performs the same sequence of 
+ * operations.
+ */
+TEST_F(FixedNelderMeadModuleTest, FixedNelderMeadModuleRosenbrockTest)
+{
+    // common parameters:
+    std::map<std::string, real> params;
+    params["nmMaxIter"] = 200;
+    params["nmInitShift"] = 1.0;
+
+    // fixed-dimension optimisation:
+    FixedNelderMeadModule<2> fixedNmm;
+    fixedNmm.setObjFun(rosenbrock);
+    fixedNmm.setParams(params);
+    fixedNmm.setInitGuess({{1.5, 1.5}});
+    fixedNmm.optimise();
+    FixedOptimSpacePoint<2> fixedOptim = fixedNmm.getOptimPoint();
+
+    // assert correct location and value of minimum:
+    real tol = 10.0*std::numeric_limits<real>::epsilon();
+    ASSERT_NEAR(1.0, fixedOptim.first[0], tol);
+    ASSERT_NEAR(1.0, fixedOptim.first[1], tol);
+    ASSERT_NEAR(0.0, fixedOptim.second, std::numeric_limits<real>::epsilon());
+
+    // dynamically sized optimisation:
+    NelderMeadModule nmm;
+    nmm.setObjFun([](std::vector<real> arg)
+    {
+        return rosenbrock({{arg[0], arg[1]}});
+    });
+    nmm.setParams(params);
+    nmm.setInitGuess({1.5, 1.5});
+    nmm.optimise();
+    OptimSpacePoint optim = nmm.getOptimPoint();
+
+    // both must agree exactly:
+    ASSERT_EQ(nmm.numIterations(), fixedNmm.numIterations());
+    ASSERT_EQ(optim.first[0], fixedOptim.first[0]);
+    ASSERT_EQ(optim.first[1], fixedOptim.first[1]);
+    ASSERT_EQ(optim.second, fixedOptim.second);
+}
+
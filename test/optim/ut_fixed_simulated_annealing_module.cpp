@@ -0,0 +1,192 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "optim/fixed_simulated_annealing_module.hpp"
+#include "optim/simulated_annealing_module.hpp"
+
+
+/*!
+ * \brief Test fixture for the fixed-dimension simulated annealing module.
+ */
+class FixedSimulatedAnnealingModuleTest : public ::testing::Test
+{
+    public:
+
+        // Rosenbrock function as objective function:
+        static real rosenbrock(const std::array<real, 2> &arg)
+        {
+            real a = 1.0;
+            real b = 100.0;
+            real x = arg[0];
+            real y = arg[1];
+            return -(a - x)*(a - x) - b*(y - x*x)*(y - x*x);
+        };
+};
+
+
+/*!
+ * Tests that the fixed-dimension simulated annealing module follows exactly 
+ * the same trajectory as the dynamically sized SimulatedAnnealingModule, 
+ * both with and without early termination. This includes the degenerate 
+ * case of a zero iteration limit, in which both take a single step.
+ */
+TEST_F(FixedSimulatedAnnealingModuleTest, FixedSimulatedAnnealingModuleRosenbrockTest)
+{
+    std::map<std::string, real> params;
+    params["saInitTemp"] = 300;
+    params["saCoolingFactor"] = 0.99;
+    params["saStepLengthFactor"] = 0.01;
+
+    for(int maxCoolingIter : {0, 1, 10000})
+    {
+        for(int convIter : {0, 100})
+        {
+            params["saMaxCoolingIter"] = maxCoolingIter;
+            params["saConvIter"] = convIter;
+
+            // fixed-dimension optimisation:
+            FixedSimulatedAnnealingModule<2> fixedSam;
+            fixedSam.setParams(params);
+            fixedSam.setInitGuess({{0.0, 0.0}});
+            fixedSam.setObjFun(rosenbrock);
+            fixedSam.optimise();
+            FixedOptimSpacePoint<2> fixedOptim = fixedSam.getOptimPoint();
+
+            // dynamically sized optimisation:
+            SimulatedAnnealingModule sam;
+            sam.setParams(params);
+            sam.setInitGuess({0.0, 0.0});
+            sam.setObjFun([](std::vector<real> arg)
+            {
+                return rosenbrock({{arg[0], arg[1]}});
+            });
+            sam.optimise();
+            OptimSpacePoint optim = sam.getOptimPoint();
+
+            // both must agree exactly:
+            ASSERT_LE(1, fixedSam.getNumCoolingIter());
+            ASSERT_EQ(sam.getNumCoolingIter(), fixedSam.getNumCoolingIter());
+            ASSERT_EQ(optim.first[0], fixedOptim.first[0]);
+            ASSERT_EQ(optim.first[1], fixedOptim.first[1]);
+            ASSERT_EQ(optim.second, fixedOptim.second);
+        }
+    }
+}
+
+
+
+/*!
+ * Tests that frame, chain, and plane index are packed into disjoint bit 
+ * fields of the stream index and that indices outside their range are 
+ * rejected.
+ */
+TEST_F(FixedSimulatedAnnealingModuleTest, FixedSimulatedAnnealingModuleStreamIndexTest)
+{
+    ASSERT_EQ(0u, annealingStream(0, 0, 0));
+    ASSERT_EQ(UINT64_C(0x0000000003000000), annealingStream(3, 0, 0));
+    ASSERT_EQ(UINT64_C(0x0000000000050000), annealingStream(0, 5, 0));
+    ASSERT_EQ(UINT64_C(0x0000000000000007), annealingStream(0, 0, 7));
+    ASSERT_EQ(UINT64_C(0xFFFFFFFFFFFFFFFF), 
+              annealingStream(UINT64_C(0xFFFFFFFFFF), 0xFF, 0xFFFF));
+
+    // frame indices beyond 32 bits are valid:
+    ASSERT_EQ(UINT64_C(0x0100000000000000), 
+              annealingStream(UINT64_C(1) << 32, 0, 0));
+
+    ASSERT_THROW(annealingStream(UINT64_C(1) << 40, 0, 0), std::out_of_range);
+    ASSERT_THROW(annealingStream(0, 256, 0), std::out_of_range);
+    ASSERT_THROW(annealingStream(0, 0, 1 << 16), std::out_of_range);
+}
+
+
+/*!
+ * Tests that the result of an annealing run only depends on key and stream,
+ * but not on which runs were carried out before, and that different streams
+ * and keys yield different runs.
+ */
+TEST_F(FixedSimulatedAnnealingModuleTest, FixedSimulatedAnnealingModuleStreamTest)
+{
+    std::map<std::string, real> params;
+    params["saMaxCoolingIter"] = 1000;
+    params["saInitTemp"] = 300;
+    params["saCoolingFactor"] = 0.99;
+    params["saStepLengthFactor"] = 0.01;
+
+    // runs on a sequence of (key, stream) pairs with one reused module:
+    auto run = [&](const std::vector<std::pair<uint64_t, uint64_t>> &order)
+    {
+        FixedSimulatedAnnealingModule<2> sam;
+        sam.setParams(params);
+        sam.setObjFun(rosenbrock);
+        std::vector<FixedOptimSpacePoint<2>> optima;
+        for(auto &keyStream : order)
+        {
+            sam.setInitGuess({{0.0, 0.0}});
+            sam.setRandomSeed(keyStream.first);
+            sam.setRandomStream(keyStream.second);
+            sam.optimise();
+            optima.push_back(sam.getOptimPoint());
+        }
+        return optima;
+    };
+
+    // same runs in forward and reverse order:
+    uint64_t key = UINT64_C(0x123456789ABCDEF0);
+    std::vector<std::pair<uint64_t, uint64_t>> order = {
+            {key, annealingStream(0, 0, 1)},
+            {key, annealingStream(0, 1, 1)},
+            {key, annealingStream(1, 0, 1)},
+            {key, annealingStream(UINT64_C(1) << 32, 0, 1)},
+            {key + 1, annealingStream(0, 0, 1)}};
+    std::vector<FixedOptimSpacePoint<2>> forward = run(order);
+    std::reverse(order.begin(), order.end());
+    std::vector<FixedOptimSpacePoint<2>> reverse = run(order);
+    std::reverse(reverse.begin(), reverse.end());
+
+    // results only depend on key and stream:
+    for(size_t i = 0; i < forward.size(); i++)
+    {
+        ASSERT_EQ(forward[i].first[0], reverse[i].first[0]);
+        ASSERT_EQ(forward[i].first[1], reverse[i].first[1]);
+        ASSERT_EQ(forward[i].second, reverse[i].second);
+    }
+
+    // different streams and keys give different runs:
+    for(size_t i = 1; i < forward.size(); i++)
+    {
+        ASSERT_NE(forward[0].first[0], forward[i].first[0]);
+    }
+}
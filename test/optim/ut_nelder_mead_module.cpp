@@ -142,3 +142,44 @@ TEST_F(NelderMeadModuleTest, NelderMeadModuleRosenbrockTest)
     ASSERT_NEAR(0.0, optim.second, std::numeric_limits<real>::epsilon());
 }
 
+
+
+/*!
+ * Tests early termination of the Nelder-Mead module. With default (zero) 
+ * tolerances, optimisation of the sphere function must stop once the simplex
+ * has collapsed and give the same result as the full optimisation. With 
+ * finite tolerances it must stop considerably earlier, but still within the
+ * given tolerance of the optimum.
+ */
+TEST_F(NelderMeadModuleTest, NelderMeadModuleConvergenceTest)
+{
+    std::map<std::string, real> params;
+    params["nmMaxIter"] = 10000;
+    params["nmInitShift"] = 1.0;
+    std::vector<real> guess = {5.0, 6.0};
+
+    // default tolerances only stop at collapsed simplex:
+    NelderMeadModule nmmCollapsed;
+    nmmCollapsed.setObjFun(sphere);
+    nmmCollapsed.setParams(params);
+    nmmCollapsed.setInitGuess(guess);
+    nmmCollapsed.optimise();
+    OptimSpacePoint optim = nmmCollapsed.getOptimPoint();
+    ASSERT_GT(10000, nmmCollapsed.numIterations());
+    ASSERT_NEAR(0.0, optim.first[0], std::numeric_limits<real>::epsilon());
+    ASSERT_NEAR(0.0, optim.first[1], std::numeric_limits<real>::epsilon());
+
+    // finite tolerances stop earlier:
+    real tol = 1e-3;
+    params["nmSimplexTol"] = tol;
+    params["nmValueTol"] = tol*tol;
+    NelderMeadModule nmmTol;
+    nmmTol.setObjFun(sphere);
+    nmmTol.setParams(params);
+    nmmTol.setInitGuess(guess);
+    nmmTol.optimise();
+    optim = nmmTol.getOptimPoint();
+    ASSERT_GT(nmmCollapsed.numIterations(), nmmTol.numIterations());
+    ASSERT_NEAR(0.0, optim.first[0], 2.0*tol);
+    ASSERT_NEAR(0.0, optim.first[1], 2.0*tol);
+}
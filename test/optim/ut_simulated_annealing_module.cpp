@@ -157,3 +157,66 @@ TEST_F(SimulatedAnnealingModuleTest, IsotropicRosenbrockTest)
     ASSERT_NEAR(1.0, res.first[1], errTol);
 }
 
+
+
+/*!
+ * Tests the early termination criteria of the simulated annealing module. On
+ * a constant objective function the best cost never improves, so that 
+ * annealing must stop after exactly one convergence window, whereas it runs 
+ * for the maximum number of cooling iterations if no window is set. On a 
+ * steep objective function at low temperature virtually no candidate is 
+ * accepted, so that the acceptance rate criterion must terminate annealing.
+ */
+TEST_F(SimulatedAnnealingModuleTest, ConvergenceCriteriaTest)
+{
+    // common parameters:
+    std::map<std::string, real> params;
+    params["saRandomSeed"] = randomSeed_;
+    params["saMaxCoolingIter"] = 1000;
+    params["saInitTemp"] = 1.0;
+    params["saCoolingFactor"] = 0.99;
+    params["saStepLengthFactor"] = 0.001;
+
+    // constant objective function:
+    ObjectiveFunction constant = [](std::vector<real>){return 1.0;};
+    std::vector<real> guess = {0.0, 0.0};
+
+    // no convergence window means maximum number of iterations is used:
+    SimulatedAnnealingModule samFull;
+    samFull.setParams(params);
+    samFull.setInitGuess(guess);
+    samFull.setObjFun(constant);
+    samFull.optimise();
+    ASSERT_EQ(1000, samFull.getNumCoolingIter());
+
+    // stagnation is detected after one window:
+    params["saConvIter"] = 50;
+    SimulatedAnnealingModule samStagnant;
+    samStagnant.setParams(params);
+    samStagnant.setInitGuess(guess);
+    samStagnant.setObjFun(constant);
+    samStagnant.optimise();
+    ASSERT_EQ(50, samStagnant.getNumCoolingIter());
+    ASSERT_NEAR(1.0, samStagnant.getOptimPoint().second, 
+                std::numeric_limits<real>::epsilon());
+
+    // steep cone at low temperature rejects (almost) all candidates:
+    // (negative tolerance disables the stagnation criterion)
+    params["saConvTol"] = -1.0;
+    params["saMinAccRate"] = 0.5;
+    params["saInitTemp"] = 1e-6;
+    ObjectiveFunction cone = [](std::vector<real> x)
+    {
+        return -1e3*std::sqrt(x[0]*x[0] + x[1]*x[1]);
+    };
+    SimulatedAnnealingModule samFrozen;
+    samFrozen.setParams(params);
+    samFrozen.setInitGuess(guess);
+    samFrozen.setObjFun(cone);
+    samFrozen.optimise();
+    ASSERT_EQ(50, samFrozen.getNumCoolingIter());
+    ASSERT_NEAR(0.0, samFrozen.getOptimPoint().first[0], 
+                std::numeric_limits<real>::epsilon());
+    ASSERT_NEAR(0.0, samFrozen.getOptimPoint().first[1], 
+                std::numeric_limits<real>::epsilon());
+}
@@ -0,0 +1,332 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "path-finding/distance_transform_path_finder.hpp"
+
+
+/*!
+ * \brief Test fixture for DistanceTransformPathFinder.
+ *
+ * Provides default parameters and a function to create an artificial pore
+ * along the z-axis embedded in a slab of atoms.
+ */
+class DistanceTransformPathFinderTest : public ::testing::Test
+{
+    public:
+
+        // constructor:
+        DistanceTransformPathFinderTest()
+        {
+            // path finder parameters:
+            params_["pfProbeStepLength"] = 0.1;
+            params_["pfProbeMaxRadius"] = 0.5;
+            params_["pfProbeMaxSteps"] = 1000;
+            params_["pfGridSpacing"] = 0.1;
+            params_["nmMaxIter"] = 100;
+            params_["nmInitShift"] = 0.1;
+
+            // box is chosen so that periodicity does not matter:
+            clear_mat(boxMat_);
+        };
+
+        // standard parameters for tests:
+        std::map<std::string, real> params_;
+
+        // box matrix for pbc:
+        matrix boxMat_;
+
+        // mathematical constants:
+        const real PI_ = std::acos(-1.0);
+
+        // centre line of pore, which is displaced along x:
+        real centreLine(real z, real poreLength, real amplitude)
+        {
+            return amplitude*std::sin(PI_*z/poreLength);
+        };
+
+        // create a pore in a slab from concentric rings of atoms:
+        std::vector<gmx::RVec> makePore(
+                real poreLength,
+                const std::vector<real> &ringRadii,
+                real poreVdwRadius,
+                real amplitude)
+        {
+            // step length and number of steps along the length of the pore:
+            real stepLengthAlong = poreVdwRadius/2.0;
+            int nStepsAlong = std::ceil(poreLength/stepLengthAlong) + 1;
+
+            std::vector<gmx::RVec> particleCentres;
+            for(auto ringRadius : ringRadii)
+            {
+                // angle required for overlapping vdW spheres:
+                real phi = std::acos(1.0 - std::pow(poreVdwRadius, 2.0)/2.0
+                                         /std::pow(ringRadius, 2.0));
+                int nStepsAround = std::ceil(2.0*PI_/phi);
+                phi = 2.0*PI_/nStepsAround;
+
+                // place particles on ring around pore centre line:
+                for(int i = 0; i < nStepsAlong; i++)
+                {
+                    real z = i*stepLengthAlong - poreLength/2.0;
+                    for(int j = 0; j < nStepsAround; j++)
+                    {
+                        particleCentres.push_back(gmx::RVec(
+                                centreLine(z, poreLength, amplitude) 
+                                + ringRadius*std::cos(phi*j),
+                                ringRadius*std::sin(phi*j),
+                                z));
+                    }
+                }
+            }
+
+            return particleCentres;
+        };
+
+        // run path finder on given pore:
+        void findPath(
+                const std::vector<gmx::RVec> &particleCentres,
+                const std::vector<real> &vdwRadii,
+                gmx::RVec initProbePos,
+                gmx::RVec chanDirVec,
+                std::vector<gmx::RVec> &points,
+                std::vector<real> &radii)
+        {
+            t_pbc pbc;
+            set_pbc(&pbc, 1, boxMat_);
+            gmx::AnalysisNeighborhoodPositions nbhPos(particleCentres);
+
+            DistanceTransformPathFinder pfm(params_,
+                                            initProbePos,
+                                            chanDirVec,
+                                            &pbc,
+                                            nbhPos,
+                                            vdwRadii);
+
+            PathFindingParameters par;
+            par.setProbeStepLength(params_["pfProbeStepLength"]);
+            par.setMaxProbeRadius(params_["pfProbeMaxRadius"]);
+            par.setMaxProbeSteps(params_["pfProbeMaxSteps"]);
+            pfm.setParameters(par);
+
+            pfm.findPath();
+            points = pfm.pathPoints();
+            radii = pfm.pathRadii();
+        };
+};
+
+
+/*!
+ * Tests the path finder on a straight cylindrical pore along the z-axis 
+ * lined by overlapping spheres of equal radius and surrounded by further 
+ * rings of atoms. The initial probe position is placed off the pore axis. 
+ * The path must leave the pore on both sides and all path points inside the
+ * pore must lie on the pore axis with a radius between the minimal and 
+ * maximal free radius of the pore. Path finding is deterministic.
+ */
+TEST_F(DistanceTransformPathFinderTest, DistanceTransformPathFinderCylinderTest)
+{
+    // define pore parameters:
+    real poreLength = 2.0;
+    real poreCentreRadius = 0.5;
+    real poreVdwRadius = 0.2;
+    std::vector<real> ringRadii = {poreCentreRadius, 0.85, 1.2};
+
+    // true pore radius:
+    real poreMinFreeRadius = poreCentreRadius - poreVdwRadius;
+    real poreMaxFreeRadius = std::sqrt(std::pow(poreVdwRadius/4.0, 2.0) +
+                             std::pow(poreCentreRadius, 2.0)) - poreVdwRadius;
+
+    // create pore:
+    std::vector<gmx::RVec> particleCentres = makePore(poreLength,
+                                                      ringRadii,
+                                                      poreVdwRadius,
+                                                      0.0);
+    std::vector<real> vdwRadii(particleCentres.size(), poreVdwRadius);
+
+    // find path from off-axis initial position:
+    gmx::RVec initProbePos(0.1*poreCentreRadius, 
+                           -0.3*poreCentreRadius, 
+                           0.3*poreCentreRadius);
+    gmx::RVec chanDirVec(0.0, 0.0, 1.0);
+    std::vector<gmx::RVec> points;
+    std::vector<real> radii;
+    findPath(particleCentres, vdwRadii, initProbePos, chanDirVec, points, 
+             radii);
+
+    // path must leave pore on both sides:
+    // (forward direction comes first)
+    ASSERT_GT(points.front()[ZZ], 0.5*poreLength);
+    ASSERT_LT(points.back()[ZZ], -0.5*poreLength);
+    ASSERT_EQ(params_["pfProbeMaxRadius"], radii.front());
+    ASSERT_EQ(params_["pfProbeMaxRadius"], radii.back());
+
+    // check internal points:
+    real tol = 1e-3;
+    int numInternal = 0;
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        if( std::abs(points[i][ZZ]) > 0.5*poreLength - poreVdwRadius )
+        {
+            continue;
+        }
+        numInternal++;
+
+        ASSERT_LE(poreMinFreeRadius - tol, radii[i]);
+        ASSERT_GE(poreMaxFreeRadius + tol, radii[i]);
+        ASSERT_NEAR(0.0, points[i][XX], tol);
+        ASSERT_NEAR(0.0, points[i][YY], tol);
+    }
+    ASSERT_LT(0, numInternal);
+
+    // path finding is deterministic:
+    std::vector<gmx::RVec> pointsRepeat;
+    std::vector<real> radiiRepeat;
+    findPath(particleCentres, vdwRadii, initProbePos, chanDirVec, 
+             pointsRepeat, radiiRepeat);
+    ASSERT_EQ(points.size(), pointsRepeat.size());
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        ASSERT_EQ(radii[i], radiiRepeat[i]);
+        for(int d = 0; d < DIM; d++)
+        {
+            ASSERT_EQ(points[i][d], pointsRepeat[i][d]);
+        }
+    }
+}
+
+
+/*!
+ * Tests the path finder on a curved pore whose centre line is displaced 
+ * sideways along the pore and does not pass through the initial probe 
+ * position. Path points inside the pore must follow the centre line and
+ * have a positive radius.
+ */
+TEST_F(DistanceTransformPathFinderTest, DistanceTransformPathFinderCurvedTest)
+{
+    // define pore parameters:
+    real poreLength = 2.0;
+    real poreCentreRadius = 0.5;
+    real poreVdwRadius = 0.2;
+    real amplitude = 0.3;
+    std::vector<real> ringRadii = {poreCentreRadius, 0.85, 1.2};
+
+    // create pore:
+    std::vector<gmx::RVec> particleCentres = makePore(poreLength,
+                                                      ringRadii,
+                                                      poreVdwRadius,
+                                                      amplitude);
+    std::vector<real> vdwRadii(particleCentres.size(), poreVdwRadius);
+
+    // find path:
+    std::vector<gmx::RVec> points;
+    std::vector<real> radii;
+    findPath(particleCentres, vdwRadii, gmx::RVec(0.0, 0.0, 0.0), 
+             gmx::RVec(0.0, 0.0, 1.0), points, radii);
+
+    // path must leave pore on both sides:
+    ASSERT_GT(points.front()[ZZ], 0.5*poreLength);
+    ASSERT_LT(points.back()[ZZ], -0.5*poreLength);
+
+    // internal points follow curved centre line:
+    real tol = 0.05;
+    int numInternal = 0;
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        if( std::abs(points[i][ZZ]) > 0.5*poreLength - poreVdwRadius )
+        {
+            continue;
+        }
+        numInternal++;
+
+        ASSERT_LT(0.0, radii[i]);
+        ASSERT_NEAR(centreLine(points[i][ZZ], poreLength, amplitude), 
+                    points[i][XX], tol);
+        ASSERT_NEAR(0.0, points[i][YY], tol);
+    }
+    ASSERT_LT(0, numInternal);
+}
+
+
+/*!
+ * Tests the path finder on a curved pore whose openings are displaced from 
+ * the axis through the initial probe position by more than twice the maximum
+ * probe radius. As the grid covers the bounding box of all atoms and the 
+ * openings are found from the distance field, the path must nevertheless 
+ * follow the centre line out of the pore on both sides rather than pass 
+ * around the outside of the pore-forming atoms.
+ */
+TEST_F(DistanceTransformPathFinderTest, DistanceTransformPathFinderDisplacedOpeningsTest)
+{
+    // define pore parameters:
+    real poreLength = 4.0;
+    real poreCentreRadius = 0.5;
+    real poreVdwRadius = 0.2;
+    real amplitude = 1.2;
+    std::vector<real> ringRadii = {poreCentreRadius, 0.85, 1.2};
+
+    // create pore:
+    std::vector<gmx::RVec> particleCentres = makePore(poreLength,
+                                                      ringRadii,
+                                                      poreVdwRadius,
+                                                      amplitude);
+    std::vector<real> vdwRadii(particleCentres.size(), poreVdwRadius);
+
+    // find path:
+    std::vector<gmx::RVec> points;
+    std::vector<real> radii;
+    findPath(particleCentres, vdwRadii, gmx::RVec(0.0, 0.0, 0.0), 
+             gmx::RVec(0.0, 0.0, 1.0), points, radii);
+
+    // path must leave pore on both sides through displaced openings:
+    ASSERT_GT(points.front()[ZZ], 0.5*poreLength);
+    ASSERT_LT(points.back()[ZZ], -0.5*poreLength);
+    ASSERT_LT(2.0*params_["pfProbeMaxRadius"], points.front()[XX]);
+    ASSERT_GT(-2.0*params_["pfProbeMaxRadius"], points.back()[XX]);
+
+    // internal points follow curved centre line:
+    real tol = 0.1;
+    int numInternal = 0;
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        if( std::abs(points[i][ZZ]) > 0.5*poreLength - poreVdwRadius )
+        {
+            continue;
+        }
+        numInternal++;
+
+        ASSERT_LT(0.0, radii[i]);
+        ASSERT_NEAR(centreLine(points[i][ZZ], poreLength, amplitude), 
+                    points[i][XX], tol);
+        ASSERT_NEAR(0.0, points[i][YY], tol);
+    }
+    ASSERT_LT(0, numInternal);
+}
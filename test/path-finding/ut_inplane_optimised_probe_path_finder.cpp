@@ -611,3 +611,150 @@ class InplaneOptimisedProbePathFinderTest : public ::testing::Test
 //                     clDistTol);
 //     }
 // }
+
+
+/*!
+ * \brief Tests that concurrent sweeps and multi-start optimisation of the 
+ * initial position yield a consistent, reproducible path.
+ *
+ * A cylindrical pore along the \f$ z \f$-axis is traced with several 
+ * simulated annealing starts for the initial probe position. The joined 
+ * path must be ordered strictly along the channel direction vector (forward
+ * sweep first and reversed, then the initial point, then the backward 
+ * sweep), terminate in bulk on either side, and report iteration counts for
+ * each point. Because each annealing run uses a fixed random number stream, a
+ * second run must reproduce the path exactly irrespective of how the work was
+ * distributed over threads.
+ */
+TEST_F(InplaneOptimisedProbePathFinderTest, InplaneOptimisedProbePathFinderConcurrentSweepTest)
+{
+    // set up periodic boundary conditions:
+    t_pbc pbc;
+    set_pbc(&pbc, 1, boxMat_);
+
+    // several starts for initial position:
+    std::map<std::string, real> params = params_;
+    params["saNumStarts"] = 4;
+
+    // create pore pointing in the z-direction:
+    real poreLength = 2.0;
+    real poreCentreRadius = 0.5;
+    real poreVdwRadius = 0.2;
+    std::vector<gmx::RVec> particleCentres = makePore(poreLength,
+                                                      poreCentreRadius,
+                                                      poreVdwRadius,
+                                                      gmx::RVec(0.0, 0.0, 0.0),
+                                                      ZZ);
+    std::vector<real> vdwRadii(particleCentres.size(), poreVdwRadius);
+    gmx::AnalysisNeighborhoodPositions nbhPos(particleCentres);
+
+    // path finding parameters:
+    PathFindingParameters par;
+    par.setProbeStepLength(params["pfProbeStepLength"]);
+    par.setMaxProbeRadius(params["pfProbeMaxRadius"]);
+    par.setMaxProbeSteps(params["pfProbeMaxSteps"]);
+
+    // run path finder twice:
+    std::vector<std::vector<gmx::RVec>> points;
+    std::vector<std::vector<real>> radii;
+    for(int run = 0; run < 2; run++)
+    {
+        InplaneOptimisedProbePathFinder pfm(params,
+                                            gmx::RVec(0.1, -0.1, 0.0),
+                                            gmx::RVec(0.0, 0.0, 1.0),
+                                            &pbc,
+                                            nbhPos,
+                                            vdwRadii);
+        pfm.setParameters(par);
+        pfm.findPath();
+        points.push_back(pfm.pathPoints());
+        radii.push_back(pfm.pathRadii());
+
+        // iteration counts are reported for every point:
+        ASSERT_EQ(points.back().size(), pfm.pathSaIterations().size());
+        ASSERT_EQ(points.back().size(), pfm.pathNmIterations().size());
+    }
+
+    // path is ordered against channel direction and ends in bulk:
+    for(size_t i = 1; i < points[0].size(); i++)
+    {
+        ASSERT_LT(points[0][i][ZZ], points[0][i - 1][ZZ]);
+    }
+    ASSERT_GT(points[0].front()[ZZ], 0.5*poreLength);
+    ASSERT_LT(points[0].back()[ZZ], -0.5*poreLength);
+    ASSERT_EQ(params["pfProbeMaxRadius"], radii[0].front());
+    ASSERT_EQ(params["pfProbeMaxRadius"], radii[0].back());
+
+    // repeated run gives identical path:
+    ASSERT_EQ(points[0].size(), points[1].size());
+    for(size_t i = 0; i < points[0].size(); i++)
+    {
+        ASSERT_EQ(radii[0][i], radii[1][i]);
+        for(int d = 0; d < DIM; d++)
+        {
+            ASSERT_EQ(points[0][i][d], points[1][i][d]);
+        }
+    }
+}
+
+
+/*!
+ * \brief Tests that cached neighbour lists do not change the pore found.
+ *
+ * The same cylindrical pore is traced with and without a neighbour list 
+ * skin. As only particles within the search cutoff of the probe contribute to
+ * the free distance in either case, both runs must find the same minimal 
+ * pore radius and path length up to the rounding differences in computing 
+ * the distance from cached distance vectors.
+ */
+TEST_F(InplaneOptimisedProbePathFinderTest, InplaneOptimisedProbePathFinderNeighbourListTest)
+{
+    // set up periodic boundary conditions:
+    t_pbc pbc;
+    set_pbc(&pbc, 1, boxMat_);
+
+    // create pore pointing in the z-direction:
+    real poreLength = 2.0;
+    real poreCentreRadius = 0.5;
+    real poreVdwRadius = 0.2;
+    std::vector<gmx::RVec> particleCentres = makePore(poreLength,
+                                                      poreCentreRadius,
+                                                      poreVdwRadius,
+                                                      gmx::RVec(0.0, 0.0, 0.0),
+                                                      ZZ);
+    std::vector<real> vdwRadii(particleCentres.size(), poreVdwRadius);
+    gmx::AnalysisNeighborhoodPositions nbhPos(particleCentres);
+
+    // path finding parameters:
+    PathFindingParameters par;
+    par.setProbeStepLength(params_["pfProbeStepLength"]);
+    par.setMaxProbeRadius(params_["pfProbeMaxRadius"]);
+    par.setMaxProbeSteps(params_["pfProbeMaxSteps"]);
+
+    // run path finder without and with skin:
+    std::vector<real> skins = {0.0, 0.2};
+    std::vector<real> minRadius;
+    std::vector<size_t> numPoints;
+    for(auto skin : skins)
+    {
+        std::map<std::string, real> params = params_;
+        params["pfNbhSkin"] = skin;
+        InplaneOptimisedProbePathFinder pfm(params,
+                                            gmx::RVec(0.1, -0.1, 0.0),
+                                            gmx::RVec(0.0, 0.0, 1.0),
+                                            &pbc,
+                                            nbhPos,
+                                            vdwRadii);
+        pfm.setParameters(par);
+        pfm.findPath();
+        std::vector<real> radii = pfm.pathRadii();
+        minRadius.push_back(*std::min_element(radii.begin(), radii.end()));
+        numPoints.push_back(radii.size());
+    }
+
+    // same pore is found in either case:
+    real eps = 1e-3;
+    ASSERT_NEAR(minRadius[0], minRadius[1], eps);
+    ASSERT_NEAR(poreCentreRadius - poreVdwRadius, minRadius[1], 0.05);
+    ASSERT_NEAR(numPoints[0], numPoints[1], 2);
+}
@@ -0,0 +1,340 @@
+// CHAP - The Channel Annotation Package
+//
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and
+// Stephen J. Tucker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/pbcutil/pbc.h>
+
+#include "path-finding/inplane_optimised_probe_path_finder.hpp"
+#include "path-finding/optimised_direction_probe_path_finder.hpp"
+
+
+/*!
+ * \brief Test fixture for OptimisedDirectionProbePathFinder.
+ *
+ * Provides some default parameters and a mock protein consisting of a block
+ * of particles on a cubic lattice, through which a curved tunnel has been 
+ * carved. The tunnel enters the block from below along the \f$ z \f$-axis, 
+ * turns by 90° on a quarter circle of radius \f$ R_\text{b} \f$ in the 
+ * \f$ xz \f$-plane, and leaves the block through its side face along the 
+ * \f$ x \f$-axis.
+ */
+class OptimisedDirectionProbePathFinderTest : public ::testing::Test
+{
+
+    public:
+
+        // constructor:
+        OptimisedDirectionProbePathFinderTest()
+        {
+                // path finder parameters:
+                params_["pfProbeRadius"] = 0.0;
+                params_["pfProbeStepLength"] = 0.05;
+                params_["pfProbeMaxRadius"] = 1.0;
+                params_["pfProbeMaxSteps"] = 1000;
+
+                // simulated annealing parameters:
+                params_["saUseAdaptiveCandidateGeneration"] = 0;
+                params_["saRandomSeed"] = 15011992;
+                params_["saMaxCoolingIter"] = 1000;
+                params_["saNumCostSamples"] = 10;
+                params_["saXi"] = 3.0;
+                params_["saConvRelTol"] = 1e-15;
+                params_["saCoolingFactor"] = 0.98;
+                params_["saInitTemp"] = 0.1;
+                params_["saStepLengthFactor"] = 0.001;
+
+                // Nelder-Mead parameters:
+                params_["nmMaxIter"] = 100;
+                params_["nmInitShift"] = 0.1;
+
+                // path finding parameters:
+                pfParams_.setProbeStepLength(params_["pfProbeStepLength"]);
+                pfParams_.setMaxProbeRadius(params_["pfProbeMaxRadius"]);
+                pfParams_.setMaxProbeSteps(params_["pfProbeMaxSteps"]);
+
+                // set periodic boundary condition struct:
+                // NOTE: box is chosen so that periodicity does not matter
+                clear_mat(boxMat_);
+                set_pbc(&pbc_, 1, boxMat_);
+
+                // create mock protein:
+                makeCurvedPore();
+        };
+
+        // standard parameters for tests:
+        std::map<std::string, real> params_;
+        PathFindingParameters pfParams_;
+
+        // periodic boundary conditions:
+        matrix boxMat_;
+        t_pbc pbc_;
+
+        // geometry of mock protein:
+        const real bendRadius_ = 0.6;
+        const real tunnelRadius_ = 0.45;
+        const real vdwRadius_ = 0.15;
+        const real latticeSpacing_ = 0.2;
+        const gmx::RVec blockLo_ = gmx::RVec(-1.0, -1.0, -1.0);
+        const gmx::RVec blockHi_ = gmx::RVec(1.2, 1.0, 2.2);
+
+        // particles of mock protein:
+        std::vector<gmx::RVec> particleCentres_;
+        std::vector<real> vdwRadii_;
+
+        // initial probe position and channel direction:
+        const gmx::RVec initProbePos_ = gmx::RVec(0.05, 0.0, -0.4);
+        const gmx::RVec chanDirVec_ = gmx::RVec(0.0, 0.0, 1.0);
+
+        /*!
+         * Distance of a point from the centre line of the tunnel, which 
+         * consists of a half line along the negative \f$ z \f$-axis, a 
+         * quarter circle around \f$ (R_\text{b}, 0, 0) \f$, and a half line 
+         * parallel to the \f$ x \f$-axis at \f$ z = R_\text{b} \f$.
+         */
+        real centreLineDist(const gmx::RVec &point)
+        {
+            real dist = std::numeric_limits<real>::infinity();
+
+            // straight section along z-axis:
+            if( point[ZZ] <= 0.0 )
+            {
+                dist = std::min(dist, std::sqrt(point[XX]*point[XX] + 
+                                                point[YY]*point[YY]));
+            }
+
+            // straight section parallel to x-axis:
+            if( point[XX] >= bendRadius_ )
+            {
+                real dz = point[ZZ] - bendRadius_;
+                dist = std::min(dist, std::sqrt(dz*dz + point[YY]*point[YY]));
+            }
+
+            // bend:
+            real dx = point[XX] - bendRadius_;
+            if( dx <= 0.0 && point[ZZ] >= 0.0 )
+            {
+                real rho = std::sqrt(dx*dx + point[ZZ]*point[ZZ]);
+                dist = std::min(dist, std::sqrt(
+                        (rho - bendRadius_)*(rho - bendRadius_) + 
+                        point[YY]*point[YY]));
+            }
+
+            return dist;
+        };
+
+        /*!
+         * Places particles on all lattice points inside the block that are
+         * not inside the tunnel.
+         */
+        void makeCurvedPore()
+        {
+            int nx = std::round((blockHi_[XX] - blockLo_[XX])/latticeSpacing_);
+            int ny = std::round((blockHi_[YY] - blockLo_[YY])/latticeSpacing_);
+            int nz = std::round((blockHi_[ZZ] - blockLo_[ZZ])/latticeSpacing_);
+            for(int i = 0; i <= nx; i++)
+            {
+                for(int j = 0; j <= ny; j++)
+                {
+                    for(int k = 0; k <= nz; k++)
+                    {
+                        gmx::RVec particle(blockLo_[XX] + i*latticeSpacing_,
+                                           blockLo_[YY] + j*latticeSpacing_,
+                                           blockLo_[ZZ] + k*latticeSpacing_);
+                        if( centreLineDist(particle) >= tunnelRadius_ )
+                        {
+                            particleCentres_.push_back(particle);
+                        }
+                    }
+                }
+            }
+            vdwRadii_.assign(particleCentres_.size(), vdwRadius_);
+        };
+};
+
+
+/*!
+ * \brief Tests that the OptimisedDirectionProbePathFinder follows a curved 
+ * tunnel with fewer probe planes than the InplaneOptimisedProbePathFinder.
+ *
+ * Both path finders start in the straight entrance section of the tunnel 
+ * described in the test fixture, with the channel direction vector pointing
+ * along the entrance. As the direction of motion of the
+ * InplaneOptimisedProbePathFinder is fixed, its probe can not turn into the
+ * exit of the tunnel and has to cross the block of particles before it 
+ * reaches bulk. The OptimisedDirectionProbePathFinder on the other hand must 
+ * stay close to the centre line of the tunnel throughout, leave the block
+ * through its side face, and hence require fewer probe planes in total.
+ */
+TEST_F(OptimisedDirectionProbePathFinderTest, 
+       OptimisedDirectionProbePathFinderCurvedPoreTest)
+{
+    gmx::AnalysisNeighborhoodPositions nbhPos(particleCentres_);
+
+    // path with fixed direction of motion:
+    InplaneOptimisedProbePathFinder fixedPfm(params_,
+                                             initProbePos_,
+                                             chanDirVec_,
+                                             &pbc_,
+                                             nbhPos,
+                                             vdwRadii_);
+    fixedPfm.setParameters(pfParams_);
+    fixedPfm.findPath();
+    std::vector<gmx::RVec> fixedPoints = fixedPfm.pathPoints();
+
+    // path with optimised direction of motion:
+    OptimisedDirectionProbePathFinder pfm(params_,
+                                          initProbePos_,
+                                          chanDirVec_,
+                                          &pbc_,
+                                          nbhPos,
+                                          vdwRadii_);
+    pfm.setParameters(pfParams_);
+    pfm.findPath();
+    std::vector<gmx::RVec> points = pfm.pathPoints();
+    std::vector<real> radii = pfm.pathRadii();
+
+    // fixed direction path leaves the tunnel:
+    real maxFixedDist = 0.0;
+    for(auto point : fixedPoints)
+    {
+        maxFixedDist = std::max(maxFixedDist, centreLineDist(point));
+    }
+    ASSERT_GT(maxFixedDist, tunnelRadius_);
+
+    // optimised direction path follows centre line of tunnel throughout:
+    real clDistTol = 0.5*(tunnelRadius_ - vdwRadius_);
+    for(auto point : points)
+    {
+        ASSERT_LT(centreLineDist(point), clDistTol);
+    }
+
+    // path leaves block through side face and bottom face:
+    ASSERT_GT(points.front()[XX], blockHi_[XX]);
+    ASSERT_LT(points.back()[ZZ], blockLo_[ZZ]);
+    ASSERT_EQ(params_["pfProbeMaxRadius"], radii.front());
+    ASSERT_EQ(params_["pfProbeMaxRadius"], radii.back());
+
+    // radius inside tunnel is that of tunnel:
+    real minRadius = *std::min_element(radii.begin(), radii.end());
+    ASSERT_GT(minRadius, tunnelRadius_ - vdwRadius_ - latticeSpacing_);
+
+    // fewer probe planes are needed than with fixed direction:
+    ASSERT_LT(points.size(), fixedPoints.size());
+}
+
+
+/*!
+ * \brief Tests that the direction of probe motion changes by no more than 
+ * the maximum angle per probe step.
+ *
+ * The directions of motion are not returned by the path finder, but can be
+ * reconstructed from the path points: starting from the channel direction 
+ * vector (or its inverse) at the initial point, each point must lie one probe
+ * step length ahead of its predecessor along the current direction, and the 
+ * next direction is the displacement between both points, limited to the 
+ * maximum change in direction. The test asserts that the path is consistent 
+ * with this sequence of directions, which could not be the case if the 
+ * direction had changed by more than the permitted angle.
+ */
+TEST_F(OptimisedDirectionProbePathFinderTest, 
+       OptimisedDirectionProbePathFinderDirectionChangeTest)
+{
+    gmx::AnalysisNeighborhoodPositions nbhPos(particleCentres_);
+
+    // path with optimised direction of motion:
+    OptimisedDirectionProbePathFinder pfm(params_,
+                                          initProbePos_,
+                                          chanDirVec_,
+                                          &pbc_,
+                                          nbhPos,
+                                          vdwRadii_);
+    pfm.setParameters(pfParams_);
+    pfm.findPath();
+    std::vector<gmx::RVec> points = pfm.pathPoints();
+
+    // initial point lies in plane through initial probe position:
+    int initIdx = -1;
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        gmx::RVec shift;
+        rvec_sub(points[i], initProbePos_, shift);
+        if( std::abs(iprod(shift, chanDirVec_)) < 1e-4 )
+        {
+            initIdx = i;
+        }
+    }
+    ASSERT_GE(initIdx, 0);
+
+    // forward sweep runs towards front of path, backward sweep towards back:
+    real stepLength = params_["pfProbeStepLength"];
+    real maxAngle = pfm.maxDirChangeAngle();
+    real angleTol = 1e-3;
+    for(int sweep : {-1, 1})
+    {
+        // initial direction of motion:
+        gmx::RVec dirVec;
+        svmul(-sweep, chanDirVec_, dirVec);
+
+        for(int i = initIdx; i + sweep >= 0 && 
+                             i + sweep < static_cast<int>(points.size()); 
+            i += sweep)
+        {
+            // next point lies one step ahead along current direction:
+            gmx::RVec step;
+            rvec_sub(points[i + sweep], points[i], step);
+            ASSERT_NEAR(stepLength, iprod(step, dirVec), 1e-4);
+
+            // direction of next step turns towards displacement:
+            gmx::RVec localAxis;
+            unitv(step, localAxis);
+            real angle = std::acos(std::min(iprod(localAxis, dirVec), 
+                                            static_cast<real>(1.0)));
+            if( angle > maxAngle )
+            {
+                // rotate by maximum angle towards displacement:
+                gmx::RVec orthAxis;
+                svmul(std::cos(angle), dirVec, orthAxis);
+                rvec_sub(localAxis, orthAxis, orthAxis);
+                unitv(orthAxis, orthAxis);
+                for(int d = 0; d < DIM; d++)
+                {
+                    localAxis[d] = std::cos(maxAngle)*dirVec[d] + 
+                                   std::sin(maxAngle)*orthAxis[d];
+                }
+            }
+
+            // change in direction is within permitted range:
+            ASSERT_LE(std::acos(std::min(iprod(localAxis, dirVec), 
+                                         static_cast<real>(1.0))), 
+                      maxAngle + angleTol);
+            dirVec = localAxis;
+        }
+    }
+}
+
@@ -0,0 +1,173 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "path-finding/pore_region_filter.hpp"
+
+
+/*!
+ * \brief Test fixture for PoreRegionFilter.
+ *
+ * Provides a regular grid of particles and periodic boundary conditions that
+ * do not affect the result.
+ */
+class PoreRegionFilterTest : public ::testing::Test
+{
+    public:
+
+        // constructor:
+        PoreRegionFilterTest()
+        {
+            // grid of particles around origin:
+            for(int i = -10; i <= 10; i++)
+            {
+                for(int j = -10; j <= 10; j++)
+                {
+                    for(int k = -10; k <= 10; k++)
+                    {
+                        positions_.push_back(
+                                gmx::RVec(0.2*i, 0.2*j, 0.2*k));
+                    }
+                }
+            }
+
+            // box is chosen so that periodicity does not matter:
+            matrix box;
+            clear_mat(box);
+            set_pbc(&pbc_, 1, box);
+        };
+
+    protected:
+
+        std::vector<gmx::RVec> positions_;
+        t_pbc pbc_;
+};
+
+
+/*!
+ * Checks that a tube around an axis retains exactly the particles within the
+ * tube radius of the axis.
+ */
+TEST_F(PoreRegionFilterTest, PoreRegionFilterAxisTest)
+{
+    real tubeRadius = 0.5;
+    PoreRegionFilter filter(gmx::RVec(0.0, 0.0, 1.0), 
+                            gmx::RVec(0.0, 0.0, 2.0), 
+                            tubeRadius, 
+                            &pbc_);
+
+    std::vector<int> inside = filter.filter(positions_);
+    std::vector<bool> isInside(positions_.size(), false);
+    for(auto idx : inside)
+    {
+        isInside.at(idx) = true;
+    }
+
+    for(size_t i = 0; i < positions_.size(); i++)
+    {
+        real dist = std::sqrt(positions_[i][XX]*positions_[i][XX] + 
+                              positions_[i][YY]*positions_[i][YY]);
+        ASSERT_NEAR(dist, filter.distance(positions_[i]), 1e-6);
+        ASSERT_EQ(dist <= tubeRadius, isInside[i]);
+    }
+}
+
+
+/*!
+ * Checks that a tube around a finely sampled straight centre line retains 
+ * the particles within the tube radius of the line segment, that the centre
+ * line is simplified to its end points, and that points near the tube 
+ * surface are not considered contained.
+ */
+TEST_F(PoreRegionFilterTest, PoreRegionFilterCentreLineTest)
+{
+    // straight centre line along z-axis:
+    std::vector<gmx::RVec> centreLine;
+    for(int i = 0; i <= 100; i++)
+    {
+        centreLine.push_back(gmx::RVec(0.0, 0.0, -1.0 + 0.02*i));
+    }
+
+    real tubeRadius = 0.5;
+    PoreRegionFilter filter(centreLine, tubeRadius, 0.01, &pbc_);
+    ASSERT_EQ(2, filter.numCentreLinePoints());
+
+    std::vector<int> inside = filter.filter(positions_);
+    std::vector<bool> isInside(positions_.size(), false);
+    for(auto idx : inside)
+    {
+        isInside.at(idx) = true;
+    }
+
+    for(size_t i = 0; i < positions_.size(); i++)
+    {
+        // distance from segment between z = -1 and z = 1:
+        real dz = std::max<real>(std::fabs(positions_[i][ZZ]) - 1.0, 0.0);
+        real dist = std::sqrt(positions_[i][XX]*positions_[i][XX] + 
+                              positions_[i][YY]*positions_[i][YY] + 
+                              dz*dz);
+        ASSERT_NEAR(dist, filter.distance(positions_[i]), 1e-6);
+        if( std::fabs(dist - tubeRadius) > 1e-6 )
+        {
+            ASSERT_EQ(dist < tubeRadius, isInside[i]);
+        }
+    }
+
+    // containment of points with search reach:
+    std::vector<gmx::RVec> points = {gmx::RVec(0.1, 0.0, 0.0), 
+                                     gmx::RVec(0.0, 0.0, 1.2)};
+    ASSERT_TRUE(filter.contains(points, 0.25));
+    ASSERT_FALSE(filter.contains(points, 0.35));
+}
+
+
+/*!
+ * Checks that a bent centre line is only simplified within the given 
+ * tolerance.
+ */
+TEST_F(PoreRegionFilterTest, PoreRegionFilterSimplificationTest)
+{
+    // quarter circle of radius one:
+    std::vector<gmx::RVec> centreLine;
+    int numPoints = 100;
+    for(int i = 0; i <= numPoints; i++)
+    {
+        real phi = 0.5*std::acos(-1.0)*i/numPoints;
+        centreLine.push_back(gmx::RVec(std::cos(phi), std::sin(phi), 0.0));
+    }
+
+    real tol = 0.01;
+    PoreRegionFilter filter(centreLine, 0.5, tol, &pbc_);
+    ASSERT_LT(filter.numCentreLinePoints(), centreLine.size());
+    ASSERT_GT(filter.numCentreLinePoints(), 2);
+    for(auto &point : centreLine)
+    {
+        ASSERT_LE(filter.distance(point), tol + 1e-6);
+    }
+}
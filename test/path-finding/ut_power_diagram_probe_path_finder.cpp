@@ -0,0 +1,331 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "path-finding/power_diagram_probe_path_finder.hpp"
+
+
+/*!
+ * \brief Test fixture for PowerDiagramProbePathFinder.
+ *
+ * Provides default parameters and a function to create an artificial 
+ * cylindrical pore oriented along the z-axis.
+ */
+class PowerDiagramProbePathFinderTest : public ::testing::Test
+{
+    public:
+
+        // constructor:
+        PowerDiagramProbePathFinderTest()
+        {
+            // path finder parameters:
+            params_["pfProbeStepLength"] = 0.05;
+            params_["pfProbeMaxRadius"] = 1.0;
+            params_["pfProbeMaxSteps"] = 1000;
+
+            // box is chosen so that periodicity does not matter:
+            clear_mat(boxMat_);
+        };
+
+        // standard parameters for tests:
+        std::map<std::string, real> params_;
+
+        // box matrix for pbc:
+        matrix boxMat_;
+
+        // mathematical constants:
+        const real PI_ = std::acos(-1.0);
+
+        // create a cylindrical mock pore along the z-axis:
+        std::vector<gmx::RVec> makePore(
+                real poreLength,
+                real poreCentreRadius,
+                real poreVdwRadius)
+        {
+            // angle required for overlapping vdW spheres:
+            real phi = std::acos(1.0 - std::pow(poreVdwRadius, 2.0)/2.0
+                                     /std::pow(poreCentreRadius, 2.0));
+            int nStepsAround = std::ceil(2.0*PI_/phi);
+            phi = 2.0*PI_/nStepsAround;
+
+            // step length and number of steps along the length of the pore:
+            real stepLengthAlong = poreVdwRadius/2.0;
+            int nStepsAlong = std::ceil(poreLength/stepLengthAlong) + 1;
+
+            // place particles on cylinder surface centered around origin:
+            std::vector<gmx::RVec> particleCentres;
+            for(int i = 0; i < nStepsAlong; i++)
+            {
+                for(int j = 0; j < nStepsAround; j++)
+                {
+                    particleCentres.push_back(gmx::RVec(
+                            poreCentreRadius*std::cos(phi*j),
+                            poreCentreRadius*std::sin(phi*j),
+                            i*stepLengthAlong - poreLength/2.0));
+                }
+            }
+
+            return particleCentres;
+        };
+
+        // run path finder on given pore:
+        void findPath(
+                const std::vector<gmx::RVec> &particleCentres,
+                const std::vector<real> &vdwRadii,
+                gmx::RVec initProbePos,
+                gmx::RVec chanDirVec,
+                std::vector<gmx::RVec> &points,
+                std::vector<real> &radii)
+        {
+            t_pbc pbc;
+            set_pbc(&pbc, 1, boxMat_);
+            gmx::AnalysisNeighborhoodPositions nbhPos(particleCentres);
+
+            PowerDiagramProbePathFinder pfm(params_,
+                                            initProbePos,
+                                            chanDirVec,
+                                            &pbc,
+                                            nbhPos,
+                                            vdwRadii);
+
+            PathFindingParameters par;
+            par.setProbeStepLength(params_["pfProbeStepLength"]);
+            par.setMaxProbeRadius(params_["pfProbeMaxRadius"]);
+            par.setMaxProbeSteps(params_["pfProbeMaxSteps"]);
+            pfm.setParameters(par);
+
+            pfm.findPath();
+            points = pfm.pathPoints();
+            radii = pfm.pathRadii();
+        };
+};
+
+
+/*!
+ * Tests the path finder on a cylindrical pore along the z-axis made from 
+ * overlapping spheres of equal radius (see the tests for 
+ * InplaneOptimisedProbePathFinder for details on the geometry). The initial
+ * probe position is placed off the pore axis. All path points inside the pore
+ * must lie on the pore axis and have a radius between the minimal and 
+ * maximal free radius of the pore. As the algorithm is deterministic, a 
+ * second run must give identical results.
+ */
+TEST_F(PowerDiagramProbePathFinderTest, PowerDiagramProbePathFinderCylinderTest)
+{
+    // define pore parameters:
+    real poreLength = 2.0;
+    real poreCentreRadius = 0.5;
+    real poreVdwRadius = 0.2;
+
+    // true pore radius:
+    real poreMinFreeRadius = poreCentreRadius - poreVdwRadius;
+    real poreMaxFreeRadius = std::sqrt(std::pow(poreVdwRadius/4.0, 2.0) +
+                             std::pow(poreCentreRadius, 2.0)) - poreVdwRadius;
+
+    // create pore:
+    std::vector<gmx::RVec> particleCentres = makePore(poreLength,
+                                                      poreCentreRadius,
+                                                      poreVdwRadius);
+    std::vector<real> vdwRadii(particleCentres.size(), poreVdwRadius);
+
+    // find path from off-axis initial position:
+    gmx::RVec initProbePos(0.1*poreCentreRadius, 
+                           -0.3*poreCentreRadius, 
+                           0.3*poreCentreRadius);
+    gmx::RVec chanDirVec(0.0, 0.0, 1.0);
+    std::vector<gmx::RVec> points;
+    std::vector<real> radii;
+    findPath(particleCentres, vdwRadii, initProbePos, chanDirVec, points, 
+             radii);
+
+    // path must leave pore on both sides:
+    // (forward direction comes first in reverse order)
+    ASSERT_GT(points.front()[ZZ], 0.5*poreLength);
+    ASSERT_LT(points.back()[ZZ], -0.5*poreLength);
+    ASSERT_EQ(params_["pfProbeMaxRadius"], radii.front());
+    ASSERT_EQ(params_["pfProbeMaxRadius"], radii.back());
+
+    // check internal points:
+    real tol = std::sqrt(std::numeric_limits<real>::epsilon());
+    int numInternal = 0;
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        if( std::abs(points[i][ZZ]) > 0.5*poreLength - poreVdwRadius )
+        {
+            continue;
+        }
+        numInternal++;
+
+        ASSERT_LE(poreMinFreeRadius - tol, radii[i]);
+        ASSERT_GE(poreMaxFreeRadius + tol, radii[i]);
+        ASSERT_NEAR(0.0, points[i][XX], tol);
+        ASSERT_NEAR(0.0, points[i][YY], tol);
+    }
+    ASSERT_LT(0, numInternal);
+
+    // path finding is deterministic:
+    std::vector<gmx::RVec> pointsRepeat;
+    std::vector<real> radiiRepeat;
+    findPath(particleCentres, vdwRadii, initProbePos, chanDirVec, 
+             pointsRepeat, radiiRepeat);
+    ASSERT_EQ(points.size(), pointsRepeat.size());
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        ASSERT_EQ(radii[i], radiiRepeat[i]);
+        for(int d = 0; d < DIM; d++)
+        {
+            ASSERT_EQ(points[i][d], pointsRepeat[i][d]);
+        }
+    }
+}
+
+
+/*!
+ * Tests that the free disc is found exactly for atoms of unequal radii. Three
+ * atoms in the plane of the initial probe position with different radii 
+ * form a bottleneck whose maximal free disc touches all three atom surfaces.
+ */
+TEST_F(PowerDiagramProbePathFinderTest, PowerDiagramProbePathFinderUnequalRadiiTest)
+{
+    // three atoms around origin:
+    std::vector<gmx::RVec> particleCentres = {gmx::RVec( 0.5,  0.0, 0.0),
+                                              gmx::RVec(-0.3,  0.4, 0.0),
+                                              gmx::RVec(-0.3, -0.4, 0.0)};
+    std::vector<real> vdwRadii = {0.25, 0.15, 0.2};
+
+    // single plane only:
+    params_["pfProbeMaxSteps"] = 1;
+
+    std::vector<gmx::RVec> points;
+    std::vector<real> radii;
+    findPath(particleCentres, vdwRadii, gmx::RVec(0.0, 0.0, 0.0), 
+             gmx::RVec(0.0, 0.0, 1.0), points, radii);
+
+    // initial point is the middle of three:
+    ASSERT_EQ(3, points.size());
+    gmx::RVec centre = points[1];
+    real radius = radii[1];
+
+    // free disc touches all atom surfaces:
+    real tol = std::sqrt(std::numeric_limits<real>::epsilon());
+    for(size_t i = 0; i < particleCentres.size(); i++)
+    {
+        ASSERT_NEAR(radius, 
+                    std::sqrt(distance2(centre, particleCentres[i])) 
+                    - vdwRadii[i],
+                    tol);
+    }
+    ASSERT_NEAR(0.0, centre[ZZ], tol);
+}
+
+
+/*!
+ * Tests the free disc for many atoms of mixed radii against a dense grid 
+ * search. Three rings of overlapping atoms with randomly perturbed positions
+ * and radii between 0.08 and 0.3 enclose the probe, one ring in the plane of 
+ * the initial probe position and two slightly above and below it. For mixed
+ * radii, the power diagram does not coincide with the diagram of nearest atom
+ * surfaces, so that the result of the path finder must be compared with the
+ * maximum free distance found on a fine grid inside the rings.
+ */
+TEST_F(PowerDiagramProbePathFinderTest, PowerDiagramProbePathFinderMixedRadiiTest)
+{
+    // random rings of atoms around the origin:
+    std::mt19937 rng(15011992);
+    std::uniform_real_distribution<real> radiusDist(0.08, 0.3);
+    std::uniform_real_distribution<real> jitterDist(-0.05, 0.05);
+    std::vector<gmx::RVec> particleCentres;
+    std::vector<real> vdwRadii;
+    int numAround = 30;
+    std::vector<real> ringHeights = {-0.15, 0.0, 0.15};
+    for(size_t k = 0; k < ringHeights.size(); k++)
+    {
+        for(int j = 0; j < numAround; j++)
+        {
+            real phi = 2.0*PI_*(j + 0.5*k)/numAround;
+            real rho = 0.6 + jitterDist(rng);
+            particleCentres.push_back(gmx::RVec(
+                    rho*std::cos(phi) + jitterDist(rng),
+                    rho*std::sin(phi) + jitterDist(rng),
+                    ringHeights[k] + jitterDist(rng)));
+            vdwRadii.push_back(radiusDist(rng));
+        }
+    }
+
+    // single plane only, starting off-centre:
+    params_["pfProbeMaxSteps"] = 1;
+    std::vector<gmx::RVec> points;
+    std::vector<real> radii;
+    findPath(particleCentres, vdwRadii, gmx::RVec(0.15, -0.1, 0.0), 
+             gmx::RVec(0.0, 0.0, 1.0), points, radii);
+    ASSERT_EQ(3, points.size());
+    gmx::RVec centre = points[1];
+    real radius = radii[1];
+
+    // free distance over all atoms:
+    auto freeDistance = [&](const gmx::RVec &x)
+    {
+        real minFreeDist = std::numeric_limits<real>::infinity();
+        for(size_t i = 0; i < particleCentres.size(); i++)
+        {
+            minFreeDist = std::min(
+                    minFreeDist, 
+                    std::sqrt(distance2(x, particleCentres[i])) - vdwRadii[i]);
+        }
+        return minFreeDist;
+    };
+
+    // radius is the free distance at the centre:
+    real tol = std::sqrt(std::numeric_limits<real>::epsilon());
+    ASSERT_NEAR(0.0, centre[ZZ], tol);
+    ASSERT_NEAR(freeDistance(centre), radius, tol);
+
+    // dense grid search inside the rings:
+    real spacing = 0.002;
+    real gridMax = -std::numeric_limits<real>::infinity();
+    int numGrid = std::lround(0.5/spacing);
+    for(int i = -numGrid; i <= numGrid; i++)
+    {
+        for(int j = -numGrid; j <= numGrid; j++)
+        {
+            gmx::RVec x(i*spacing, j*spacing, 0.0);
+            if( norm(x) < 0.5 )
+            {
+                gridMax = std::max(gridMax, freeDistance(x));
+            }
+        }
+    }
+
+    // free distance is Lipschitz continuous with constant one:
+    real gridTol = spacing/std::sqrt(2.0) + tol;
+    ASSERT_NEAR(gridMax, radius, gridTol);
+}
@@ -147,3 +147,55 @@ TEST_F(SummaryStatisticsTest, SummaryStatisticsVarSdTest)
     ASSERT_NEAR(sd, testDataSummary.sd(), eps);
 }
 
+
+/*!
+ * Checks that merging the summary statistics of two disjoint parts of the 
+ * dataset yields the same result as updating a single object with the entire
+ * dataset. Also checks that merging with an empty object has no effect.
+ */
+TEST_F(SummaryStatisticsTest, SummaryStatisticsMergeTest)
+{
+    // tolerance threshold for floating point comparison:
+    real eps = 10*std::numeric_limits<real>::epsilon();
+
+    // summary statistics of entire dataset:
+    SummaryStatistics fullSummary;
+    for(size_t i = 0; i < testData_.size(); i++)
+    {
+        fullSummary.update(testData_.at(i));
+    }
+
+    // summary statistics of two parts of dataset:
+    SummaryStatistics firstSummary;
+    SummaryStatistics secondSummary;
+    for(size_t i = 0; i < testData_.size(); i++)
+    {
+        if( i < 2 )
+        {
+            firstSummary.update(testData_.at(i));
+        }
+        else
+        {
+            secondSummary.update(testData_.at(i));
+        }
+    }
+
+    // merge second part into first part and also merge an empty object:
+    firstSummary.merge(secondSummary);
+    firstSummary.merge(SummaryStatistics());
+
+    // assert correctness:
+    ASSERT_EQ(fullSummary.num(), firstSummary.num());
+    ASSERT_NEAR(fullSummary.min(), firstSummary.min(), eps);
+    ASSERT_NEAR(fullSummary.max(), firstSummary.max(), eps);
+    ASSERT_NEAR(fullSummary.mean(), firstSummary.mean(), eps);
+    ASSERT_NEAR(fullSummary.var(), firstSummary.var(), eps);
+    ASSERT_NEAR(fullSummary.sd(), firstSummary.sd(), eps);
+
+    // merging into an empty object should yield a copy:
+    SummaryStatistics emptySummary;
+    emptySummary.merge(fullSummary);
+    ASSERT_EQ(fullSummary.num(), emptySummary.num());
+    ASSERT_NEAR(fullSummary.mean(), emptySummary.mean(), eps);
+    ASSERT_NEAR(fullSummary.var(), emptySummary.var(), eps);
+}